@@ -0,0 +1,118 @@
+/**
+ * @file ble_session_test.c
+ * @brief Host unit tests for the session pool and print job scheduler (ble_session.c)
+ *
+ * Built and run by the host CMake project:
+ *
+ *   cmake -S host -B host/build && cmake --build host/build
+ *   ctest --test-dir host/build --output-on-failure
+ *
+ * The print job itself is modelled by a flag: like print_writer_open(), a
+ * new job cannot start while the previous one is still open.
+ */
+
+#include <stdio.h>
+#include "ble_session.h"
+
+static int s_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: %s\n", __func__, __LINE__, #cond); \
+        s_failures++; \
+    } \
+} while (0)
+
+static bool s_job_open;
+static int s_aborts;
+
+static void abort_job(void) {
+    s_job_open = false;
+    s_aborts++;
+}
+
+static void reset(void) {
+    ble_session_pool_init();
+    ble_session_set_print_abort_handler(abort_job);
+    s_job_open = false;
+    s_aborts = 0;
+}
+
+/**
+ * PRINT_START: take the printer and open the job
+ * @return true if the job was opened, false if queued or the buffer is busy
+ */
+static bool print_start(ble_session_t *session) {
+    if (!ble_session_print_acquire(session) || s_job_open) {
+        return false;
+    }
+    s_job_open = true;
+    return true;
+}
+
+/**
+ * PRINT_EXECUTE rejected (no film, cover open, ...)
+ */
+static ble_session_t *print_reject(ble_session_t *session) {
+    ble_session_print_abort(session);
+    return ble_session_print_release(session);
+}
+
+static void test_reject_then_new_print(void) {
+    reset();
+    ble_session_t *a = ble_session_open(1);
+    CHECK(a != NULL);
+
+    CHECK(print_start(a));
+    CHECK(print_reject(a) == NULL);
+    CHECK(s_aborts == 1 && !s_job_open);
+    CHECK(ble_session_print_owner() == NULL);
+
+    // The app retries once the error is cleared
+    CHECK(print_start(a));
+    CHECK(ble_session_print_owner() == a);
+}
+
+static void test_reject_hands_over_free_buffer(void) {
+    reset();
+    ble_session_t *a = ble_session_open(1);
+    ble_session_t *b = ble_session_open(2);
+    CHECK(a != NULL && b != NULL);
+
+    CHECK(print_start(a));
+    CHECK(!print_start(b));  // Queued behind a
+
+    // The printer goes to b with the buffer already free
+    CHECK(print_reject(a) == b);
+    CHECK(ble_session_print_owner() == b);
+    CHECK(print_start(b));
+    CHECK(s_aborts == 1);
+}
+
+static void test_abort_needs_ownership(void) {
+    reset();
+    ble_session_t *a = ble_session_open(1);
+    ble_session_t *b = ble_session_open(2);
+
+    CHECK(print_start(a));
+    CHECK(!print_start(b));
+
+    // A queued session has no job to abandon - a's job must survive
+    CHECK(!ble_session_print_abort(b));
+    CHECK(ble_session_print_release(b) == NULL);
+    CHECK(s_aborts == 0 && s_job_open);
+    CHECK(ble_session_print_owner() == a);
+}
+
+int main(void) {
+    test_reject_then_new_print();
+    test_reject_hands_over_free_buffer();
+    test_abort_needs_ownership();
+
+    if (s_failures > 0) {
+        printf("%d checks failed\n", s_failures);
+        return 1;
+    }
+    printf("All session tests passed\n");
+    return 0;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file checksum_bench.c
+ * @brief Host benchmark: Instax frame checksum, word-wide vs byte loop
+ *
+ * Built by the host CMake project (instax_protocol.c has no ESP-IDF
+ * dependencies) at the firmware's optimization level, -Og by default:
+ *
+ *   cmake -S host -B host/build [-DINSTAX_BENCH_OPT=-Os] && cmake --build host/build
+ *   host/build/checksum_bench
+ *
+ * Checks instax_calculate_checksum() and the running checksum against the
+ * original byte loop for every length and alignment first, then times one
+ * PRINT_DATA frame per model chunk size: the byte loop, the word-wide
+ * kernel, and the running checksum fed in BLE-write-sized pieces as
+ * reassembly does.
+ *
+ * On an x86-64 host the word-wide kernel measured about 4x the byte loop at
+ * -Og, 1.4-1.8x at -Os and 1.6-2.8x at -O2. At -O3 GCC vectorizes the byte
+ * loop and it is the faster one (0.5-0.7x), which says nothing about Xtensa.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "instax_protocol.h"
+
+#define ITERATIONS      200000
+#define WRITE_SIZE      INSTAX_MAX_BLE_PACKET_SIZE
+
+// The checksum loop as it was before the word-wide kernel
+static uint8_t checksum_bytewise(const uint8_t *data, size_t len) {
+    uint8_t sum = 0;
+    for (size_t i = 0; i < len; i++) {
+        sum += data[i];
+    }
+    return (255 - sum) & 0xFF;
+}
+
+static uint8_t checksum_pieces(const uint8_t *data, size_t len, size_t piece) {
+    instax_checksum_t ctx;
+    instax_checksum_init(&ctx);
+    for (size_t off = 0; off < len; off += piece) {
+        instax_checksum_update(&ctx, &data[off], len - off < piece ? len - off : piece);
+    }
+    return instax_checksum_final(&ctx);
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int verify(const uint8_t *buf, size_t size) {
+    int failures = 0;
+    for (size_t align = 0; align < 4; align++) {
+        for (size_t len = 0; len + align <= size; len++) {
+            uint8_t expected = checksum_bytewise(&buf[align], len);
+            if (instax_calculate_checksum(&buf[align], len) != expected) {
+                printf("FAIL: one-shot checksum, offset %zu length %zu\n", align, len);
+                failures++;
+            }
+            if (checksum_pieces(&buf[align], len, 7) != expected) {
+                printf("FAIL: running checksum, offset %zu length %zu\n", align, len);
+                failures++;
+            }
+        }
+    }
+
+    // A frame with its checksum byte appended must validate
+    uint8_t frame[64];
+    memcpy(frame, buf, sizeof(frame) - 1);
+    frame[sizeof(frame) - 1] = instax_calculate_checksum(frame, sizeof(frame) - 1);
+    instax_checksum_t ctx;
+    instax_checksum_init(&ctx);
+    instax_checksum_update(&ctx, frame, sizeof(frame));
+    if (!instax_checksum_frame_valid(&ctx)) {
+        printf("FAIL: frame with correct checksum byte rejected\n");
+        failures++;
+    }
+    frame[10] ^= 0x01;
+    instax_checksum_init(&ctx);
+    instax_checksum_update(&ctx, frame, sizeof(frame));
+    if (instax_checksum_frame_valid(&ctx)) {
+        printf("FAIL: corrupted frame accepted\n");
+        failures++;
+    }
+    return failures;
+}
+
+int main(void) {
+    // Largest frame: Square chunk + header, index and checksum, plus alignment room
+    static uint8_t buf[2048 + 4];
+    srand(1);
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = (uint8_t)rand();
+    }
+    // All-0xFF data is the worst case for lane overflow
+    static uint8_t ones[2048];
+    memset(ones, 0xFF, sizeof(ones));
+
+    int failures = verify(buf, sizeof(buf)) + verify(ones, sizeof(ones));
+    if (failures > 0) {
+        printf("%d checksum mismatches\n", failures);
+        return 1;
+    }
+    printf("Checksums match the byte loop for every length and alignment\n\n");
+
+    const instax_model_t models[] = { INSTAX_MODEL_MINI, INSTAX_MODEL_SQUARE, INSTAX_MODEL_WIDE };
+    const char *names[] = { "mini", "square", "wide" };
+    printf("%-7s %6s %12s %12s %12s %8s\n", "model", "frame", "byte ns", "word ns", "running ns", "speedup");
+
+    volatile uint8_t sink = 0;
+    for (size_t m = 0; m < sizeof(models) / sizeof(models[0]); m++) {
+        // Checksum covers the frame without its checksum byte
+        size_t len = 6 + 4 + instax_get_model_info(models[m])->chunk_size;
+
+        double start = now_s();
+        for (int i = 0; i < ITERATIONS; i++) {
+            sink += checksum_bytewise(buf, len);
+            buf[0] = (uint8_t)i;    // Keep the loop from being hoisted
+        }
+        double byte_ns = (now_s() - start) * 1e9 / ITERATIONS;
+
+        start = now_s();
+        for (int i = 0; i < ITERATIONS; i++) {
+            sink += instax_calculate_checksum(buf, len);
+            buf[0] = (uint8_t)i;
+        }
+        double word_ns = (now_s() - start) * 1e9 / ITERATIONS;
+
+        start = now_s();
+        for (int i = 0; i < ITERATIONS; i++) {
+            sink += checksum_pieces(buf, len, WRITE_SIZE);
+            buf[0] = (uint8_t)i;
+        }
+        double running_ns = (now_s() - start) * 1e9 / ITERATIONS;
+
+        printf("%-7s %6zu %12.1f %12.1f %12.1f %7.1fx\n",
+               names[m], len + 1, byte_ns, word_ns, running_ns, byte_ns / word_ns);
+    }
+    (void)sink;
+
+    return 0;
+}
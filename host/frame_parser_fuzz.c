@@ -0,0 +1,264 @@
+/**
+ * @file frame_parser_fuzz.c
+ * @brief Host fuzz test for the streaming Instax frame parser
+ *
+ * Randomized run (default 20000 rounds, seed from the command line), built by
+ * the host CMake project; ctest runs a short session:
+ *
+ *   cmake -S host -B host/build -DINSTAX_HOST_SANITIZE=ON && cmake --build host/build
+ *   host/build/frame_parser_fuzz [rounds] [seed]
+ *
+ * libFuzzer:
+ *
+ *   clang -O1 -g -fsanitize=fuzzer,address,undefined -DFUZZ_LIBFUZZER -I main \
+ *      host/frame_parser_fuzz.c main/instax_protocol.c -o frame_parser_fuzz
+ *
+ * Each round builds a stream of valid frames, corrupted frames and junk,
+ * pushes it in random slices and checks that exactly the valid frames come
+ * out, in order. Junk and frame bodies never contain the first header byte,
+ * so no false header can swallow a real frame and the expected output is
+ * exact. Rounds alternate between a parser that reuses one buffer and one
+ * that keeps each buffer, as the peripheral does with ring slots. Arbitrary
+ * bytes (libFuzzer input, and a share of the random rounds) are checked for
+ * memory errors and for every emitted frame being well formed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "instax_protocol.h"
+
+#define BUF_SIZE        2048
+#define STREAM_MAX      (64 * 1024)
+#define FRAMES_MAX      256
+
+typedef struct {
+    bool keep;                      // Keep each buffer (rotate through bufs)
+    uint8_t bufs[4][BUF_SIZE];
+    unsigned next_buf;
+    unsigned outstanding;           // Buffers handed out and not returned
+    // Emitted frames, concatenated
+    uint8_t out[STREAM_MAX];
+    size_t out_len;
+    size_t frames;
+    int errors;
+} sink_t;
+
+static uint8_t *get_buffer(void *ctx, size_t *capacity) {
+    sink_t *sink = ctx;
+    *capacity = BUF_SIZE;
+    sink->outstanding++;
+    if (!sink->keep) {
+        return sink->bufs[0];
+    }
+    return sink->bufs[sink->next_buf++ % 4];
+}
+
+static bool on_frame(void *ctx, uint8_t *frame, size_t len) {
+    sink_t *sink = ctx;
+    uint8_t function, operation;
+    const uint8_t *payload;
+    size_t payload_len;
+    if (!instax_parse_command(frame, len, &function, &operation, &payload, &payload_len) ||
+        payload_len != len - 7) {
+        printf("FAIL: emitted frame of %zu bytes does not parse\n", len);
+        sink->errors++;
+    }
+    if (sink->out_len + len <= sizeof(sink->out)) {
+        memcpy(&sink->out[sink->out_len], frame, len);
+        sink->out_len += len;
+    }
+    sink->frames++;
+    return sink->keep;
+}
+
+static uint8_t random_body_byte(void) {
+    uint8_t b;
+    do {
+        b = (uint8_t)rand();
+    } while (b == INSTAX_HEADER_TO_DEVICE_0);
+    return b;
+}
+
+static size_t build_frame(uint8_t *dst, size_t payload_len) {
+    size_t len = 7 + payload_len;
+    dst[0] = INSTAX_HEADER_TO_DEVICE_0;
+    dst[1] = INSTAX_HEADER_TO_DEVICE_1;
+    dst[2] = (uint8_t)(len >> 8);
+    dst[3] = (uint8_t)len;
+    for (size_t i = 4; i < len - 1; i++) {
+        dst[i] = random_body_byte();
+    }
+    dst[len - 1] = instax_calculate_checksum(dst, len - 1);
+    // The checksum byte can be anything - redo the body until it is not a header byte
+    while (dst[len - 1] == INSTAX_HEADER_TO_DEVICE_0) {
+        dst[4] = random_body_byte();
+        dst[len - 1] = instax_calculate_checksum(dst, len - 1);
+    }
+    return len;
+}
+
+static void push_slices(instax_parser_t *parser, const uint8_t *stream, size_t len, size_t max_slice) {
+    size_t off = 0;
+    while (off < len) {
+        size_t n = 1 + (size_t)rand() % max_slice;
+        if (n > len - off) {
+            n = len - off;
+        }
+        if (rand() % 2) {
+            instax_parser_push(parser, &stream[off], n);
+        } else {
+            // Copy-in path, as the peripheral uses
+            size_t done = 0;
+            while (done < n) {
+                size_t space;
+                uint8_t *dst = instax_parser_write_ptr(parser, &space);
+                size_t m = n - done < space ? n - done : space;
+                memcpy(dst, &stream[off + done], m);
+                instax_parser_written(parser, m);
+                done += m;
+            }
+        }
+        off += n;
+    }
+}
+
+/**
+ * Structured round: the output must be exactly the valid frames
+ */
+static int structured_round(bool keep) {
+    static uint8_t stream[STREAM_MAX];
+    static uint8_t expected[STREAM_MAX];
+    static sink_t sink;
+    size_t stream_len = 0, expected_len = 0, expected_frames = 0, corrupted = 0;
+
+    memset(&sink, 0, sizeof(sink));
+    sink.keep = keep;
+
+    int count = 1 + rand() % 40;
+    for (int i = 0; i < count && stream_len < STREAM_MAX - 4096; i++) {
+        int kind = rand() % 10;
+        if (kind == 0) {
+            // Junk between frames
+            size_t n = 1 + (size_t)rand() % 64;
+            for (size_t j = 0; j < n; j++) {
+                stream[stream_len++] = random_body_byte();
+            }
+            continue;
+        }
+
+        // Mostly small command frames, sometimes a full Square chunk
+        size_t payload = (kind == 1) ? 4 + 1808 : (size_t)rand() % 40;
+        size_t len = build_frame(&stream[stream_len], payload);
+        if (kind == 2 && len > 5) {
+            // Corrupt one body or checksum byte (not the header or length)
+            size_t pos = 4 + (size_t)rand() % (len - 4);
+            uint8_t b;
+            do {
+                b = random_body_byte();
+            } while (b == stream[stream_len + pos]);
+            stream[stream_len + pos] = b;
+            corrupted++;
+        } else if (kind == 3 && i == count - 1) {
+            // Truncated last frame - never completes
+            len = 4 + (size_t)rand() % (len - 4);
+            stream_len += len;
+            continue;
+        } else {
+            memcpy(&expected[expected_len], &stream[stream_len], len);
+            expected_len += len;
+            expected_frames++;
+        }
+        stream_len += len;
+    }
+
+    instax_parser_t parser;
+    instax_parser_init(&parser, true, get_buffer, on_frame, &sink);
+    push_slices(&parser, stream, stream_len, 1 + (size_t)rand() % 300);
+
+    int errors = sink.errors;
+    if (sink.frames != expected_frames || sink.out_len != expected_len ||
+        memcmp(sink.out, expected, expected_len) != 0) {
+        printf("FAIL: %zu frames out, %zu expected (%zu corrupted, keep=%d)\n",
+               sink.frames, expected_frames, corrupted, keep);
+        errors++;
+    }
+    if (parser.stats.frames != expected_frames || parser.stats.bad_checksum < corrupted) {
+        printf("FAIL: stats %u frames / %u bad checksums, expected %zu / >= %zu\n",
+               (unsigned)parser.stats.frames, (unsigned)parser.stats.bad_checksum,
+               expected_frames, corrupted);
+        errors++;
+    }
+    if (parser.stats.bytes_dropped != 0) {
+        printf("FAIL: %u bytes dropped with buffers available\n", (unsigned)parser.stats.bytes_dropped);
+        errors++;
+    }
+    return errors;
+}
+
+/**
+ * Arbitrary bytes: only memory safety and well-formed output are checked
+ */
+static int run_bytes(const uint8_t *data, size_t len, bool keep, size_t max_slice) {
+    static sink_t sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.keep = keep;
+
+    instax_parser_t parser;
+    instax_parser_init(&parser, true, get_buffer, on_frame, &sink);
+    push_slices(&parser, data, len, max_slice);
+    if (instax_parser_buffered(&parser) >= BUF_SIZE) {
+        printf("FAIL: parser holds %zu bytes\n", instax_parser_buffered(&parser));
+        sink.errors++;
+    }
+    return sink.errors;
+}
+
+#ifdef FUZZ_LIBFUZZER
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    srand(data[0]);
+    if (run_bytes(data + 1, size - 1, data[0] & 1, 1 + data[0] * 4) != 0) {
+        abort();
+    }
+    return 0;
+}
+
+#else
+
+int main(int argc, char **argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 20000;
+    unsigned seed = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 0) : 1;
+    srand(seed);
+
+    static uint8_t noise[8192];
+    int errors = 0;
+    for (int i = 0; i < rounds && errors < 10; i++) {
+        if (i % 4 == 3) {
+            // Random bytes seeded with real headers
+            size_t len = (size_t)rand() % sizeof(noise);
+            for (size_t j = 0; j < len; j++) {
+                noise[j] = (uint8_t)rand();
+                if (rand() % 64 == 0 && j + 1 < len) {
+                    noise[j++] = INSTAX_HEADER_TO_DEVICE_0;
+                    noise[j] = INSTAX_HEADER_TO_DEVICE_1;
+                }
+            }
+            errors += run_bytes(noise, len, i & 1, 1 + (size_t)rand() % 300);
+        } else {
+            errors += structured_round(i & 1);
+        }
+    }
+
+    if (errors > 0) {
+        printf("%d failures (seed %u)\n", errors, seed);
+        return 1;
+    }
+    printf("%d rounds passed (seed %u)\n", rounds, seed);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * @file frame_ring_test.c
+ * @brief Host unit tests for the reassembled-frame ring (frame_ring.c)
+ *
+ * Built and run by the host CMake project:
+ *
+ *   cmake -S host -B host/build && cmake --build host/build
+ *   ctest --test-dir host/build --output-on-failure
+ *
+ * Plays the NimBLE host task (acquire/commit per connection) and the
+ * protocol task (peek/release) in one thread.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "frame_ring.h"
+
+static int s_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: %s\n", __func__, __LINE__, #cond); \
+        s_failures++; \
+    } \
+} while (0)
+
+static frame_ring_t s_ring;
+
+/**
+ * Reassemble and commit one frame for a connection
+ */
+static frame_ring_slot_t *push_frame(uint8_t session, uint8_t seq) {
+    frame_ring_slot_t *slot = frame_ring_acquire(&s_ring);
+    if (slot == NULL) {
+        return NULL;
+    }
+    slot->kind = FRAME_RING_KIND_PACKET;
+    slot->session = session;
+    slot->data[0] = seq;
+    slot->len = 1;
+    frame_ring_commit(&s_ring, slot);
+    return slot;
+}
+
+static void test_commit_order(void) {
+    frame_ring_init(&s_ring);
+    CHECK(frame_ring_peek(&s_ring) == NULL);
+
+    // Two connections mid-frame; the one that completes first is consumed first
+    frame_ring_slot_t *a = frame_ring_acquire(&s_ring);
+    frame_ring_slot_t *b = frame_ring_acquire(&s_ring);
+    CHECK(a != NULL && b != NULL && a != b);
+    b->session = 1;
+    frame_ring_commit(&s_ring, b);
+    a->session = 0;
+    frame_ring_commit(&s_ring, a);
+
+    CHECK(frame_ring_peek(&s_ring) == b);
+    frame_ring_release(&s_ring);
+    CHECK(frame_ring_peek(&s_ring) == a);
+    frame_ring_release(&s_ring);
+    CHECK(frame_ring_peek(&s_ring) == NULL);
+}
+
+static void test_stalled_connection(void) {
+    frame_ring_init(&s_ring);
+
+    // Connection 0 stops halfway through a PRINT_DATA frame and never commits
+    frame_ring_slot_t *stalled = frame_ring_acquire(&s_ring);
+    CHECK(stalled != NULL);
+
+    // Connection 1 keeps going for many times the ring size
+    for (int i = 0; i < FRAME_RING_SLOTS * 10; i++) {
+        frame_ring_slot_t *slot = push_frame(1, (uint8_t)i);
+        CHECK(slot != NULL && slot != stalled);
+        frame_ring_slot_t *next = frame_ring_peek(&s_ring);
+        CHECK(next == slot && next->session == 1 && next->data[0] == (uint8_t)i);
+        frame_ring_release(&s_ring);
+    }
+
+    frame_ring_stats_t stats;
+    frame_ring_get_stats(&s_ring, &stats);
+    CHECK(stats.depth == 0 && stats.reserved == 1 && stats.dropped == 0);
+    CHECK(stats.pushed == FRAME_RING_SLOTS * 10);
+
+    // The stalled frame is abandoned as a drop marker and its slot comes back
+    stalled->kind = FRAME_RING_KIND_DROPPED;
+    frame_ring_commit(&s_ring, stalled);
+    CHECK(frame_ring_peek(&s_ring) == stalled);
+    frame_ring_release(&s_ring);
+    frame_ring_get_stats(&s_ring, &stats);
+    CHECK(stats.depth == 0 && stats.reserved == 0);
+}
+
+static void test_full(void) {
+    frame_ring_init(&s_ring);
+
+    // Every slot queued - the next frame is dropped until one is consumed
+    for (int i = 0; i < FRAME_RING_SLOTS; i++) {
+        CHECK(push_frame(0, (uint8_t)i) != NULL);
+    }
+    CHECK(frame_ring_acquire(&s_ring) == NULL);
+
+    frame_ring_stats_t stats;
+    frame_ring_get_stats(&s_ring, &stats);
+    CHECK(stats.depth == FRAME_RING_SLOTS && stats.high_water == FRAME_RING_SLOTS && stats.dropped == 1);
+
+    CHECK(frame_ring_peek(&s_ring)->data[0] == 0);
+    frame_ring_release(&s_ring);
+    CHECK(push_frame(0, FRAME_RING_SLOTS) != NULL);
+    for (int i = 1; i <= FRAME_RING_SLOTS; i++) {
+        frame_ring_slot_t *slot = frame_ring_peek(&s_ring);
+        CHECK(slot != NULL && slot->data[0] == (uint8_t)i);
+        frame_ring_release(&s_ring);
+    }
+    CHECK(frame_ring_peek(&s_ring) == NULL);
+}
+
+int main(void) {
+    test_commit_order();
+    test_stalled_connection();
+    test_full();
+
+    if (s_failures > 0) {
+        printf("%d checks failed\n", s_failures);
+        return 1;
+    }
+    printf("All frame ring tests passed\n");
+    return 0;
+}
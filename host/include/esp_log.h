@@ -0,0 +1,22 @@
+/**
+ * @file esp_log.h
+ * @brief Host stand-in for the ESP-IDF logging calls used by main/ sources
+ *
+ * Only for sources in the host build; log lines are discarded.
+ */
+
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+#include <stdint.h>
+
+#define ESP_LOGE(tag, fmt, ...) ((void)(tag))
+#define ESP_LOGW(tag, fmt, ...) ((void)(tag))
+#define ESP_LOGI(tag, fmt, ...) ((void)(tag))
+#define ESP_LOGD(tag, fmt, ...) ((void)(tag))
+
+static inline uint32_t esp_log_timestamp(void) {
+    return 0;
+}
+
+#endif // HOST_ESP_LOG_H
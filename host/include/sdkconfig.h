@@ -0,0 +1,14 @@
+/**
+ * @file sdkconfig.h
+ * @brief Host stand-in for the generated ESP-IDF configuration
+ *
+ * Only the options used by main/ sources in the host build, with the values
+ * from the project sdkconfig.
+ */
+
+#ifndef HOST_SDKCONFIG_H
+#define HOST_SDKCONFIG_H
+
+#define CONFIG_BT_NIMBLE_MAX_CONNECTIONS 3
+
+#endif // HOST_SDKCONFIG_H
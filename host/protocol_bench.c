@@ -0,0 +1,123 @@
+/**
+ * @file protocol_bench.c
+ * @brief Host benchmark: PRINT_DATA frame build and parse rate per model
+ *
+ * Built by the host CMake project (Release by default):
+ *
+ *   cmake -S host -B host/build && cmake --build host/build
+ *   host/build/protocol_bench [iterations]
+ *
+ * For each model's chunk size it times:
+ *   create  - instax_create_print_data() into a flat buffer
+ *   gather  - instax_build_print_data(), header and checksum only
+ *   parse   - instax_parse_command() on a whole frame
+ *   stream  - instax_parser_push() of a frame in BLE-write-sized pieces
+ * and prints frames per second and the payload rate each one reaches.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "instax_protocol.h"
+
+#define DEFAULT_ITERATIONS  100000
+#define WRITE_SIZE          INSTAX_MAX_BLE_PACKET_SIZE
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+typedef struct {
+    uint8_t buf[2048];
+    size_t frames;
+} bench_sink_t;
+
+static uint8_t *sink_buffer(void *ctx, size_t *capacity) {
+    bench_sink_t *sink = ctx;
+    *capacity = sizeof(sink->buf);
+    return sink->buf;
+}
+
+static bool sink_frame(void *ctx, uint8_t *frame, size_t len) {
+    bench_sink_t *sink = ctx;
+    sink->frames++;
+    return false;
+}
+
+static void report(const char *model, const char *op, int iterations, double seconds, size_t chunk) {
+    double fps = iterations / seconds;
+    printf("%-7s %-7s %6zu %14.0f %10.1f\n", model, op, chunk, fps, fps * chunk / (1024.0 * 1024.0));
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) {
+        iterations = DEFAULT_ITERATIONS;
+    }
+
+    static uint8_t image[2048];
+    static uint8_t frame[2048 + 16];
+    static bench_sink_t sink;
+    srand(1);
+    for (size_t i = 0; i < sizeof(image); i++) {
+        image[i] = (uint8_t)rand();
+    }
+
+    const instax_model_t models[] = { INSTAX_MODEL_MINI, INSTAX_MODEL_SQUARE, INSTAX_MODEL_WIDE };
+    const char *names[] = { "mini", "square", "wide" };
+    printf("%-7s %-7s %6s %14s %10s\n", "model", "op", "chunk", "frames/s", "MB/s");
+
+    volatile size_t keep = 0;
+    for (size_t m = 0; m < sizeof(models) / sizeof(models[0]); m++) {
+        size_t chunk = instax_get_model_info(models[m])->chunk_size;
+
+        double start = now_s();
+        for (int i = 0; i < iterations; i++) {
+            keep += instax_create_print_data((uint32_t)i, image, chunk, frame, sizeof(frame));
+        }
+        report(names[m], "create", iterations, now_s() - start, chunk);
+
+        start = now_s();
+        for (int i = 0; i < iterations; i++) {
+            instax_frame_parts_t parts;
+            keep += instax_build_print_data((uint32_t)i, image, chunk, &parts);
+            image[0] = (uint8_t)i;  // Keep the checksum from being hoisted
+        }
+        report(names[m], "gather", iterations, now_s() - start, chunk);
+
+        size_t frame_len = instax_create_print_data(0, image, chunk, frame, sizeof(frame));
+        start = now_s();
+        for (int i = 0; i < iterations; i++) {
+            uint8_t function, operation;
+            const uint8_t *payload;
+            size_t payload_len = 0;
+            if (instax_parse_command(frame, frame_len, &function, &operation, &payload, &payload_len)) {
+                keep += payload_len;
+            }
+        }
+        report(names[m], "parse", iterations, now_s() - start, chunk);
+
+        instax_parser_t parser;
+        memset(&sink, 0, sizeof(sink));
+        instax_parser_init(&parser, true, sink_buffer, sink_frame, &sink);
+        start = now_s();
+        for (int i = 0; i < iterations; i++) {
+            for (size_t off = 0; off < frame_len; off += WRITE_SIZE) {
+                size_t n = frame_len - off < WRITE_SIZE ? frame_len - off : WRITE_SIZE;
+                instax_parser_push(&parser, &frame[off], n);
+            }
+        }
+        double seconds = now_s() - start;
+        if (sink.frames != (size_t)iterations) {
+            printf("FAIL: stream parser emitted %zu of %d frames\n", sink.frames, iterations);
+            return 1;
+        }
+        report(names[m], "stream", iterations, seconds, chunk);
+    }
+    (void)keep;
+
+    return 0;
+}
@@ -0,0 +1,467 @@
+/**
+ * @file protocol_test.c
+ * @brief Host unit tests for the Instax protocol codec (instax_protocol.c)
+ *
+ * Built and run by the host CMake project:
+ *
+ *   cmake -S host -B host/build && cmake --build host/build
+ *   ctest --test-dir host/build --output-on-failure
+ *
+ * Every instax_create_* function is checked against literal wire bytes and
+ * round-tripped through instax_parse_command(); every instax_parse_*
+ * function is checked on a valid input and on each way it should reject one.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "instax_protocol.h"
+
+static int s_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: %s\n", __func__, __LINE__, #cond); \
+        s_failures++; \
+    } \
+} while (0)
+
+#define CHECK_BYTES(buf, len, ...) do { \
+    const uint8_t expected_[] = { __VA_ARGS__ }; \
+    CHECK((len) == sizeof(expected_) && memcmp((buf), expected_, sizeof(expected_)) == 0); \
+} while (0)
+
+/**
+ * Build a printer-to-app frame for the parse_response tests
+ */
+static size_t make_response(uint8_t function, uint8_t operation, const uint8_t *payload,
+                            size_t payload_len, uint8_t *buf) {
+    size_t len = 7 + payload_len;
+    buf[0] = INSTAX_HEADER_FROM_DEVICE_0;
+    buf[1] = INSTAX_HEADER_FROM_DEVICE_1;
+    buf[2] = (uint8_t)(len >> 8);
+    buf[3] = (uint8_t)len;
+    buf[4] = function;
+    buf[5] = operation;
+    if (payload_len > 0) {
+        memcpy(&buf[6], payload, payload_len);
+    }
+    buf[len - 1] = instax_calculate_checksum(buf, len - 1);
+    return len;
+}
+
+/**
+ * Parse a to-device frame and check its function, operation and payload
+ */
+static void check_command(const uint8_t *frame, size_t len, uint8_t function, uint8_t operation,
+                          const uint8_t *payload, size_t payload_len) {
+    uint8_t f = 0xEE, op = 0xEE;
+    const uint8_t *p = NULL;
+    size_t plen = 12345;
+    CHECK(instax_parse_command(frame, len, &f, &op, &p, &plen));
+    CHECK(f == function);
+    CHECK(op == operation);
+    CHECK(plen == payload_len);
+    if (payload_len == 0) {
+        CHECK(p == NULL);
+    } else {
+        CHECK(p == &frame[6]);
+        CHECK(p != NULL && memcmp(p, payload, payload_len) == 0);
+    }
+}
+
+static void test_checksum(void) {
+    const uint8_t data[] = { 0x41, 0x62, 0x00, 0x07, 0x10, 0x02 };
+    CHECK(instax_calculate_checksum(data, sizeof(data)) == 0x43);
+    CHECK(instax_calculate_checksum(NULL, 0) == 0xFF);
+
+    // Running form, split anywhere, matches the one-shot form
+    for (size_t split = 0; split <= sizeof(data); split++) {
+        instax_checksum_t ctx;
+        instax_checksum_init(&ctx);
+        instax_checksum_update(&ctx, data, split);
+        instax_checksum_update(&ctx, &data[split], sizeof(data) - split);
+        CHECK(instax_checksum_final(&ctx) == 0x43);
+    }
+
+    // A whole frame, checksum byte included, validates; a flipped bit does not
+    uint8_t frame[7];
+    memcpy(frame, data, sizeof(data));
+    frame[6] = 0x43;
+    instax_checksum_t ctx;
+    instax_checksum_init(&ctx);
+    instax_checksum_update(&ctx, frame, sizeof(frame));
+    CHECK(instax_checksum_frame_valid(&ctx));
+    frame[4] ^= 0x01;
+    instax_checksum_init(&ctx);
+    instax_checksum_update(&ctx, frame, sizeof(frame));
+    CHECK(!instax_checksum_frame_valid(&ctx));
+}
+
+static void test_model_info(void) {
+    const instax_model_info_t *mini = instax_get_model_info(INSTAX_MODEL_MINI);
+    const instax_model_info_t *square = instax_get_model_info(INSTAX_MODEL_SQUARE);
+    const instax_model_info_t *wide = instax_get_model_info(INSTAX_MODEL_WIDE);
+    CHECK(mini != NULL && mini->width == 600 && mini->height == 800 && mini->chunk_size == 900);
+    CHECK(square != NULL && square->width == 800 && square->height == 800 && square->chunk_size == 1808);
+    CHECK(wide != NULL && wide->width == 1260 && wide->height == 840 && wide->chunk_size == 900);
+    CHECK(instax_get_model_info(INSTAX_MODEL_UNKNOWN) == NULL);
+
+    CHECK(instax_detect_model(600, 800) == INSTAX_MODEL_MINI);
+    CHECK(instax_detect_model(800, 800) == INSTAX_MODEL_SQUARE);
+    CHECK(instax_detect_model(1260, 840) == INSTAX_MODEL_WIDE);
+    CHECK(instax_detect_model(800, 600) == INSTAX_MODEL_UNKNOWN);
+}
+
+static void test_model_profile(void) {
+    const instax_model_info_t *defaults = instax_get_default_model_info(INSTAX_MODEL_SQUARE);
+    CHECK(defaults != NULL && defaults->preferred_mtu == 256 && defaults->ack_delay_ms == 50);
+    CHECK(defaults->chunk_delay_ms == 75 && defaults->start_delay_ms == 100 &&
+          defaults->end_delay_ms == 100 && defaults->execute_delay_ms == 1000);
+    CHECK(instax_get_default_model_info(INSTAX_MODEL_UNKNOWN) == NULL);
+
+    // Transport fields change; dimensions and file size do not
+    instax_model_info_t profile = *defaults;
+    profile.width = 1;
+    profile.max_file_size = 1;
+    profile.chunk_size = 1200;
+    profile.preferred_mtu = 185;
+    profile.chunk_delay_ms = 20;
+    CHECK(instax_set_model_info(INSTAX_MODEL_SQUARE, &profile));
+    const instax_model_info_t *live = instax_get_model_info(INSTAX_MODEL_SQUARE);
+    CHECK(live->chunk_size == 1200 && live->preferred_mtu == 185 && live->chunk_delay_ms == 20);
+    CHECK(live->width == 800 && live->max_file_size == defaults->max_file_size);
+    CHECK(defaults->chunk_size == 1808);
+
+    // Out-of-range values are rejected whole
+    instax_model_info_t bad = profile;
+    bad.chunk_size = INSTAX_PROFILE_CHUNK_MAX + 1;
+    bad.chunk_delay_ms = 0;
+    CHECK(!instax_set_model_info(INSTAX_MODEL_SQUARE, &bad));
+    bad = profile;
+    bad.preferred_mtu = INSTAX_PROFILE_MTU_MIN - 1;
+    CHECK(!instax_set_model_info(INSTAX_MODEL_SQUARE, &bad));
+    bad = profile;
+    bad.ack_delay_ms = INSTAX_PROFILE_ACK_DELAY_MAX_MS + 1;
+    CHECK(!instax_set_model_info(INSTAX_MODEL_SQUARE, &bad));
+    bad = profile;
+    bad.execute_delay_ms = INSTAX_PROFILE_DELAY_MAX_MS + 1;
+    CHECK(!instax_set_model_info(INSTAX_MODEL_SQUARE, &bad));
+    CHECK(!instax_set_model_info(INSTAX_MODEL_UNKNOWN, &profile));
+    CHECK(live->chunk_size == 1200 && live->chunk_delay_ms == 20);
+
+    // The largest chunk still makes a PRINT_DATA frame of at most 2048 bytes
+    bad = profile;
+    bad.chunk_size = INSTAX_PROFILE_CHUNK_MAX;
+    CHECK(instax_set_model_info(INSTAX_MODEL_SQUARE, &bad));
+    static uint8_t chunk[INSTAX_PROFILE_CHUNK_MAX];
+    instax_frame_parts_t parts;
+    size_t frame_len = instax_build_print_data(0, chunk, live->chunk_size, &parts);
+    CHECK(frame_len == INSTAX_PROFILE_CHUNK_MAX + 11 && frame_len <= 2048);
+
+    // Back to the built-in profile for the tests that follow
+    CHECK(instax_set_model_info(INSTAX_MODEL_SQUARE, defaults));
+    CHECK(memcmp(live, defaults, sizeof(*live)) == 0);
+}
+
+static void test_create_info_query(void) {
+    uint8_t buf[16];
+    size_t len = instax_create_info_query(INSTAX_INFO_BATTERY, buf, sizeof(buf));
+    CHECK_BYTES(buf, len, 0x41, 0x62, 0x00, 0x08, 0x00, 0x02, 0x01, 0x51);
+
+    const instax_info_type_t types[] = {
+        INSTAX_INFO_IMAGE_SUPPORT, INSTAX_INFO_BATTERY,
+        INSTAX_INFO_PRINTER_FUNCTION, INSTAX_INFO_PRINT_HISTORY
+    };
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+        uint8_t type = (uint8_t)types[i];
+        len = instax_create_info_query(types[i], buf, sizeof(buf));
+        CHECK(len == 8);
+        check_command(buf, len, INSTAX_FUNC_INFO, INSTAX_OP_SUPPORT_FUNCTION_INFO, &type, 1);
+    }
+
+    CHECK(instax_create_info_query(INSTAX_INFO_BATTERY, buf, 7) == 0);
+}
+
+static void test_create_print_start(void) {
+    uint8_t buf[32];
+    size_t len = instax_create_print_start(0x00012345, buf, sizeof(buf));
+    CHECK_BYTES(buf, len, 0x41, 0x62, 0x00, 0x0F, 0x10, 0x00,
+                0x02, 0x00, 0x00, 0x00, 0x00, 0x01, 0x23, 0x45, 0xD2);
+
+    const uint8_t payload[] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01, 0x23, 0x45 };
+    check_command(buf, len, INSTAX_FUNC_PRINT, INSTAX_OP_PRINT_START, payload, sizeof(payload));
+
+    CHECK(instax_create_print_start(0x00012345, buf, 14) == 0);
+}
+
+static void test_create_print_data(void) {
+    static uint8_t image[1808];
+    static uint8_t buf[2048];
+    for (size_t i = 0; i < sizeof(image); i++) {
+        image[i] = (uint8_t)(i * 7 + 3);
+    }
+
+    const instax_model_t models[] = { INSTAX_MODEL_MINI, INSTAX_MODEL_SQUARE, INSTAX_MODEL_WIDE };
+    for (size_t m = 0; m < sizeof(models) / sizeof(models[0]); m++) {
+        size_t chunk = instax_get_model_info(models[m])->chunk_size;
+        size_t len = instax_create_print_data(0x01020304, image, chunk, buf, sizeof(buf));
+        CHECK(len == 7 + 4 + chunk);
+        CHECK(buf[2] == (uint8_t)(len >> 8) && buf[3] == (uint8_t)len);
+
+        uint8_t f, op;
+        const uint8_t *p;
+        size_t plen;
+        CHECK(instax_parse_command(buf, len, &f, &op, &p, &plen));
+        CHECK(f == INSTAX_FUNC_PRINT && op == INSTAX_OP_PRINT_DATA && plen == 4 + chunk);
+        CHECK(p[0] == 0x01 && p[1] == 0x02 && p[2] == 0x03 && p[3] == 0x04);
+        CHECK(memcmp(&p[4], image, chunk) == 0);
+
+        // One byte short of the frame
+        CHECK(instax_create_print_data(0, image, chunk, buf, len - 1) == 0);
+    }
+
+    // Short last chunk and an empty one
+    size_t len = instax_create_print_data(7, image, 3, buf, sizeof(buf));
+    CHECK_BYTES(buf, len, 0x41, 0x62, 0x00, 0x0E, 0x10, 0x01,
+                0x00, 0x00, 0x00, 0x07, 0x03, 0x0A, 0x11, 0x18);
+    len = instax_create_print_data(7, NULL, 0, buf, sizeof(buf));
+    CHECK(len == 11);
+    const uint8_t index[] = { 0x00, 0x00, 0x00, 0x07 };
+    check_command(buf, len, INSTAX_FUNC_PRINT, INSTAX_OP_PRINT_DATA, index, sizeof(index));
+}
+
+static void test_create_fixed_commands(void) {
+    uint8_t buf[16];
+    size_t len = instax_create_print_end(buf, sizeof(buf));
+    CHECK_BYTES(buf, len, 0x41, 0x62, 0x00, 0x07, 0x10, 0x02, 0x43);
+    check_command(buf, len, INSTAX_FUNC_PRINT, INSTAX_OP_PRINT_END, NULL, 0);
+
+    len = instax_create_led_pattern(buf, sizeof(buf));
+    CHECK_BYTES(buf, len, 0x41, 0x62, 0x00, 0x07, 0x30, 0x01, 0x24);
+    check_command(buf, len, INSTAX_FUNC_LED, INSTAX_OP_LED_PATTERN, NULL, 0);
+
+    len = instax_create_print_execute(buf, sizeof(buf));
+    CHECK_BYTES(buf, len, 0x41, 0x62, 0x00, 0x07, 0x10, 0x80, 0xC5);
+    check_command(buf, len, INSTAX_FUNC_PRINT, INSTAX_OP_PRINT_EXECUTE, NULL, 0);
+
+    CHECK(instax_create_print_end(buf, 6) == 0);
+    CHECK(instax_create_led_pattern(buf, 6) == 0);
+    CHECK(instax_create_print_execute(buf, 6) == 0);
+}
+
+static void test_build_frame(void) {
+    static uint8_t image[1808];
+    static uint8_t flat[2048], gathered[2048];
+    for (size_t i = 0; i < sizeof(image); i++) {
+        image[i] = (uint8_t)(i * 13 + 1);
+    }
+
+    // Split across segments, the frame is the same as the flat encoding
+    const instax_iovec_t segs[] = {
+        { image, 1 }, { &image[1], 0 }, { &image[1], 1000 }, { &image[1001], 807 }
+    };
+    instax_frame_parts_t parts;
+    size_t len = instax_build_frame(INSTAX_FUNC_PRINT, INSTAX_OP_PRINT_DATA, segs, 4, &parts);
+    CHECK(len == 7 + sizeof(image) && parts.frame_len == len && parts.header_len == 6);
+    CHECK(instax_frame_copy(&parts, segs, 4, gathered, sizeof(gathered)) == len);
+    check_command(gathered, len, INSTAX_FUNC_PRINT, INSTAX_OP_PRINT_DATA, image, sizeof(image));
+    CHECK(instax_frame_copy(&parts, segs, 4, gathered, len - 1) == 0);
+
+    // PRINT_DATA keeps the chunk index in the header
+    len = instax_build_print_data(42, image, sizeof(image), &parts);
+    CHECK(parts.header_len == 10 && len == 11 + sizeof(image));
+    const instax_iovec_t chunk = { image, sizeof(image) };
+    CHECK(instax_frame_copy(&parts, &chunk, 1, gathered, sizeof(gathered)) == len);
+    CHECK(instax_create_print_data(42, image, sizeof(image), flat, sizeof(flat)) == len);
+    CHECK(memcmp(flat, gathered, len) == 0);
+
+    // The 16-bit length field limits a frame to 0xFFFF bytes; data is not read
+    const instax_iovec_t huge = { image, 0xFFFF - 6 };
+    CHECK(instax_build_frame(INSTAX_FUNC_PRINT, INSTAX_OP_PRINT_DATA, &huge, 1, &parts) == 0);
+}
+
+static void test_parse_command(void) {
+    uint8_t buf[32];
+    size_t len = instax_create_print_start(1000, buf, sizeof(buf));
+    uint8_t f, op;
+    const uint8_t *p;
+    size_t plen;
+
+    // Trailing bytes after the frame are ignored
+    buf[len] = 0xAA;
+    CHECK(instax_parse_command(buf, len + 1, &f, &op, &p, &plen) && plen == 8);
+
+    CHECK(!instax_parse_command(buf, len - 1, &f, &op, &p, &plen));    // Truncated
+    CHECK(!instax_parse_command(buf, 6, &f, &op, &p, &plen));          // Below minimum
+
+    buf[len - 1] ^= 0xFF;                                               // Bad checksum
+    CHECK(!instax_parse_command(buf, len, &f, &op, &p, &plen));
+    buf[len - 1] ^= 0xFF;
+
+    buf[8] ^= 0x10;                                                     // Corrupted payload
+    CHECK(!instax_parse_command(buf, len, &f, &op, &p, &plen));
+    buf[8] ^= 0x10;
+
+    uint8_t length_lo = buf[3];
+    buf[3] = 0x06;                                                      // Length below minimum
+    CHECK(!instax_parse_command(buf, len, &f, &op, &p, &plen));
+    buf[3] = length_lo;
+
+    // Response header is not a command
+    uint8_t resp[16];
+    len = make_response(INSTAX_FUNC_PRINT, INSTAX_OP_PRINT_START, NULL, 0, resp);
+    CHECK(!instax_parse_command(resp, len, &f, &op, &p, &plen));
+}
+
+static void test_parse_response(void) {
+    const uint8_t payload[] = { 0x00, 0x00, 0x02, 0x58, 0x03, 0x20 };
+    uint8_t buf[32];
+    size_t len = make_response(INSTAX_FUNC_INFO, INSTAX_OP_SUPPORT_FUNCTION_INFO,
+                               payload, sizeof(payload), buf);
+    uint8_t f, op;
+    const uint8_t *p;
+    size_t plen;
+    CHECK(instax_parse_response(buf, len, &f, &op, &p, &plen));
+    CHECK(f == INSTAX_FUNC_INFO && op == INSTAX_OP_SUPPORT_FUNCTION_INFO);
+    CHECK(plen == sizeof(payload) && p == &buf[6]);
+
+    len = make_response(INSTAX_FUNC_PRINT, INSTAX_OP_PRINT_END, NULL, 0, buf);
+    CHECK(instax_parse_response(buf, len, &f, &op, &p, &plen) && plen == 0 && p == NULL);
+
+    CHECK(!instax_parse_response(buf, len - 1, &f, &op, &p, &plen));   // Truncated
+    buf[len - 1] ^= 0x01;                                               // Bad checksum
+    CHECK(!instax_parse_response(buf, len, &f, &op, &p, &plen));
+
+    // Command header is not a response
+    len = instax_create_print_end(buf, sizeof(buf));
+    CHECK(!instax_parse_response(buf, len, &f, &op, &p, &plen));
+}
+
+static void test_parse_info_payloads(void) {
+    // Payloads as they come out of instax_parse_response()
+    const uint8_t image_support[] = { 0x00, 0x00, 0x04, 0xEC, 0x03, 0x48 };
+    uint16_t width = 0, height = 0;
+    CHECK(instax_parse_image_support_info(image_support, sizeof(image_support), &width, &height));
+    CHECK(width == 1260 && height == 840);
+    CHECK(!instax_parse_image_support_info(image_support, 5, &width, &height));
+
+    const uint8_t battery[] = { 0x00, 0x01, 0x03, 0x55 };
+    uint8_t state = 0, percentage = 0;
+    CHECK(instax_parse_battery_info(battery, sizeof(battery), &state, &percentage));
+    CHECK(state == 3 && percentage == 85);
+    CHECK(!instax_parse_battery_info(battery, 3, &state, &percentage));
+
+    const uint8_t function_charging[] = { 0x00, 0x02, 0x88 };
+    const uint8_t function_idle[] = { 0x00, 0x02, 0x0A };
+    uint8_t photos = 0;
+    bool charging = false;
+    CHECK(instax_parse_printer_function_info(function_charging, 3, &photos, &charging));
+    CHECK(photos == 8 && charging);
+    CHECK(instax_parse_printer_function_info(function_idle, 3, &photos, &charging));
+    CHECK(photos == 10 && !charging);
+    CHECK(!instax_parse_printer_function_info(function_idle, 2, &photos, &charging));
+
+    const uint8_t history[] = { 0x00, 0x03, 0x00, 0x01, 0x02, 0x03 };
+    uint32_t count = 0;
+    CHECK(instax_parse_print_history_info(history, sizeof(history), &count));
+    CHECK(count == 0x00010203);
+    CHECK(!instax_parse_print_history_info(history, 5, &count));
+}
+
+typedef struct {
+    uint8_t buf[2048];
+    size_t frames;
+    size_t last_len;
+    uint8_t last_op;
+    size_t bad_frames;
+    uint8_t bad_op;
+} parser_sink_t;
+
+static uint8_t *sink_buffer(void *ctx, size_t *capacity) {
+    parser_sink_t *sink = ctx;
+    *capacity = sizeof(sink->buf);
+    return sink->buf;
+}
+
+static bool sink_frame(void *ctx, uint8_t *frame, size_t len) {
+    parser_sink_t *sink = ctx;
+    sink->frames++;
+    sink->last_len = len;
+    sink->last_op = frame[5];
+    return false;
+}
+
+static void sink_bad_frame(void *ctx, const uint8_t *frame, size_t len) {
+    parser_sink_t *sink = ctx;
+    sink->bad_frames++;
+    sink->bad_op = frame[5];
+}
+
+static void test_stream_parser(void) {
+    static parser_sink_t sink;
+    static uint8_t stream[4096];
+    static uint8_t image[900];
+    size_t len = 0;
+
+    // Junk, a print start, a corrupted end, a data chunk - pushed a byte at a time
+    stream[len++] = 0x00;
+    stream[len++] = 0x41;
+    len += instax_create_print_start(sizeof(image), &stream[len], sizeof(stream) - len);
+    size_t end = len;
+    len += instax_create_print_end(&stream[len], sizeof(stream) - len);
+    stream[len - 1] ^= 0x01;
+    len += instax_create_print_data(0, image, sizeof(image), &stream[len], sizeof(stream) - len);
+
+    instax_parser_t parser;
+    memset(&sink, 0, sizeof(sink));
+    instax_parser_init(&parser, true, sink_buffer, sink_frame, &sink);
+    instax_parser_set_bad_frame_handler(&parser, sink_bad_frame);
+    for (size_t i = 0; i < len; i++) {
+        instax_parser_push(&parser, &stream[i], 1);
+    }
+    CHECK(sink.frames == 2);
+    CHECK(sink.last_op == INSTAX_OP_PRINT_DATA && sink.last_len == 11 + sizeof(image));
+    CHECK(parser.stats.frames == 2 && parser.stats.bad_checksum == 1);
+    CHECK(sink.bad_frames == 1 && sink.bad_op == INSTAX_OP_PRINT_END);
+    CHECK(parser.stats.bytes_skipped >= 2);
+    CHECK(instax_parser_buffered(&parser) == 0);
+
+    // Half a frame is held until the rest arrives; reset drops it
+    memset(&sink, 0, sizeof(sink));
+    instax_parser_reset(&parser);
+    instax_parser_push(&parser, stream + end, 4);
+    CHECK(instax_parser_buffered(&parser) == 4 && instax_parser_missing(&parser) == 3);
+    instax_parser_reset(&parser);
+    CHECK(instax_parser_buffered(&parser) == 0 && sink.frames == 0);
+
+    // A printer-side parser ignores app frames and takes responses
+    uint8_t resp[16];
+    size_t resp_len = make_response(INSTAX_FUNC_PRINT, INSTAX_OP_PRINT_EXECUTE, NULL, 0, resp);
+    memset(&sink, 0, sizeof(sink));
+    instax_parser_init(&parser, false, sink_buffer, sink_frame, &sink);
+    instax_parser_push(&parser, stream, len);
+    instax_parser_push(&parser, resp, resp_len);
+    CHECK(sink.frames == 1 && sink.last_op == INSTAX_OP_PRINT_EXECUTE);
+}
+
+int main(void) {
+    test_checksum();
+    test_model_info();
+    test_model_profile();
+    test_create_info_query();
+    test_create_print_start();
+    test_create_print_data();
+    test_create_fixed_commands();
+    test_build_frame();
+    test_parse_command();
+    test_parse_response();
+    test_parse_info_payloads();
+    test_stream_parser();
+
+    if (s_failures > 0) {
+        printf("%d checks failed\n", s_failures);
+        return 1;
+    }
+    printf("All protocol tests passed\n");
+    return 0;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file ack_pacer.c
+ * @brief Adaptive pacing of PRINT_DATA acknowledgements
+ */
+
+#include "ack_pacer.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include "host/ble_hs.h"
+
+static const char *TAG = "ack_pacer";
+
+// NVS storage keys
+#define NVS_NAMESPACE           "ack_pacer"
+#define NVS_KEY_MODE            "mode"
+
+// Buffer credits: below this many free chunk slots a buffer swap is imminent;
+// if the writer is still draining, the expected flush cost is spread over
+// the remaining chunks
+#define LOW_CREDITS             2
+
+// Free mbuf low-water mark (MSYS_1 has 18 blocks) and delay per missing mbuf
+#define MBUF_LOW_WATER          4
+#define MBUF_STEP_US            5000
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static ack_pacer_stats_t s_stats = {
+    .mode = ACK_PACER_MODE_ADAPTIVE,
+    .mbuf_free = -1,
+    .mbuf_free_min = -1,
+};
+
+esp_err_t ack_pacer_init(void) {
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    if (ret == ESP_OK) {
+        uint8_t mode;
+        if (nvs_get_u8(nvs_handle, NVS_KEY_MODE, &mode) == ESP_OK && mode <= ACK_PACER_MODE_FIXED) {
+            s_stats.mode = (ack_pacer_mode_t)mode;
+        }
+        nvs_close(nvs_handle);
+    }
+
+    ESP_LOGI(TAG, "ACK pacing: %s", ack_pacer_mode_to_string(s_stats.mode));
+    return ESP_OK;
+}
+
+void ack_pacer_reset(uint32_t fixed_delay_ms) {
+    portENTER_CRITICAL(&s_lock);
+    s_stats.fixed_delay_ms = fixed_delay_ms;
+    s_stats.acks_paced = 0;
+    s_stats.acks_delayed = 0;
+    s_stats.last_delay_ms = 0;
+    s_stats.max_delay_ms = 0;
+    s_stats.total_delay_ms = 0;
+    s_stats.flush_count = 0;
+    s_stats.flush_last_us = 0;
+    s_stats.flush_max_us = 0;
+    s_stats.mbuf_free = -1;
+    s_stats.mbuf_free_min = -1;
+    // flush_avg_us is a property of the storage, not the job - keep it
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void ack_pacer_report_buffer(size_t used, size_t capacity) {
+    portENTER_CRITICAL(&s_lock);
+    s_stats.buffer_used = used;
+    s_stats.buffer_capacity = capacity;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void ack_pacer_report_drain(bool in_flight) {
+    portENTER_CRITICAL(&s_lock);
+    s_stats.drain_in_flight = in_flight;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void ack_pacer_report_flush(size_t bytes, uint32_t elapsed_us) {
+    portENTER_CRITICAL(&s_lock);
+    s_stats.flush_count++;
+    s_stats.flush_last_us = elapsed_us;
+    if (elapsed_us > s_stats.flush_max_us) {
+        s_stats.flush_max_us = elapsed_us;
+    }
+    // Exponential moving average (1/8 weight for new samples)
+    if (s_stats.flush_avg_us == 0) {
+        s_stats.flush_avg_us = elapsed_us;
+    } else {
+        s_stats.flush_avg_us = (s_stats.flush_avg_us * 7 + elapsed_us) / 8;
+    }
+    uint32_t avg_us = s_stats.flush_avg_us;
+    portEXIT_CRITICAL(&s_lock);
+
+    ESP_LOGD(TAG, "Flush: %u bytes in %lu us (avg %lu us)",
+             (unsigned)bytes, (unsigned long)elapsed_us, (unsigned long)avg_us);
+}
+
+uint32_t ack_pacer_next_delay_ms(size_t chunk_len) {
+    // Sample mbuf headroom outside the critical section
+    int mbuf_free = os_msys_num_free();
+
+    portENTER_CRITICAL(&s_lock);
+    uint32_t delay_ms;
+    if (s_stats.mode == ACK_PACER_MODE_FIXED) {
+        delay_ms = s_stats.fixed_delay_ms;
+    } else {
+        uint32_t delay_us = 0;
+
+        // Buffer credits - only throttle when the next chunk(s) will force a swap
+        // while the previous buffer is still being written
+        if (s_stats.buffer_capacity > 0 && chunk_len > 0 && s_stats.drain_in_flight) {
+            size_t free_bytes = s_stats.buffer_capacity > s_stats.buffer_used ?
+                                s_stats.buffer_capacity - s_stats.buffer_used : 0;
+            uint32_t credits = free_bytes / chunk_len;
+            if (credits < LOW_CREDITS) {
+                delay_us += s_stats.flush_avg_us * (LOW_CREDITS - credits) / LOW_CREDITS;
+            }
+        }
+
+        // Mbuf headroom - the host is running out of buffers for incoming writes
+        if (mbuf_free >= 0 && mbuf_free < MBUF_LOW_WATER) {
+            delay_us += (uint32_t)(MBUF_LOW_WATER - mbuf_free) * MBUF_STEP_US;
+        }
+
+        delay_ms = (delay_us + 999) / 1000;
+    }
+
+    if (delay_ms > ACK_PACER_MAX_DELAY_MS) {
+        delay_ms = ACK_PACER_MAX_DELAY_MS;
+    }
+    // Round up to a whole tick so short delays are not truncated to zero
+    if (delay_ms > 0) {
+        delay_ms = ((delay_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS) * portTICK_PERIOD_MS;
+    }
+
+    s_stats.acks_paced++;
+    s_stats.last_delay_ms = delay_ms;
+    s_stats.total_delay_ms += delay_ms;
+    if (delay_ms > 0) {
+        s_stats.acks_delayed++;
+    }
+    if (delay_ms > s_stats.max_delay_ms) {
+        s_stats.max_delay_ms = delay_ms;
+    }
+    s_stats.mbuf_free = mbuf_free;
+    if (s_stats.mbuf_free_min < 0 || mbuf_free < s_stats.mbuf_free_min) {
+        s_stats.mbuf_free_min = mbuf_free;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    return delay_ms;
+}
+
+esp_err_t ack_pacer_set_mode(ack_pacer_mode_t mode) {
+    if (mode != ACK_PACER_MODE_ADAPTIVE && mode != ACK_PACER_MODE_FIXED) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.mode = mode;
+    portEXIT_CRITICAL(&s_lock);
+
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    nvs_set_u8(nvs_handle, NVS_KEY_MODE, (uint8_t)mode);
+    ret = nvs_commit(nvs_handle);
+    nvs_close(nvs_handle);
+
+    ESP_LOGI(TAG, "ACK pacing set to %s", ack_pacer_mode_to_string(mode));
+    return ret;
+}
+
+void ack_pacer_get_stats(ack_pacer_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    memcpy(stats, &s_stats, sizeof(*stats));
+    portEXIT_CRITICAL(&s_lock);
+}
+
+const char* ack_pacer_mode_to_string(ack_pacer_mode_t mode) {
+    switch (mode) {
+        case ACK_PACER_MODE_ADAPTIVE: return "adaptive";
+        case ACK_PACER_MODE_FIXED:    return "fixed";
+        default:                      return "unknown";
+    }
+}
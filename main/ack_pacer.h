@@ -0,0 +1,111 @@
+/**
+ * @file ack_pacer.h
+ * @brief Adaptive pacing of PRINT_DATA acknowledgements
+ *
+ * The sending app waits for each PRINT_DATA ACK before sending the next
+ * chunk, so the time between our ACK and the next packet is the only
+ * throttle we have. Instead of sleeping a fixed time after every ACK, the
+ * pacer sizes the delay from live backpressure signals:
+ *   - RAM print buffer credits (how many more chunks fit before a swap),
+ *     which only matter while the print writer is still draining the
+ *     other buffer to flash
+ *   - measured SPIFFS flush latency
+ *   - free NimBLE mbufs
+ * With headroom on all three the delay is zero. A fixed-delay mode is kept
+ * for apps that misbehave when ACKs come back too quickly; its delay is the
+ * emulated model's ack_delay_ms transport profile field.
+ */
+
+#ifndef ACK_PACER_H
+#define ACK_PACER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Upper bound for any pacing delay (both modes)
+#define ACK_PACER_MAX_DELAY_MS              500
+
+typedef enum {
+    ACK_PACER_MODE_ADAPTIVE = 0,  // Delay derived from backpressure signals
+    ACK_PACER_MODE_FIXED = 1,     // Constant delay after every DATA ACK (legacy behaviour)
+} ack_pacer_mode_t;
+
+// Pacing statistics (per print job unless noted)
+typedef struct {
+    ack_pacer_mode_t mode;
+    uint32_t fixed_delay_ms;      // Fixed-mode delay of this job (model transport profile)
+    uint32_t acks_paced;          // DATA ACKs that went through the pacer
+    uint32_t acks_delayed;        // ACKs that were followed by a non-zero delay
+    uint32_t last_delay_ms;
+    uint32_t max_delay_ms;
+    uint32_t total_delay_ms;      // Dead time added to the transfer
+    size_t buffer_used;           // Last reported RAM buffer occupancy
+    size_t buffer_capacity;
+    bool drain_in_flight;         // Print writer is writing the other buffer to flash
+    uint32_t flush_count;         // SPIFFS flushes this job
+    uint32_t flush_last_us;
+    uint32_t flush_avg_us;        // Moving average, kept across jobs
+    uint32_t flush_max_us;
+    int mbuf_free;                // Free NimBLE mbufs at last pacing decision
+    int mbuf_free_min;            // Lowest free mbuf count seen this job
+} ack_pacer_stats_t;
+
+/**
+ * Initialize the pacer and load the saved mode from NVS
+ */
+esp_err_t ack_pacer_init(void);
+
+/**
+ * Reset per-job statistics (call at PRINT_START)
+ * @param fixed_delay_ms Delay to use in fixed mode for this job
+ */
+void ack_pacer_reset(uint32_t fixed_delay_ms);
+
+/**
+ * Report RAM print buffer occupancy
+ * @param used Bytes currently buffered
+ * @param capacity Total buffer size (0 if no buffer is allocated)
+ */
+void ack_pacer_report_buffer(size_t used, size_t capacity);
+
+/**
+ * Report whether the print writer is draining a buffer to storage
+ * While it is, filling the active buffer means waiting for the drain.
+ */
+void ack_pacer_report_drain(bool in_flight);
+
+/**
+ * Report a completed flush of buffered print data to storage
+ * @param bytes Number of bytes written
+ * @param elapsed_us Time the write took in microseconds
+ */
+void ack_pacer_report_flush(size_t bytes, uint32_t elapsed_us);
+
+/**
+ * Compute the delay to apply after sending a PRINT_DATA ACK
+ * @param chunk_len Size of the image data in the chunk just acknowledged
+ * @return Delay in milliseconds (rounded up to the RTOS tick, 0 = no delay)
+ */
+uint32_t ack_pacer_next_delay_ms(size_t chunk_len);
+
+/**
+ * Set pacing mode and persist it to NVS
+ * The fixed-mode delay is part of the model's transport profile
+ * (transport_profile_set).
+ * @param mode ACK_PACER_MODE_ADAPTIVE or ACK_PACER_MODE_FIXED
+ */
+esp_err_t ack_pacer_set_mode(ack_pacer_mode_t mode);
+
+/**
+ * Get a snapshot of pacing statistics
+ */
+void ack_pacer_get_stats(ack_pacer_stats_t *stats);
+
+/**
+ * Get pacing mode as string
+ */
+const char* ack_pacer_mode_to_string(ack_pacer_mode_t mode);
+
+#endif // ACK_PACER_H
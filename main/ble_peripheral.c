@@ -6,11 +6,20 @@
 #include "ble_peripheral.h"
 #include "instax_protocol.h"
 #include "printer_emulator.h"
+#include "ack_pacer.h"
+#include "frame_ring.h"
+#include "notify_queue.h"
+#include "link_policy.h"
+#include "ble_session.h"
+#include "print_telemetry.h"
+#include "print_resume.h"
+#include "event_trace.h"
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "esp_mac.h"
 #include "nvs_flash.h"
 #include "host/ble_hs.h"
@@ -48,38 +57,60 @@ static uint8_t custom_mac[6] = {0x1C, 0x7D, 0x22, 0x55, 0x55, 0x00};
 
 // BLE state
 static bool s_advertising = false;
-static bool s_connected = false;
 static bool s_bonding_enabled = true;  // Bonding preference (loaded from NVS at init)
-static uint16_t s_conn_handle = BLE_HS_CONN_HANDLE_NONE;
 static uint16_t s_notify_handle = 0;
 static uint16_t s_indicate_handle = 0;  // For Wide: write char that supports indications
-static uint16_t s_subscribed_indicate_handle = 0;  // Handle the app actually subscribed to for indications
 
-// Print state
-static uint32_t s_print_image_size = 0;
-static uint32_t s_print_bytes_received = 0;
-static uint32_t s_print_chunk_index = 0;
-static bool s_print_in_progress = false;  // True between START and END commands
-
-// Cached Link 3 responses for instant replies during print upload
-static uint8_t s_cached_fff1_data[12] = {0};
-static bool s_fff1_cached = false;
-
-// Packet reassembly buffer for handling fragmented BLE writes
-#define PACKET_BUFFER_SIZE 4096
-static uint8_t s_packet_buffer[PACKET_BUFFER_SIZE];
-static size_t s_packet_buffer_len = 0;
-static uint16_t s_expected_packet_len = 0;
-
-// ACK delay for data packets (milliseconds)
-// Slows down sender to prevent buffer overflow during print data transfer
-// Square printer: 50ms delay reduces packet rate from ~300ms to ~350ms between packets
-#define DATA_PACKET_ACK_DELAY_MS 50
+// Per-connection state (reassembly, print job, Link 3 cache) lives in a
+// ble_session_t; this is the session whose frame the protocol task is handling
+static ble_session_t *s_session = NULL;  // Protocol task only
+static uint32_t s_frame_rx_us = 0;       // Reassembly time of that frame (protocol task only)
+
+// Host resets / disconnects (host task writes, any task reads)
+static ble_failure_stats_t s_failure_stats = {0};
+
+// Packet reassembly: fragmented BLE writes are reassembled directly into a
+// frame ring slot, which is handed to the protocol task once complete
+static frame_ring_t s_frame_ring;
+
+// Zero-copy PRINT_DATA: image data is copied from the mbufs straight into the
+// print buffer; only the 10-byte header and the checksum go into the slot
+#define PRINT_DATA_HEADER_LEN   10  // Header(2) + Length(2) + Func(1) + Op(1) + Chunk index(4)
+_Static_assert(INSTAX_PROFILE_CHUNK_MAX + PRINT_DATA_HEADER_LEN + 1 <= FRAME_RING_SLOT_SIZE,
+               "Largest PRINT_DATA frame must fit in a frame ring slot");
+static ble_print_data_path_stats_t s_copy_stats = {0};  // Protocol task only
+static uint32_t s_in_place_checksum_errors = 0;          // Protocol task only
+static uint32_t s_bad_frame_replies = 0;                 // Protocol task only
+
+// Status sent back for a frame that arrived with a bad checksum. Any non-zero
+// status makes the app resend or abort instead of waiting for its timeout.
+#define STATUS_BAD_CHECKSUM     0xB7
+#define BAD_FRAME_PENDING       0x10000  // Marks bad_frame_pending as set (opcode may be 0x0000)
+static instax_parser_stats_t s_rx_parser_totals = {0};   // Closed connections (host task)
+
+// Protocol task - runs handle_instax_packet() off the NimBLE host task so that
+// SPIFFS writes, NVS commits and ACK pacing never stall connection handling
+#define PROTOCOL_TASK_STACK_SIZE        6144
+#define PROTOCOL_TASK_PRIORITY_DEFAULT  8   // Below the NimBLE host task
+static TaskHandle_t s_protocol_task = NULL;
+
+// A PRINT_START queued behind another connection's job is answered "printer
+// busy" if the printer is not handed over within this time
+#define PRINT_WAIT_TIMEOUT_MS           15000
+#define PRINT_WAIT_POLL_MS              500
 
 // Callbacks
 static ble_peripheral_print_start_callback_t s_print_start_callback = NULL;
 static ble_peripheral_print_data_callback_t s_print_data_callback = NULL;
 static ble_peripheral_print_complete_callback_t s_print_complete_callback = NULL;
+static ble_peripheral_print_commit_callback_t s_print_commit_callback = NULL;
+
+// Zero-copy print target, published by the protocol task and read by the host task
+static portMUX_TYPE s_print_target_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t *s_print_target_dest = NULL;     // NULL = copying path
+static size_t s_print_target_capacity = 0;
+static uint32_t s_print_target_gen = 0;          // Bumped on every publish
+static bool s_print_target_writing = false;      // Host task is copying into the target
 
 // Instax service UUID: 70954782-2d83-473d-9e5f-81e1d02d5273
 static const ble_uuid128_t instax_service_uuid = BLE_UUID128_INIT(
@@ -215,8 +246,10 @@ static int link3_status_chr_access(uint16_t conn_handle, uint16_t attr_handle,
 static int wide_chr_access(uint16_t conn_handle, uint16_t attr_handle,
                            struct ble_gatt_access_ctxt *ctxt, void *arg);
 static const char* get_model_number_for_printer(instax_model_t model);
-static esp_err_t send_wide_ffe1_notification(void);
-static esp_err_t send_wide_ffea_notification(void);
+static esp_err_t send_wide_ffe1_notification(uint16_t conn_handle);
+static esp_err_t send_wide_ffea_notification(uint16_t conn_handle);
+static void op_count_bytes_out(size_t len);
+static void release_printer(ble_session_t *session);
 
 // =====================================================
 // GATT Service Definitions - Model-Specific
@@ -367,104 +400,46 @@ static const struct ble_gatt_svc_def gatt_svr_svcs_wide[] = {
     {0}
 };
 
-// Retry configuration for ACK sending
-#define ACK_RETRY_COUNT 5
-#define ACK_RETRY_DELAY_MS 10
-
-// ACK statistics for diagnostics
-static uint32_t s_ack_sent_count = 0;
-static uint32_t s_ack_retry_count = 0;
-static uint32_t s_ack_fail_count = 0;
-
 /**
- * Send a notification to the connected client with retry logic
- * Returns ESP_OK if notification sent successfully, error code otherwise
+ * Queue a protocol response notification to the connected client
+ * The notification scheduler transmits it from the host task, ahead of any
+ * status traffic, and retries without blocking if the host is out of mbufs.
+ * Returns ESP_OK if the notification was queued, error code otherwise
  */
 static esp_err_t send_notification(const uint8_t *data, size_t len) {
-    if (!s_connected || s_conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+    if (s_session == NULL || !s_session->connected) {
         ESP_LOGW(TAG, "Cannot send notification: not connected");
         return ESP_ERR_INVALID_STATE;
     }
 
-    // During active print upload, we must still respond to essential queries
-    // Only block unsolicited status updates, not responses to app queries
-    // The blocking was causing timeout because INFO_QUERY responses were dropped!
-    // FIX (Dec 2025): Allow all responses during print - the app needs them
+    esp_err_t ret = notify_queue_send(s_session->conn_handle, s_notify_handle, data, len, NOTIFY_CLASS_ACK, false);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ CRITICAL: ACK could not be queued: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    op_count_bytes_out(len);
 
-    // Check if this is a DATA packet ACK for logging purposes
+    // Response bytes go to the trace ring (`trace` command); DATA ACKs only when verbose
     bool is_data_ack = (len >= 6 && data[4] == 0x10 && data[5] == 0x01);
-
-    // Retry loop for reliable ACK delivery
-    int retry;
-    for (retry = 0; retry < ACK_RETRY_COUNT; retry++) {
-        // Wait for mbuf to become available if this is a retry
-        if (retry > 0) {
-            s_ack_retry_count++;
-            ESP_LOGW(TAG, "⚠️ ACK retry %d/%d (waiting %dms for buffers)",
-                     retry, ACK_RETRY_COUNT, ACK_RETRY_DELAY_MS);
-            vTaskDelay(pdMS_TO_TICKS(ACK_RETRY_DELAY_MS));
-        }
-
-        struct os_mbuf *om = ble_hs_mbuf_from_flat(data, len);
-        if (om == NULL) {
-            ESP_LOGW(TAG, "⚠️ mbuf allocation failed (retry %d/%d)", retry + 1, ACK_RETRY_COUNT);
-            continue;  // Retry after delay
-        }
-
-        int rc = ble_gatts_notify_custom(s_conn_handle, s_notify_handle, om);
-        if (rc == 0) {
-            // Success!
-            s_ack_sent_count++;
-
-            // Log DATA packet ACKs with count for diagnostics
-            if (is_data_ack) {
-                // Periodic logging every 10 ACKs to track progress without flooding
-                if (s_ack_sent_count % 10 == 0 || retry > 0) {
-                    ESP_LOGI(TAG, "✅ DATA ACK #%lu sent%s",
-                             (unsigned long)s_ack_sent_count,
-                             retry > 0 ? " (after retry)" : "");
-                }
-            } else {
-                ESP_LOGI(TAG, "📤 Sent response (%d bytes)", len);
-                // Log first 16 bytes of response for debugging
-                ESP_LOGI(TAG, "   First bytes: %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X",
-                        len > 0 ? data[0] : 0, len > 1 ? data[1] : 0,
-                        len > 2 ? data[2] : 0, len > 3 ? data[3] : 0,
-                        len > 4 ? data[4] : 0, len > 5 ? data[5] : 0,
-                        len > 6 ? data[6] : 0, len > 7 ? data[7] : 0,
-                        len > 8 ? data[8] : 0, len > 9 ? data[9] : 0,
-                        len > 10 ? data[10] : 0, len > 11 ? data[11] : 0,
-                        len > 12 ? data[12] : 0, len > 13 ? data[13] : 0,
-                        len > 14 ? data[14] : 0, len > 15 ? data[15] : 0);
-            }
-            return ESP_OK;
-        }
-
-        // BLE stack error - log and retry
-        ESP_LOGW(TAG, "⚠️ ble_gatts_notify_custom failed: %d (retry %d/%d)", rc, retry + 1, ACK_RETRY_COUNT);
-        // Note: om is freed by NimBLE on failure, don't free it
+    if (event_trace_enabled(EVENT_TRACE_SUBSYS_TX, is_data_ack ? EVENT_TRACE_LEVEL_VERBOSE : EVENT_TRACE_LEVEL_FRAMES)) {
+        event_trace_data(EVENT_TRACE_TX_NOTIFY, s_notify_handle, data, len);
     }
-
-    // All retries exhausted - this is critical!
-    s_ack_fail_count++;
-    ESP_LOGE(TAG, "❌ CRITICAL: ACK LOST after %d retries! Total failures: %lu",
-             ACK_RETRY_COUNT, (unsigned long)s_ack_fail_count);
-    return ESP_FAIL;
+    return ESP_OK;
 }
 
 /**
- * Send an indication (for Wide model print responses)
+ * Queue an indication (for Wide model print responses)
  * Wide app subscribes to indications on the write characteristic (handle 8)
  * We use the handle that the app actually subscribed to, not the one from GATT registration
  */
 static esp_err_t send_indication(const uint8_t *data, size_t len) {
-    if (!s_connected || s_conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+    if (s_session == NULL || !s_session->connected) {
         ESP_LOGW(TAG, "Cannot send indication: not connected");
         return ESP_ERR_INVALID_STATE;
     }
 
     // Use the handle the app actually subscribed to for indications
-    uint16_t use_handle = s_subscribed_indicate_handle;
+    uint16_t use_handle = s_session->subscribed_indicate_handle;
     if (use_handle == 0) {
         // Fall back to the registered handle if no subscription recorded
         use_handle = s_indicate_handle;
@@ -476,24 +451,16 @@ static esp_err_t send_indication(const uint8_t *data, size_t len) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    struct os_mbuf *om = ble_hs_mbuf_from_flat(data, len);
-    if (om == NULL) {
-        ESP_LOGE(TAG, "mbuf allocation failed for indication");
-        return ESP_ERR_NO_MEM;
+    esp_err_t ret = notify_queue_send(s_session->conn_handle, use_handle, data, len, NOTIFY_CLASS_ACK, true);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to queue indication: %s (handle %d)", esp_err_to_name(ret), use_handle);
+        return ret;
     }
+    op_count_bytes_out(len);
 
-    int rc = ble_gatts_indicate_custom(s_conn_handle, use_handle, om);
-    if (rc != 0) {
-        ESP_LOGE(TAG, "ble_gatts_indicate_custom failed: %d (handle %d)", rc, use_handle);
-        return ESP_FAIL;
+    if (event_trace_enabled(EVENT_TRACE_SUBSYS_TX, EVENT_TRACE_LEVEL_FRAMES)) {
+        event_trace_data(EVENT_TRACE_TX_INDICATE, use_handle, data, len);
     }
-
-    ESP_LOGI(TAG, "📨 Sent indication (%d bytes) on handle %d", len, use_handle);
-    ESP_LOGI(TAG, "   First bytes: %02X %02X %02X %02X %02X %02X %02X %02X",
-            len > 0 ? data[0] : 0, len > 1 ? data[1] : 0,
-            len > 2 ? data[2] : 0, len > 3 ? data[3] : 0,
-            len > 4 ? data[4] : 0, len > 5 ? data[5] : 0,
-            len > 6 ? data[6] : 0, len > 7 ? data[7] : 0);
     return ESP_OK;
 }
 
@@ -502,8 +469,8 @@ static esp_err_t send_indication(const uint8_t *data, size_t len) {
  * FFEA is a Wide-specific status characteristic that must be sent for the official app to recognize printer as ready
  * Data pattern from real Wide printer: 02 09 B9 00 11 01 00 80 84 1E 00
  */
-static esp_err_t send_wide_ffea_notification(void) {
-    if (!s_connected || s_conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+static esp_err_t send_wide_ffea_notification(uint16_t conn_handle) {
+    if (ble_session_find(conn_handle) == NULL) {
         ESP_LOGW(TAG, "Cannot send Wide FFEA notification: not connected");
         return ESP_ERR_INVALID_STATE;
     }
@@ -529,25 +496,1467 @@ static esp_err_t send_wide_ffea_notification(void) {
         0x02, 0x09, 0xB9, 0x00, 0x11, 0x01, 0x00, 0x80, 0x84, 0x1E, 0x00
     };
 
-    struct os_mbuf *om = ble_hs_mbuf_from_flat(ffea_data, sizeof(ffea_data));
-    if (om == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate mbuf for Wide FFEA notification");
-        return ESP_ERR_NO_MEM;
+    esp_err_t ret = notify_queue_send(conn_handle, s_wide_ffea_notify_handle, ffea_data, sizeof(ffea_data),
+                                      NOTIFY_CLASS_STATUS, false);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to queue Wide FFEA notification: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "📤 Queued Wide FFEA notification (11 bytes)");
+    if (event_trace_enabled(EVENT_TRACE_SUBSYS_TX, EVENT_TRACE_LEVEL_FRAMES)) {
+        event_trace_data(EVENT_TRACE_TX_STATUS, s_wide_ffea_notify_handle, ffea_data, sizeof(ffea_data));
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * Handle a PRINT_DATA chunk (protocol task)
+ * @param image_data Chunk image data (copying path), ignored when in_place
+ * @param image_len Chunk image data length
+ * @param in_place true if reassembly already wrote the data into the print buffer
+ * @return Pacing delay to apply after the ACK, in milliseconds
+ */
+static uint32_t handle_print_data(const uint8_t *image_data, size_t image_len, bool in_place) {
+    ble_session_t *session = s_session;
+    uint8_t status = 0x00;
+
+    if (ble_session_print_owner() != session) {
+        // Only the session that owns the printer may write to the print buffer
+        ESP_LOGW(TAG, "Session %d sent print data without owning the printer - rejected", session->index);
+        status = 0xB5;  // Error 181: printer busy
+    } else {
+        // Log first chunk and every 50th chunk to verify data is arriving
+        if (session->print_chunk_index == 0) {
+            ESP_LOGI(TAG, "📦 FIRST DATA chunk received! len=%d (%s)", image_len + 4,
+                     in_place ? "zero-copy" : "copied");
+        } else if (session->print_chunk_index % 50 == 0) {
+            ESP_LOGI(TAG, "📦 Data chunk %lu received, len=%d",
+                    (unsigned long)session->print_chunk_index, image_len + 4);
+        }
+
+        if (in_place) {
+            if (s_print_commit_callback) {
+                s_print_commit_callback(session->print_chunk_index, image_len);
+            }
+            session->print_bytes_received += image_len;
+            s_copy_stats.zero_copy_chunks++;
+            s_copy_stats.bytes_copied += image_len;  // mbuf -> print buffer
+        } else if (s_print_data_callback && image_len > 0) {
+            s_print_data_callback(session->print_chunk_index, image_data, image_len);
+            session->print_bytes_received += image_len;
+            s_copy_stats.copied_chunks++;
+            s_copy_stats.bytes_copied += image_len * 2;  // mbuf -> frame slot -> print buffer
+        }
+        s_copy_stats.payload_bytes += image_len;
+        session->print_chunk_index++;
+        print_telemetry_record_chunk(s_frame_rx_us, image_len);
+    }
+
+    // Data is in the print buffer - reassembly may reserve space for the next chunk
+    __atomic_sub_fetch(&session->print_frames_pending, 1, __ATOMIC_RELEASE);
+
+    // Send ACK with proper packet structure
+    uint8_t response[8];
+    size_t response_len = 8; // Header(2) + Length(2) + Func(1) + Op(1) + Status(1) + Checksum(1)
+    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+    response[2] = (response_len >> 8) & 0xFF; // Length high byte
+    response[3] = response_len & 0xFF;         // Length low byte
+    response[4] = INSTAX_FUNC_PRINT;
+    response[5] = INSTAX_OP_PRINT_DATA;
+    response[6] = status;
+    response[7] = instax_calculate_checksum(response, 7);
+
+    // Send ACK immediately - don't delay before sending!
+    // This ensures ACK goes out right away before any buffer issues
+    send_notification(response, response_len);
+
+    // Delay AFTER ACK to throttle next packet processing
+    // The pacer sizes this from buffer/flush/mbuf backpressure (0 when idle)
+    return status == 0x00 ? ack_pacer_next_delay_ms(image_len) : 0;
+}
+
+/**
+ * INFO 0x00: general identify/ping
+ */
+static void op_info_identify(uint8_t function, uint8_t operation,
+                             const uint8_t *payload, size_t payload_len) {
+    uint8_t response[256];
+    size_t response_len = 0;
+    const instax_printer_info_t *info = printer_emulator_get_info();
+
+    // Official Instax app sends func=0x00 op=0x00 as a general "ping/identify" command
+    ESP_LOGI(TAG, "General identify/ping command - sending device info");
+    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+    response_len = 16; // Header(2) + Length(2) + Func(1) + Op(1) + Payload(9) + Checksum(1)
+    response[2] = 0x00; // Length high byte
+    response[3] = 0x10; // Length low byte (16 decimal)
+    response[4] = function;
+    response[5] = operation;
+    // Device identification payload (9 bytes)
+    // Real Wide (BO-22 capture): 61 42 00 10 00 00 00 01 00 01 00 00 00 00 00 4a
+    // Real Mini during successful print (frame 40753): 61 42 00 10 00 00 00 01 00 02 00 00 00 00 00 49
+    // Earlier Mini sessions used 0x02 at byte 7, but successful print uses 0x01
+    // Byte 7: 0x01 for all models (ready to print state)
+    // Byte 9: Wide=0x01, Mini/Square=0x02
+    response[6] = 0x00;
+    response[7] = 0x01; // Changed: Use 0x01 for all models (matches successful print capture)
+    response[8] = 0x00;
+    response[9] = (info->model == INSTAX_MODEL_WIDE) ? 0x01 : 0x02;
+    response[10] = 0x00;
+    response[11] = 0x00;
+    response[12] = 0x00;
+    response[13] = 0x00;
+    response[14] = 0x00;
+    response[15] = instax_calculate_checksum(response, 15);
+    send_notification(response, response_len);
+}
+
+// ============================================================================
+// INFO Response Cache
+// ============================================================================
+
+// The app sends INFO queries in bursts on connect. Their responses depend only on
+// instax_printer_info_t, so each is serialized once (checksum included) and reused
+// until printer_emulator bumps its info generation.
+
+#define INFO_QUERY_CACHED_MAX               0x0a    // INFO op 0x01 queries 0x01-0x0a
+#define RESPONSE_CACHE_QUERY_SLOT(q)        ((q) - 1)
+#define RESPONSE_CACHE_DIMENSIONS_SLOT      (INFO_QUERY_CACHED_MAX)
+#define RESPONSE_CACHE_INFO_TYPE_SLOT(t)    (INFO_QUERY_CACHED_MAX + 1 + (t))
+#define RESPONSE_CACHE_SLOTS                (INFO_QUERY_CACHED_MAX + 1 + INSTAX_INFO_PRINT_HISTORY + 1)
+
+// Largest cached frame: 9-byte query header + 31-char string + checksum
+#define RESPONSE_CACHE_FRAME_MAX            48
+
+typedef struct {
+    uint32_t generation;    // printer info generation the frame was built from (0 = empty)
+    uint8_t len;
+    uint8_t frame[RESPONSE_CACHE_FRAME_MAX];
+} response_cache_entry_t;
+
+// Builds a complete response frame into response (256 bytes), returns its length
+typedef size_t (*response_builder_t)(const instax_printer_info_t *info, uint8_t key, uint8_t *response);
+
+static response_cache_entry_t s_response_cache[RESPONSE_CACHE_SLOTS];  // Protocol task only
+static uint32_t s_response_cache_hits = 0;
+static uint32_t s_response_cache_misses = 0;
+
+/**
+ * Send a cached response frame, rebuilding it if printer info changed
+ * @param slot Cache slot, or -1 to build without caching
+ * @param build Frame builder
+ * @param key Query/info type passed to the builder
+ */
+static void send_cached_response(int slot, response_builder_t build, uint8_t key) {
+    uint32_t generation = printer_emulator_get_info_generation();
+
+    if (slot >= 0) {
+        response_cache_entry_t *entry = &s_response_cache[slot];
+        if (entry->generation == generation) {
+            s_response_cache_hits++;
+            send_notification(entry->frame, entry->len);
+            return;
+        }
+    }
+
+    uint8_t response[256];
+    size_t response_len = build(printer_emulator_get_info(), key, response);
+    s_response_cache_misses++;
+
+    if (slot >= 0 && response_len <= RESPONSE_CACHE_FRAME_MAX) {
+        response_cache_entry_t *entry = &s_response_cache[slot];
+        memcpy(entry->frame, response, response_len);
+        entry->len = (uint8_t)response_len;
+        entry->generation = generation;
+    }
+    send_notification(response, response_len);
+}
+
+/**
+ * Build the response frame for an INFO op 0x01 query
+ * @return Frame length including checksum
+ */
+static size_t build_info_query_response(const instax_printer_info_t *info, uint8_t info_query, uint8_t *response) {
+    size_t response_len = 0;
+
+    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+    response[4] = INSTAX_FUNC_INFO;
+    response[5] = 0x01;
+
+    switch (info_query) {
+        case 0x01: {
+            // Model/Firmware info - read from current printer configuration
+            // Format: [00 01] [length] "FI033" (Mini) or "FI017" (Square) or "FI022" (Wide)
+            ESP_LOGI(TAG, "Sending model/firmware info");
+            const char *model_str = info->model_number; // Use actual configured model
+            uint8_t model_len = strlen(model_str);
+            response[6] = 0x00; response[7] = 0x01; // Payload header (matches query type)
+            response[8] = model_len; // Length of string
+            memcpy(&response[9], model_str, model_len);
+            response_len = 9 + model_len + 1; // Header(2) + Length(2) + Func(1) + Op(1) + PayloadHdr(2) + Len(1) + String + Checksum(1)
+            ESP_LOGI(TAG, "  Model: %s (length: %d)", model_str, model_len);
+            break;
+        }
+        case 0x02: {
+            // Serial number - read from current printer configuration
+            // Format: [00 02] [length] "70555555" (Mini) or "50196563" (Square) or "20555555" (Wide)
+            ESP_LOGI(TAG, "Sending serial number");
+            const char *serial = info->serial_number; // Use actual configured serial
+            uint8_t serial_len = strlen(serial);
+            response[6] = 0x00; response[7] = 0x02; // Payload header (matches query type)
+            response[8] = serial_len; // Length of string
+            memcpy(&response[9], serial, serial_len);
+            response_len = 9 + serial_len + 1; // Header(2) + Length(2) + Func(1) + Op(1) + PayloadHdr(2) + Len(1) + String + Checksum(1)
+            ESP_LOGI(TAG, "  Serial: %s (length: %d)", serial, serial_len);
+            break;
+        }
+        case 0x03: {
+            // Additional device info - matches real device format
+            // Real device sends: [00 03] [04] "0000"
+            ESP_LOGI(TAG, "Sending additional device info");
+            const char *info_str = "0000"; // Real device sends this
+            uint8_t info_len = strlen(info_str);
+            response[6] = 0x00; response[7] = 0x03; // Payload header (matches query type)
+            response[8] = info_len; // Length of string
+            memcpy(&response[9], info_str, info_len);
+            response_len = 9 + info_len + 1; // Header(2) + Length(2) + Func(1) + Op(1) + PayloadHdr(2) + Len(1) + String + Checksum(1)
+            break;
+        }
+        case 0x04: {
+            // Firmware revision - new query type discovered Dec 2025
+            // Format: [00 04] [length] "0101" (Mini/Square) or "0100" (Wide)
+            ESP_LOGI(TAG, "Sending firmware revision");
+            const char *fw_str = info->firmware_revision; // Use actual configured firmware
+            uint8_t fw_len = strlen(fw_str);
+            response[6] = 0x00; response[7] = 0x04; // Payload header (matches query type)
+            response[8] = fw_len; // Length of string
+            memcpy(&response[9], fw_str, fw_len);
+            response_len = 9 + fw_len + 1; // Header(2) + Length(2) + Func(1) + Op(1) + PayloadHdr(2) + Len(1) + String + Checksum(1)
+            ESP_LOGI(TAG, "  Firmware: %s (length: %d)", fw_str, fw_len);
+            break;
+        }
+        case 0x05: {
+            // Hardware revision - query type 0x05
+            // Format: [00 05] [length] "0000" (Mini) or "0001" (Square/Wide)
+            ESP_LOGI(TAG, "Sending hardware revision");
+            const char *hw_str = info->hardware_revision;
+            uint8_t hw_len = strlen(hw_str);
+            response[6] = 0x00; response[7] = 0x05;
+            response[8] = hw_len;
+            memcpy(&response[9], hw_str, hw_len);
+            response_len = 9 + hw_len + 1;
+            ESP_LOGI(TAG, "  Hardware: %s (length: %d)", hw_str, hw_len);
+            break;
+        }
+        case 0x06: {
+            // Software revision - query type 0x06
+            // Format: [00 06] [length] "0003" (Mini) or "0002" (Square)
+            ESP_LOGI(TAG, "Sending software revision");
+            const char *sw_str = info->software_revision;
+            uint8_t sw_len = strlen(sw_str);
+            response[6] = 0x00; response[7] = 0x06;
+            response[8] = sw_len;
+            memcpy(&response[9], sw_str, sw_len);
+            response_len = 9 + sw_len + 1;
+            ESP_LOGI(TAG, "  Software: %s (length: %d)", sw_str, sw_len);
+            break;
+        }
+        case 0x07: {
+            // Manufacturer name - query type 0x07
+            // Format: [00 07] [length] "FUJIFILM"
+            ESP_LOGI(TAG, "Sending manufacturer name");
+            const char *mfr_str = info->manufacturer_name;
+            uint8_t mfr_len = strlen(mfr_str);
+            response[6] = 0x00; response[7] = 0x07;
+            response[8] = mfr_len;
+            memcpy(&response[9], mfr_str, mfr_len);
+            response_len = 9 + mfr_len + 1;
+            ESP_LOGI(TAG, "  Manufacturer: %s (length: %d)", mfr_str, mfr_len);
+            break;
+        }
+        case 0x08: {
+            // Device name - query type 0x08 (speculation)
+            // Format: [00 08] [length] "INSTAX-70555555"
+            ESP_LOGI(TAG, "Sending device name");
+            const char *name_str = info->device_name;
+            uint8_t name_len = strlen(name_str);
+            response[6] = 0x00; response[7] = 0x08;
+            response[8] = name_len;
+            memcpy(&response[9], name_str, name_len);
+            response_len = 9 + name_len + 1;
+            ESP_LOGI(TAG, "  Device Name: %s (length: %d)", name_str, name_len);
+            break;
+        }
+        case 0x09: {
+            // Query type 0x09 - Version/capability info (from real printer capture)
+            // Real Mini Link 3 returns: "00010012" (8 bytes)
+            ESP_LOGI(TAG, "Sending version/capability info (query 0x09)");
+            const char *ver_str = "00010012"; // From real printer capture
+            uint8_t ver_len = strlen(ver_str);
+            response[6] = 0x00; response[7] = 0x09;
+            response[8] = ver_len;
+            memcpy(&response[9], ver_str, ver_len);
+            response_len = 9 + ver_len + 1;
+            ESP_LOGI(TAG, "  Version info: %s (length: %d)", ver_str, ver_len);
+            break;
+        }
+        case 0x0a: {
+            // Query type 0x0a - Additional version info (from real printer capture)
+            // Real Mini Link 3 returns: "00000001" (8 bytes)
+            ESP_LOGI(TAG, "Sending additional version info (query 0x0a)");
+            const char *ver2_str = "00000001"; // From real printer capture
+            uint8_t ver2_len = strlen(ver2_str);
+            response[6] = 0x00; response[7] = 0x0a;
+            response[8] = ver2_len;
+            memcpy(&response[9], ver2_str, ver2_len);
+            response_len = 9 + ver2_len + 1;
+            ESP_LOGI(TAG, "  Version info 2: %s (length: %d)", ver2_str, ver2_len);
+            break;
+        }
+        default:
+            ESP_LOGW(TAG, "Unknown info query: 0x%02x - sending ACK", info_query);
+            response[6] = 0x00; // Status: OK
+            response_len = 7;
+            break;
+    }
+
+    // Fill in packet length (total bytes)
+    response[2] = (response_len >> 8) & 0xFF;
+    response[3] = response_len & 0xFF;
+    // Add checksum (last byte before response_len position)
+    response[response_len - 1] = instax_calculate_checksum(response, response_len - 1);
+    return response_len;
+}
+
+/**
+ * INFO 0x01: model/serial/firmware string queries
+ */
+static void op_info_query(uint8_t function, uint8_t operation,
+                          const uint8_t *payload, size_t payload_len) {
+    // Official Instax app uses op=0x01 to query printer info (similar to op=0x02)
+    // Payload byte indicates what info is requested
+    if (payload_len > 0) {
+        uint8_t info_query = payload[0];
+        ESP_LOGI(TAG, "Info query op=0x01 (query type: 0x%02x)", info_query);
+
+        int slot = (info_query >= 0x01 && info_query <= INFO_QUERY_CACHED_MAX) ?
+                   RESPONSE_CACHE_QUERY_SLOT(info_query) : -1;
+        send_cached_response(slot, build_info_query_response, info_query);
+    }
+}
+
+/**
+ * Build the image dimensions response (INFO op 0x02 with empty/0x00 payload)
+ * @return Frame length including checksum
+ */
+static size_t build_dimensions_response(const instax_printer_info_t *info, uint8_t key, uint8_t *response) {
+    size_t response_len = 0;
+
+    // Query with payload 0x00 - send image dimensions (real device behavior)
+    // Response format varies by model!
+    ESP_LOGI(TAG, "Image dimensions query (payload=0x00) - model=%d (WIDE=%d), dimensions=%dx%d",
+            info->model, INSTAX_MODEL_WIDE, info->width, info->height);
+    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+    // Bytes 2-3 (length) filled below based on model
+    response[4] = INSTAX_FUNC_INFO;
+    response[5] = INSTAX_OP_SUPPORT_FUNCTION_INFO;
+    response[6] = 0x00; // Payload header byte 0
+    response[7] = 0x00; // Payload header byte 1
+    // Image dimensions (model-specific)
+    response[8] = (info->width >> 8) & 0xFF;   // Width high byte
+    response[9] = info->width & 0xFF;          // Width low byte
+    response[10] = (info->height >> 8) & 0xFF; // Height high byte
+    response[11] = info->height & 0xFF;        // Height low byte
+
+    if (info->model == INSTAX_MODEL_WIDE) {
+        // Real Wide: 61 42 00 13 00 02 00 00 04 ec 03 48 02 7b 00 05 28 00 62
+        // Total 19 bytes = Header(2) + Length(2) + Func(1) + Op(1) + Payload(12) + Checksum(1)
+        ESP_LOGI(TAG, "Sending WIDE-specific dimensions response (19 bytes)");
+        response_len = 19;
+        response[2] = 0x00; // Length high byte
+        response[3] = 0x13; // Length low byte (19 decimal)
+        response[12] = 0x02; // Max file size high byte
+        response[13] = 0x7B; // Max file size low byte (0x027B = 635 KB)
+        response[14] = 0x00;
+        response[15] = 0x05; // Wide-specific (not 0x06)
+        response[16] = 0x28; // Wide-specific (not 0x40)
+        response[17] = 0x00;
+        response[18] = instax_calculate_checksum(response, 18);
+    } else {
+        // Square/Mini: 23 byte response
+        // Real Square: [61 42 00 17 00 02 00 00] [03 20 03 20 02 4b 00 06 40 00 01 00 00 00] [69]
+        ESP_LOGI(TAG, "Sending Square/Mini dimensions response (23 bytes)");
+        response_len = 23;
+        response[2] = 0x00; // Length high byte
+        response[3] = 0x17; // Length low byte (23 decimal)
+        response[12] = 0x02; // Capability byte 1
+        response[13] = 0x4b; // Capability byte 2
+        response[14] = 0x00; // Capability byte 3
+        response[15] = 0x06; // Capability byte 4
+        response[16] = 0x40; // Capability byte 5
+        response[17] = 0x00; // Capability byte 6
+        response[18] = 0x01; // Capability byte 7
+        response[19] = 0x00; // Capability byte 8
+        response[20] = 0x00; // Capability byte 9
+        response[21] = 0x00; // Capability byte 10
+        response[22] = instax_calculate_checksum(response, 22);
+    }
+    return response_len;
+}
+
+/**
+ * Build the response frame for an INFO op 0x02 info type
+ * @return Frame length including checksum
+ */
+static size_t build_info_type_response(const instax_printer_info_t *info, uint8_t info_type, uint8_t *response) {
+    size_t response_len = 0;
+
+    // Build packet structure: [0-1: header] [2-3: length] [4: func] [5: op] [6+: payload] [last: checksum]
+    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+    // Length will be filled in later (bytes 2-3)
+    response[4] = INSTAX_FUNC_INFO;
+    response[5] = INSTAX_OP_SUPPORT_FUNCTION_INFO;
+
+    // Build payload based on info type (starting at byte 6)
+    switch (info_type) {
+        case INSTAX_INFO_IMAGE_SUPPORT:
+            // Payload: [0-1: header] [2-3: width] [4-5: height] [6-15: capabilities]
+            // Real Mini Link 3 sends: [61 42 00 17 00 02 00 00] [02 58 03 20 02 7b 00 02 58 00 00 00 00 00] [ef]
+            // Real Square sends: [61 42 00 17 00 02 00 00] [03 20 03 20 02 4b 00 06 40 00 01 00 00 00] [69]
+            ESP_LOGI(TAG, "Sending image support: %dx%d, model enum=%d (WIDE=%d, MINI=%d, SQUARE=%d)",
+                    info->width, info->height, info->model, INSTAX_MODEL_WIDE, INSTAX_MODEL_MINI, INSTAX_MODEL_SQUARE);
+            response[6] = 0x00; // Payload header byte 0
+            response[7] = 0x00; // Payload header byte 1 (matches query type)
+            response[8] = (info->width >> 8) & 0xFF;  // Width high byte
+            response[9] = info->width & 0xFF;         // Width low byte
+            response[10] = (info->height >> 8) & 0xFF; // Height high byte
+            response[11] = info->height & 0xFF;        // Height low byte
+
+            // Extended capabilities - MODEL SPECIFIC (from real printer captures)
+            if (info->model == INSTAX_MODEL_WIDE) {
+                // Wide Link specific values from real printer capture:
+                // Real Wide: 61 42 00 13 00 02 00 00 04 ec 03 48 02 7b 00 05 28 00 62
+                // Total 19 bytes = Header(2) + Length(2) + Func(1) + Op(1) + Payload(12) + Checksum(1)
+                response[12] = 0x02; // Max file size high byte
+                response[13] = 0x7B; // Max file size low byte (0x027B = 635 KB, same as Mini)
+                response[14] = 0x00; // Unknown byte 1
+                response[15] = 0x05; // Unknown byte 2 (Wide-specific: 0x05, not 0x06)
+                response[16] = 0x28; // Unknown byte 3 (Wide-specific: 0x28, not 0x40)
+                response[17] = 0x00; // Unknown byte 4
+                // Wide has 6 capability bytes, not 7 - no byte 18!
+                response_len = 18; // Header(2) + Length(2) + Func(1) + Op(1) + Payload(12) = 18, checksum added later
+            } else if (info->model == INSTAX_MODEL_MINI) {
+                // Mini Link 3 specific values
+                response[12] = 0x02; // Max file size high byte
+                response[13] = 0x7B; // Max file size low byte (0x027B = 635 KB)
+                response[14] = 0x00; // Unknown byte 1
+                response[15] = 0x02; // Unknown byte 2 (was 0x06 for Square)
+                response[16] = 0x58; // Unknown byte 3 (was 0x40 for Square)
+                response[17] = 0x00; // Unknown byte 4
+                response[18] = 0x00; // Unknown byte 5 (was 0x01 for Square)
+                response[19] = 0x00; // Padding
+                response[20] = 0x00; // Padding
+                response[21] = 0x00; // Padding
+                response_len = 22; // Header(2) + Length(2) + Func(1) + Op(1) + Payload(16) = 22, checksum added later
+            } else {
+                // Square values (original)
+                response[12] = 0x02; // Max file size high byte
+                response[13] = 0x4B; // Max file size low byte (0x024B = 587 KB)
+                response[14] = 0x00; // Unknown
+                response[15] = 0x06; // Unknown (maybe color mode count)
+                response[16] = 0x40; // Unknown high byte
+                response[17] = 0x00; // Unknown low byte (0x4000 = 16384)
+                response[18] = 0x01; // Boolean flag (maybe supports color tables)
+                response[19] = 0x00; // Padding
+                response[20] = 0x00; // Padding
+                response[21] = 0x00; // Padding
+                response_len = 22; // Header(2) + Length(2) + Func(1) + Op(1) + Payload(16) = 22, checksum added later
+            }
+            break;
+
+        case INSTAX_INFO_BATTERY:
+            // Payload: [0-1: header] [2: data_len] [3: percentage] [4-5: extra]
+            // Real Mini Link 3 sends: [61 42 00 0d 00 02 00 01] [03 50 00 10] [e9]
+            // Real Wide (BO-22) sends: [61 42 00 0d 00 02 00 01] [02 41 00 10] [f9]
+            // Byte 8: Mini=0x03, Wide=0x02 (CRITICAL: 0x01 may mean "busy"!)
+            // Byte 9: Battery percentage (0x41=65% for Wide, 0x50=80% for Mini)
+            // Byte 11 is ALWAYS 0x10 (16) on real printer
+            ESP_LOGI(TAG, "Sending battery info: state=%d, %d%%",
+                    info->battery_state, info->battery_percentage);
+            response[6] = 0x00; // Payload header byte 0
+            response[7] = 0x01; // Payload header byte 1 (matches query type)
+            // Byte 8: Battery/ready state
+            // Real Mini capture shows 0x02 during successful print sequence
+            // (earlier captures showed 0x03 during initial connection)
+            // Wide also uses 0x02. Using 0x02 for all models.
+            response[8] = 0x02;
+            // Byte 9: All models use battery percentage (0-100)
+            response[9] = info->battery_percentage;
+            ESP_LOGI(TAG, "  Battery response: byte8=0x%02x (ready), byte9=0x%02x (%d%%)",
+                    response[8], response[9], info->battery_percentage);
+            response[10] = 0x00; // Extra byte 1
+            response[11] = 0x10; // ALWAYS 0x10 (16) - matches real printer exactly!
+            response_len = 12; // Header(2) + Length(2) + Func(1) + Op(1) + Payload(6) = 12, checksum added later
+            break;
+
+        case INSTAX_INFO_PRINTER_FUNCTION:
+            // Payload: [0-1: header] [2-9: printer data]
+            // Real device sends: [61 42 00 11 00 02 00 02] [28 00 00 0c 00 00 00 00] [13]
+            ESP_LOGI(TAG, "Sending printer function: %d photos, charging=%d",
+                    info->photos_remaining, info->is_charging);
+            ESP_LOGI(TAG, "  → Capability byte will be at payload[2], photos at payload[5]");
+            response[6] = 0x00; // Payload header byte 0
+            response[7] = 0x02; // Payload header byte 1 (matches query type)
+
+            // Capability byte encoding (VERIFIED with real printer captures Dec 2025):
+            // Format: [Bit 7: Charging] [Bits 4-6: Model flags] [Bits 0-3: Photos remaining 0-10]
+            //
+            // WIDE LINK (BO-22/FI022): Base 0x20 (0010 0000) - CORRECTED Dec 27, 2025
+            //   Real capture with 4 films: 0x24 = 0x20 | 0x04
+            //   Film count stored in LOWER NIBBLE (bits 0-3) of capability byte
+            //   Moments Print reads payload[2] & 0x0F for Wide
+            //
+            // SQUARE LINK (FI017): Base 0x20 (0010 0000)
+            //   Real printer with 12 films: 0x2C = 0x20 | 0x0C
+            //   Film count stored in FULL BYTE at payload[5]
+            //   Moments Print reads payload[5] for Square
+            //
+            // MINI LINK 3 (FI033): Base 0x30 (0011 0000)
+            //   Film count encoding unknown (needs testing)
+            uint8_t capability;
+            uint8_t film_count = info->photos_remaining;
+            if (film_count > 10) film_count = 10;
+
+            if (info->model == INSTAX_MODEL_WIDE) {
+                // Wide Link base flags: 0010 0000 (0x20) - VERIFIED with real BO-22 capture
+                // Real Wide capture shows constant 0x24 regardless of film count
+                capability = 0x20 | (film_count & 0x0F);
+            } else if (info->model == INSTAX_MODEL_MINI) {
+                // Mini Link 2 (FI033): Uses 0x20 base + film count in lower nibble
+                // The Mini app reads film count from capability byte lower nibble
+                // Real Mini shows 0x24 (with 4 film) or 0x2b (with 11 film) etc.
+                // Note: ping byte 7 must be 0x01 and battery state 0x02 for printing
+                capability = 0x20 | (film_count & 0x0F);
+            } else if (info->model == INSTAX_MODEL_SQUARE) {
+                // Square Link base flags: 0010 0000 (0x20) - VERIFIED with real FI017
+                capability = 0x20 | (film_count & 0x0F);
+            } else {
+                // Default to Square pattern
+                capability = 0x20 | (film_count & 0x0F);
+            }
+
+            // Apply charging bit for all models (bit 7)
+            if (info->is_charging) {
+                capability |= 0x80;  // Set bit 7 for charging
+            }
+            response[8] = capability;
+
+            response[9] = 0x00;  // Reserved byte 1
+            response[10] = 0x00; // Reserved byte 2
+
+            // Payload[5] behavior differs by model (UPDATED Dec 2025):
+            // - Square: Sends 0x0C (unknown purpose, NOT film count) - VERIFIED with real FI017
+            // - Wide: Sends 0x0D (13) - observed in print capture vs 0x0C during connection
+            // - Older Mini 1/2: Contains actual film count (capability byte 0x10-0x1F range)
+            // Both Square and Wide use capability byte lower nibble for film count!
+            if (info->model == INSTAX_MODEL_WIDE) {
+                // Wide: Testing 0x0D based on print capture comparison (Dec 2025)
+                // Previous 0x0C may have been from connection-only captures
+                response[11] = 0x0D; // Try 0x0D (13) instead of 0x0C (12)
+            } else if (info->model == INSTAX_MODEL_SQUARE) {
+                // Square: Real printers send 0x0C here
+                response[11] = 0x0C; // Match real printer behavior
+            } else {
+                // Older Mini 1/2: Actual film count in payload[5]
+                response[11] = info->photos_remaining;
+            }
+
+            response[12] = 0x00; // Padding byte 1
+            response[13] = 0x00; // Padding byte 2
+            response[14] = 0x00; // Padding byte 3
+            response[15] = 0x00; // Padding byte 4
+            response_len = 16; // Header(2) + Length(2) + Func(1) + Op(1) + Payload(10) = 16, checksum added later
+
+            // Debug: Log the exact payload bytes
+            ESP_LOGI(TAG, "  Payload bytes: [0-1]=0x%02x%02x [2]=0x%02x [3-4]=0x%02x%02x [5]=0x%02x [6-9]=0x%02x%02x%02x%02x",
+                    response[6], response[7], response[8], response[9], response[10],
+                    response[11], response[12], response[13], response[14], response[15]);
+            if (info->model == INSTAX_MODEL_WIDE) {
+                ESP_LOGI(TAG, "  → WIDE: Capability byte 0x%02x, film count %d in lower nibble (payload[2] & 0x0F)",
+                        capability, capability & 0x0F);
+                ESP_LOGI(TAG, "  → WIDE: payload[5] = 0x%02x (unknown purpose, matches real printer)",
+                        response[11]);
+            } else {
+                ESP_LOGI(TAG, "  → SQUARE/MINI: Capability byte 0x%02x, film count %d at payload[5]",
+                        capability, response[11]);
+            }
+            break;
+
+        case INSTAX_INFO_PRINT_HISTORY:
+            // Payload: [0-1: header] [2-5: lifetime count] [6-9: current pack info]
+            // Real Mini Link 3 sends: [61 42 00 11 00 02 00 03] [00 00 00 23 00 00 00 07] [1c]
+            // Byte 15 might be what the app reads for film count!
+            ESP_LOGI(TAG, "Sending print history: %lu lifetime, %d current pack",
+                    (unsigned long)info->lifetime_print_count, info->photos_remaining);
+            response[6] = 0x00; // Payload header byte 0
+            response[7] = 0x03; // Payload header byte 1 (MUST match query type 3!)
+            response[8] = (info->lifetime_print_count >> 24) & 0xFF;
+            response[9] = (info->lifetime_print_count >> 16) & 0xFF;
+            response[10] = (info->lifetime_print_count >> 8) & 0xFF;
+            response[11] = info->lifetime_print_count & 0xFF;
+            response[12] = 0x00; // Unknown byte 1
+            response[13] = 0x00; // Unknown byte 2
+            response[14] = 0x00; // Unknown byte 3
+            // Real printer sends 0x07 here when film count is 0x0b (11)
+            // Relationship unclear - maybe pack generation, error count, or calibration offset?
+            response[15] = 0x07; // Testing: use real printer's exact value
+            response_len = 16; // Header(2) + Length(2) + Func(1) + Op(1) + Payload(10) = 16, checksum added later
+
+            // NOTE: Previously tried sending FFEA notification here, but app doesn't subscribe
+            // to Wide service handles (FFE1=22, FFEA=27) - only standard service (8, 18)
+            // Removed to avoid potential issues from unsolicited notifications
+            break;
+
+        default:
+            // Unknown info type, send simple ACK
+            ESP_LOGW(TAG, "Unknown info type: %d", info_type);
+            response[6] = 0x00; // Status: OK
+            response_len = 7; // Header(2) + Length(2) + Func(1) + Op(1) + Status(1)
+            break;
+    }
+
+    // Fill in packet length (total bytes including checksum)
+    uint16_t packet_len = response_len + 1; // +1 for checksum
+    response[2] = (packet_len >> 8) & 0xFF;
+    response[3] = packet_len & 0xFF;
+
+    // Add checksum
+    response[response_len] = instax_calculate_checksum(response, response_len);
+    response_len++;
+    return response_len;
+}
+
+/**
+ * INFO 0x02: image dimensions, battery, printer function and history
+ */
+static void op_info_support_function(uint8_t function, uint8_t operation,
+                                     const uint8_t *payload, size_t payload_len) {
+    // Always respond to status queries - Mini app requires responses during printing
+    // (Previously suppressed for Mini/Square to prevent BLE bandwidth saturation,
+    // but this caused the Mini app to timeout waiting for responses)
+
+    // Return supported functions info
+    ESP_LOGI(TAG, "Info request: operation=0x%02x, payload_len=%d", operation, payload_len);
+
+    // Official Instax app sends this command with payload=0x00 to query image dimensions
+    // Moments Print app includes payload byte to specify info type
+    if (payload_len == 0 || (payload_len == 1 && payload[0] == 0x00)) {
+        send_cached_response(RESPONSE_CACHE_DIMENSIONS_SLOT, build_dimensions_response, 0);
+    } else if (payload_len > 0) {
+        uint8_t info_type = payload[0];
+        ESP_LOGI(TAG, "Info type: %d", info_type);
+
+        int slot = info_type <= INSTAX_INFO_PRINT_HISTORY ? RESPONSE_CACHE_INFO_TYPE_SLOT(info_type) : -1;
+        send_cached_response(slot, build_info_type_response, info_type);
+    }
+}
+
+/**
+ * DEVICE_CONTROL 0x02: auto-sleep settings
+ */
+static void op_device_auto_sleep(uint8_t function, uint8_t operation,
+                                 const uint8_t *payload, size_t payload_len) {
+    uint8_t response[256];
+    size_t response_len = 0;
+    // Device control operations (newly discovered - Dec 2025)
+    ESP_LOGI(TAG, "Device control operation: 0x%02x", operation);
+
+    // Auto-sleep settings (function 0x01, operation 0x02)
+    // Payload: [timeout_minutes] [12 bytes padding]
+    // 0x00 = never shutdown, 0x01-0xFF = timeout in minutes
+    if (payload_len >= 1) {
+        uint8_t timeout_minutes = payload[0];
+        printer_emulator_set_auto_sleep(timeout_minutes);
+        ESP_LOGI(TAG, "Auto-sleep timeout set to %d minutes (%s)",
+                timeout_minutes, timeout_minutes == 0 ? "never" : "enabled");
+    } else {
+        ESP_LOGW(TAG, "Auto-sleep command with insufficient payload (%d bytes)", payload_len);
+    }
+
+    // Send ACK
+    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+    response_len = 8;
+    response[2] = (response_len >> 8) & 0xFF;
+    response[3] = response_len & 0xFF;
+    response[4] = function;
+    response[5] = operation;
+    response[6] = 0x00; // Status: OK
+    response[7] = instax_calculate_checksum(response, 7);
+    send_notification(response, response_len);
+}
+
+/**
+ * DEVICE_CONTROL 0x03: BLE connection management
+ */
+static void op_device_ble_connect(uint8_t function, uint8_t operation,
+                                  const uint8_t *payload, size_t payload_len) {
+    uint8_t response[256];
+    size_t response_len = 0;
+    // Device control operations (newly discovered - Dec 2025)
+    ESP_LOGI(TAG, "Device control operation: 0x%02x", operation);
+
+    // BLE connection management (function 0x01, operation 0x03)
+    // Observed in packet captures before print operations
+    ESP_LOGI(TAG, "BLE connection management command (payload: %d bytes)", payload_len);
+
+    // Send ACK
+    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+    response_len = 8;
+    response[2] = (response_len >> 8) & 0xFF;
+    response[3] = response_len & 0xFF;
+    response[4] = function;
+    response[5] = operation;
+    response[6] = 0x00; // Status: OK
+    response[7] = instax_calculate_checksum(response, 7);
+    send_notification(response, response_len);
+}
+
+/**
+ * DEVICE_CONTROL (other operations): generic ACK
+ */
+static void op_device_ack(uint8_t function, uint8_t operation,
+                          const uint8_t *payload, size_t payload_len) {
+    uint8_t response[256];
+    size_t response_len = 0;
+    ESP_LOGI(TAG, "Device control operation: 0x%02x", operation);
+    ESP_LOGI(TAG, "Unknown device control operation: 0x%02x - sending ACK", operation);
+    // Send generic ACK for unknown operations
+    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+    response_len = 8;
+    response[2] = (response_len >> 8) & 0xFF;
+    response[3] = response_len & 0xFF;
+    response[4] = function;
+    response[5] = operation;
+    response[6] = 0x00; // Status: OK
+    response[7] = instax_calculate_checksum(response, 7);
+    send_notification(response, response_len);
+}
+
+/**
+ * PRINT 0x00: start print job
+ */
+static void op_print_start(uint8_t function, uint8_t operation,
+                           const uint8_t *payload, size_t payload_len) {
+    uint8_t response[256];
+    size_t response_len = 0;
+    // Check printer error conditions
+    const instax_printer_info_t *printer_info = printer_emulator_get_info();
+    uint8_t error_code = 0;
+    const char *error_msg = NULL;
+
+    // Error 178 (0xB2): No film
+    if (printer_info->photos_remaining == 0) {
+        error_code = 0xB2;
+        error_msg = "No film";
+    }
+    // Error 179 (0xB3): Cover open
+    else if (printer_info->cover_open) {
+        error_code = 0xB3;
+        error_msg = "Cover open";
+    }
+    // Error 180 (0xB4): Battery low (< 20%)
+    else if (printer_info->battery_percentage < 20) {
+        error_code = 0xB4;
+        error_msg = "Battery low";
+    }
+    // Error 181 (0xB5): Printer busy
+    else if (printer_info->printer_busy) {
+        error_code = 0xB5;
+        error_msg = "Printer busy";
+    }
+
+    // Send error response if any error detected
+    if (error_code != 0) {
+        ESP_LOGW(TAG, "Print start rejected: %s (error %d = 0x%02X)", error_msg, error_code, error_code);
+
+        response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+        response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+        response_len = 8; // Header(2) + Length(2) + Func(1) + Op(1) + Status(1) + Checksum(1)
+        response[2] = (response_len >> 8) & 0xFF; // Length high byte
+        response[3] = response_len & 0xFF;         // Length low byte
+        response[4] = function;
+        response[5] = operation;
+        response[6] = error_code;
+        response[7] = instax_calculate_checksum(response, 7);
+
+        send_notification(response, response_len);
+
+        // A deferred start that was just handed the printer gives it up again
+        release_printer(s_session);
+        return;
+    }
+
+    // One print job at a time: if another connection owns the printer, keep
+    // the request and answer it when the printer is handed over
+    if (payload_len >= 8 && !ble_session_print_acquire(s_session)) {
+        s_session->print_start_payload_len = payload_len < BLE_SESSION_START_PAYLOAD_MAX ?
+                                             payload_len : BLE_SESSION_START_PAYLOAD_MAX;
+        memcpy(s_session->print_start_payload, payload, s_session->print_start_payload_len);
+        ESP_LOGI(TAG, "⏳ Print start from session %d queued behind session %d",
+                 s_session->index, ble_session_print_owner()->index);
+        return;
+    }
+
+    // Extract image size from payload
+    // Payload format: [0-3: header 0x02 0x00 0x00 0x00] [4-7: size big-endian]
+    if (payload_len >= 8) {
+        // Skip first 4 bytes (header), read bytes 4-7 as big-endian uint32
+        s_session->print_image_size = ((uint32_t)payload[4] << 24) |
+                                      ((uint32_t)payload[5] << 16) |
+                                      ((uint32_t)payload[6] << 8) |
+                                      payload[7];
+        s_session->print_bytes_received = 0;
+        s_session->print_chunk_index = 0;
+
+        // Print start banner for easy log identification
+        ESP_LOGI(TAG, "");
+        ESP_LOGI(TAG, "╔════════════════════════════════════════════════════════════════╗");
+        ESP_LOGI(TAG, "║            🖨️  PRINT JOB STARTED                               ║");
+        ESP_LOGI(TAG, "╠════════════════════════════════════════════════════════════════╣");
+        ESP_LOGI(TAG, "║  Image Size:   %6lu bytes                                    ║", (unsigned long)s_session->print_image_size);
+        ESP_LOGI(TAG, "║  Timestamp:    %lu ms                                    ║", (unsigned long)esp_log_timestamp());
+        ESP_LOGI(TAG, "║  Print Number: %d                                             ║", printer_emulator_get_info()->lifetime_print_count + 1);
+        ESP_LOGI(TAG, "╚════════════════════════════════════════════════════════════════╝");
+        ESP_LOGI(TAG, "");
+
+        // Call print start callback and check if it succeeded
+        bool print_start_ok = true;
+        if (s_print_start_callback) {
+            print_start_ok = s_print_start_callback(s_session->print_image_size);
+        }
+
+        // Send response (ACK if successful, error if failed)
+        // Real Wide printer Print START ACK (from packet capture):
+        //   61 42 00 0C 10 00 00 00 00 03 84 B9
+        //   12 bytes total: header(2) + length(2) + func(1) + op(1) + payload(5) + checksum(1)
+        //   Payload: Status(1) + Padding(2) + ChunkSize(2) = 5 bytes
+        //   0x0384 = 900 bytes (Wide chunk size)
+        //   B9 = checksum (NOT part of chunk size!)
+        response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+        response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+        response[2] = 0x00; // Length high byte
+        response[3] = 0x0C; // Length low byte (12 = total packet length)
+        response[4] = function;
+        response[5] = operation;
+
+        if (print_start_ok) {
+            // Chunk size the app should use, from the emulated model's transport profile
+            uint16_t chunk_size = instax_get_model_info(printer_emulator_get_info()->model)->chunk_size;
+            response[6] = 0x00;  // Status: OK
+            response[7] = 0x00;  // Padding byte 1
+            response[8] = 0x00;  // Padding byte 2
+            response[9] = (chunk_size >> 8) & 0xFF;  // Chunk size high byte
+            response[10] = chunk_size & 0xFF;        // Chunk size low byte
+            ESP_LOGI(TAG, "🚀 Sending print start ACK (12 bytes, timestamp: %lu ms)", (unsigned long)esp_log_timestamp());
+        } else {
+            response[6] = 0xB1; // Status: Error 177 (out of memory)
+            response[7] = 0x00;
+            response[8] = 0x00;
+            response[9] = 0x00;
+            response[10] = 0x00;
+            ESP_LOGE(TAG, "❌ Sending print start ERROR (out of memory)");
+        }
+
+        // Checksum is calculated over bytes 0-10 (11 bytes), appended as byte 11
+        // Total packet = 12 bytes (matching real Wide printer exactly)
+        response[11] = instax_calculate_checksum(response, 11);
+        response_len = 12;
+
+        // Send Print START ACK as notification on s_notify_handle
+        // Real Wide printer sends ALL Instax protocol responses (61 42...) as NOTIFICATIONS
+        // on handle 0x002a (verified via packet capture Dec 2025)
+        // Indications (0x1d) on handle 0x0008 are a separate device service (0a00ffff)
+        send_notification(response, response_len);
+
+        if (print_start_ok) {
+            ESP_LOGI(TAG, "✅ Print start ACK sent (timestamp: %lu ms)", (unsigned long)esp_log_timestamp());
+            s_session->print_in_progress = true;  // Mark print as active (data upload phase)
+
+            // Reset ACK statistics for this print job
+            notify_queue_reset_stats();
+            ack_pacer_reset(instax_get_model_info(printer_emulator_get_info()->model)->ack_delay_ms);
+            memset(&s_copy_stats, 0, sizeof(s_copy_stats));
+            link_policy_print_started(s_session->conn_handle);
+            print_telemetry_begin(s_session->conn_handle, printer_emulator_get_info()->model,
+                                  ble_att_mtu(s_session->conn_handle), s_session->print_image_size);
+            ESP_LOGI(TAG, "📊 ACK counters reset for new print job");
+
+            // Pre-build cached Link 3 FFF1 response for instant replies during upload
+            // This minimizes GATT request processing time to prevent data packet loss
+            const instax_printer_info_t *info = printer_emulator_get_info();
+            s_session->cached_fff1_data[0] = (uint8_t)(10 - info->photos_remaining);
+            s_session->cached_fff1_data[1] = 0x01;
+            s_session->cached_fff1_data[3] = 0x15;
+            s_session->cached_fff1_data[6] = 0x4F;
+            s_session->cached_fff1_data[8] = (uint8_t)((info->battery_percentage * 200) / 100);
+            s_session->cached_fff1_data[9] = info->is_charging ? 0x00 : 0xFF;
+            s_session->cached_fff1_data[10] = 0x0F;
+            s_session->fff1_cached = true;
+        } else {
+            release_printer(s_session);
+        }
+    }
+}
+
+/**
+ * Give up the printer and answer the next queued PRINT_START, if any
+ */
+static void release_printer(ble_session_t *session) {
+    ble_session_t *next = ble_session_print_release(session);
+    if (next == NULL) {
+        return;
+    }
+
+    // Run the deferred start in the context of the session that sent it
+    ble_session_t *prev = s_session;
+    s_session = next;
+    op_print_start(INSTAX_FUNC_PRINT, INSTAX_OP_PRINT_START,
+                   next->print_start_payload, next->print_start_payload_len);
+    s_session = prev;
+}
+
+/**
+ * PRINT 0x02: end of image upload
+ */
+static void op_print_end(uint8_t function, uint8_t operation,
+                         const uint8_t *payload, size_t payload_len) {
+    uint8_t response[256];
+    size_t response_len = 0;
+    ESP_LOGI(TAG, "Print end: received %lu/%lu bytes",
+            (unsigned long)s_session->print_bytes_received,
+            (unsigned long)s_session->print_image_size);
+
+    // Log ACK statistics for this print job
+    ESP_LOGI(TAG, "");
+    ESP_LOGI(TAG, "╔════════════════════════════════════════════════════════════════╗");
+    ESP_LOGI(TAG, "║            📊 ACK STATISTICS                                   ║");
+    ESP_LOGI(TAG, "╠════════════════════════════════════════════════════════════════╣");
+    notify_queue_stats_t notify;
+    notify_queue_get_stats(&notify);
+    ESP_LOGI(TAG, "║  ACKs Sent:     %6lu                                         ║", (unsigned long)notify.acks_sent);
+    ESP_LOGI(TAG, "║  Retries:       %6lu (%lu from reserve)                       ║",
+             (unsigned long)notify.acks_retried, (unsigned long)notify.acks_from_reserve);
+    ESP_LOGI(TAG, "║  Failures:      %6lu                                         ║", (unsigned long)notify.acks_failed);
+    ack_pacer_stats_t pacing;
+    ack_pacer_get_stats(&pacing);
+    ESP_LOGI(TAG, "║  Copied:       %7lu bytes for %6lu payload (%lu zero-copy)   ║",
+             (unsigned long)s_copy_stats.bytes_copied, (unsigned long)s_copy_stats.payload_bytes,
+             (unsigned long)s_copy_stats.zero_copy_chunks);
+    ESP_LOGI(TAG, "║  Pacing:        %-8s                                       ║", ack_pacer_mode_to_string(pacing.mode));
+    ESP_LOGI(TAG, "║  Delayed ACKs:  %6lu (max %4lu ms)                           ║",
+             (unsigned long)pacing.acks_delayed, (unsigned long)pacing.max_delay_ms);
+    ESP_LOGI(TAG, "║  Pacing Delay:  %6lu ms total                                 ║", (unsigned long)pacing.total_delay_ms);
+    ESP_LOGI(TAG, "║  Flushes:       %6lu (avg %6lu us, max %6lu us)            ║",
+             (unsigned long)pacing.flush_count, (unsigned long)pacing.flush_avg_us,
+             (unsigned long)pacing.flush_max_us);
+    ESP_LOGI(TAG, "╚════════════════════════════════════════════════════════════════╝");
+    if (notify.acks_failed > 0) {
+        ESP_LOGE(TAG, "⚠️ WARNING: %lu ACKs were lost! Client may report packet loss.",
+                 (unsigned long)notify.acks_failed);
+    } else if (notify.acks_retried > 0) {
+        ESP_LOGW(TAG, "ℹ️ %lu retries were needed, but all ACKs delivered successfully.",
+                 (unsigned long)notify.acks_retried);
+    } else {
+        ESP_LOGI(TAG, "✅ All ACKs delivered successfully with no retries needed.");
+    }
+    ESP_LOGI(TAG, "");
+
+    s_session->print_in_progress = false;  // Data upload complete, resume normal status queries
+    s_session->fff1_cached = false;  // Clear cached Link 3 response
+
+    // Send ACK with proper packet structure
+    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+    response_len = 8; // Header(2) + Length(2) + Func(1) + Op(1) + Status(1) + Checksum(1)
+    response[2] = (response_len >> 8) & 0xFF; // Length high byte
+    response[3] = response_len & 0xFF;         // Length low byte
+    response[4] = function;
+    response[5] = operation;
+    response[6] = 0x00; // Status: OK
+    response[7] = instax_calculate_checksum(response, 7);
+
+    send_notification(response, response_len);
+}
+
+/**
+ * PRINT 0x80: execute print
+ */
+static void op_print_execute(uint8_t function, uint8_t operation,
+                             const uint8_t *payload, size_t payload_len) {
+    uint8_t response[256];
+    size_t response_len = 0;
+    ESP_LOGI(TAG, "Print execute");
+
+    // Check printer error conditions (double-check before executing)
+    const instax_printer_info_t *printer_info = printer_emulator_get_info();
+    uint8_t error_code = 0;
+    const char *error_msg = NULL;
+
+    // Error 178 (0xB2): No film
+    if (printer_info->photos_remaining == 0) {
+        error_code = 0xB2;
+        error_msg = "No film";
+    }
+    // Error 179 (0xB3): Cover open
+    else if (printer_info->cover_open) {
+        error_code = 0xB3;
+        error_msg = "Cover open";
+    }
+    // Error 180 (0xB4): Battery low (< 20%)
+    else if (printer_info->battery_percentage < 20) {
+        error_code = 0xB4;
+        error_msg = "Battery low";
+    }
+    // Error 181 (0xB5): Printer busy
+    else if (printer_info->printer_busy) {
+        error_code = 0xB5;
+        error_msg = "Printer busy";
+    }
+    // Error 181 (0xB5): another connection's job owns the print buffer
+    else if (ble_session_print_owner() != NULL && ble_session_print_owner() != s_session) {
+        error_code = 0xB5;
+        error_msg = "Printer busy (another connection is printing)";
+    }
+
+    // Send error response if any error detected
+    if (error_code != 0) {
+        ESP_LOGW(TAG, "Print execute rejected: %s (error %d = 0x%02X)", error_msg, error_code, error_code);
+
+        response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+        response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+        response_len = 8; // Header(2) + Length(2) + Func(1) + Op(1) + Status(1) + Checksum(1)
+        response[2] = (response_len >> 8) & 0xFF; // Length high byte
+        response[3] = response_len & 0xFF;         // Length low byte
+        response[4] = function;
+        response[5] = operation;
+        response[6] = error_code;
+        response[7] = instax_calculate_checksum(response, 7);
+
+        send_notification(response, response_len);
+        link_policy_print_finished(s_session->conn_handle);
+
+        // The job opened by PRINT_START holds the print buffer - free it
+        // before the printer goes to the next connection
+        if (ble_session_print_abort(s_session)) {
+            print_telemetry_end(PRINT_END_REJECTED);
+        }
+
+        // Reset print state
+        s_session->print_image_size = 0;
+        s_session->print_bytes_received = 0;
+        s_session->print_chunk_index = 0;
+        release_printer(s_session);
+        return;
+    }
+
+    // Print completion banner
+    ESP_LOGI(TAG, "");
+    ESP_LOGI(TAG, "╔════════════════════════════════════════════════════════════════╗");
+    ESP_LOGI(TAG, "║            ✅ PRINT JOB COMPLETED                             ║");
+    ESP_LOGI(TAG, "╠════════════════════════════════════════════════════════════════╣");
+    ESP_LOGI(TAG, "║  Received:     %6lu bytes                                    ║", (unsigned long)s_session->print_bytes_received);
+    ESP_LOGI(TAG, "║  Expected:     %6lu bytes                                    ║", (unsigned long)s_session->print_image_size);
+    ESP_LOGI(TAG, "║  Timestamp:    %lu ms                                    ║", (unsigned long)esp_log_timestamp());
+    ESP_LOGI(TAG, "║  Print Number: %d                                             ║", printer_emulator_get_info()->lifetime_print_count);
+    ESP_LOGI(TAG, "╚════════════════════════════════════════════════════════════════╝");
+    ESP_LOGI(TAG, "");
+
+    if (s_print_complete_callback) {
+        s_print_complete_callback();
+    }
+
+    // Send ACK with proper packet structure
+    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+    response_len = 8; // Header(2) + Length(2) + Func(1) + Op(1) + Status(1) + Checksum(1)
+    response[2] = (response_len >> 8) & 0xFF; // Length high byte
+    response[3] = response_len & 0xFF;         // Length low byte
+    response[4] = function;
+    response[5] = operation;
+    response[6] = 0x00; // Status: OK (print accepted)
+    response[7] = instax_calculate_checksum(response, 7);
+
+    send_notification(response, response_len);
+
+    // Upload is over - let the link relax once the app goes quiet
+    link_policy_print_finished(s_session->conn_handle);
+    print_telemetry_end(PRINT_END_COMPLETED);
+
+    // Reset print state
+    s_session->print_image_size = 0;
+    s_session->print_bytes_received = 0;
+    s_session->print_chunk_index = 0;
+
+    // Job done - the next queued connection may start its print
+    release_printer(s_session);
+}
+
+/**
+ * PRINT (other operations)
+ */
+static void op_print_unknown(uint8_t function, uint8_t operation,
+                             const uint8_t *payload, size_t payload_len) {
+    ESP_LOGW(TAG, "Unknown print operation: 0x%02x", operation);
+}
+
+/**
+ * LED 0x00: accelerometer data
+ */
+static void op_led_xyz_axis(uint8_t function, uint8_t operation,
+                            const uint8_t *payload, size_t payload_len) {
+    uint8_t response[256];
+    size_t response_len = 0;
+    ESP_LOGI(TAG, "XYZ Axis Info request");
+
+    // Get current accelerometer values from printer emulator
+    const instax_printer_info_t *printer_info = printer_emulator_get_info();
+
+    // Build response packet with accelerometer data
+    // Payload: [x_low] [x_high] [y_low] [y_high] [z_low] [z_high] [orientation]
+    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+    response_len = 14; // Header(2) + Length(2) + Func(1) + Op(1) + Payload(7) + Checksum(1)
+    response[2] = (response_len >> 8) & 0xFF; // Length high byte
+    response[3] = response_len & 0xFF;         // Length low byte
+    response[4] = function;
+    response[5] = operation;
+
+    // Pack accelerometer data as little-endian int16
+    response[6] = printer_info->accelerometer.x & 0xFF;        // X low byte
+    response[7] = (printer_info->accelerometer.x >> 8) & 0xFF; // X high byte
+    response[8] = printer_info->accelerometer.y & 0xFF;        // Y low byte
+    response[9] = (printer_info->accelerometer.y >> 8) & 0xFF; // Y high byte
+    response[10] = printer_info->accelerometer.z & 0xFF;       // Z low byte
+    response[11] = (printer_info->accelerometer.z >> 8) & 0xFF; // Z high byte
+    response[12] = printer_info->accelerometer.orientation;    // Orientation state
+
+    response[13] = instax_calculate_checksum(response, 13);
+
+    ESP_LOGI(TAG, "Accelerometer data: x=%d, y=%d, z=%d, o=%d",
+            printer_info->accelerometer.x,
+            printer_info->accelerometer.y,
+            printer_info->accelerometer.z,
+            printer_info->accelerometer.orientation);
+
+    send_notification(response, response_len);
+}
+
+/**
+ * LED 0x01: color correction table / print mode
+ */
+static void op_led_color_correction(uint8_t function, uint8_t operation,
+                                    const uint8_t *payload, size_t payload_len) {
+    uint8_t response[256];
+    size_t response_len = 0;
+    // Color correction table upload (function 0x30, operation 0x01)
+    // Newly discovered Dec 2025 - includes print mode in first byte
+    // Payload: [mode] [color_correction_table...]
+    // mode: 0x00 = Rich (311 bytes total), 0x03 = Natural (251 bytes total)
+
+    if (payload_len >= 1) {
+        uint8_t print_mode = payload[0];
+        printer_emulator_set_print_mode(print_mode);
+
+        const char *mode_str = (print_mode == 0x00) ? "Rich" :
+                              (print_mode == 0x03) ? "Natural" : "Unknown";
+        ESP_LOGI(TAG, "Color correction table: mode=0x%02x (%s), table_size=%d bytes",
+                print_mode, mode_str, payload_len - 1);
+    } else {
+        ESP_LOGW(TAG, "Color correction command with no payload");
+    }
+
+    // Send ACK
+    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+    response_len = 8;
+    response[2] = (response_len >> 8) & 0xFF;
+    response[3] = response_len & 0xFF;
+    response[4] = function;
+    response[5] = operation;
+    response[6] = 0x00; // Status: OK
+    response[7] = instax_calculate_checksum(response, 7);
+    send_notification(response, response_len);
+}
+
+/**
+ * LED 0x10: additional sensor/device info
+ */
+static void op_led_additional_info(uint8_t function, uint8_t operation,
+                                   const uint8_t *payload, size_t payload_len) {
+    uint8_t response[256];
+    size_t response_len = 0;
+    // Additional sensor/device info query
+    // Packet capture shows payload byte indicates query type:
+    //   payload=0x00 → 17-byte response with sensor data
+    //   payload=0x01 → 21-byte response with different sensor data
+
+    uint8_t query_type = (payload_len > 0) ? payload[0] : 0x00;
+    ESP_LOGI(TAG, "Additional info request: query_type=0x%02x", query_type);
+
+    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+    response[4] = function;
+    response[5] = operation;
+
+    if (query_type == 0x00) {
+        // 17-byte response with sensor data
+        // Real Mini during successful print: 61 42 00 11 30 10 00 00 be 19 00 fc 00 00 00 00 XX
+        // Real Square during successful print: 61 42 00 11 30 10 00 00 c1 a6 00 d2 00 00 00 00 XX
+        const instax_printer_info_t *info = printer_emulator_get_info();
+        response_len = 17;
+        response[2] = 0x00; // Length high byte
+        response[3] = 0x11; // Length low byte (17)
+        response[6] = 0x00; // Payload header 1
+        response[7] = 0x00; // Payload header 2 (matches query type)
+
+        if (info->model == INSTAX_MODEL_SQUARE) {
+            // Square-specific sensor data from real FI017 capture
+            response[8] = 0xc1;
+            response[9] = 0xa6;
+            response[10] = 0x00;
+            response[11] = 0xd2;
+        } else {
+            // Mini sensor data from successful print capture
+            response[8] = 0xbe;
+            response[9] = 0x19;
+            response[10] = 0x00;
+            response[11] = 0xfc;
+        }
+        response[12] = 0x00;
+        response[13] = 0x00;
+        response[14] = 0x00;
+        response[15] = 0x00;
+        response[16] = instax_calculate_checksum(response, 16);
+
+        ESP_LOGI(TAG, "📤 Sent additional info type 0 (17 bytes)");
+
+    } else if (query_type == 0x01) {
+        // 21-byte response with different sensor data
+        // Real Wide:   61 42 00 15 30 10 00 01 00 00 00 1e 00 01 01 00 00 00 00 00 XX
+        // Real Mini:   61 42 00 15 30 10 00 01 00 00 00 2a 01 00 01 01 00 00 00 00 XX
+        // Real Square: 61 42 00 15 30 10 00 01 00 00 00 04 ff 00 01 02 00 00 00 00 XX
+        const instax_printer_info_t *info = printer_emulator_get_info();
+        response_len = 21;
+        response[2] = 0x00; // Length high byte
+        response[3] = 0x15; // Length low byte (21)
+        response[6] = 0x00; // Payload header 1
+        response[7] = 0x01; // Payload header 2 (matches query type)
+        response[8] = 0x00;
+        response[9] = 0x00;
+        response[10] = 0x00;
+
+        if (info->model == INSTAX_MODEL_WIDE) {
+            // Wide-specific sensor data from real Wide printer capture
+            response[11] = 0x1e; // Wide: 0x1e (30 decimal)
+            response[12] = 0x00; // Wide: 0x00
+            response[13] = 0x01; // Wide: 0x01
+            response[14] = 0x01; // Wide: 0x01
+            response[15] = 0x00; // Wide: 0x00
+        } else if (info->model == INSTAX_MODEL_SQUARE) {
+            // Square-specific sensor data from real FI017 capture
+            response[11] = 0x04;
+            response[12] = 0xff;
+            response[13] = 0x00;
+            response[14] = 0x01;
+            response[15] = 0x02;
+        } else {
+            // Mini sensor data from successful print session
+            response[11] = 0x2a;
+            response[12] = 0x01;
+            response[13] = 0x00;
+            response[14] = 0x01;
+            response[15] = 0x01;
+        }
+        response[16] = 0x00;
+        response[17] = 0x00;
+        response[18] = 0x00;
+        response[19] = 0x00;
+        response[20] = instax_calculate_checksum(response, 20);
+
+        ESP_LOGI(TAG, "📤 Sent additional info type 1 (21 bytes)");
+
+    } else {
+        // Unknown query type - send minimal response
+        ESP_LOGW(TAG, "Unknown additional info query type: 0x%02x", query_type);
+        response_len = 8;
+        response[2] = 0x00;
+        response[3] = 0x08;
+        response[6] = 0x00; // Status OK
+        response[7] = instax_calculate_checksum(response, 7);
+    }
+
+    send_notification(response, response_len);
+}
+
+/**
+ * LED (other operations): generic ACK
+ */
+static void op_led_ack(uint8_t function, uint8_t operation,
+                       const uint8_t *payload, size_t payload_len) {
+    uint8_t response[256];
+    size_t response_len = 0;
+    // For other LED/sensor operations, send simple ACK
+    ESP_LOGI(TAG, "LED/Sensor control: operation=0x%02x", operation);
+
+    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+    response_len = 8; // Header(2) + Length(2) + Func(1) + Op(1) + Status(1) + Checksum(1)
+    response[2] = (response_len >> 8) & 0xFF; // Length high byte
+    response[3] = response_len & 0xFF;         // Length low byte
+    response[4] = function;
+    response[5] = operation;
+    response[6] = 0x00; // Status: OK
+    response[7] = instax_calculate_checksum(response, 7);
+
+    send_notification(response, response_len);
+}
+
+/**
+ * Unknown function code
+ */
+static void op_unknown(uint8_t function, uint8_t operation,
+                       const uint8_t *payload, size_t payload_len) {
+    ESP_LOGW(TAG, "Unknown function code: 0x%02x", function);
+}
+
+/**
+ * PRINT 0x01: image data chunk (reached only via the fast path in handle_instax_packet)
+ */
+static void op_print_data(uint8_t function, uint8_t operation,
+                          const uint8_t *payload, size_t payload_len) {
+    // Payload format: [0-3: chunk index] [4+: actual image data]
+    uint32_t pace_ms = handle_print_data(payload_len > 4 ? payload + 4 : NULL,
+                                         payload_len > 4 ? payload_len - 4 : 0, false);
+    if (pace_ms > 0) {
+        vTaskDelay(pdMS_TO_TICKS(pace_ms));
+    }
+}
+
+// ============================================================================
+// Opcode Dispatch
+// ============================================================================
+
+typedef void (*instax_op_handler_t)(uint8_t function, uint8_t operation,
+                                    const uint8_t *payload, size_t payload_len);
+
+typedef struct {
+    uint16_t function;      // BLE_OPCODE_ANY matches any function
+    uint16_t operation;     // BLE_OPCODE_ANY matches any operation of the function
+    const char *name;
+    instax_op_handler_t handler;
+} instax_op_entry_t;
+
+// Exact (function, operation) entries first, then per-function fallbacks, then the catch-all.
+// Lookup is a linear scan; PRINT_DATA never scans (see OP_INDEX_PRINT_DATA).
+static const instax_op_entry_t s_op_table[] = {
+    { INSTAX_FUNC_PRINT,          INSTAX_OP_PRINT_DATA,            "print_data",         op_print_data },
+    { INSTAX_FUNC_INFO,           0x00,                            "info_identify",      op_info_identify },
+    { INSTAX_FUNC_INFO,           0x01,                            "info_query",         op_info_query },
+    { INSTAX_FUNC_INFO,           INSTAX_OP_SUPPORT_FUNCTION_INFO, "info_support_func",  op_info_support_function },
+    { INSTAX_FUNC_DEVICE_CONTROL, INSTAX_OP_AUTO_SLEEP_SETTINGS,   "auto_sleep",         op_device_auto_sleep },
+    { INSTAX_FUNC_DEVICE_CONTROL, INSTAX_OP_BLE_CONNECT,           "ble_connect",        op_device_ble_connect },
+    { INSTAX_FUNC_PRINT,          INSTAX_OP_PRINT_START,           "print_start",        op_print_start },
+    { INSTAX_FUNC_PRINT,          INSTAX_OP_PRINT_END,             "print_end",          op_print_end },
+    { INSTAX_FUNC_PRINT,          INSTAX_OP_PRINT_EXECUTE,         "print_execute",      op_print_execute },
+    { INSTAX_FUNC_LED,            INSTAX_OP_XYZ_AXIS_INFO,         "xyz_axis",           op_led_xyz_axis },
+    { INSTAX_FUNC_LED,            INSTAX_OP_COLOR_CORRECTION,      "color_correction",   op_led_color_correction },
+    { INSTAX_FUNC_LED,            INSTAX_OP_ADDITIONAL_INFO,       "additional_info",    op_led_additional_info },
+    { INSTAX_FUNC_INFO,           BLE_OPCODE_ANY,                  "info_other",         NULL },  // Ignored
+    { INSTAX_FUNC_DEVICE_CONTROL, BLE_OPCODE_ANY,                  "device_other",       op_device_ack },
+    { INSTAX_FUNC_PRINT,          BLE_OPCODE_ANY,                  "print_other",        op_print_unknown },
+    { INSTAX_FUNC_LED,            BLE_OPCODE_ANY,                  "led_other",          op_led_ack },
+    { BLE_OPCODE_ANY,             BLE_OPCODE_ANY,                  "unknown",            op_unknown },
+};
+
+#define OP_TABLE_SIZE           (sizeof(s_op_table) / sizeof(s_op_table[0]))
+#define OP_INDEX_PRINT_DATA     0
+
+_Static_assert(OP_TABLE_SIZE <= BLE_OPCODE_STATS_MAX, "BLE_OPCODE_STATS_MAX too small for opcode table");
+
+// Per-entry counters (written by the protocol task, read by console/HTTP)
+typedef struct {
+    uint32_t calls;
+    uint64_t total_us;
+    uint32_t max_us;
+    uint32_t bytes_in;
+    uint32_t bytes_out;
+} op_counters_t;
+
+static op_counters_t s_op_counters[OP_TABLE_SIZE];
+static portMUX_TYPE s_op_counters_lock = portMUX_INITIALIZER_UNLOCKED;
+static int s_op_current = -1;  // Entry being dispatched (protocol task only), -1 = none
+
+/**
+ * Attribute sent response bytes to the handler being dispatched
+ */
+static void op_count_bytes_out(size_t len) {
+    if (s_op_current >= 0 && xTaskGetCurrentTaskHandle() == s_protocol_task) {
+        portENTER_CRITICAL(&s_op_counters_lock);
+        s_op_counters[s_op_current].bytes_out += len;
+        portEXIT_CRITICAL(&s_op_counters_lock);
     }
+}
 
-    int rc = ble_gatts_notify_custom(s_conn_handle, s_wide_ffea_notify_handle, om);
-    if (rc != 0) {
-        ESP_LOGE(TAG, "Failed to send Wide FFEA notification: %d", rc);
-        return ESP_FAIL;
+static void op_record(int index, size_t bytes_in, int64_t elapsed_us) {
+    op_counters_t *c = &s_op_counters[index];
+    uint32_t us = elapsed_us > 0 ? (uint32_t)elapsed_us : 0;
+
+    portENTER_CRITICAL(&s_op_counters_lock);
+    c->calls++;
+    c->total_us += us;
+    if (us > c->max_us) {
+        c->max_us = us;
     }
+    c->bytes_in += bytes_in;
+    portEXIT_CRITICAL(&s_op_counters_lock);
+}
 
-    ESP_LOGI(TAG, "📤 Sent Wide FFEA notification (11 bytes)");
-    ESP_LOGI(TAG, "   Data: %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X",
-            ffea_data[0], ffea_data[1], ffea_data[2], ffea_data[3],
-            ffea_data[4], ffea_data[5], ffea_data[6], ffea_data[7],
-            ffea_data[8], ffea_data[9], ffea_data[10]);
+static int op_lookup(uint8_t function, uint8_t operation) {
+    for (int i = 0; i < (int)OP_TABLE_SIZE; i++) {
+        const instax_op_entry_t *e = &s_op_table[i];
+        if ((e->function == function || e->function == BLE_OPCODE_ANY) &&
+            (e->operation == operation || e->operation == BLE_OPCODE_ANY)) {
+            return i;
+        }
+    }
+    return OP_TABLE_SIZE - 1;
+}
 
-    return ESP_OK;
+/**
+ * PRINT_DATA fast path - no table scan, no per-packet logging
+ * @param frame_len Full frame length for bytes-in accounting
+ */
+static void dispatch_print_data(const uint8_t *image_data, size_t image_len, size_t frame_len, bool in_place) {
+    int64_t start = esp_timer_get_time();
+    s_op_current = OP_INDEX_PRINT_DATA;
+    uint32_t pace_ms = handle_print_data(image_data, image_len, in_place);
+    s_op_current = -1;
+    op_record(OP_INDEX_PRINT_DATA, frame_len, esp_timer_get_time() - start);
+
+    // Pacing delay is dead time, not handler time - keep it out of the counters
+    if (pace_ms > 0) {
+        vTaskDelay(pdMS_TO_TICKS(pace_ms));
+    }
 }
 
 /**
@@ -560,1107 +1969,468 @@ static void handle_instax_packet(const uint8_t *data, size_t len) {
 
     // Parse command packet (from app to device)
     if (!instax_parse_command(data, len, &function, &operation, &payload, &payload_len)) {
-        ESP_LOGE(TAG, "❌ Failed to parse Instax command!");
-        // Log first few bytes for debugging
-        ESP_LOGE(TAG, "Packet hex: %02x %02x %02x %02x %02x %02x...",
-                 len > 0 ? data[0] : 0, len > 1 ? data[1] : 0, len > 2 ? data[2] : 0,
-                 len > 3 ? data[3] : 0, len > 4 ? data[4] : 0, len > 5 ? data[5] : 0);
+        ESP_LOGE(TAG, "❌ Failed to parse Instax command (%d bytes) - see `trace` for the frame", len);
+        if (event_trace_enabled(EVENT_TRACE_SUBSYS_PROTO, EVENT_TRACE_LEVEL_FRAMES)) {
+            event_trace_data(EVENT_TRACE_PARSE_FAIL, s_session->index, data, len);
+        }
         return;
     }
 
-    // Skip verbose logging for data packets (0x10, 0x01) to improve performance
-    bool is_data_packet = (function == 0x10 && operation == 0x01);
-
-    if (!is_data_packet) {
-        ESP_LOGI(TAG, "🔍 Parsing packet (%d bytes)...", len);
-        ESP_LOGI(TAG, "✅ Parsed: func=0x%02x op=0x%02x payload_len=%d",
-                 function, operation, payload_len);
+    // Hot path: data chunks skip the table scan and verbose logging
+    if (function == INSTAX_FUNC_PRINT && operation == INSTAX_OP_PRINT_DATA) {
+        if (event_trace_enabled(EVENT_TRACE_SUBSYS_PROTO, EVENT_TRACE_LEVEL_VERBOSE)) {
+            event_trace_values(EVENT_TRACE_DISPATCH, s_session->index, function, operation, payload_len);
+        }
+        dispatch_print_data(payload_len > 4 ? payload + 4 : NULL,
+                            payload_len > 4 ? payload_len - 4 : 0, len, false);
+        return;
     }
 
-    // Create response buffer
-    uint8_t response[256];
-    size_t response_len = 0;
-
-    // Handle based on function code
-    switch (function) {
-        case INSTAX_FUNC_INFO: {
-            // Info request
-            const instax_printer_info_t *info = printer_emulator_get_info();
-
-            // Official Instax app sends func=0x00 op=0x00 as a general "ping/identify" command
-            if (operation == 0x00) {
-                ESP_LOGI(TAG, "General identify/ping command - sending device info");
-                response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                response_len = 16; // Header(2) + Length(2) + Func(1) + Op(1) + Payload(9) + Checksum(1)
-                response[2] = 0x00; // Length high byte
-                response[3] = 0x10; // Length low byte (16 decimal)
-                response[4] = function;
-                response[5] = operation;
-                // Device identification payload (9 bytes)
-                // Real Wide (BO-22 capture): 61 42 00 10 00 00 00 01 00 01 00 00 00 00 00 4a
-                // Real Mini during successful print (frame 40753): 61 42 00 10 00 00 00 01 00 02 00 00 00 00 00 49
-                // Earlier Mini sessions used 0x02 at byte 7, but successful print uses 0x01
-                // Byte 7: 0x01 for all models (ready to print state)
-                // Byte 9: Wide=0x01, Mini/Square=0x02
-                response[6] = 0x00;
-                response[7] = 0x01; // Changed: Use 0x01 for all models (matches successful print capture)
-                response[8] = 0x00;
-                response[9] = (info->model == INSTAX_MODEL_WIDE) ? 0x01 : 0x02;
-                response[10] = 0x00;
-                response[11] = 0x00;
-                response[12] = 0x00;
-                response[13] = 0x00;
-                response[14] = 0x00;
-                response[15] = instax_calculate_checksum(response, 15);
-                send_notification(response, response_len);
-            } else if (operation == 0x01) {
-                // Official Instax app uses op=0x01 to query printer info (similar to op=0x02)
-                // Payload byte indicates what info is requested
-                if (payload_len > 0) {
-                    uint8_t info_query = payload[0];
-                    ESP_LOGI(TAG, "Info query op=0x01 (query type: 0x%02x)", info_query);
-
-                    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                    response[4] = function;
-                    response[5] = operation;
-
-                    switch (info_query) {
-                        case 0x01: {
-                            // Model/Firmware info - read from current printer configuration
-                            // Format: [00 01] [length] "FI033" (Mini) or "FI017" (Square) or "FI022" (Wide)
-                            ESP_LOGI(TAG, "Sending model/firmware info");
-                            const char *model_str = info->model_number; // Use actual configured model
-                            uint8_t model_len = strlen(model_str);
-                            response[6] = 0x00; response[7] = 0x01; // Payload header (matches query type)
-                            response[8] = model_len; // Length of string
-                            memcpy(&response[9], model_str, model_len);
-                            response_len = 9 + model_len + 1; // Header(2) + Length(2) + Func(1) + Op(1) + PayloadHdr(2) + Len(1) + String + Checksum(1)
-                            ESP_LOGI(TAG, "  Model: %s (length: %d)", model_str, model_len);
-                            break;
-                        }
-                        case 0x02: {
-                            // Serial number - read from current printer configuration
-                            // Format: [00 02] [length] "70555555" (Mini) or "50196563" (Square) or "20555555" (Wide)
-                            ESP_LOGI(TAG, "Sending serial number");
-                            const char *serial = info->serial_number; // Use actual configured serial
-                            uint8_t serial_len = strlen(serial);
-                            response[6] = 0x00; response[7] = 0x02; // Payload header (matches query type)
-                            response[8] = serial_len; // Length of string
-                            memcpy(&response[9], serial, serial_len);
-                            response_len = 9 + serial_len + 1; // Header(2) + Length(2) + Func(1) + Op(1) + PayloadHdr(2) + Len(1) + String + Checksum(1)
-                            ESP_LOGI(TAG, "  Serial: %s (length: %d)", serial, serial_len);
-                            break;
-                        }
-                        case 0x03: {
-                            // Additional device info - matches real device format
-                            // Real device sends: [00 03] [04] "0000"
-                            ESP_LOGI(TAG, "Sending additional device info");
-                            const char *info_str = "0000"; // Real device sends this
-                            uint8_t info_len = strlen(info_str);
-                            response[6] = 0x00; response[7] = 0x03; // Payload header (matches query type)
-                            response[8] = info_len; // Length of string
-                            memcpy(&response[9], info_str, info_len);
-                            response_len = 9 + info_len + 1; // Header(2) + Length(2) + Func(1) + Op(1) + PayloadHdr(2) + Len(1) + String + Checksum(1)
-                            break;
-                        }
-                        case 0x04: {
-                            // Firmware revision - new query type discovered Dec 2025
-                            // Format: [00 04] [length] "0101" (Mini/Square) or "0100" (Wide)
-                            ESP_LOGI(TAG, "Sending firmware revision");
-                            const char *fw_str = info->firmware_revision; // Use actual configured firmware
-                            uint8_t fw_len = strlen(fw_str);
-                            response[6] = 0x00; response[7] = 0x04; // Payload header (matches query type)
-                            response[8] = fw_len; // Length of string
-                            memcpy(&response[9], fw_str, fw_len);
-                            response_len = 9 + fw_len + 1; // Header(2) + Length(2) + Func(1) + Op(1) + PayloadHdr(2) + Len(1) + String + Checksum(1)
-                            ESP_LOGI(TAG, "  Firmware: %s (length: %d)", fw_str, fw_len);
-                            break;
-                        }
-                        case 0x05: {
-                            // Hardware revision - query type 0x05
-                            // Format: [00 05] [length] "0000" (Mini) or "0001" (Square/Wide)
-                            ESP_LOGI(TAG, "Sending hardware revision");
-                            const char *hw_str = info->hardware_revision;
-                            uint8_t hw_len = strlen(hw_str);
-                            response[6] = 0x00; response[7] = 0x05;
-                            response[8] = hw_len;
-                            memcpy(&response[9], hw_str, hw_len);
-                            response_len = 9 + hw_len + 1;
-                            ESP_LOGI(TAG, "  Hardware: %s (length: %d)", hw_str, hw_len);
-                            break;
-                        }
-                        case 0x06: {
-                            // Software revision - query type 0x06
-                            // Format: [00 06] [length] "0003" (Mini) or "0002" (Square)
-                            ESP_LOGI(TAG, "Sending software revision");
-                            const char *sw_str = info->software_revision;
-                            uint8_t sw_len = strlen(sw_str);
-                            response[6] = 0x00; response[7] = 0x06;
-                            response[8] = sw_len;
-                            memcpy(&response[9], sw_str, sw_len);
-                            response_len = 9 + sw_len + 1;
-                            ESP_LOGI(TAG, "  Software: %s (length: %d)", sw_str, sw_len);
-                            break;
-                        }
-                        case 0x07: {
-                            // Manufacturer name - query type 0x07
-                            // Format: [00 07] [length] "FUJIFILM"
-                            ESP_LOGI(TAG, "Sending manufacturer name");
-                            const char *mfr_str = info->manufacturer_name;
-                            uint8_t mfr_len = strlen(mfr_str);
-                            response[6] = 0x00; response[7] = 0x07;
-                            response[8] = mfr_len;
-                            memcpy(&response[9], mfr_str, mfr_len);
-                            response_len = 9 + mfr_len + 1;
-                            ESP_LOGI(TAG, "  Manufacturer: %s (length: %d)", mfr_str, mfr_len);
-                            break;
-                        }
-                        case 0x08: {
-                            // Device name - query type 0x08 (speculation)
-                            // Format: [00 08] [length] "INSTAX-70555555"
-                            ESP_LOGI(TAG, "Sending device name");
-                            const char *name_str = info->device_name;
-                            uint8_t name_len = strlen(name_str);
-                            response[6] = 0x00; response[7] = 0x08;
-                            response[8] = name_len;
-                            memcpy(&response[9], name_str, name_len);
-                            response_len = 9 + name_len + 1;
-                            ESP_LOGI(TAG, "  Device Name: %s (length: %d)", name_str, name_len);
-                            break;
-                        }
-                        case 0x09: {
-                            // Query type 0x09 - Version/capability info (from real printer capture)
-                            // Real Mini Link 3 returns: "00010012" (8 bytes)
-                            ESP_LOGI(TAG, "Sending version/capability info (query 0x09)");
-                            const char *ver_str = "00010012"; // From real printer capture
-                            uint8_t ver_len = strlen(ver_str);
-                            response[6] = 0x00; response[7] = 0x09;
-                            response[8] = ver_len;
-                            memcpy(&response[9], ver_str, ver_len);
-                            response_len = 9 + ver_len + 1;
-                            ESP_LOGI(TAG, "  Version info: %s (length: %d)", ver_str, ver_len);
-                            break;
-                        }
-                        case 0x0a: {
-                            // Query type 0x0a - Additional version info (from real printer capture)
-                            // Real Mini Link 3 returns: "00000001" (8 bytes)
-                            ESP_LOGI(TAG, "Sending additional version info (query 0x0a)");
-                            const char *ver2_str = "00000001"; // From real printer capture
-                            uint8_t ver2_len = strlen(ver2_str);
-                            response[6] = 0x00; response[7] = 0x0a;
-                            response[8] = ver2_len;
-                            memcpy(&response[9], ver2_str, ver2_len);
-                            response_len = 9 + ver2_len + 1;
-                            ESP_LOGI(TAG, "  Version info 2: %s (length: %d)", ver2_str, ver2_len);
-                            break;
-                        }
-                        default:
-                            ESP_LOGW(TAG, "Unknown info query: 0x%02x - sending ACK", info_query);
-                            response[6] = 0x00; // Status: OK
-                            response_len = 7;
-                            break;
-                    }
-
-                    // Fill in packet length (total bytes)
-                    response[2] = (response_len >> 8) & 0xFF;
-                    response[3] = response_len & 0xFF;
-                    // Add checksum (last byte before response_len position)
-                    response[response_len - 1] = instax_calculate_checksum(response, response_len - 1);
-                    send_notification(response, response_len);
-                }
-            } else if (operation == INSTAX_OP_SUPPORT_FUNCTION_INFO) {
-                // Always respond to status queries - Mini app requires responses during printing
-                // (Previously suppressed for Mini/Square to prevent BLE bandwidth saturation,
-                // but this caused the Mini app to timeout waiting for responses)
-
-                // Return supported functions info
-                ESP_LOGI(TAG, "Info request: operation=0x%02x, payload_len=%d", operation, payload_len);
-
-                // Official Instax app sends this command with payload=0x00 to query image dimensions
-                // Moments Print app includes payload byte to specify info type
-                if (payload_len == 0 || (payload_len == 1 && payload[0] == 0x00)) {
-                    // Query with payload 0x00 - send image dimensions (real device behavior)
-                    // Response format varies by model!
-                    ESP_LOGI(TAG, "Image dimensions query (payload=0x00) - model=%d (WIDE=%d), dimensions=%dx%d",
-                            info->model, INSTAX_MODEL_WIDE, info->width, info->height);
-                    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                    // Bytes 2-3 (length) filled below based on model
-                    response[4] = function;
-                    response[5] = operation;
-                    response[6] = 0x00; // Payload header byte 0
-                    response[7] = 0x00; // Payload header byte 1
-                    // Image dimensions (model-specific)
-                    response[8] = (info->width >> 8) & 0xFF;   // Width high byte
-                    response[9] = info->width & 0xFF;          // Width low byte
-                    response[10] = (info->height >> 8) & 0xFF; // Height high byte
-                    response[11] = info->height & 0xFF;        // Height low byte
-
-                    if (info->model == INSTAX_MODEL_WIDE) {
-                        // Real Wide: 61 42 00 13 00 02 00 00 04 ec 03 48 02 7b 00 05 28 00 62
-                        // Total 19 bytes = Header(2) + Length(2) + Func(1) + Op(1) + Payload(12) + Checksum(1)
-                        ESP_LOGI(TAG, "Sending WIDE-specific dimensions response (19 bytes)");
-                        response_len = 19;
-                        response[2] = 0x00; // Length high byte
-                        response[3] = 0x13; // Length low byte (19 decimal)
-                        response[12] = 0x02; // Max file size high byte
-                        response[13] = 0x7B; // Max file size low byte (0x027B = 635 KB)
-                        response[14] = 0x00;
-                        response[15] = 0x05; // Wide-specific (not 0x06)
-                        response[16] = 0x28; // Wide-specific (not 0x40)
-                        response[17] = 0x00;
-                        response[18] = instax_calculate_checksum(response, 18);
-                    } else {
-                        // Square/Mini: 23 byte response
-                        // Real Square: [61 42 00 17 00 02 00 00] [03 20 03 20 02 4b 00 06 40 00 01 00 00 00] [69]
-                        ESP_LOGI(TAG, "Sending Square/Mini dimensions response (23 bytes)");
-                        response_len = 23;
-                        response[2] = 0x00; // Length high byte
-                        response[3] = 0x17; // Length low byte (23 decimal)
-                        response[12] = 0x02; // Capability byte 1
-                        response[13] = 0x4b; // Capability byte 2
-                        response[14] = 0x00; // Capability byte 3
-                        response[15] = 0x06; // Capability byte 4
-                        response[16] = 0x40; // Capability byte 5
-                        response[17] = 0x00; // Capability byte 6
-                        response[18] = 0x01; // Capability byte 7
-                        response[19] = 0x00; // Capability byte 8
-                        response[20] = 0x00; // Capability byte 9
-                        response[21] = 0x00; // Capability byte 10
-                        response[22] = instax_calculate_checksum(response, 22);
-                    }
-                    send_notification(response, response_len);
-                } else if (payload_len > 0) {
-                    uint8_t info_type = payload[0];
-                    ESP_LOGI(TAG, "Info type: %d", info_type);
-
-                    // Build packet structure: [0-1: header] [2-3: length] [4: func] [5: op] [6+: payload] [last: checksum]
-                    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                    // Length will be filled in later (bytes 2-3)
-                    response[4] = function;
-                    response[5] = operation;
-
-                    // Build payload based on info type (starting at byte 6)
-                    switch (info_type) {
-                        case INSTAX_INFO_IMAGE_SUPPORT:
-                            // Payload: [0-1: header] [2-3: width] [4-5: height] [6-15: capabilities]
-                            // Real Mini Link 3 sends: [61 42 00 17 00 02 00 00] [02 58 03 20 02 7b 00 02 58 00 00 00 00 00] [ef]
-                            // Real Square sends: [61 42 00 17 00 02 00 00] [03 20 03 20 02 4b 00 06 40 00 01 00 00 00] [69]
-                            ESP_LOGI(TAG, "Sending image support: %dx%d, model enum=%d (WIDE=%d, MINI=%d, SQUARE=%d)",
-                                    info->width, info->height, info->model, INSTAX_MODEL_WIDE, INSTAX_MODEL_MINI, INSTAX_MODEL_SQUARE);
-                            response[6] = 0x00; // Payload header byte 0
-                            response[7] = 0x00; // Payload header byte 1 (matches query type)
-                            response[8] = (info->width >> 8) & 0xFF;  // Width high byte
-                            response[9] = info->width & 0xFF;         // Width low byte
-                            response[10] = (info->height >> 8) & 0xFF; // Height high byte
-                            response[11] = info->height & 0xFF;        // Height low byte
-
-                            // Extended capabilities - MODEL SPECIFIC (from real printer captures)
-                            if (info->model == INSTAX_MODEL_WIDE) {
-                                // Wide Link specific values from real printer capture:
-                                // Real Wide: 61 42 00 13 00 02 00 00 04 ec 03 48 02 7b 00 05 28 00 62
-                                // Total 19 bytes = Header(2) + Length(2) + Func(1) + Op(1) + Payload(12) + Checksum(1)
-                                response[12] = 0x02; // Max file size high byte
-                                response[13] = 0x7B; // Max file size low byte (0x027B = 635 KB, same as Mini)
-                                response[14] = 0x00; // Unknown byte 1
-                                response[15] = 0x05; // Unknown byte 2 (Wide-specific: 0x05, not 0x06)
-                                response[16] = 0x28; // Unknown byte 3 (Wide-specific: 0x28, not 0x40)
-                                response[17] = 0x00; // Unknown byte 4
-                                // Wide has 6 capability bytes, not 7 - no byte 18!
-                                response_len = 18; // Header(2) + Length(2) + Func(1) + Op(1) + Payload(12) = 18, checksum added later
-                            } else if (info->model == INSTAX_MODEL_MINI) {
-                                // Mini Link 3 specific values
-                                response[12] = 0x02; // Max file size high byte
-                                response[13] = 0x7B; // Max file size low byte (0x027B = 635 KB)
-                                response[14] = 0x00; // Unknown byte 1
-                                response[15] = 0x02; // Unknown byte 2 (was 0x06 for Square)
-                                response[16] = 0x58; // Unknown byte 3 (was 0x40 for Square)
-                                response[17] = 0x00; // Unknown byte 4
-                                response[18] = 0x00; // Unknown byte 5 (was 0x01 for Square)
-                                response[19] = 0x00; // Padding
-                                response[20] = 0x00; // Padding
-                                response[21] = 0x00; // Padding
-                                response_len = 22; // Header(2) + Length(2) + Func(1) + Op(1) + Payload(16) = 22, checksum added later
-                            } else {
-                                // Square values (original)
-                                response[12] = 0x02; // Max file size high byte
-                                response[13] = 0x4B; // Max file size low byte (0x024B = 587 KB)
-                                response[14] = 0x00; // Unknown
-                                response[15] = 0x06; // Unknown (maybe color mode count)
-                                response[16] = 0x40; // Unknown high byte
-                                response[17] = 0x00; // Unknown low byte (0x4000 = 16384)
-                                response[18] = 0x01; // Boolean flag (maybe supports color tables)
-                                response[19] = 0x00; // Padding
-                                response[20] = 0x00; // Padding
-                                response[21] = 0x00; // Padding
-                                response_len = 22; // Header(2) + Length(2) + Func(1) + Op(1) + Payload(16) = 22, checksum added later
-                            }
-                            break;
-
-                        case INSTAX_INFO_BATTERY:
-                            // Payload: [0-1: header] [2: data_len] [3: percentage] [4-5: extra]
-                            // Real Mini Link 3 sends: [61 42 00 0d 00 02 00 01] [03 50 00 10] [e9]
-                            // Real Wide (BO-22) sends: [61 42 00 0d 00 02 00 01] [02 41 00 10] [f9]
-                            // Byte 8: Mini=0x03, Wide=0x02 (CRITICAL: 0x01 may mean "busy"!)
-                            // Byte 9: Battery percentage (0x41=65% for Wide, 0x50=80% for Mini)
-                            // Byte 11 is ALWAYS 0x10 (16) on real printer
-                            ESP_LOGI(TAG, "Sending battery info: state=%d, %d%%",
-                                    info->battery_state, info->battery_percentage);
-                            response[6] = 0x00; // Payload header byte 0
-                            response[7] = 0x01; // Payload header byte 1 (matches query type)
-                            // Byte 8: Battery/ready state
-                            // Real Mini capture shows 0x02 during successful print sequence
-                            // (earlier captures showed 0x03 during initial connection)
-                            // Wide also uses 0x02. Using 0x02 for all models.
-                            response[8] = 0x02;
-                            // Byte 9: All models use battery percentage (0-100)
-                            response[9] = info->battery_percentage;
-                            ESP_LOGI(TAG, "  Battery response: byte8=0x%02x (ready), byte9=0x%02x (%d%%)",
-                                    response[8], response[9], info->battery_percentage);
-                            response[10] = 0x00; // Extra byte 1
-                            response[11] = 0x10; // ALWAYS 0x10 (16) - matches real printer exactly!
-                            response_len = 12; // Header(2) + Length(2) + Func(1) + Op(1) + Payload(6) = 12, checksum added later
-                            break;
-
-                        case INSTAX_INFO_PRINTER_FUNCTION:
-                            // Payload: [0-1: header] [2-9: printer data]
-                            // Real device sends: [61 42 00 11 00 02 00 02] [28 00 00 0c 00 00 00 00] [13]
-                            ESP_LOGI(TAG, "Sending printer function: %d photos, charging=%d",
-                                    info->photos_remaining, info->is_charging);
-                            ESP_LOGI(TAG, "  → Capability byte will be at payload[2], photos at payload[5]");
-                            response[6] = 0x00; // Payload header byte 0
-                            response[7] = 0x02; // Payload header byte 1 (matches query type)
-
-                            // Capability byte encoding (VERIFIED with real printer captures Dec 2025):
-                            // Format: [Bit 7: Charging] [Bits 4-6: Model flags] [Bits 0-3: Photos remaining 0-10]
-                            //
-                            // WIDE LINK (BO-22/FI022): Base 0x20 (0010 0000) - CORRECTED Dec 27, 2025
-                            //   Real capture with 4 films: 0x24 = 0x20 | 0x04
-                            //   Film count stored in LOWER NIBBLE (bits 0-3) of capability byte
-                            //   Moments Print reads payload[2] & 0x0F for Wide
-                            //
-                            // SQUARE LINK (FI017): Base 0x20 (0010 0000)
-                            //   Real printer with 12 films: 0x2C = 0x20 | 0x0C
-                            //   Film count stored in FULL BYTE at payload[5]
-                            //   Moments Print reads payload[5] for Square
-                            //
-                            // MINI LINK 3 (FI033): Base 0x30 (0011 0000)
-                            //   Film count encoding unknown (needs testing)
-                            uint8_t capability;
-                            uint8_t film_count = info->photos_remaining;
-                            if (film_count > 10) film_count = 10;
-
-                            if (info->model == INSTAX_MODEL_WIDE) {
-                                // Wide Link base flags: 0010 0000 (0x20) - VERIFIED with real BO-22 capture
-                                // Real Wide capture shows constant 0x24 regardless of film count
-                                capability = 0x20 | (film_count & 0x0F);
-                            } else if (info->model == INSTAX_MODEL_MINI) {
-                                // Mini Link 2 (FI033): Uses 0x20 base + film count in lower nibble
-                                // The Mini app reads film count from capability byte lower nibble
-                                // Real Mini shows 0x24 (with 4 film) or 0x2b (with 11 film) etc.
-                                // Note: ping byte 7 must be 0x01 and battery state 0x02 for printing
-                                capability = 0x20 | (film_count & 0x0F);
-                            } else if (info->model == INSTAX_MODEL_SQUARE) {
-                                // Square Link base flags: 0010 0000 (0x20) - VERIFIED with real FI017
-                                capability = 0x20 | (film_count & 0x0F);
-                            } else {
-                                // Default to Square pattern
-                                capability = 0x20 | (film_count & 0x0F);
-                            }
-
-                            // Apply charging bit for all models (bit 7)
-                            if (info->is_charging) {
-                                capability |= 0x80;  // Set bit 7 for charging
-                            }
-                            response[8] = capability;
-
-                            response[9] = 0x00;  // Reserved byte 1
-                            response[10] = 0x00; // Reserved byte 2
-
-                            // Payload[5] behavior differs by model (UPDATED Dec 2025):
-                            // - Square: Sends 0x0C (unknown purpose, NOT film count) - VERIFIED with real FI017
-                            // - Wide: Sends 0x0D (13) - observed in print capture vs 0x0C during connection
-                            // - Older Mini 1/2: Contains actual film count (capability byte 0x10-0x1F range)
-                            // Both Square and Wide use capability byte lower nibble for film count!
-                            if (info->model == INSTAX_MODEL_WIDE) {
-                                // Wide: Testing 0x0D based on print capture comparison (Dec 2025)
-                                // Previous 0x0C may have been from connection-only captures
-                                response[11] = 0x0D; // Try 0x0D (13) instead of 0x0C (12)
-                            } else if (info->model == INSTAX_MODEL_SQUARE) {
-                                // Square: Real printers send 0x0C here
-                                response[11] = 0x0C; // Match real printer behavior
-                            } else {
-                                // Older Mini 1/2: Actual film count in payload[5]
-                                response[11] = info->photos_remaining;
-                            }
-
-                            response[12] = 0x00; // Padding byte 1
-                            response[13] = 0x00; // Padding byte 2
-                            response[14] = 0x00; // Padding byte 3
-                            response[15] = 0x00; // Padding byte 4
-                            response_len = 16; // Header(2) + Length(2) + Func(1) + Op(1) + Payload(10) = 16, checksum added later
-
-                            // Debug: Log the exact payload bytes
-                            ESP_LOGI(TAG, "  Payload bytes: [0-1]=0x%02x%02x [2]=0x%02x [3-4]=0x%02x%02x [5]=0x%02x [6-9]=0x%02x%02x%02x%02x",
-                                    response[6], response[7], response[8], response[9], response[10],
-                                    response[11], response[12], response[13], response[14], response[15]);
-                            if (info->model == INSTAX_MODEL_WIDE) {
-                                ESP_LOGI(TAG, "  → WIDE: Capability byte 0x%02x, film count %d in lower nibble (payload[2] & 0x0F)",
-                                        capability, capability & 0x0F);
-                                ESP_LOGI(TAG, "  → WIDE: payload[5] = 0x%02x (unknown purpose, matches real printer)",
-                                        response[11]);
-                            } else {
-                                ESP_LOGI(TAG, "  → SQUARE/MINI: Capability byte 0x%02x, film count %d at payload[5]",
-                                        capability, response[11]);
-                            }
-                            break;
-
-                        case INSTAX_INFO_PRINT_HISTORY:
-                            // Payload: [0-1: header] [2-5: lifetime count] [6-9: current pack info]
-                            // Real Mini Link 3 sends: [61 42 00 11 00 02 00 03] [00 00 00 23 00 00 00 07] [1c]
-                            // Byte 15 might be what the app reads for film count!
-                            ESP_LOGI(TAG, "Sending print history: %lu lifetime, %d current pack",
-                                    (unsigned long)info->lifetime_print_count, info->photos_remaining);
-                            response[6] = 0x00; // Payload header byte 0
-                            response[7] = 0x03; // Payload header byte 1 (MUST match query type 3!)
-                            response[8] = (info->lifetime_print_count >> 24) & 0xFF;
-                            response[9] = (info->lifetime_print_count >> 16) & 0xFF;
-                            response[10] = (info->lifetime_print_count >> 8) & 0xFF;
-                            response[11] = info->lifetime_print_count & 0xFF;
-                            response[12] = 0x00; // Unknown byte 1
-                            response[13] = 0x00; // Unknown byte 2
-                            response[14] = 0x00; // Unknown byte 3
-                            // Real printer sends 0x07 here when film count is 0x0b (11)
-                            // Relationship unclear - maybe pack generation, error count, or calibration offset?
-                            response[15] = 0x07; // Testing: use real printer's exact value
-                            response_len = 16; // Header(2) + Length(2) + Func(1) + Op(1) + Payload(10) = 16, checksum added later
-
-                            // NOTE: Previously tried sending FFEA notification here, but app doesn't subscribe
-                            // to Wide service handles (FFE1=22, FFEA=27) - only standard service (8, 18)
-                            // Removed to avoid potential issues from unsolicited notifications
-                            break;
-
-                        default:
-                            // Unknown info type, send simple ACK
-                            ESP_LOGW(TAG, "Unknown info type: %d", info_type);
-                            response[6] = 0x00; // Status: OK
-                            response_len = 7; // Header(2) + Length(2) + Func(1) + Op(1) + Status(1)
-                            break;
-                    }
+    if (event_trace_enabled(EVENT_TRACE_SUBSYS_PROTO, EVENT_TRACE_LEVEL_FRAMES)) {
+        event_trace_values(EVENT_TRACE_DISPATCH, s_session->index, function, operation, payload_len);
+    }
 
-                    // Fill in packet length (total bytes including checksum)
-                    uint16_t packet_len = response_len + 1; // +1 for checksum
-                    response[2] = (packet_len >> 8) & 0xFF;
-                    response[3] = packet_len & 0xFF;
+    int index = op_lookup(function, operation);
+    const instax_op_entry_t *entry = &s_op_table[index];
 
-                    // Add checksum
-                    response[response_len] = instax_calculate_checksum(response, response_len);
-                    response_len++;
+    int64_t start = esp_timer_get_time();
+    s_op_current = index;
+    if (entry->handler != NULL) {
+        entry->handler(function, operation, payload, payload_len);
+    }
+    s_op_current = -1;
+    op_record(index, len, esp_timer_get_time() - start);
+}
 
-                    send_notification(response, response_len);
-                }
-            }
-            break;
-        }
+/**
+ * Reset a session's print state after its connection dropped and return it
+ * to the pool (protocol task context)
+ */
+static void handle_disconnect_cleanup(ble_session_t *session) {
+    // Only the job that owns the printer has anything in the print buffer
+    if (ble_session_print_abort(session)) {
+        print_telemetry_end(PRINT_END_DISCONNECTED);
+    }
+    session->print_in_progress = false;  // Reset print state
+    session->fff1_cached = false;  // Clear cached Link 3 response
+    session->print_image_size = 0;
+    session->print_bytes_received = 0;
+    session->print_chunk_index = 0;
+    release_printer(session);
+    ble_session_close(session);
+}
 
-        case INSTAX_FUNC_DEVICE_CONTROL: {
-            // Device control operations (newly discovered - Dec 2025)
-            ESP_LOGI(TAG, "Device control operation: 0x%02x", operation);
-
-            switch (operation) {
-                case INSTAX_OP_AUTO_SLEEP_SETTINGS: {
-                    // Auto-sleep settings (function 0x01, operation 0x02)
-                    // Payload: [timeout_minutes] [12 bytes padding]
-                    // 0x00 = never shutdown, 0x01-0xFF = timeout in minutes
-                    if (payload_len >= 1) {
-                        uint8_t timeout_minutes = payload[0];
-                        printer_emulator_set_auto_sleep(timeout_minutes);
-                        ESP_LOGI(TAG, "Auto-sleep timeout set to %d minutes (%s)",
-                                timeout_minutes, timeout_minutes == 0 ? "never" : "enabled");
-                    } else {
-                        ESP_LOGW(TAG, "Auto-sleep command with insufficient payload (%d bytes)", payload_len);
-                    }
+static void add_parser_stats(instax_parser_stats_t *total, const instax_parser_stats_t *stats) {
+    total->frames += stats->frames;
+    total->bad_checksum += stats->bad_checksum;
+    total->bad_length += stats->bad_length;
+    total->resyncs += stats->resyncs;
+    total->bytes_skipped += stats->bytes_skipped;
+    total->bytes_dropped += stats->bytes_dropped;
+}
 
-                    // Send ACK
-                    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                    response_len = 8;
-                    response[2] = (response_len >> 8) & 0xFF;
-                    response[3] = response_len & 0xFF;
-                    response[4] = function;
-                    response[5] = operation;
-                    response[6] = 0x00; // Status: OK
-                    response[7] = instax_calculate_checksum(response, 7);
-                    send_notification(response, response_len);
-                    break;
-                }
+/**
+ * Queue a disconnect marker behind any frames still waiting for the protocol task
+ * Called from the GAP event handler (host task - the ring's only producer)
+ */
+static void post_disconnect_to_protocol_task(ble_session_t *session) {
+    // A half-reassembled frame is useless now - reuse its slot for the marker
+    frame_ring_slot_t *slot = session->rx_slot != NULL ? session->rx_slot : frame_ring_acquire(&s_frame_ring);
+    session->rx_slot = NULL;
+    session->rx_dest = NULL;
+    session->rx_frame_len = 0;
+    session->expected_len = 0;
+    instax_parser_reset(&session->rx_parser);
+    add_parser_stats(&s_rx_parser_totals, &session->rx_parser.stats);
+    memset(&session->rx_parser.stats, 0, sizeof(session->rx_parser.stats));
+
+    if (slot != NULL) {
+        slot->kind = FRAME_RING_KIND_DISCONNECT;
+        slot->conn_handle = session->conn_handle;
+        slot->session = session->index;
+        slot->len = 0;
+        frame_ring_commit(&s_frame_ring, slot);
+    } else {
+        ESP_LOGW(TAG, "Frame ring full - flagging disconnect cleanup for session %d", session->index);
+        session->disconnect_pending = true;
+    }
 
-                case INSTAX_OP_BLE_CONNECT: {
-                    // BLE connection management (function 0x01, operation 0x03)
-                    // Observed in packet captures before print operations
-                    ESP_LOGI(TAG, "BLE connection management command (payload: %d bytes)", payload_len);
-
-                    // Send ACK
-                    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                    response_len = 8;
-                    response[2] = (response_len >> 8) & 0xFF;
-                    response[3] = response_len & 0xFF;
-                    response[4] = function;
-                    response[5] = operation;
-                    response[6] = 0x00; // Status: OK
-                    response[7] = instax_calculate_checksum(response, 7);
-                    send_notification(response, response_len);
-                    break;
-                }
+    if (s_protocol_task != NULL) {
+        xTaskNotifyGive(s_protocol_task);
+    }
+}
 
-                default:
-                    ESP_LOGI(TAG, "Unknown device control operation: 0x%02x - sending ACK", operation);
-                    // Send generic ACK for unknown operations
-                    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                    response_len = 8;
-                    response[2] = (response_len >> 8) & 0xFF;
-                    response[3] = response_len & 0xFF;
-                    response[4] = function;
-                    response[5] = operation;
-                    response[6] = 0x00; // Status: OK
-                    response[7] = instax_calculate_checksum(response, 7);
-                    send_notification(response, response_len);
-                    break;
-            }
-            break;
-        }
+/**
+ * Answer "printer busy" to PRINT_STARTs that waited too long for another job
+ */
+static void expire_print_waiters(void) {
+    ble_session_t *session;
+    while ((session = ble_session_print_take_expired(esp_log_timestamp(), PRINT_WAIT_TIMEOUT_MS)) != NULL) {
+        ESP_LOGW(TAG, "Print start from session %d timed out waiting for the printer", session->index);
+
+        uint8_t response[8];
+        size_t response_len = 8; // Header(2) + Length(2) + Func(1) + Op(1) + Status(1) + Checksum(1)
+        response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+        response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+        response[2] = (response_len >> 8) & 0xFF; // Length high byte
+        response[3] = response_len & 0xFF;         // Length low byte
+        response[4] = INSTAX_FUNC_PRINT;
+        response[5] = INSTAX_OP_PRINT_START;
+        response[6] = 0xB5; // Error 181: printer busy
+        response[7] = instax_calculate_checksum(response, 7);
+
+        s_session = session;
+        send_notification(response, response_len);
+        s_session = NULL;
+    }
+}
 
-        case INSTAX_FUNC_PRINT: {
-            // Print operation
-            switch (operation) {
-                case INSTAX_OP_PRINT_START: {
-                    // Check printer error conditions
-                    const instax_printer_info_t *printer_info = printer_emulator_get_info();
-                    uint8_t error_code = 0;
-                    const char *error_msg = NULL;
-
-                    // Error 178 (0xB2): No film
-                    if (printer_info->photos_remaining == 0) {
-                        error_code = 0xB2;
-                        error_msg = "No film";
-                    }
-                    // Error 179 (0xB3): Cover open
-                    else if (printer_info->cover_open) {
-                        error_code = 0xB3;
-                        error_msg = "Cover open";
-                    }
-                    // Error 180 (0xB4): Battery low (< 20%)
-                    else if (printer_info->battery_percentage < 20) {
-                        error_code = 0xB4;
-                        error_msg = "Battery low";
-                    }
-                    // Error 181 (0xB5): Printer busy
-                    else if (printer_info->printer_busy) {
-                        error_code = 0xB5;
-                        error_msg = "Printer busy";
-                    }
+/**
+ * Claim the print target for one copy if it is still the one reserved (host task)
+ * The protocol task cannot publish a new target until print_target_write_end().
+ */
+static bool print_target_write_begin(uint32_t generation) {
+    portENTER_CRITICAL(&s_print_target_lock);
+    bool valid = s_print_target_gen == generation && s_print_target_dest != NULL;
+    s_print_target_writing = valid;
+    portEXIT_CRITICAL(&s_print_target_lock);
+    return valid;
+}
 
-                    // Send error response if any error detected
-                    if (error_code != 0) {
-                        ESP_LOGW(TAG, "Print start rejected: %s (error %d = 0x%02X)", error_msg, error_code, error_code);
-
-                        response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                        response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                        response_len = 8; // Header(2) + Length(2) + Func(1) + Op(1) + Status(1) + Checksum(1)
-                        response[2] = (response_len >> 8) & 0xFF; // Length high byte
-                        response[3] = response_len & 0xFF;         // Length low byte
-                        response[4] = function;
-                        response[5] = operation;
-                        response[6] = error_code;
-                        response[7] = instax_calculate_checksum(response, 7);
-
-                        send_notification(response, response_len);
-                        break;
-                    }
+static void print_target_write_end(void) {
+    portENTER_CRITICAL(&s_print_target_lock);
+    s_print_target_writing = false;
+    portEXIT_CRITICAL(&s_print_target_lock);
+}
 
-                    // Extract image size from payload
-                    // Payload format: [0-3: header 0x02 0x00 0x00 0x00] [4-7: size big-endian]
-                    if (payload_len >= 8) {
-                        // Skip first 4 bytes (header), read bytes 4-7 as big-endian uint32
-                        s_print_image_size = ((uint32_t)payload[4] << 24) |
-                                           ((uint32_t)payload[5] << 16) |
-                                           ((uint32_t)payload[6] << 8) |
-                                           payload[7];
-                        s_print_bytes_received = 0;
-                        s_print_chunk_index = 0;
-
-                        // Print start banner for easy log identification
-                        ESP_LOGI(TAG, "");
-                        ESP_LOGI(TAG, "╔════════════════════════════════════════════════════════════════╗");
-                        ESP_LOGI(TAG, "║            🖨️  PRINT JOB STARTED                               ║");
-                        ESP_LOGI(TAG, "╠════════════════════════════════════════════════════════════════╣");
-                        ESP_LOGI(TAG, "║  Image Size:   %6lu bytes                                    ║", (unsigned long)s_print_image_size);
-                        ESP_LOGI(TAG, "║  Timestamp:    %lu ms                                    ║", (unsigned long)esp_log_timestamp());
-                        ESP_LOGI(TAG, "║  Print Number: %d                                             ║", printer_emulator_get_info()->lifetime_print_count + 1);
-                        ESP_LOGI(TAG, "╚════════════════════════════════════════════════════════════════╝");
-                        ESP_LOGI(TAG, "");
-
-                        // Call print start callback and check if it succeeded
-                        bool print_start_ok = true;
-                        if (s_print_start_callback) {
-                            print_start_ok = s_print_start_callback(s_print_image_size);
-                        }
-
-                        // Send response (ACK if successful, error if failed)
-                        // Real Wide printer Print START ACK (from packet capture):
-                        //   61 42 00 0C 10 00 00 00 00 03 84 B9
-                        //   12 bytes total: header(2) + length(2) + func(1) + op(1) + payload(5) + checksum(1)
-                        //   Payload: Status(1) + Padding(2) + ChunkSize(2) = 5 bytes
-                        //   0x0384 = 900 bytes (Wide chunk size)
-                        //   B9 = checksum (NOT part of chunk size!)
-                        response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                        response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                        response[2] = 0x00; // Length high byte
-                        response[3] = 0x0C; // Length low byte (12 = total packet length)
-                        response[4] = function;
-                        response[5] = operation;
-
-                        if (print_start_ok) {
-                            response[6] = 0x00;  // Status: OK
-                            response[7] = 0x00;  // Padding byte 1
-                            response[8] = 0x00;  // Padding byte 2
-                            // Chunk size: 0x0384 = 900 bytes (Wide chunk size, 2 bytes)
-                            response[9] = 0x03;  // Chunk size high byte
-                            response[10] = 0x84; // Chunk size low byte (900 bytes)
-                            ESP_LOGI(TAG, "🚀 Sending print start ACK (12 bytes, timestamp: %lu ms)", (unsigned long)esp_log_timestamp());
-                        } else {
-                            response[6] = 0xB1; // Status: Error 177 (out of memory)
-                            response[7] = 0x00;
-                            response[8] = 0x00;
-                            response[9] = 0x00;
-                            response[10] = 0x00;
-                            ESP_LOGE(TAG, "❌ Sending print start ERROR (out of memory)");
-                        }
-
-                        // Checksum is calculated over bytes 0-10 (11 bytes), appended as byte 11
-                        // Total packet = 12 bytes (matching real Wide printer exactly)
-                        response[11] = instax_calculate_checksum(response, 11);
-                        response_len = 12;
-
-                        // Send Print START ACK as notification on s_notify_handle
-                        // Real Wide printer sends ALL Instax protocol responses (61 42...) as NOTIFICATIONS
-                        // on handle 0x002a (verified via packet capture Dec 2025)
-                        // Indications (0x1d) on handle 0x0008 are a separate device service (0a00ffff)
-                        send_notification(response, response_len);
-
-                        if (print_start_ok) {
-                            ESP_LOGI(TAG, "✅ Print start ACK sent (timestamp: %lu ms)", (unsigned long)esp_log_timestamp());
-                            s_print_in_progress = true;  // Mark print as active (data upload phase)
-
-                            // Reset ACK statistics for this print job
-                            s_ack_sent_count = 0;
-                            s_ack_retry_count = 0;
-                            s_ack_fail_count = 0;
-                            ESP_LOGI(TAG, "📊 ACK counters reset for new print job");
-
-                            // Pre-build cached Link 3 FFF1 response for instant replies during upload
-                            // This minimizes GATT request processing time to prevent data packet loss
-                            const instax_printer_info_t *info = printer_emulator_get_info();
-                            s_cached_fff1_data[0] = (uint8_t)(10 - info->photos_remaining);
-                            s_cached_fff1_data[1] = 0x01;
-                            s_cached_fff1_data[3] = 0x15;
-                            s_cached_fff1_data[6] = 0x4F;
-                            s_cached_fff1_data[8] = (uint8_t)((info->battery_percentage * 200) / 100);
-                            s_cached_fff1_data[9] = info->is_charging ? 0x00 : 0xFF;
-                            s_cached_fff1_data[10] = 0x0F;
-                            s_fff1_cached = true;
-                        }
-                    }
-                    break;
-                }
+/**
+ * Whether a completed in-place frame went to the current print target (protocol task)
+ */
+static bool print_target_current(uint32_t generation) {
+    portENTER_CRITICAL(&s_print_target_lock);
+    bool current = s_print_target_gen == generation && s_print_target_dest != NULL;
+    portEXIT_CRITICAL(&s_print_target_lock);
+    return current;
+}
 
-                case INSTAX_OP_PRINT_DATA: {
-                    // Print data chunk
-                    // Payload format: [0-3: chunk index] [4+: actual image data]
-                    // Log first chunk and every 50th chunk to verify data is arriving
-                    if (s_print_chunk_index == 0) {
-                        ESP_LOGI(TAG, "📦 FIRST DATA chunk received! len=%d", payload_len);
-                    } else if (s_print_chunk_index % 50 == 0) {
-                        ESP_LOGI(TAG, "📦 Data chunk %lu received, len=%d",
-                                (unsigned long)s_print_chunk_index, payload_len);
-                    }
+/**
+ * Answer a dropped frame with an error status for its opcode
+ */
+static esp_err_t send_frame_status(uint8_t function, uint8_t operation, uint8_t status) {
+    uint8_t response[8];
+    size_t response_len = 8; // Header(2) + Length(2) + Func(1) + Op(1) + Status(1) + Checksum(1)
+    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
+    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
+    response[2] = (response_len >> 8) & 0xFF; // Length high byte
+    response[3] = response_len & 0xFF;         // Length low byte
+    response[4] = function;
+    response[5] = operation;
+    response[6] = status;
+    response[7] = instax_calculate_checksum(response, 7);
+    return send_notification(response, response_len);
+}
 
-                    if (s_print_data_callback && payload_len > 4) {
-                        // Skip first 4 bytes (chunk index) and only pass the actual image data
-                        const uint8_t *image_data = payload + 4;
-                        size_t image_data_len = payload_len - 4;
-                        s_print_data_callback(s_print_chunk_index, image_data, image_data_len);
-                        s_print_bytes_received += image_data_len;
-                    }
+/**
+ * Answer a frame that arrived with a bad checksum
+ */
+static void send_bad_frame_status(uint8_t function, uint8_t operation) {
+    if (send_frame_status(function, operation, STATUS_BAD_CHECKSUM) == ESP_OK) {
+        s_bad_frame_replies++;
+    }
+}
 
-                    s_print_chunk_index++;
-
-                    // Send ACK with proper packet structure
-                    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                    response_len = 8; // Header(2) + Length(2) + Func(1) + Op(1) + Status(1) + Checksum(1)
-                    response[2] = (response_len >> 8) & 0xFF; // Length high byte
-                    response[3] = response_len & 0xFF;         // Length low byte
-                    response[4] = function;
-                    response[5] = operation;
-                    response[6] = 0x00; // Status: OK
-                    response[7] = instax_calculate_checksum(response, 7);
-
-                    // Send ACK immediately - don't delay before sending!
-                    // This ensures ACK goes out right away before any buffer issues
-                    send_notification(response, response_len);
-
-                    // Delay AFTER ACK to throttle next packet processing
-                    // This gives ESP32 time to process data and prevents buffer overflow
-                    vTaskDelay(pdMS_TO_TICKS(DATA_PACKET_ACK_DELAY_MS));
-                    break;
-                }
+/**
+ * Check the checksum summed while a PRINT_DATA frame was received in place
+ * A bad frame is answered with an error status, like one the frame parser
+ * rejects; its image data stays uncommitted and is overwritten by the resend.
+ * @return true if the frame can be processed
+ */
+static bool check_in_place_checksum(const frame_ring_slot_t *slot) {
+    if (slot->checksum_ok) {
+        return true;
+    }
+    s_in_place_checksum_errors++;
+    ESP_LOGW(TAG, "⚠️ Checksum mismatch in %u-byte PRINT_DATA frame - dropped",
+             (unsigned)(PRINT_DATA_HEADER_LEN + slot->payload_len + 1));
+    if (event_trace_enabled(EVENT_TRACE_SUBSYS_PROTO, EVENT_TRACE_LEVEL_FRAMES)) {
+        event_trace_data(EVENT_TRACE_CHECKSUM_FAIL, slot->session, slot->data, slot->len);
+    }
+    __atomic_sub_fetch(&s_session->print_frames_pending, 1, __ATOMIC_RELEASE);
+    send_bad_frame_status(INSTAX_FUNC_PRINT, INSTAX_OP_PRINT_DATA);
+    return false;
+}
 
-                case INSTAX_OP_PRINT_END: {
-                    ESP_LOGI(TAG, "Print end: received %lu/%lu bytes",
-                            (unsigned long)s_print_bytes_received,
-                            (unsigned long)s_print_image_size);
-
-                    // Log ACK statistics for this print job
-                    ESP_LOGI(TAG, "");
-                    ESP_LOGI(TAG, "╔════════════════════════════════════════════════════════════════╗");
-                    ESP_LOGI(TAG, "║            📊 ACK STATISTICS                                   ║");
-                    ESP_LOGI(TAG, "╠════════════════════════════════════════════════════════════════╣");
-                    ESP_LOGI(TAG, "║  ACKs Sent:     %6lu                                         ║", (unsigned long)s_ack_sent_count);
-                    ESP_LOGI(TAG, "║  Retries:       %6lu                                         ║", (unsigned long)s_ack_retry_count);
-                    ESP_LOGI(TAG, "║  Failures:      %6lu                                         ║", (unsigned long)s_ack_fail_count);
-                    ESP_LOGI(TAG, "╚════════════════════════════════════════════════════════════════╝");
-                    if (s_ack_fail_count > 0) {
-                        ESP_LOGE(TAG, "⚠️ WARNING: %lu ACKs were lost! Client may report packet loss.",
-                                 (unsigned long)s_ack_fail_count);
-                    } else if (s_ack_retry_count > 0) {
-                        ESP_LOGW(TAG, "ℹ️ %lu retries were needed, but all ACKs delivered successfully.",
-                                 (unsigned long)s_ack_retry_count);
-                    } else {
-                        ESP_LOGI(TAG, "✅ All ACKs delivered successfully with no retries needed.");
-                    }
-                    ESP_LOGI(TAG, "");
-
-                    s_print_in_progress = false;  // Data upload complete, resume normal status queries
-                    s_fff1_cached = false;  // Clear cached Link 3 response
-
-                    // Send ACK with proper packet structure
-                    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                    response_len = 8; // Header(2) + Length(2) + Func(1) + Op(1) + Status(1) + Checksum(1)
-                    response[2] = (response_len >> 8) & 0xFF; // Length high byte
-                    response[3] = response_len & 0xFF;         // Length low byte
-                    response[4] = function;
-                    response[5] = operation;
-                    response[6] = 0x00; // Status: OK
-                    response[7] = instax_calculate_checksum(response, 7);
-
-                    send_notification(response, response_len);
-                    break;
+/**
+ * Protocol task - drains the frame ring and runs the protocol handler
+ */
+static void protocol_task(void *arg) {
+    ESP_LOGI(TAG, "Protocol task started (priority %d)", (int)uxTaskPriorityGet(NULL));
+
+    while (true) {
+        // Wake periodically while a PRINT_START is queued or a dropped job is
+        // kept for resuming, so they can time out
+        ulTaskNotifyTake(pdTRUE, ble_session_print_has_waiters() || print_resume_pending() ?
+                         pdMS_TO_TICKS(PRINT_WAIT_POLL_MS) : portMAX_DELAY);
+
+        frame_ring_slot_t *slot;
+        while ((slot = frame_ring_peek(&s_frame_ring)) != NULL) {
+            s_session = ble_session_get(slot->session);
+            s_frame_rx_us = slot->rx_us;
+            if (slot->kind == FRAME_RING_KIND_DROPPED) {
+                // Abandoned reassembly - nothing to do
+            } else if (s_session == NULL) {
+                ESP_LOGW(TAG, "Frame for closed session %d dropped", slot->session);
+            } else if (slot->kind == FRAME_RING_KIND_DISCONNECT) {
+                handle_disconnect_cleanup(s_session);
+            } else if (slot->kind == FRAME_RING_KIND_PRINT_DATA_IN_PLACE) {
+                // Header and checksum are in the slot, image data already in the print buffer
+                if (!print_target_current(slot->target_gen)) {
+                    // The buffer was swapped or freed after the frame started (job ended or restarted)
+                    ESP_LOGW(TAG, "PRINT_DATA frame written to a stale print buffer - dropped");
+                    __atomic_sub_fetch(&s_session->print_frames_pending, 1, __ATOMIC_RELEASE);
+                    send_frame_status(INSTAX_FUNC_PRINT, INSTAX_OP_PRINT_DATA, 0xB5);  // Error 181: printer busy
+                } else if (check_in_place_checksum(slot)) {
+                    dispatch_print_data(NULL, slot->payload_len,
+                                        PRINT_DATA_HEADER_LEN + slot->payload_len + 1, true);
                 }
+            } else {
+                // Checked by the frame parser
+                handle_instax_packet(slot->data, slot->len);
+            }
+            s_session = NULL;
+            frame_ring_release(&s_frame_ring);
+        }
 
-                case INSTAX_OP_PRINT_EXECUTE: {
-                    ESP_LOGI(TAG, "Print execute");
-
-                    // Check printer error conditions (double-check before executing)
-                    const instax_printer_info_t *printer_info = printer_emulator_get_info();
-                    uint8_t error_code = 0;
-                    const char *error_msg = NULL;
-
-                    // Error 178 (0xB2): No film
-                    if (printer_info->photos_remaining == 0) {
-                        error_code = 0xB2;
-                        error_msg = "No film";
-                    }
-                    // Error 179 (0xB3): Cover open
-                    else if (printer_info->cover_open) {
-                        error_code = 0xB3;
-                        error_msg = "Cover open";
-                    }
-                    // Error 180 (0xB4): Battery low (< 20%)
-                    else if (printer_info->battery_percentage < 20) {
-                        error_code = 0xB4;
-                        error_msg = "Battery low";
-                    }
-                    // Error 181 (0xB5): Printer busy
-                    else if (printer_info->printer_busy) {
-                        error_code = 0xB5;
-                        error_msg = "Printer busy";
-                    }
+        // Disconnects that could not be queued because the ring was full, and
+        // frames the parser dropped for a bad checksum (after the frames before them)
+        for (uint8_t i = 0; i < BLE_SESSION_MAX; i++) {
+            ble_session_t *session = ble_session_get(i);
+            if (session == NULL) {
+                continue;
+            }
+            uint32_t bad_frame = __atomic_exchange_n(&session->bad_frame_pending, 0, __ATOMIC_ACQUIRE);
+            if (session->disconnect_pending) {
+                session->disconnect_pending = false;
+                handle_disconnect_cleanup(session);
+            } else if (bad_frame != 0) {
+                s_session = session;
+                send_bad_frame_status((bad_frame >> 8) & 0xFF, bad_frame & 0xFF);
+                s_session = NULL;
+            }
+        }
 
-                    // Send error response if any error detected
-                    if (error_code != 0) {
-                        ESP_LOGW(TAG, "Print execute rejected: %s (error %d = 0x%02X)", error_msg, error_code, error_code);
-
-                        response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                        response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                        response_len = 8; // Header(2) + Length(2) + Func(1) + Op(1) + Status(1) + Checksum(1)
-                        response[2] = (response_len >> 8) & 0xFF; // Length high byte
-                        response[3] = response_len & 0xFF;         // Length low byte
-                        response[4] = function;
-                        response[5] = operation;
-                        response[6] = error_code;
-                        response[7] = instax_calculate_checksum(response, 7);
-
-                        send_notification(response, response_len);
-
-                        // Reset print state
-                        s_print_image_size = 0;
-                        s_print_bytes_received = 0;
-                        s_print_chunk_index = 0;
-                        break;
-                    }
+        expire_print_waiters();
+        print_resume_expire();
+    }
+}
 
-                    // Print completion banner
-                    ESP_LOGI(TAG, "");
-                    ESP_LOGI(TAG, "╔════════════════════════════════════════════════════════════════╗");
-                    ESP_LOGI(TAG, "║            ✅ PRINT JOB COMPLETED                             ║");
-                    ESP_LOGI(TAG, "╠════════════════════════════════════════════════════════════════╣");
-                    ESP_LOGI(TAG, "║  Received:     %6lu bytes                                    ║", (unsigned long)s_print_bytes_received);
-                    ESP_LOGI(TAG, "║  Expected:     %6lu bytes                                    ║", (unsigned long)s_print_image_size);
-                    ESP_LOGI(TAG, "║  Timestamp:    %lu ms                                    ║", (unsigned long)esp_log_timestamp());
-                    ESP_LOGI(TAG, "║  Print Number: %d                                             ║", printer_emulator_get_info()->lifetime_print_count);
-                    ESP_LOGI(TAG, "╚════════════════════════════════════════════════════════════════╝");
-                    ESP_LOGI(TAG, "");
-
-                    if (s_print_complete_callback) {
-                        s_print_complete_callback();
-                    }
+/**
+ * Abandon a partly reassembled frame (host task)
+ * The slot is committed as a drop marker so the consumer returns it to the free list.
+ */
+static void drop_rx_slot(ble_session_t *session) {
+    if (session->rx_slot == NULL) {
+        return;
+    }
+    session->rx_slot->kind = FRAME_RING_KIND_DROPPED;
+    session->rx_slot->session = session->index;
+    session->rx_slot->len = 0;
+    frame_ring_commit(&s_frame_ring, session->rx_slot);
+    session->rx_slot = NULL;
+    session->rx_dest = NULL;
+    session->rx_frame_len = 0;
+    session->expected_len = 0;
+    instax_parser_reset(&session->rx_parser);
+}
 
-                    // Send ACK with proper packet structure
-                    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                    response_len = 8; // Header(2) + Length(2) + Func(1) + Op(1) + Status(1) + Checksum(1)
-                    response[2] = (response_len >> 8) & 0xFF; // Length high byte
-                    response[3] = response_len & 0xFF;         // Length low byte
-                    response[4] = function;
-                    response[5] = operation;
-                    response[6] = 0x00; // Status: OK (print accepted)
-                    response[7] = instax_calculate_checksum(response, 7);
-
-                    send_notification(response, response_len);
-
-                    // Reset print state
-                    s_print_image_size = 0;
-                    s_print_bytes_received = 0;
-                    s_print_chunk_index = 0;
-                    break;
-                }
+/**
+ * Hand the session's completed slot to the protocol task (host task)
+ */
+static void publish_rx_slot(ble_session_t *session) {
+    frame_ring_slot_t *slot = session->rx_slot;
+    slot->conn_handle = session->conn_handle;
+    slot->session = session->index;
+    slot->rx_us = (uint32_t)esp_timer_get_time();
+    frame_ring_commit(&s_frame_ring, slot);
+    session->rx_slot = NULL;
+    if (s_protocol_task != NULL) {
+        xTaskNotifyGive(s_protocol_task);
+    }
+}
 
-                default:
-                    ESP_LOGW(TAG, "Unknown print operation: 0x%02x", operation);
-                    break;
-            }
-            break;
+/**
+ * Frame parser buffer: frames are assembled straight in a ring slot (host task)
+ */
+static uint8_t *rx_parser_get_buffer(void *ctx, size_t *capacity) {
+    ble_session_t *session = ctx;
+    if (session->rx_slot == NULL) {
+        session->rx_slot = frame_ring_acquire(&s_frame_ring);
+        if (session->rx_slot == NULL) {
+            ESP_LOGE(TAG, "❌ Frame ring full - protocol task not keeping up, dropping data");
+            return NULL;
         }
+    }
+    session->rx_slot->len = 0;
+    *capacity = FRAME_RING_SLOT_SIZE;
+    return session->rx_slot->data;
+}
 
-        case INSTAX_FUNC_LED: {
-            // LED & Sensor operations
-            switch (operation) {
-                case INSTAX_OP_XYZ_AXIS_INFO: {
-                    ESP_LOGI(TAG, "XYZ Axis Info request");
-
-                    // Get current accelerometer values from printer emulator
-                    const instax_printer_info_t *printer_info = printer_emulator_get_info();
-
-                    // Build response packet with accelerometer data
-                    // Payload: [x_low] [x_high] [y_low] [y_high] [z_low] [z_high] [orientation]
-                    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                    response_len = 14; // Header(2) + Length(2) + Func(1) + Op(1) + Payload(7) + Checksum(1)
-                    response[2] = (response_len >> 8) & 0xFF; // Length high byte
-                    response[3] = response_len & 0xFF;         // Length low byte
-                    response[4] = function;
-                    response[5] = operation;
-
-                    // Pack accelerometer data as little-endian int16
-                    response[6] = printer_info->accelerometer.x & 0xFF;        // X low byte
-                    response[7] = (printer_info->accelerometer.x >> 8) & 0xFF; // X high byte
-                    response[8] = printer_info->accelerometer.y & 0xFF;        // Y low byte
-                    response[9] = (printer_info->accelerometer.y >> 8) & 0xFF; // Y high byte
-                    response[10] = printer_info->accelerometer.z & 0xFF;       // Z low byte
-                    response[11] = (printer_info->accelerometer.z >> 8) & 0xFF; // Z high byte
-                    response[12] = printer_info->accelerometer.orientation;    // Orientation state
-
-                    response[13] = instax_calculate_checksum(response, 13);
-
-                    ESP_LOGI(TAG, "Accelerometer data: x=%d, y=%d, z=%d, o=%d",
-                            printer_info->accelerometer.x,
-                            printer_info->accelerometer.y,
-                            printer_info->accelerometer.z,
-                            printer_info->accelerometer.orientation);
-
-                    send_notification(response, response_len);
-                    break;
-                }
-
-                case INSTAX_OP_COLOR_CORRECTION: {
-                    // Color correction table upload (function 0x30, operation 0x01)
-                    // Newly discovered Dec 2025 - includes print mode in first byte
-                    // Payload: [mode] [color_correction_table...]
-                    // mode: 0x00 = Rich (311 bytes total), 0x03 = Natural (251 bytes total)
+/**
+ * Frame parser output: a complete frame with a valid checksum (host task)
+ * @return true - the slot now belongs to the protocol task
+ */
+static bool rx_parser_on_frame(void *ctx, uint8_t *frame, size_t len) {
+    ble_session_t *session = ctx;
+    bool is_data_packet = frame[4] == INSTAX_FUNC_PRINT && frame[5] == INSTAX_OP_PRINT_DATA;
+
+    // First bytes of the frame go to the trace ring for app compatibility debugging
+    if (event_trace_enabled(EVENT_TRACE_SUBSYS_RX, is_data_packet ? EVENT_TRACE_LEVEL_VERBOSE
+                                                                  : EVENT_TRACE_LEVEL_FRAMES)) {
+        event_trace_data(EVENT_TRACE_RX_FRAME, session->conn_handle, frame, len);
+    }
+    if (!is_data_packet) {
+        ESP_LOGI(TAG, "✅ Complete packet received: %d bytes - queued for processing", (int)len);
+    } else {
+        // Held until the protocol task has the data in the print buffer
+        __atomic_add_fetch(&session->print_frames_pending, 1, __ATOMIC_RELEASE);
+    }
 
-                    if (payload_len >= 1) {
-                        uint8_t print_mode = payload[0];
-                        printer_emulator_set_print_mode(print_mode);
+    session->rx_slot->kind = FRAME_RING_KIND_PACKET;
+    session->rx_slot->len = len;
+    session->rx_slot->checksum_ok = true;
+    publish_rx_slot(session);
+    return true;
+}
 
-                        const char *mode_str = (print_mode == 0x00) ? "Rich" :
-                                              (print_mode == 0x03) ? "Natural" : "Unknown";
-                        ESP_LOGI(TAG, "Color correction table: mode=0x%02x (%s), table_size=%d bytes",
-                                print_mode, mode_str, payload_len - 1);
-                    } else {
-                        ESP_LOGW(TAG, "Color correction command with no payload");
-                    }
+/**
+ * Frame parser: a frame with a bad checksum is about to be dropped (host task)
+ * The protocol task answers it once the frames queued before it are handled.
+ * Only the first one is kept until then - later ones are usually false header
+ * matches inside its data.
+ */
+static void rx_parser_on_bad_frame(void *ctx, const uint8_t *frame, size_t len) {
+    ble_session_t *session = ctx;
+    uint32_t none = 0;
+    uint32_t opcode = BAD_FRAME_PENDING | ((uint32_t)frame[4] << 8) | frame[5];
+    if (__atomic_compare_exchange_n(&session->bad_frame_pending, &none, opcode, false,
+                                    __ATOMIC_RELEASE, __ATOMIC_RELAXED) && s_protocol_task != NULL) {
+        xTaskNotifyGive(s_protocol_task);
+    }
+}
 
-                    // Send ACK
-                    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                    response_len = 8;
-                    response[2] = (response_len >> 8) & 0xFF;
-                    response[3] = response_len & 0xFF;
-                    response[4] = function;
-                    response[5] = operation;
-                    response[6] = 0x00; // Status: OK
-                    response[7] = instax_calculate_checksum(response, 7);
-                    send_notification(response, response_len);
-                    break;
-                }
+/**
+ * Start a zero-copy PRINT_DATA frame if the write at off begins one (host task)
+ * Only at a frame boundary: once earlier print data has been consumed, the
+ * print target published by the protocol task is the exact spot this chunk's
+ * image data belongs in.
+ * @return true if the frame is received in place
+ */
+static bool start_in_place_frame(ble_session_t *session, struct os_mbuf *om, uint16_t off, uint16_t avail) {
+    uint8_t header[PRINT_DATA_HEADER_LEN];
+    if (avail < 6 || s_print_commit_callback == NULL || ble_session_print_owner() != session ||
+        instax_parser_buffered(&session->rx_parser) > 0 ||
+        __atomic_load_n(&session->print_frames_pending, __ATOMIC_ACQUIRE) != 0) {
+        return false;
+    }
+    uint16_t peek_len = avail < sizeof(header) ? avail : sizeof(header);
+    if (os_mbuf_copydata(om, off, peek_len, header) != 0 ||
+        header[0] != INSTAX_HEADER_TO_DEVICE_0 || header[1] != INSTAX_HEADER_TO_DEVICE_1 ||
+        header[4] != INSTAX_FUNC_PRINT || header[5] != INSTAX_OP_PRINT_DATA) {
+        return false;
+    }
+    uint16_t frame_len = ((uint16_t)header[2] << 8) | header[3];
+    if (frame_len <= PRINT_DATA_HEADER_LEN + 1 || frame_len > FRAME_RING_SLOT_SIZE) {
+        return false;  // The parser drops it
+    }
 
-                case INSTAX_OP_ADDITIONAL_INFO: {
-                    // Additional sensor/device info query
-                    // Packet capture shows payload byte indicates query type:
-                    //   payload=0x00 → 17-byte response with sensor data
-                    //   payload=0x01 → 21-byte response with different sensor data
-
-                    uint8_t query_type = (payload_len > 0) ? payload[0] : 0x00;
-                    ESP_LOGI(TAG, "Additional info request: query_type=0x%02x", query_type);
-
-                    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                    response[4] = function;
-                    response[5] = operation;
-
-                    if (query_type == 0x00) {
-                        // 17-byte response with sensor data
-                        // Real Mini during successful print: 61 42 00 11 30 10 00 00 be 19 00 fc 00 00 00 00 XX
-                        // Real Square during successful print: 61 42 00 11 30 10 00 00 c1 a6 00 d2 00 00 00 00 XX
-                        const instax_printer_info_t *info = printer_emulator_get_info();
-                        response_len = 17;
-                        response[2] = 0x00; // Length high byte
-                        response[3] = 0x11; // Length low byte (17)
-                        response[6] = 0x00; // Payload header 1
-                        response[7] = 0x00; // Payload header 2 (matches query type)
-
-                        if (info->model == INSTAX_MODEL_SQUARE) {
-                            // Square-specific sensor data from real FI017 capture
-                            response[8] = 0xc1;
-                            response[9] = 0xa6;
-                            response[10] = 0x00;
-                            response[11] = 0xd2;
-                        } else {
-                            // Mini sensor data from successful print capture
-                            response[8] = 0xbe;
-                            response[9] = 0x19;
-                            response[10] = 0x00;
-                            response[11] = 0xfc;
-                        }
-                        response[12] = 0x00;
-                        response[13] = 0x00;
-                        response[14] = 0x00;
-                        response[15] = 0x00;
-                        response[16] = instax_calculate_checksum(response, 16);
-
-                        ESP_LOGI(TAG, "📤 Sent additional info type 0 (17 bytes)");
-
-                    } else if (query_type == 0x01) {
-                        // 21-byte response with different sensor data
-                        // Real Wide:   61 42 00 15 30 10 00 01 00 00 00 1e 00 01 01 00 00 00 00 00 XX
-                        // Real Mini:   61 42 00 15 30 10 00 01 00 00 00 2a 01 00 01 01 00 00 00 00 XX
-                        // Real Square: 61 42 00 15 30 10 00 01 00 00 00 04 ff 00 01 02 00 00 00 00 XX
-                        const instax_printer_info_t *info = printer_emulator_get_info();
-                        response_len = 21;
-                        response[2] = 0x00; // Length high byte
-                        response[3] = 0x15; // Length low byte (21)
-                        response[6] = 0x00; // Payload header 1
-                        response[7] = 0x01; // Payload header 2 (matches query type)
-                        response[8] = 0x00;
-                        response[9] = 0x00;
-                        response[10] = 0x00;
-
-                        if (info->model == INSTAX_MODEL_WIDE) {
-                            // Wide-specific sensor data from real Wide printer capture
-                            response[11] = 0x1e; // Wide: 0x1e (30 decimal)
-                            response[12] = 0x00; // Wide: 0x00
-                            response[13] = 0x01; // Wide: 0x01
-                            response[14] = 0x01; // Wide: 0x01
-                            response[15] = 0x00; // Wide: 0x00
-                        } else if (info->model == INSTAX_MODEL_SQUARE) {
-                            // Square-specific sensor data from real FI017 capture
-                            response[11] = 0x04;
-                            response[12] = 0xff;
-                            response[13] = 0x00;
-                            response[14] = 0x01;
-                            response[15] = 0x02;
-                        } else {
-                            // Mini sensor data from successful print session
-                            response[11] = 0x2a;
-                            response[12] = 0x01;
-                            response[13] = 0x00;
-                            response[14] = 0x01;
-                            response[15] = 0x01;
-                        }
-                        response[16] = 0x00;
-                        response[17] = 0x00;
-                        response[18] = 0x00;
-                        response[19] = 0x00;
-                        response[20] = instax_calculate_checksum(response, 20);
-
-                        ESP_LOGI(TAG, "📤 Sent additional info type 1 (21 bytes)");
+    // The parser may hold an empty slot from earlier junk - take it over
+    if (session->rx_slot == NULL) {
+        session->rx_slot = frame_ring_acquire(&s_frame_ring);
+        if (session->rx_slot == NULL) {
+            return false;
+        }
+    }
+    instax_parser_reset(&session->rx_parser);
 
-                    } else {
-                        // Unknown query type - send minimal response
-                        ESP_LOGW(TAG, "Unknown additional info query type: 0x%02x", query_type);
-                        response_len = 8;
-                        response[2] = 0x00;
-                        response[3] = 0x08;
-                        response[6] = 0x00; // Status OK
-                        response[7] = instax_calculate_checksum(response, 7);
-                    }
+    portENTER_CRITICAL(&s_print_target_lock);
+    if (s_print_target_capacity >= (size_t)(frame_len - PRINT_DATA_HEADER_LEN - 1)) {
+        session->rx_dest = s_print_target_dest;
+        session->rx_target_gen = s_print_target_gen;
+    }
+    portEXIT_CRITICAL(&s_print_target_lock);
+    if (session->rx_dest == NULL) {
+        return false;
+    }
+    session->rx_slot->len = 0;
+    session->expected_len = frame_len;
+    session->rx_frame_len = 0;
+    instax_checksum_init(&session->rx_checksum);
 
-                    send_notification(response, response_len);
-                    break;
-                }
+    if (event_trace_enabled(EVENT_TRACE_SUBSYS_RX, EVENT_TRACE_LEVEL_VERBOSE)) {
+        event_trace_data(EVENT_TRACE_RX_FRAME, session->conn_handle, header, peek_len);
+    }
+    return true;
+}
 
-                default: {
-                    // For other LED/sensor operations, send simple ACK
-                    ESP_LOGI(TAG, "LED/Sensor control: operation=0x%02x", operation);
-
-                    response[0] = INSTAX_HEADER_FROM_DEVICE_0;
-                    response[1] = INSTAX_HEADER_FROM_DEVICE_1;
-                    response_len = 8; // Header(2) + Length(2) + Func(1) + Op(1) + Status(1) + Checksum(1)
-                    response[2] = (response_len >> 8) & 0xFF; // Length high byte
-                    response[3] = response_len & 0xFF;         // Length low byte
-                    response[4] = function;
-                    response[5] = operation;
-                    response[6] = 0x00; // Status: OK
-                    response[7] = instax_calculate_checksum(response, 7);
-
-                    send_notification(response, response_len);
-                    break;
-                }
-            }
-            break;
+/**
+ * Copy the next part of a zero-copy PRINT_DATA frame out of the write (host task)
+ * Header and checksum go into the slot, image data straight into the print
+ * buffer; each byte is copied once and summed while it is still in cache.
+ * @return Bytes taken from the write (stops at the end of the frame), -1 on error
+ */
+static int receive_in_place(ble_session_t *session, struct os_mbuf *om, uint16_t off, uint16_t avail) {
+    uint16_t data_end = session->expected_len - 1;  // Frame offset of the checksum
+    uint16_t taken = 0;
+    while (taken < avail && session->rx_frame_len < session->expected_len) {
+        uint16_t n;
+        uint8_t *dst;
+        bool to_target = false;
+        if (session->rx_frame_len < PRINT_DATA_HEADER_LEN) {
+            n = PRINT_DATA_HEADER_LEN - session->rx_frame_len;
+            dst = &session->rx_slot->data[session->rx_frame_len];
+        } else if (session->rx_frame_len < data_end) {
+            n = data_end - session->rx_frame_len;
+            dst = session->rx_dest + (session->rx_frame_len - PRINT_DATA_HEADER_LEN);
+            to_target = true;
+        } else {
+            n = 1;
+            dst = &session->rx_slot->data[PRINT_DATA_HEADER_LEN];  // Checksum
+        }
+        if (n > avail - taken) {
+            n = avail - taken;
+        }
+        if (to_target && !print_target_write_begin(session->rx_target_gen)) {
+            // The protocol task moved or freed the buffer (job ended, aborted or restarted)
+            ESP_LOGW(TAG, "Print buffer changed under a PRINT_DATA frame - dropping it");
+            drop_rx_slot(session);
+            return taken;
+        }
+        int rc = os_mbuf_copydata(om, off + taken, n, dst);
+        if (to_target) {
+            print_target_write_end();
         }
+        if (rc != 0) {
+            return -1;
+        }
+        instax_checksum_update(&session->rx_checksum, dst, n);
+        taken += n;
+        session->rx_frame_len += n;
+    }
 
-        default:
-            ESP_LOGW(TAG, "Unknown function code: 0x%02x", function);
-            break;
+    if (session->rx_frame_len >= session->expected_len) {
+        // Slot holds the header and the checksum
+        session->rx_slot->len = PRINT_DATA_HEADER_LEN + 1;
+        session->rx_slot->kind = FRAME_RING_KIND_PRINT_DATA_IN_PLACE;
+        session->rx_slot->payload_len = session->expected_len - PRINT_DATA_HEADER_LEN - 1;
+        session->rx_slot->checksum_ok = instax_checksum_frame_valid(&session->rx_checksum);
+        session->rx_slot->target_gen = session->rx_target_gen;
+        __atomic_add_fetch(&session->print_frames_pending, 1, __ATOMIC_RELEASE);
+        publish_rx_slot(session);
+        session->rx_dest = NULL;
+        session->rx_frame_len = 0;
+        session->expected_len = 0;
     }
+    return taken;
 }
 
 /**
@@ -1673,74 +2443,65 @@ static int gatt_svr_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     if (ble_uuid_cmp(uuid, &instax_write_char_uuid.u) == 0) {
         // Write characteristic
         if (ctxt->op == BLE_GATT_ACCESS_OP_WRITE_CHR) {
-            uint16_t chunk_len = OS_MBUF_PKTLEN(ctxt->om);
-            ESP_LOGD(TAG, "Write characteristic: %d bytes (buffer has %d/%d)",
-                     chunk_len, s_packet_buffer_len, s_expected_packet_len);
-
-            // Copy chunk to temporary buffer
-            uint8_t chunk[512];
-            if (chunk_len > sizeof(chunk)) {
-                ESP_LOGW(TAG, "Chunk too large: %d bytes", chunk_len);
-                return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
-            }
-
-            int rc = ble_hs_mbuf_to_flat(ctxt->om, chunk, chunk_len, NULL);
-            if (rc != 0) {
-                ESP_LOGE(TAG, "Failed to copy mbuf: %d", rc);
+            ble_session_t *session = ble_session_find(conn_handle);
+            if (session == NULL) {
+                ESP_LOGW(TAG, "Write from connection %d without a session - ignoring", conn_handle);
                 return BLE_ATT_ERR_UNLIKELY;
             }
 
-            // Check if this is the start of a new packet (has Instax header)
-            if (chunk_len >= 4 && chunk[0] == INSTAX_HEADER_TO_DEVICE_0 && chunk[1] == INSTAX_HEADER_TO_DEVICE_1) {
-                // New packet starting - extract expected length
-                s_expected_packet_len = ((uint16_t)chunk[2] << 8) | chunk[3];
-                s_packet_buffer_len = 0;
-
-                // Check if this is a data packet (func=0x10, op=0x01) - skip verbose logging for these
-                bool is_data_packet = (chunk_len >= 6 && chunk[4] == 0x10 && chunk[5] == 0x01);
-
-                if (!is_data_packet) {
-                    ESP_LOGI(TAG, "📥 Received command packet (%d bytes)", chunk_len);
-                    // Log first 16 bytes of packet for debugging official app compatibility
-                    ESP_LOGI(TAG, "   First bytes: %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X",
-                            chunk_len > 0 ? chunk[0] : 0, chunk_len > 1 ? chunk[1] : 0,
-                            chunk_len > 2 ? chunk[2] : 0, chunk_len > 3 ? chunk[3] : 0,
-                            chunk_len > 4 ? chunk[4] : 0, chunk_len > 5 ? chunk[5] : 0,
-                            chunk_len > 6 ? chunk[6] : 0, chunk_len > 7 ? chunk[7] : 0,
-                            chunk_len > 8 ? chunk[8] : 0, chunk_len > 9 ? chunk[9] : 0,
-                            chunk_len > 10 ? chunk[10] : 0, chunk_len > 11 ? chunk[11] : 0,
-                            chunk_len > 12 ? chunk[12] : 0, chunk_len > 13 ? chunk[13] : 0,
-                            chunk_len > 14 ? chunk[14] : 0, chunk_len > 15 ? chunk[15] : 0);
+            // A write may end one frame and start the next, or split a frame anywhere;
+            // frames only start where the previous one ended
+            uint16_t chunk_len = OS_MBUF_PKTLEN(ctxt->om);
+            ESP_LOGD(TAG, "Write characteristic: %d bytes (%d buffered)",
+                     chunk_len, (int)instax_parser_buffered(&session->rx_parser));
+
+            uint16_t off = 0;
+            while (off < chunk_len) {
+                uint16_t avail = chunk_len - off;
+
+                if (session->rx_dest != NULL || start_in_place_frame(session, ctxt->om, off, avail)) {
+                    int n = receive_in_place(session, ctxt->om, off, avail);
+                    if (n < 0) {
+                        ESP_LOGE(TAG, "Failed to copy mbuf");
+                        drop_rx_slot(session);
+                        return BLE_ATT_ERR_UNLIKELY;
+                    }
+                    off += n;
+                    continue;
                 }
-                ESP_LOGD(TAG, "New packet starting, expecting %d bytes total", s_expected_packet_len);
-            }
-
-            // Append chunk to packet buffer
-            if (s_packet_buffer_len + chunk_len > PACKET_BUFFER_SIZE) {
-                ESP_LOGE(TAG, "Packet buffer overflow! Resetting.");
-                s_packet_buffer_len = 0;
-                s_expected_packet_len = 0;
-                return BLE_ATT_ERR_UNLIKELY;
-            }
-
-            memcpy(&s_packet_buffer[s_packet_buffer_len], chunk, chunk_len);
-            s_packet_buffer_len += chunk_len;
-
-            // Check if we have a complete packet
-            if (s_expected_packet_len > 0 && s_packet_buffer_len >= s_expected_packet_len) {
-                // Check if this is a data packet - skip verbose logging
-                bool is_data_packet = (s_packet_buffer_len >= 6 &&
-                                      s_packet_buffer[4] == 0x10 && s_packet_buffer[5] == 0x01);
 
-                if (!is_data_packet) {
-                    ESP_LOGI(TAG, "✅ Complete packet received: %d bytes - processing", s_packet_buffer_len);
+                // Everything else goes through the frame parser, straight into a ring slot
+                size_t space;
+                uint8_t *dst = instax_parser_write_ptr(&session->rx_parser, &space);
+                if (dst == NULL) {
+                    session->rx_parser.stats.bytes_dropped += avail;
+                    return BLE_ATT_ERR_INSUFFICIENT_RES;
                 }
+                // Stop at the end of the current frame, so a PRINT_DATA frame after it can go in place
+                size_t buffered = instax_parser_buffered(&session->rx_parser);
+                size_t missing = instax_parser_missing(&session->rx_parser);
+                size_t n = avail;
+                if (buffered < 4 && n > 4 - buffered) {
+                    n = 4 - buffered;  // Header and length first
+                } else if (missing > 0 && n > missing) {
+                    n = missing;
+                }
+                if (n > space) {
+                    n = space;
+                }
+                if (os_mbuf_copydata(ctxt->om, off, n, dst) != 0) {
+                    ESP_LOGE(TAG, "Failed to copy mbuf");
+                    drop_rx_slot(session);
+                    return BLE_ATT_ERR_UNLIKELY;
+                }
+                instax_parser_written(&session->rx_parser, n);
+                off += n;
+            }
 
-                // Process the complete packet
-                handle_instax_packet(s_packet_buffer, s_packet_buffer_len);
-                // Reset for next packet
-                s_packet_buffer_len = 0;
-                s_expected_packet_len = 0;
+            // Do not sit on an empty slot (after junk) - it would hold back other connections' frames
+            if (session->rx_dest == NULL && session->rx_slot != NULL &&
+                instax_parser_buffered(&session->rx_parser) == 0) {
+                drop_rx_slot(session);
             }
 
             return 0;
@@ -1776,8 +2537,18 @@ static int gap_event_handler(struct ble_gap_event *event, void *arg) {
             if (event->connect.status == 0) {
                 // Connection successful - advertising stops automatically
                 s_advertising = false;  // Clear flag since BLE stack stopped advertising
-                s_connected = true;
-                s_conn_handle = event->connect.conn_handle;
+
+                ble_session_t *session = ble_session_open(event->connect.conn_handle);
+                if (session == NULL) {
+                    // Every session is busy (or still being cleaned up) - turn the central away
+                    ble_gap_terminate(event->connect.conn_handle, BLE_ERR_REM_USER_CONN_TERM);
+                    break;
+                }
+                instax_parser_init(&session->rx_parser, true, rx_parser_get_buffer, rx_parser_on_frame, session);
+                instax_parser_set_bad_frame_handler(&session->rx_parser, rx_parser_on_bad_frame);
+
+                // Ask for a fast link (interval, data length, PHY, MTU) for this model
+                link_policy_on_connect(event->connect.conn_handle, printer_emulator_get_info()->model);
 
                 // Conditionally send security request based on bonding preference
                 // Real printer sends this ~90ms after connection when bonding is enabled
@@ -1791,6 +2562,11 @@ static int gap_event_handler(struct ble_gap_event *event, void *arg) {
                 } else {
                     ESP_LOGI(TAG, "🛠️  Bonding disabled - skipping security request (development mode)");
                 }
+
+                // Keep advertising so further centrals can connect while sessions are free
+                if (ble_session_count() < BLE_SESSION_MAX) {
+                    ble_peripheral_start_advertising(NULL);
+                }
             } else {
                 // Connection failed, resume advertising
                 s_advertising = false;  // Clear flag before restarting
@@ -1798,23 +2574,28 @@ static int gap_event_handler(struct ble_gap_event *event, void *arg) {
             }
             break;
 
-        case BLE_GAP_EVENT_DISCONNECT:
-            ESP_LOGI(TAG, "Disconnect; reason=%d", event->disconnect.reason);
-            s_connected = false;
-            s_conn_handle = BLE_HS_CONN_HANDLE_NONE;
-
-            // CRITICAL: Cleanup any active print job to prevent memory leak
-            printer_emulator_abort_print();
-            s_print_in_progress = false;  // Reset print state
-            s_fff1_cached = false;  // Clear cached Link 3 response
-            s_print_image_size = 0;
-            s_print_bytes_received = 0;
-            s_print_chunk_index = 0;
+        case BLE_GAP_EVENT_DISCONNECT: {
+            ESP_LOGI(TAG, "Disconnect; conn_handle=%d reason=%d",
+                     event->disconnect.conn.conn_handle, event->disconnect.reason);
+            s_failure_stats.disconnect_count++;
+            s_failure_stats.last_disconnect_reason = event->disconnect.reason;
+            s_failure_stats.last_disconnect_ms = esp_log_timestamp();
+            notify_queue_flush(event->disconnect.conn.conn_handle);
+            link_policy_on_disconnect(event->disconnect.conn.conn_handle);
+
+            ble_session_t *session = ble_session_find(event->disconnect.conn.conn_handle);
+            if (session != NULL) {
+                session->connected = false;
+                // CRITICAL: Cleanup any active print job to prevent memory leak
+                // Queued behind any pending frames so the protocol task aborts in order
+                post_disconnect_to_protocol_task(session);
+            }
 
             // Clear advertising flag and resume advertising
             s_advertising = false;  // CRITICAL: Clear flag before restarting
             ble_peripheral_start_advertising(NULL);
             break;
+        }
 
         case BLE_GAP_EVENT_ADV_COMPLETE:
             ESP_LOGI(TAG, "Advertising complete; reason=%d", event->adv_complete.reason);
@@ -1840,7 +2621,7 @@ static int gap_event_handler(struct ble_gap_event *event, void *arg) {
                 if (event->subscribe.attr_handle == s_wide_ffea_notify_handle) {
                     ESP_LOGI(TAG, "   🎯 Wide FFEA subscription detected - sending initial notification");
                     // Send FFEA notification immediately when client subscribes
-                    send_wide_ffea_notification();
+                    send_wide_ffea_notification(event->subscribe.conn_handle);
                 }
                 // Wide FFE1: Real printer does NOT send notifications on subscribe or write
                 // The nRF Connect capture shows FFEA sends notifications but FFE1 does not
@@ -1858,11 +2639,18 @@ static int gap_event_handler(struct ble_gap_event *event, void *arg) {
             if (event->subscribe.cur_indicate && !event->subscribe.prev_indicate) {
                 ESP_LOGI(TAG, "   ✅ Client SUBSCRIBED to indications on handle %d", event->subscribe.attr_handle);
                 // Save the handle the app subscribed to - we'll use this for sending indications
-                s_subscribed_indicate_handle = event->subscribe.attr_handle;
-                ESP_LOGI(TAG, "   🎯 Saved indication handle %d for Wide print responses", s_subscribed_indicate_handle);
+                ble_session_t *session = ble_session_find(event->subscribe.conn_handle);
+                if (session != NULL) {
+                    session->subscribed_indicate_handle = event->subscribe.attr_handle;
+                    ESP_LOGI(TAG, "   🎯 Saved indication handle %d for Wide print responses (session %d)",
+                             session->subscribed_indicate_handle, session->index);
+                }
             } else if (!event->subscribe.cur_indicate && event->subscribe.prev_indicate) {
                 ESP_LOGI(TAG, "   ❌ Client UNSUBSCRIBED from indications on handle %d", event->subscribe.attr_handle);
-                s_subscribed_indicate_handle = 0;
+                ble_session_t *session = ble_session_find(event->subscribe.conn_handle);
+                if (session != NULL) {
+                    session->subscribed_indicate_handle = 0;
+                }
             }
 
             // Log which characteristic this is
@@ -1907,13 +2695,25 @@ static int gap_event_handler(struct ble_gap_event *event, void *arg) {
             break;
 
         case BLE_GAP_EVENT_NOTIFY_TX:
-            // Notification transmitted successfully
+            // A notification/indication completed - its mbufs are free again
+            notify_queue_on_tx_complete();
             break;
 
         case BLE_GAP_EVENT_MTU:
             ESP_LOGI(TAG, "📏 MTU update event; conn_handle=%d mtu=%d",
                      event->mtu.conn_handle,
                      event->mtu.value);
+            link_policy_on_gap_event(event);
+            break;
+
+        case BLE_GAP_EVENT_CONN_UPDATE:
+        case BLE_GAP_EVENT_CONN_UPDATE_REQ:
+        case BLE_GAP_EVENT_PHY_UPDATE_COMPLETE:
+#ifdef BLE_GAP_EVENT_DATA_LEN_CHG
+        case BLE_GAP_EVENT_DATA_LEN_CHG:
+#endif
+            // Link negotiation results (recorded for /api/status)
+            link_policy_on_gap_event(event);
             break;
 
         default:
@@ -2203,7 +3003,10 @@ static void on_sync(void) {
  * On reset callback
  */
 static void on_reset(int reason) {
-    ESP_LOGW(TAG, "BLE host reset: reason=%d", reason);
+    ESP_LOGW(TAG, "BLE host reset: reason=%d (%s)", reason, ble_peripheral_reason_to_string(reason));
+    s_failure_stats.reset_count++;
+    s_failure_stats.last_reset_reason = reason;
+    s_failure_stats.last_reset_ms = esp_log_timestamp();
 }
 
 // =====================================================
@@ -2233,8 +3036,10 @@ static int link3_info_chr_access(uint16_t conn_handle, uint16_t attr_handle,
 
             // CRITICAL: During print upload, return cached data instantly to minimize processing time
             // This prevents BLE receive buffer overflow from delayed data packet reception
-            if (s_print_in_progress && s_fff1_cached) {
-                return os_mbuf_append(ctxt->om, s_cached_fff1_data, sizeof(s_cached_fff1_data));
+            ble_session_t *session = ble_session_find(conn_handle);
+            bool print_in_progress = (session != NULL && session->print_in_progress);
+            if (print_in_progress && session->fff1_cached) {
+                return os_mbuf_append(ctxt->om, session->cached_fff1_data, sizeof(session->cached_fff1_data));
             }
 
             uint8_t fff1_data[12] = {0};
@@ -2247,7 +3052,7 @@ static int link3_info_chr_access(uint16_t conn_handle, uint16_t attr_handle,
             fff1_data[10] = 0x0F;
 
             // Suppress verbose logging during active print upload to prevent BLE bandwidth saturation
-            if (!s_print_in_progress) {
+            if (!print_in_progress) {
                 uint8_t photos_used = fff1_data[0];
                 ESP_LOGI(TAG, "Link3 Info: FFF1 read - %d used, %d remaining, %d%% battery",
                          photos_used, printer_info->photos_remaining, printer_info->battery_percentage);
@@ -2348,8 +3153,8 @@ static int link3_status_chr_access(uint16_t conn_handle, uint16_t attr_handle,
  * Send Wide FFE1 status notification
  * FFE1 is Write/Notify - app writes to request status, printer responds with notification
  */
-static esp_err_t send_wide_ffe1_notification(void) {
-    if (!s_connected || s_conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+static esp_err_t send_wide_ffe1_notification(uint16_t conn_handle) {
+    if (ble_session_find(conn_handle) == NULL) {
         ESP_LOGW(TAG, "Cannot send Wide FFE1 notification: not connected");
         return ESP_ERR_INVALID_STATE;
     }
@@ -2377,19 +3182,14 @@ static esp_err_t send_wide_ffe1_notification(void) {
     ffe1_data[10] = 0x0F;  // Status byte
     ffe1_data[11] = 0x00;  // Unknown
 
-    struct os_mbuf *om = ble_hs_mbuf_from_flat(ffe1_data, sizeof(ffe1_data));
-    if (om == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate mbuf for Wide FFE1 notification");
-        return ESP_ERR_NO_MEM;
-    }
-
-    int rc = ble_gatts_notify_custom(s_conn_handle, s_wide_ffe1_notify_handle, om);
-    if (rc != 0) {
-        ESP_LOGE(TAG, "Failed to send Wide FFE1 notification: %d", rc);
-        return ESP_FAIL;
+    esp_err_t ret = notify_queue_send(conn_handle, s_wide_ffe1_notify_handle, ffe1_data, sizeof(ffe1_data),
+                                      NOTIFY_CLASS_STATUS, false);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to queue Wide FFE1 notification: %s", esp_err_to_name(ret));
+        return ret;
     }
 
-    ESP_LOGI(TAG, "📤 Sent Wide FFE1 notification (12 bytes): %d photos, %d%% battery, ready=%d",
+    ESP_LOGI(TAG, "📤 Queued Wide FFE1 notification (12 bytes): %d photos, %d%% battery, ready=%d",
             info->photos_remaining, info->battery_percentage, !info->printer_busy);
 
     return ESP_OK;
@@ -2424,7 +3224,7 @@ static int wide_chr_access(uint16_t conn_handle, uint16_t attr_handle,
             }
 
             // Send FFE1 notification response with current status
-            send_wide_ffe1_notification();
+            send_wide_ffe1_notification(conn_handle);
             return 0;
         }
         else if (ble_uuid_cmp(uuid, &wide_ffe9_uuid.u) == 0) {
@@ -2443,7 +3243,7 @@ static int wide_chr_access(uint16_t conn_handle, uint16_t attr_handle,
             }
 
             // Send FFEA notification in response to FFE9 write
-            send_wide_ffea_notification();
+            send_wide_ffea_notification(conn_handle);
             return 0;
         }
     }
@@ -2536,9 +3336,30 @@ esp_err_t ble_peripheral_init(void) {
     }
     // ========================================================================
 
+    // Start the protocol task before the host so no frame can arrive without a consumer
+    ble_session_pool_init();
+    ble_session_set_print_abort_handler(printer_emulator_abort_print);
+    frame_ring_init(&s_frame_ring);
+    if (s_protocol_task == NULL) {
+        BaseType_t task_ok = xTaskCreate(protocol_task, "instax_proto", PROTOCOL_TASK_STACK_SIZE,
+                                         NULL, PROTOCOL_TASK_PRIORITY_DEFAULT, &s_protocol_task);
+        if (task_ok != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create protocol task");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
     // Initialize NimBLE host
     nimble_port_init();
 
+    // Outbound notification scheduler (runs on the host task's event queue)
+    print_telemetry_init();
+    event_trace_init();
+    notify_queue_init();
+
+    // Connection parameter / PHY / data length / MTU negotiation
+    link_policy_init();
+
     // Configure host callbacks
     ble_hs_cfg.sync_cb = on_sync;
     ble_hs_cfg.reset_cb = on_reset;
@@ -2664,7 +3485,7 @@ bool ble_peripheral_is_advertising(void) {
 }
 
 bool ble_peripheral_is_connected(void) {
-    return s_connected;
+    return ble_session_count() > 0;
 }
 
 void ble_peripheral_get_mac_address(uint8_t *mac_out) {
@@ -2702,6 +3523,29 @@ void ble_peripheral_register_print_complete_callback(ble_peripheral_print_comple
     s_print_complete_callback = callback;
 }
 
+void ble_peripheral_register_print_commit_callback(ble_peripheral_print_commit_callback_t callback) {
+    s_print_commit_callback = callback;
+}
+
+void ble_peripheral_publish_print_target(uint8_t *dest, size_t capacity) {
+    while (true) {
+        portENTER_CRITICAL(&s_print_target_lock);
+        if (!s_print_target_writing) {
+            s_print_target_dest = dest;
+            s_print_target_capacity = dest != NULL ? capacity : 0;
+            s_print_target_gen++;
+            portEXIT_CRITICAL(&s_print_target_lock);
+            return;
+        }
+        portEXIT_CRITICAL(&s_print_target_lock);
+        vTaskDelay(1);  // One BLE write is being copied into the old target
+    }
+}
+
+void ble_peripheral_get_print_data_path_stats(ble_print_data_path_stats_t *stats) {
+    memcpy(stats, &s_copy_stats, sizeof(*stats));
+}
+
 void ble_peripheral_update_model_number(instax_model_t model) {
     const char *model_number = get_model_number_for_printer(model);
     ble_svc_dis_model_number_set(model_number);
@@ -2765,3 +3609,92 @@ void ble_peripheral_update_device_name_with_ip(const char *ip_address) {
         // when the user restarts advertising from the web interface
     }
 }
+
+esp_err_t ble_peripheral_set_protocol_task_priority(uint32_t priority) {
+    if (priority == 0 || priority >= configMAX_PRIORITIES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_protocol_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    vTaskPrioritySet(s_protocol_task, priority);
+    ESP_LOGI(TAG, "Protocol task priority set to %lu", (unsigned long)priority);
+    return ESP_OK;
+}
+
+void ble_peripheral_get_protocol_task_stats(ble_protocol_task_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    frame_ring_get_stats(&s_frame_ring, &stats->ring);
+    stats->rx = s_rx_parser_totals;
+    for (uint8_t i = 0; i < BLE_SESSION_MAX; i++) {
+        ble_session_t *session = ble_session_get(i);
+        if (session != NULL) {
+            add_parser_stats(&stats->rx, &session->rx_parser.stats);
+        }
+    }
+    stats->rx.bad_checksum += s_in_place_checksum_errors;
+    stats->bad_frame_replies = s_bad_frame_replies;
+    if (s_protocol_task != NULL) {
+        stats->priority = uxTaskPriorityGet(s_protocol_task);
+        stats->stack_free = uxTaskGetStackHighWaterMark(s_protocol_task);
+    }
+}
+
+void ble_peripheral_get_failure_stats(ble_failure_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    memcpy(stats, &s_failure_stats, sizeof(*stats));
+}
+
+const char *ble_peripheral_reason_to_string(int reason) {
+    switch (reason) {
+        case 0:                                             return "None";
+        case BLE_HS_ETIMEOUT:                               return "Host timeout";
+        case BLE_HS_ECONTROLLER:                            return "Controller error";
+        case BLE_HS_ENOTSYNCED:                             return "Host not synced";
+        case BLE_HS_ERR_HCI_BASE + BLE_ERR_CONN_SPVN_TMO:   return "Supervision timeout";
+        case BLE_HS_ERR_HCI_BASE + BLE_ERR_REM_USER_CONN_TERM: return "Terminated by central";
+        case BLE_HS_ERR_HCI_BASE + BLE_ERR_RD_CONN_TERM_PWROFF: return "Central powered off";
+        case BLE_HS_ERR_HCI_BASE + BLE_ERR_CONN_TERM_LOCAL: return "Terminated locally";
+        case BLE_HS_ERR_HCI_BASE + BLE_ERR_CONN_ESTABLISHMENT: return "Connection failed to establish";
+        case BLE_HS_ERR_HCI_BASE + BLE_ERR_LMP_LL_RSP_TMO:  return "LL response timeout";
+        case BLE_HS_ERR_HCI_BASE + BLE_ERR_CONN_TERM_MIC:   return "MIC failure";
+        default:                                            return "Other";
+    }
+}
+
+void ble_peripheral_get_response_cache_stats(ble_response_cache_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    stats->hits = s_response_cache_hits;
+    stats->misses = s_response_cache_misses;
+}
+
+size_t ble_peripheral_get_opcode_stats(ble_opcode_stats_t *stats, size_t max_entries) {
+    if (stats == NULL) {
+        return 0;
+    }
+
+    size_t count = OP_TABLE_SIZE < max_entries ? OP_TABLE_SIZE : max_entries;
+    portENTER_CRITICAL(&s_op_counters_lock);
+    for (size_t i = 0; i < count; i++) {
+        stats[i].function = s_op_table[i].function;
+        stats[i].operation = s_op_table[i].operation;
+        stats[i].name = s_op_table[i].name;
+        stats[i].calls = s_op_counters[i].calls;
+        stats[i].total_us = s_op_counters[i].total_us;
+        stats[i].max_us = s_op_counters[i].max_us;
+        stats[i].bytes_in = s_op_counters[i].bytes_in;
+        stats[i].bytes_out = s_op_counters[i].bytes_out;
+    }
+    portEXIT_CRITICAL(&s_op_counters_lock);
+    return count;
+}
+
+void ble_peripheral_reset_opcode_stats(void) {
+    portENTER_CRITICAL(&s_op_counters_lock);
+    memset(s_op_counters, 0, sizeof(s_op_counters));
+    portEXIT_CRITICAL(&s_op_counters_lock);
+}
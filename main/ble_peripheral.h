@@ -10,6 +10,7 @@
 
 #include "esp_err.h"
 #include "instax_protocol.h"
+#include "frame_ring.h"
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -33,6 +34,68 @@ typedef void (*ble_peripheral_print_data_callback_t)(uint32_t chunk_index, const
  */
 typedef void (*ble_peripheral_print_complete_callback_t)(void);
 
+/**
+ * Callback to commit a chunk that was written in place (protocol task)
+ * The image data is at the print target published before the frame started
+ * (see ble_peripheral_publish_print_target). An uncommitted chunk is simply
+ * overwritten by the next one.
+ * @param chunk_index Index of this data chunk
+ * @param len Length of chunk data
+ */
+typedef void (*ble_peripheral_print_commit_callback_t)(uint32_t chunk_index, size_t len);
+
+// PRINT_DATA copy accounting for the current/last print job
+typedef struct {
+    uint32_t payload_bytes;       // Image bytes received
+    uint32_t bytes_copied;        // Image bytes copied on the way to the print buffer
+    uint32_t zero_copy_chunks;    // Chunks copied once, mbuf -> print buffer
+    uint32_t copied_chunks;       // Chunks that went mbuf -> frame slot -> print buffer
+} ble_print_data_path_stats_t;
+
+// Protocol task statistics
+typedef struct {
+    frame_ring_stats_t ring;      // Frame ring depth / drops
+    uint32_t priority;            // Current task priority
+    uint32_t stack_free;          // Minimum free stack seen (bytes)
+    instax_parser_stats_t rx;     // Frame parser, all connections since boot (bad_checksum
+                                  // includes zero-copy PRINT_DATA frames)
+    uint32_t bad_frame_replies;   // Error statuses sent for frames with a bad checksum
+} ble_protocol_task_stats_t;
+
+// Host resets and disconnects (since boot)
+typedef struct {
+    uint32_t reset_count;         // NimBLE host resets
+    int last_reset_reason;        // NimBLE error code of the last reset
+    uint32_t last_reset_ms;       // Timestamp of the last reset (0 = none)
+    uint32_t disconnect_count;
+    int last_disconnect_reason;   // NimBLE/HCI error code of the last disconnect
+    uint32_t last_disconnect_ms;  // Timestamp of the last disconnect (0 = none)
+} ble_failure_stats_t;
+
+// Wildcard function/operation in opcode statistics (per-function fallback entries)
+#define BLE_OPCODE_ANY          0x100
+
+// Upper bound on entries returned by ble_peripheral_get_opcode_stats()
+#define BLE_OPCODE_STATS_MAX    24
+
+// Per-opcode handler statistics (since boot or last reset)
+typedef struct {
+    uint16_t function;            // Instax function code, or BLE_OPCODE_ANY
+    uint16_t operation;           // Instax operation code, or BLE_OPCODE_ANY
+    const char *name;             // Handler name (static string)
+    uint32_t calls;               // Frames dispatched to this handler
+    uint64_t total_us;            // Total handler time (excludes ACK pacing delay)
+    uint32_t max_us;              // Slowest single call
+    uint32_t bytes_in;            // Frame bytes received
+    uint32_t bytes_out;           // Response bytes sent (notifications/indications)
+} ble_opcode_stats_t;
+
+// INFO response cache statistics (since boot)
+typedef struct {
+    uint32_t hits;                // Responses sent from a prebuilt frame
+    uint32_t misses;              // Responses built (cold, invalidated or uncacheable)
+} ble_response_cache_stats_t;
+
 /**
  * Initialize BLE peripheral as Instax printer
  */
@@ -80,6 +143,28 @@ void ble_peripheral_register_print_data_callback(ble_peripheral_print_data_callb
  */
 void ble_peripheral_register_print_complete_callback(ble_peripheral_print_complete_callback_t callback);
 
+/**
+ * Register the commit callback for the zero-copy print data path
+ * Without it every chunk goes through the print data callback.
+ */
+void ble_peripheral_register_print_commit_callback(ble_peripheral_print_commit_callback_t callback);
+
+/**
+ * Publish where the next zero-copy chunk may be written (protocol task)
+ * The NimBLE host task copies image data only to the target published last.
+ * Publish whenever the print buffer position changes, and NULL before a
+ * buffer is swapped or freed. Waits while a BLE write is being copied to
+ * the old target. Frames written to an older target are dropped, not committed.
+ * @param dest Destination for the next chunk's image data, NULL for the copying path
+ * @param capacity Bytes that fit at dest
+ */
+void ble_peripheral_publish_print_target(uint8_t *dest, size_t capacity);
+
+/**
+ * Get PRINT_DATA copy accounting for the current/last print job
+ */
+void ble_peripheral_get_print_data_path_stats(ble_print_data_path_stats_t *stats);
+
 /**
  * Update the advertised model number in Device Information Service
  * @param model Printer model (INSTAX_MODEL_MINI, INSTAX_MODEL_SQUARE, INSTAX_MODEL_WIDE)
@@ -98,4 +183,43 @@ void ble_peripheral_update_model_number(instax_model_t model);
  */
 void ble_peripheral_update_dis_from_printer_info(void);
 
+/**
+ * Set priority of the protocol task that processes reassembled frames
+ * @param priority FreeRTOS priority (1 to configMAX_PRIORITIES - 1)
+ */
+esp_err_t ble_peripheral_set_protocol_task_priority(uint32_t priority);
+
+/**
+ * Get host reset / disconnect counters
+ */
+void ble_peripheral_get_failure_stats(ble_failure_stats_t *stats);
+
+/**
+ * Get display name for a disconnect or reset reason code
+ */
+const char *ble_peripheral_reason_to_string(int reason);
+
+/**
+ * Get protocol task and frame ring statistics
+ */
+void ble_peripheral_get_protocol_task_stats(ble_protocol_task_stats_t *stats);
+
+/**
+ * Get per-opcode dispatch statistics
+ * @param stats Array to fill (BLE_OPCODE_STATS_MAX entries is always enough)
+ * @param max_entries Size of the stats array
+ * @return Number of entries written
+ */
+size_t ble_peripheral_get_opcode_stats(ble_opcode_stats_t *stats, size_t max_entries);
+
+/**
+ * Get INFO response cache hit/miss counters
+ */
+void ble_peripheral_get_response_cache_stats(ble_response_cache_stats_t *stats);
+
+/**
+ * Reset per-opcode dispatch statistics
+ */
+void ble_peripheral_reset_opcode_stats(void);
+
 #endif // BLE_PERIPHERAL_H
@@ -29,12 +29,28 @@ static int s_discovered_count = 0;
 static uint16_t s_conn_handle = BLE_HS_CONN_HANDLE_NONE;
 static uint16_t s_write_handle = 0;
 static uint16_t s_notify_handle = 0;
+static bool s_mtu_requested = false;        // MTU exchange sent on this connection
 
 // Callbacks
 static ble_scan_result_callback_t s_scan_callback = NULL;
 static ble_connection_callback_t s_connection_callback = NULL;
 static ble_data_callback_t s_data_callback = NULL;
 
+// Printer responses are reassembled from notifications into whole, checked frames
+#define RX_FRAME_BUF_SIZE   512
+static uint8_t s_rx_frame[RX_FRAME_BUF_SIZE];
+static instax_parser_t s_rx_parser;
+
+// Payload segments accepted by ble_scanner_write_frame (header and trailer come on top)
+#define WRITE_FRAME_MAX_SEGMENTS    4
+
+// ATT allows one outstanding write request per connection: each write waits
+// for its Write Response. NimBLE ends a request after the 30 s ATT timeout,
+// the wait only guards against a callback that never comes.
+#define WRITE_RSP_TIMEOUT_MS        35000
+static SemaphoreHandle_t s_write_done;
+static volatile int s_write_status;         // ATT status of the last write request
+
 // Instax service UUID (128-bit)
 // Note: Reserved for future GATT service discovery
 static const ble_uuid128_t __attribute__((unused)) instax_service_uuid = BLE_UUID128_INIT(
@@ -56,6 +72,48 @@ static const ble_uuid128_t __attribute__((unused)) instax_notify_char_uuid = BLE
     0x3d, 0x47, 0x83, 0x2d, 0x84, 0x47, 0x95, 0x70
 );
 
+static uint8_t *rx_parser_get_buffer(void *ctx, size_t *capacity) {
+    *capacity = sizeof(s_rx_frame);
+    return s_rx_frame;
+}
+
+static bool rx_parser_on_frame(void *ctx, uint8_t *frame, size_t len) {
+    if (s_data_callback) {
+        s_data_callback(frame, len);
+    }
+    return false;   // Handled - reuse the buffer
+}
+
+static int on_write_done(uint16_t conn_handle, const struct ble_gatt_error *error,
+                         struct ble_gatt_attr *attr, void *arg) {
+    s_write_status = error->status;
+    xSemaphoreGive(s_write_done);
+    return 0;
+}
+
+/**
+ * Send one ATT write request and wait for its response (not the host task)
+ * @param om Value to write; consumed, also on failure
+ */
+static esp_err_t write_and_wait(struct os_mbuf *om) {
+    xSemaphoreTake(s_write_done, 0);    // Late response to a timed-out write
+
+    int rc = ble_gattc_write(s_conn_handle, s_write_handle, om, on_write_done, NULL);
+    if (rc != 0) {
+        ESP_LOGE(TAG, "Failed to write: %d", rc);
+        return rc == BLE_HS_ENOMEM ? ESP_ERR_NO_MEM : ESP_FAIL;
+    }
+    if (xSemaphoreTake(s_write_done, pdMS_TO_TICKS(WRITE_RSP_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGE(TAG, "No write response after %d ms", WRITE_RSP_TIMEOUT_MS);
+        return ESP_ERR_TIMEOUT;
+    }
+    if (s_write_status != 0) {
+        ESP_LOGE(TAG, "Write failed: %d", s_write_status);
+        return s_write_status == BLE_HS_ETIMEOUT ? ESP_ERR_TIMEOUT : ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
 static void set_state(ble_state_t new_state) {
     xSemaphoreTake(s_state_mutex, portMAX_DELAY);
     s_state = new_state;
@@ -140,6 +198,8 @@ static int gap_event_handler(struct ble_gap_event *event, void *arg) {
             if (event->connect.status == 0) {
                 ESP_LOGI(TAG, "Connected, handle=%d", event->connect.conn_handle);
                 s_conn_handle = event->connect.conn_handle;
+                s_mtu_requested = false;
+                instax_parser_reset(&s_rx_parser);
                 set_state(BLE_STATE_CONNECTED);
 
                 // Start service discovery
@@ -159,10 +219,10 @@ static int gap_event_handler(struct ble_gap_event *event, void *arg) {
             break;
 
         case BLE_GAP_EVENT_NOTIFY_RX:
-            // Data received from printer
-            ESP_LOGI(TAG, "Notification received, len=%d", event->notify_rx.om->om_len);
-            if (s_data_callback) {
-                s_data_callback(event->notify_rx.om->om_data, event->notify_rx.om->om_len);
+            // Data received from printer - may hold part of a frame, or more than one
+            ESP_LOGI(TAG, "Notification received, len=%d", OS_MBUF_PKTLEN(event->notify_rx.om));
+            for (struct os_mbuf *om = event->notify_rx.om; om != NULL; om = SLIST_NEXT(om, om_next)) {
+                instax_parser_push(&s_rx_parser, om->om_data, om->om_len);
             }
             break;
 
@@ -195,9 +255,11 @@ static void on_reset(int reason) {
 
 esp_err_t ble_scanner_init(void) {
     s_state_mutex = xSemaphoreCreateMutex();
-    if (s_state_mutex == NULL) {
+    s_write_done = xSemaphoreCreateBinary();
+    if (s_state_mutex == NULL || s_write_done == NULL) {
         return ESP_ERR_NO_MEM;
     }
+    instax_parser_init(&s_rx_parser, false, rx_parser_get_buffer, rx_parser_on_frame, NULL);
 
     // Initialize NimBLE
     esp_err_t ret = nimble_port_init();
@@ -330,10 +392,80 @@ esp_err_t ble_scanner_write(const uint8_t *data, size_t len) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    int rc = ble_gattc_write_flat(s_conn_handle, s_write_handle, data, len, NULL, NULL);
-    if (rc != 0) {
-        ESP_LOGE(TAG, "Failed to write: %d", rc);
-        return ESP_FAIL;
+    struct os_mbuf *om = ble_hs_mbuf_from_flat(data, len);
+    if (om == NULL) {
+        ESP_LOGE(TAG, "No mbuf for write");
+        return ESP_ERR_NO_MEM;
+    }
+    return write_and_wait(om);
+}
+
+esp_err_t ble_scanner_write_frame(const instax_frame_parts_t *parts,
+                                  const instax_iovec_t *payload, size_t count) {
+    if (!ble_scanner_is_connected() || s_write_handle == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (parts->frame_len == 0 || count > WRITE_FRAME_MAX_SEGMENTS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Header, payload segments, checksum - walked in order, never joined in RAM
+    instax_iovec_t segs[WRITE_FRAME_MAX_SEGMENTS + 2];
+    size_t nsegs = 0;
+    segs[nsegs++] = (instax_iovec_t){ .data = parts->header, .len = parts->header_len };
+    for (size_t i = 0; i < count; i++) {
+        if (payload[i].len > 0) {
+            segs[nsegs++] = payload[i];
+        }
+    }
+    segs[nsegs++] = (instax_iovec_t){ .data = parts->trailer, .len = sizeof(parts->trailer) };
+
+    // One ATT write per piece, no larger than the printer apps send or the MTU allows
+    size_t piece_max = ble_att_mtu(s_conn_handle) - 3;
+    if (piece_max > INSTAX_MAX_BLE_PACKET_SIZE || ble_att_mtu(s_conn_handle) <= 3) {
+        piece_max = INSTAX_MAX_BLE_PACKET_SIZE;
+    }
+
+    size_t seg = 0, seg_off = 0, sent = 0;
+    while (sent < parts->frame_len) {
+        size_t piece = parts->frame_len - sent;
+        if (piece > piece_max) {
+            piece = piece_max;
+        }
+
+        // The mbuf is filled straight from the segments
+        struct os_mbuf *om = ble_hs_mbuf_att_pkt();
+        if (om == NULL) {
+            ESP_LOGE(TAG, "No mbuf for frame write");
+            return ESP_ERR_NO_MEM;
+        }
+        size_t filled = 0;
+        while (filled < piece) {
+            size_t n = segs[seg].len - seg_off;
+            if (n > piece - filled) {
+                n = piece - filled;
+            }
+            if (os_mbuf_append(om, (const uint8_t *)segs[seg].data + seg_off, n) != 0) {
+                os_mbuf_free_chain(om);
+                ESP_LOGE(TAG, "No mbuf for frame write");
+                return ESP_ERR_NO_MEM;
+            }
+            filled += n;
+            seg_off += n;
+            if (seg_off == segs[seg].len) {
+                seg++;
+                seg_off = 0;
+            }
+        }
+
+        // ble_gattc_write() owns the mbuf from here, also on failure; one
+        // request in flight also keeps a chunk from draining the mbuf pool
+        esp_err_t ret = write_and_wait(om);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Frame write failed at byte %u of %u", (unsigned)sent, (unsigned)parts->frame_len);
+            return ret;
+        }
+        sent += piece;
     }
 
     return ESP_OK;
@@ -371,6 +503,19 @@ esp_err_t ble_scanner_print_image(const uint8_t *image_data, size_t image_len,
     if (model_info == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
+    // Chunk size and delays stay fixed for the job even if the profile is retuned
+    const instax_model_info_t profile = *model_info;
+
+    // Larger MTU means fewer ATT writes per frame; the exchange completes while
+    // PRINT_START is handled and ble_scanner_write_frame() follows the new MTU
+    if (!s_mtu_requested) {
+        ble_att_set_preferred_mtu(profile.preferred_mtu);
+        int rc = ble_gattc_exchange_mtu(s_conn_handle, NULL, NULL);
+        if (rc != 0 && rc != BLE_HS_EALREADY) {
+            ESP_LOGW(TAG, "MTU exchange request failed: %d", rc);
+        }
+        s_mtu_requested = true;
+    }
 
     instax_print_progress_t progress = {
         .status = INSTAX_PRINT_STARTING,
@@ -380,7 +525,8 @@ esp_err_t ble_scanner_print_image(const uint8_t *image_data, size_t image_len,
         .error_message = {0}
     };
 
-    uint8_t packet_buffer[INSTAX_MAX_BLE_PACKET_SIZE + 10];
+    // Only the small command frames are staged here
+    uint8_t packet_buffer[32];
     size_t packet_len;
 
     // Send print start
@@ -392,21 +538,23 @@ esp_err_t ble_scanner_print_image(const uint8_t *image_data, size_t image_len,
         return ESP_FAIL;
     }
 
-    vTaskDelay(pdMS_TO_TICKS(100));
+    vTaskDelay(pdMS_TO_TICKS(profile.start_delay_ms));
 
     // Send image data in chunks
     progress.status = INSTAX_PRINT_SENDING_DATA;
     size_t offset = 0;
     uint32_t chunk_index = 0;
-    size_t chunk_size = model_info->chunk_size;
+    size_t chunk_size = profile.chunk_size;
 
     while (offset < image_len) {
         size_t remaining = image_len - offset;
         size_t this_chunk = (remaining < chunk_size) ? remaining : chunk_size;
 
-        packet_len = instax_create_print_data(chunk_index, &image_data[offset], this_chunk,
-                                               packet_buffer, sizeof(packet_buffer));
-        if (packet_len == 0 || ble_scanner_write(packet_buffer, packet_len) != ESP_OK) {
+        // Header and checksum are built around the chunk; the image is read in place
+        instax_iovec_t chunk = { .data = &image_data[offset], .len = this_chunk };
+        instax_frame_parts_t parts;
+        if (instax_build_print_data(chunk_index, chunk.data, chunk.len, &parts) == 0 ||
+            ble_scanner_write_frame(&parts, &chunk, 1) != ESP_OK) {
             strcpy(progress.error_message, "Failed to send image data");
             progress.status = INSTAX_PRINT_ERROR;
             if (progress_callback) progress_callback(&progress);
@@ -422,8 +570,8 @@ esp_err_t ble_scanner_print_image(const uint8_t *image_data, size_t image_len,
             progress_callback(&progress);
         }
 
-        // Delay between packets (75ms for Link 3 compatibility)
-        vTaskDelay(pdMS_TO_TICKS(75));
+        // Delay between packets (75ms by default, for Link 3 compatibility)
+        vTaskDelay(pdMS_TO_TICKS(profile.chunk_delay_ms));
     }
 
     // Send print end
@@ -438,13 +586,13 @@ esp_err_t ble_scanner_print_image(const uint8_t *image_data, size_t image_len,
         return ESP_FAIL;
     }
 
-    vTaskDelay(pdMS_TO_TICKS(100));
+    vTaskDelay(pdMS_TO_TICKS(profile.end_delay_ms));
 
     // Send LED pattern (required for Link 3)
     packet_len = instax_create_led_pattern(packet_buffer, sizeof(packet_buffer));
     ble_scanner_write(packet_buffer, packet_len);
 
-    vTaskDelay(pdMS_TO_TICKS(1000)); // Link 3 needs 1 second delay
+    vTaskDelay(pdMS_TO_TICKS(profile.execute_delay_ms)); // Link 3 needs 1 second delay
 
     // Send print execute
     progress.status = INSTAX_PRINT_EXECUTING;
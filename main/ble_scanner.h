@@ -95,12 +95,31 @@ bool ble_scanner_is_connected(void);
 
 /**
  * Write data to the Instax write characteristic
+ * Waits for the printer's Write Response (do not call from the NimBLE host task).
  * @param data Data to write
  * @param len Length of data
  * @return ESP_OK on success
  */
 esp_err_t ble_scanner_write(const uint8_t *data, size_t len);
 
+/**
+ * Write a frame built with instax_build_frame()/instax_build_print_data()
+ *
+ * The frame is split into ATT writes of at most INSTAX_MAX_BLE_PACKET_SIZE
+ * bytes (less if the MTU is smaller); each write's mbuf is filled directly
+ * from the header, the payload segments and the checksum, so the payload is
+ * never staged in a frame buffer. Each write waits for the printer's Write
+ * Response before the next is sent, as ATT allows only one request in flight
+ * (do not call from the NimBLE host task).
+ * @param parts Header and trailer of the frame
+ * @param payload Payload segments the frame was built over (up to 4)
+ * @param count Number of segments
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if no mbuf was available,
+ *         ESP_ERR_TIMEOUT if the printer did not answer, ESP_FAIL if a write was refused
+ */
+esp_err_t ble_scanner_write_frame(const instax_frame_parts_t *parts,
+                                  const instax_iovec_t *payload, size_t count);
+
 /**
  * Register callback for scan results
  * @param callback Function to call when device found
@@ -114,7 +133,8 @@ void ble_scanner_register_scan_callback(ble_scan_result_callback_t callback);
 void ble_scanner_register_connection_callback(ble_connection_callback_t callback);
 
 /**
- * Register callback for received data (notifications)
+ * Register callback for received printer frames (whole frames with a valid
+ * checksum, reassembled from notifications)
  * @param callback Function to call when data received
  */
 void ble_scanner_register_data_callback(ble_data_callback_t callback);
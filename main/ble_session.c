@@ -0,0 +1,174 @@
+/**
+ * @file ble_session.c
+ * @brief Per-connection session pool and print job scheduler
+ */
+
+#include "ble_session.h"
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "ble_session";
+
+#define NO_OWNER    -1
+
+static ble_session_t s_sessions[BLE_SESSION_MAX];
+
+// Printer ownership - written by the protocol task, read by the host task
+static int s_print_owner = NO_OWNER;
+static uint32_t s_print_wait_seq = 0;   // Protocol task only
+static ble_session_print_abort_fn s_print_abort_handler = NULL;
+
+void ble_session_pool_init(void) {
+    memset(s_sessions, 0, sizeof(s_sessions));
+    for (int i = 0; i < BLE_SESSION_MAX; i++) {
+        s_sessions[i].index = i;
+    }
+    s_print_owner = NO_OWNER;
+    s_print_wait_seq = 0;
+}
+
+ble_session_t *ble_session_open(uint16_t conn_handle) {
+    for (int i = 0; i < BLE_SESSION_MAX; i++) {
+        ble_session_t *session = &s_sessions[i];
+        if (__atomic_load_n(&session->in_use, __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+        memset(session, 0, sizeof(*session));
+        session->index = i;
+        session->conn_handle = conn_handle;
+        session->opened_ms = esp_log_timestamp();
+        session->connected = true;
+        __atomic_store_n(&session->in_use, true, __ATOMIC_RELEASE);
+
+        ESP_LOGI(TAG, "Session %d opened for connection %d (%d/%d in use)",
+                 i, conn_handle, (int)ble_session_count(), BLE_SESSION_MAX);
+        return session;
+    }
+
+    ESP_LOGW(TAG, "No free session for connection %d", conn_handle);
+    return NULL;
+}
+
+void ble_session_close(ble_session_t *session) {
+    if (session == NULL) {
+        return;
+    }
+    ESP_LOGI(TAG, "Session %d closed (connection %d)", session->index, session->conn_handle);
+    // The host task may reuse the slot as soon as in_use is clear
+    __atomic_store_n(&session->in_use, false, __ATOMIC_RELEASE);
+}
+
+ble_session_t *ble_session_find(uint16_t conn_handle) {
+    for (int i = 0; i < BLE_SESSION_MAX; i++) {
+        ble_session_t *session = &s_sessions[i];
+        if (session->in_use && session->connected && session->conn_handle == conn_handle) {
+            return session;
+        }
+    }
+    return NULL;
+}
+
+ble_session_t *ble_session_get(uint8_t index) {
+    if (index >= BLE_SESSION_MAX || !s_sessions[index].in_use) {
+        return NULL;
+    }
+    return &s_sessions[index];
+}
+
+size_t ble_session_count(void) {
+    size_t count = 0;
+    for (int i = 0; i < BLE_SESSION_MAX; i++) {
+        if (s_sessions[i].in_use && s_sessions[i].connected) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool ble_session_print_acquire(ble_session_t *session) {
+    int owner = __atomic_load_n(&s_print_owner, __ATOMIC_ACQUIRE);
+
+    if (owner == NO_OWNER || owner == session->index) {
+        session->print_waiting = false;
+        __atomic_store_n(&s_print_owner, session->index, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    if (!session->print_waiting) {
+        session->print_waiting = true;
+        session->print_wait_seq = s_print_wait_seq++;
+        session->print_wait_start_ms = esp_log_timestamp();
+        ESP_LOGI(TAG, "Session %d waiting for the printer (owned by session %d)", session->index, owner);
+    }
+    return false;
+}
+
+ble_session_t *ble_session_print_release(ble_session_t *session) {
+    session->print_waiting = false;
+
+    if (__atomic_load_n(&s_print_owner, __ATOMIC_ACQUIRE) != session->index) {
+        return NULL;
+    }
+
+    // Hand the printer to the longest-waiting session
+    ble_session_t *next = NULL;
+    for (int i = 0; i < BLE_SESSION_MAX; i++) {
+        ble_session_t *candidate = &s_sessions[i];
+        if (candidate->in_use && candidate->connected && candidate->print_waiting &&
+            (next == NULL || (int32_t)(candidate->print_wait_seq - next->print_wait_seq) < 0)) {
+            next = candidate;
+        }
+    }
+
+    if (next != NULL) {
+        next->print_waiting = false;
+        __atomic_store_n(&s_print_owner, next->index, __ATOMIC_RELEASE);
+        ESP_LOGI(TAG, "Printer handed from session %d to session %d after %lu ms",
+                 session->index, next->index,
+                 (unsigned long)(esp_log_timestamp() - next->print_wait_start_ms));
+    } else {
+        __atomic_store_n(&s_print_owner, NO_OWNER, __ATOMIC_RELEASE);
+    }
+    return next;
+}
+
+void ble_session_set_print_abort_handler(ble_session_print_abort_fn handler) {
+    s_print_abort_handler = handler;
+}
+
+bool ble_session_print_abort(ble_session_t *session) {
+    if (__atomic_load_n(&s_print_owner, __ATOMIC_ACQUIRE) != session->index) {
+        return false;
+    }
+    ESP_LOGI(TAG, "Session %d abandons its print job", session->index);
+    if (s_print_abort_handler != NULL) {
+        s_print_abort_handler();
+    }
+    return true;
+}
+
+ble_session_t *ble_session_print_owner(void) {
+    int owner = __atomic_load_n(&s_print_owner, __ATOMIC_ACQUIRE);
+    return owner == NO_OWNER ? NULL : &s_sessions[owner];
+}
+
+ble_session_t *ble_session_print_take_expired(uint32_t now_ms, uint32_t timeout_ms) {
+    for (int i = 0; i < BLE_SESSION_MAX; i++) {
+        ble_session_t *session = &s_sessions[i];
+        if (session->in_use && session->print_waiting &&
+            now_ms - session->print_wait_start_ms >= timeout_ms) {
+            session->print_waiting = false;
+            return session;
+        }
+    }
+    return NULL;
+}
+
+bool ble_session_print_has_waiters(void) {
+    for (int i = 0; i < BLE_SESSION_MAX; i++) {
+        if (s_sessions[i].in_use && s_sessions[i].print_waiting) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file ble_session.h
+ * @brief Per-connection session pool and print job scheduler
+ *
+ * Each connected central gets a session from a fixed-size pool holding its
+ * frame reassembly state (host task) and its print job state (protocol task).
+ * A session is opened on BLE_GAP_EVENT_CONNECT and closed by the protocol
+ * task once the disconnect marker has been processed, so frames still queued
+ * for a dropped connection always find their session.
+ *
+ * There is a single print buffer, so print jobs are serialized: the session
+ * that owns the printer runs its job, later PRINT_STARTs wait in FIFO order
+ * and are answered when the printer is handed to them.
+ */
+
+#ifndef BLE_SESSION_H
+#define BLE_SESSION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "frame_ring.h"
+#include "instax_protocol.h"
+
+// Concurrent centrals - one session for every connection NimBLE accepts
+#define BLE_SESSION_MAX                 CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+
+_Static_assert(BLE_SESSION_MAX <= UINT8_MAX, "Session indices are stored as uint8_t");
+_Static_assert(FRAME_RING_SLOTS > BLE_SESSION_MAX,
+               "Frame ring needs a slot per connection plus one for completed frames");
+
+// Largest PRINT_START payload kept for a deferred start
+#define BLE_SESSION_START_PAYLOAD_MAX   16
+
+typedef struct {
+    uint8_t index;                  // Position in the pool (carried in frame ring slots)
+    volatile bool in_use;           // Allocated; cleared by the protocol task on close
+    volatile bool connected;        // Cleared by the host task on disconnect
+    uint16_t conn_handle;
+    uint16_t subscribed_indicate_handle;  // Handle the app subscribed to for indications
+    uint32_t opened_ms;
+
+    // Frame reassembly (host task only)
+    instax_parser_t rx_parser;      // Frames assembled in rx_slot
+    frame_ring_slot_t *rx_slot;     // Slot reserved for this session's frames
+    uint8_t *rx_dest;               // In-place PRINT_DATA destination (NULL = parser)
+    uint32_t rx_target_gen;         // Print target generation rx_dest was taken from
+    uint16_t expected_len;          // Length of the in-place frame (0 = none)
+    uint16_t rx_frame_len;          // Bytes of the in-place frame received
+    instax_checksum_t rx_checksum;  // Running checksum of the in-place frame
+    uint32_t print_frames_pending;  // PRINT_DATA frames queued but not yet consumed (atomic)
+    volatile bool disconnect_pending;  // Disconnect marker could not be queued
+    uint32_t bad_frame_pending;     // Opcode of a corrupt frame to answer, 0 = none (atomic)
+
+    // Print job (protocol task only)
+    uint32_t print_image_size;
+    uint32_t print_bytes_received;
+    uint32_t print_chunk_index;
+    volatile bool print_in_progress;    // True between START and END (read by GATT reads)
+    bool print_waiting;                 // PRINT_START deferred until the printer is free
+    uint32_t print_wait_seq;            // FIFO order among waiting sessions
+    uint32_t print_wait_start_ms;
+    uint8_t print_start_payload[BLE_SESSION_START_PAYLOAD_MAX];
+    uint8_t print_start_payload_len;
+
+    // Cached Link 3 FFF1 response for instant replies during upload
+    uint8_t cached_fff1_data[12];
+    volatile bool fff1_cached;
+} ble_session_t;
+
+/**
+ * Callback that abandons the print job of the session owning the printer
+ * (frees the print buffer and withdraws the zero-copy print target)
+ */
+typedef void (*ble_session_print_abort_fn)(void);
+
+/**
+ * Reset the pool (call before the host starts)
+ */
+void ble_session_pool_init(void);
+
+/**
+ * Allocate a session for a new connection (host task)
+ * @return Session, or NULL if every session is still in use
+ */
+ble_session_t *ble_session_open(uint16_t conn_handle);
+
+/**
+ * Return a session to the pool (protocol task, after disconnect cleanup)
+ */
+void ble_session_close(ble_session_t *session);
+
+/**
+ * Find the connected session for a connection handle
+ * @return Session, or NULL if none
+ */
+ble_session_t *ble_session_find(uint16_t conn_handle);
+
+/**
+ * Get a session by pool index
+ * @return Session, or NULL if index is out of range or the slot is free
+ */
+ble_session_t *ble_session_get(uint8_t index);
+
+/**
+ * Number of connected sessions
+ */
+size_t ble_session_count(void);
+
+/**
+ * Ask for the printer (protocol task, PRINT_START)
+ * @return true if the session owns the printer, false if it was queued
+ */
+bool ble_session_print_acquire(ble_session_t *session);
+
+/**
+ * Give up the printer or a place in the queue (protocol task)
+ * @return Next session, which now owns the printer and must have its deferred
+ *         PRINT_START answered, or NULL
+ */
+ble_session_t *ble_session_print_release(ble_session_t *session);
+
+/**
+ * Set the callback ble_session_print_abort() uses to abandon a print job
+ */
+void ble_session_set_print_abort_handler(ble_session_print_abort_fn handler);
+
+/**
+ * Abandon the session's print job before it gives up the printer (protocol task)
+ * Does nothing unless the session owns the printer, so the next owner always
+ * finds the print buffer free.
+ * @return true if a job was abandoned
+ */
+bool ble_session_print_abort(ble_session_t *session);
+
+/**
+ * Session that currently owns the printer (any task)
+ * @return Session, or NULL if the printer is free
+ */
+ble_session_t *ble_session_print_owner(void);
+
+/**
+ * Remove and return a session that has waited longer than timeout_ms (protocol task)
+ * @return Session, or NULL if none has expired
+ */
+ble_session_t *ble_session_print_take_expired(uint32_t now_ms, uint32_t timeout_ms);
+
+/**
+ * Whether any session is waiting for the printer (protocol task)
+ */
+bool ble_session_print_has_waiters(void);
+
+#endif // BLE_SESSION_H
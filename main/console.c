@@ -7,6 +7,20 @@
 #include "wifi_manager.h"
 #include "spiffs_manager.h"
 #include "printer_emulator.h"
+#include "ack_pacer.h"
+#include "transport_profile.h"
+#include "print_writer.h"
+#include "print_pool.h"
+#include "print_cache.h"
+#include "print_journal.h"
+#include "retention.h"
+#include "storage_bench.h"
+#include "notify_queue.h"
+#include "link_policy.h"
+#include "print_telemetry.h"
+#include "print_resume.h"
+#include "event_trace.h"
+#include "ble_peripheral.h"
 #include <string.h>
 #include <stdio.h>
 #include "esp_console.h"
@@ -150,6 +164,14 @@ static int cmd_printer_status(int argc, char **argv) {
     printf("  Prints remaining: %d\n", info->photos_remaining);
     printf("  Lifetime prints: %lu\n", (unsigned long)info->lifetime_print_count);
     printf("  BLE Status: %s\n", printer_emulator_is_advertising() ? "Advertising" : "Stopped");
+
+    printer_state_stats_t state;
+    printer_emulator_get_state_stats(&state);
+    printf("  NVS state: %lu changes -> %lu commits (%lu unchanged, %lu failed), last %lu us, avg %lu us, max %lu us%s\n",
+           (unsigned long)state.requests, (unsigned long)state.commits, (unsigned long)state.unchanged,
+           (unsigned long)state.failures, (unsigned long)state.last_us,
+           (unsigned long)(state.commits ? state.total_us / state.commits : 0), (unsigned long)state.max_us,
+           state.pending ? ", save pending" : "");
     printf("\n");
 
     return 0;
@@ -522,6 +544,716 @@ static int cmd_ble_stop(int argc, char **argv) {
     return ret == ESP_OK ? 0 : 1;
 }
 
+// Command: transport [<model> [<field> <value> | reset]]
+static struct {
+    struct arg_str *model;
+    struct arg_str *field;
+    struct arg_int *value;
+    struct arg_end *end;
+} transport_args;
+
+static void print_transport_profile(instax_model_t model) {
+    const instax_model_info_t *p = instax_get_model_info(model);
+    printf("  %-7s%s MTU %u, chunk %u, ack %u ms, gap %u ms, start %u ms, end %u ms, execute %u ms\n",
+           printer_emulator_model_to_string(model), transport_profile_is_custom(model) ? "*" : " ",
+           p->preferred_mtu, p->chunk_size, p->ack_delay_ms, p->chunk_delay_ms,
+           p->start_delay_ms, p->end_delay_ms, p->execute_delay_ms);
+}
+
+static int cmd_transport(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&transport_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, transport_args.end, argv[0]);
+        return 1;
+    }
+
+    if (transport_args.model->count > 0) {
+        const char *model_str = transport_args.model->sval[0];
+        instax_model_t model;
+        if (strcasecmp(model_str, "mini") == 0) {
+            model = INSTAX_MODEL_MINI;
+        } else if (strcasecmp(model_str, "square") == 0) {
+            model = INSTAX_MODEL_SQUARE;
+        } else if (strcasecmp(model_str, "wide") == 0) {
+            model = INSTAX_MODEL_WIDE;
+        } else {
+            printf("Invalid model. Use 'mini', 'square' or 'wide'\n");
+            return 1;
+        }
+
+        if (transport_args.field->count > 0) {
+            const char *field = transport_args.field->sval[0];
+            esp_err_t ret;
+            if (strcasecmp(field, "reset") == 0) {
+                ret = transport_profile_reset(model);
+            } else {
+                if (transport_args.value->count == 0) {
+                    printf("Missing value for %s\n", field);
+                    return 1;
+                }
+                int value = transport_args.value->ival[0];
+                if (value < 0 || value > UINT16_MAX) {
+                    printf("Value out of range\n");
+                    return 1;
+                }
+                instax_model_info_t profile = *instax_get_model_info(model);
+                if (strcasecmp(field, "mtu") == 0) {
+                    profile.preferred_mtu = (uint16_t)value;
+                } else if (strcasecmp(field, "chunk") == 0) {
+                    profile.chunk_size = (uint16_t)value;
+                } else if (strcasecmp(field, "ack") == 0) {
+                    profile.ack_delay_ms = (uint16_t)value;
+                } else if (strcasecmp(field, "gap") == 0) {
+                    profile.chunk_delay_ms = (uint16_t)value;
+                } else if (strcasecmp(field, "start") == 0) {
+                    profile.start_delay_ms = (uint16_t)value;
+                } else if (strcasecmp(field, "end") == 0) {
+                    profile.end_delay_ms = (uint16_t)value;
+                } else if (strcasecmp(field, "execute") == 0) {
+                    profile.execute_delay_ms = (uint16_t)value;
+                } else {
+                    printf("Invalid field. Use mtu, chunk, ack, gap, start, end, execute or reset\n");
+                    return 1;
+                }
+                ret = transport_profile_set(model, &profile);
+            }
+            if (ret == ESP_ERR_INVALID_ARG) {
+                printf("Out of range (MTU %d-%d, chunk %d-%d, ack 0-%d ms, other delays 0-%d ms)\n",
+                       INSTAX_PROFILE_MTU_MIN, INSTAX_PROFILE_MTU_MAX,
+                       INSTAX_PROFILE_CHUNK_MIN, INSTAX_PROFILE_CHUNK_MAX,
+                       INSTAX_PROFILE_ACK_DELAY_MAX_MS, INSTAX_PROFILE_DELAY_MAX_MS);
+                return 1;
+            } else if (ret != ESP_OK) {
+                printf("Failed to save transport profile: %s\n", esp_err_to_name(ret));
+                return 1;
+            }
+        }
+    }
+
+    printf("\n");
+    printf("Transport Profiles (* = custom, saved in NVS):\n");
+    for (int m = INSTAX_MODEL_MINI; m <= INSTAX_MODEL_WIDE; m++) {
+        print_transport_profile((instax_model_t)m);
+    }
+    printf("  ack = emulator fixed-mode ACK delay; gap/start/end/execute = scanner delays\n");
+    printf("\n");
+    return 0;
+}
+
+// Command: ack_pacing [adaptive|fixed] [delay_ms]
+static struct {
+    struct arg_str *mode;
+    struct arg_int *delay_ms;
+    struct arg_end *end;
+} ack_pacing_args;
+
+static int cmd_ack_pacing(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&ack_pacing_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, ack_pacing_args.end, argv[0]);
+        return 1;
+    }
+
+    ack_pacer_stats_t stats;
+    ack_pacer_get_stats(&stats);
+
+    if (ack_pacing_args.mode->count > 0) {
+        const char *mode_str = ack_pacing_args.mode->sval[0];
+        ack_pacer_mode_t mode;
+
+        if (strcasecmp(mode_str, "adaptive") == 0) {
+            mode = ACK_PACER_MODE_ADAPTIVE;
+        } else if (strcasecmp(mode_str, "fixed") == 0) {
+            mode = ACK_PACER_MODE_FIXED;
+        } else {
+            printf("Invalid mode. Use 'adaptive' or 'fixed'\n");
+            return 1;
+        }
+
+        // The fixed delay belongs to the emulated model's transport profile
+        if (ack_pacing_args.delay_ms->count > 0) {
+            int value = ack_pacing_args.delay_ms->ival[0];
+            if (value < 0 || value > ACK_PACER_MAX_DELAY_MS) {
+                printf("Delay must be 0-%d ms\n", ACK_PACER_MAX_DELAY_MS);
+                return 1;
+            }
+            instax_model_t model = printer_emulator_get_info()->model;
+            instax_model_info_t profile = *instax_get_model_info(model);
+            profile.ack_delay_ms = (uint16_t)value;
+            esp_err_t ret = transport_profile_set(model, &profile);
+            if (ret != ESP_OK) {
+                printf("Failed to set ACK delay: %s\n", esp_err_to_name(ret));
+                return 1;
+            }
+        }
+
+        esp_err_t ret = ack_pacer_set_mode(mode);
+        if (ret != ESP_OK) {
+            printf("Failed to set ACK pacing: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        ack_pacer_get_stats(&stats);
+    }
+
+    printf("\n");
+    printf("ACK Pacing:\n");
+    instax_model_t model = printer_emulator_get_info()->model;
+    printf("  Mode: %s (fixed delay %u ms for %s)\n", ack_pacer_mode_to_string(stats.mode),
+           instax_get_model_info(model)->ack_delay_ms, printer_emulator_model_to_string(model));
+    printf("  Last job: %lu ACKs, %lu delayed, %lu ms total (max %lu ms)\n",
+           (unsigned long)stats.acks_paced, (unsigned long)stats.acks_delayed,
+           (unsigned long)stats.total_delay_ms, (unsigned long)stats.max_delay_ms);
+    printf("  Flushes: %lu (last %lu us, avg %lu us, max %lu us)\n",
+           (unsigned long)stats.flush_count, (unsigned long)stats.flush_last_us,
+           (unsigned long)stats.flush_avg_us, (unsigned long)stats.flush_max_us);
+    printf("  Buffer: %u / %u bytes%s\n", (unsigned)stats.buffer_used, (unsigned)stats.buffer_capacity,
+           stats.drain_in_flight ? " (other buffer draining)" : "");
+    printf("  Free mbufs: %d (min %d)\n", stats.mbuf_free, stats.mbuf_free_min);
+
+    print_writer_stats_t writer;
+    print_writer_get_stats(&writer);
+    printf("  Writer: %lu bytes in %lu flushes, %lu stalls (%lu us total, max %lu us), %lu errors\n",
+           (unsigned long)writer.bytes_written, (unsigned long)writer.flushes,
+           (unsigned long)writer.stalls, (unsigned long)writer.stall_total_us,
+           (unsigned long)writer.stall_max_us, (unsigned long)writer.write_errors);
+    printf("\n");
+
+    return 0;
+}
+
+// Command: proto_task [priority]
+static struct {
+    struct arg_int *priority;
+    struct arg_end *end;
+} proto_task_args;
+
+static int cmd_proto_task(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&proto_task_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, proto_task_args.end, argv[0]);
+        return 1;
+    }
+
+    if (proto_task_args.priority->count > 0) {
+        int priority = proto_task_args.priority->ival[0];
+        esp_err_t ret = ble_peripheral_set_protocol_task_priority((uint32_t)(priority < 0 ? 0 : priority));
+        if (ret != ESP_OK) {
+            printf("Failed to set priority: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+    }
+
+    ble_protocol_task_stats_t stats;
+    ble_peripheral_get_protocol_task_stats(&stats);
+
+    printf("\n");
+    printf("Protocol Task:\n");
+    printf("  Priority: %lu\n", (unsigned long)stats.priority);
+    printf("  Stack free (min): %lu bytes\n", (unsigned long)stats.stack_free);
+    printf("  Frame ring: %lu queued, high water %lu/%d\n",
+           (unsigned long)stats.ring.depth, (unsigned long)stats.ring.high_water, FRAME_RING_SLOTS);
+    printf("  Frames: %lu processed, %lu dropped (ring full)\n",
+           (unsigned long)stats.ring.pushed, (unsigned long)stats.ring.dropped);
+    printf("  Parser: %lu bad checksum, %lu bad length, %lu resyncs (%lu bytes skipped), %lu bytes dropped\n",
+           (unsigned long)stats.rx.bad_checksum, (unsigned long)stats.rx.bad_length,
+           (unsigned long)stats.rx.resyncs, (unsigned long)stats.rx.bytes_skipped,
+           (unsigned long)stats.rx.bytes_dropped);
+    printf("  Bad checksum replies: %lu\n", (unsigned long)stats.bad_frame_replies);
+
+    notify_queue_stats_t notify;
+    notify_queue_get_stats(&notify);
+    printf("  Notify queue: %lu ACKs sent (%lu retried, %lu failed, %lu from reserve), high water %lu/%d\n",
+           (unsigned long)notify.acks_sent, (unsigned long)notify.acks_retried,
+           (unsigned long)notify.acks_failed, (unsigned long)notify.acks_from_reserve,
+           (unsigned long)notify.depth_high_water, NOTIFY_QUEUE_DEPTH);
+    printf("  Status notifications: %lu sent, %lu deferred, %lu failed; %lu reserved mbufs held\n",
+           (unsigned long)notify.status_sent, (unsigned long)notify.status_deferred,
+           (unsigned long)notify.status_failed, (unsigned long)notify.reserve_held);
+
+    ble_print_data_path_stats_t copy_stats;
+    ble_peripheral_get_print_data_path_stats(&copy_stats);
+    printf("  Last job: %lu bytes copied for %lu payload bytes (%lu zero-copy, %lu copied chunks)\n",
+           (unsigned long)copy_stats.bytes_copied, (unsigned long)copy_stats.payload_bytes,
+           (unsigned long)copy_stats.zero_copy_chunks, (unsigned long)copy_stats.copied_chunks);
+    printf("\n");
+
+    return 0;
+}
+
+// Command: opstats [reset]
+static struct {
+    struct arg_str *action;
+    struct arg_end *end;
+} opstats_args;
+
+static void format_opcode(char *buf, size_t len, uint16_t code) {
+    if (code == BLE_OPCODE_ANY) {
+        snprintf(buf, len, "*");
+    } else {
+        snprintf(buf, len, "%02x", code);
+    }
+}
+
+static int cmd_opstats(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&opstats_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, opstats_args.end, argv[0]);
+        return 1;
+    }
+
+    if (opstats_args.action->count > 0) {
+        if (strcasecmp(opstats_args.action->sval[0], "reset") != 0) {
+            printf("Unknown action. Use 'opstats' or 'opstats reset'\n");
+            return 1;
+        }
+        ble_peripheral_reset_opcode_stats();
+        printf("Opcode statistics reset\n");
+        return 0;
+    }
+
+    ble_opcode_stats_t stats[BLE_OPCODE_STATS_MAX];
+    size_t count = ble_peripheral_get_opcode_stats(stats, BLE_OPCODE_STATS_MAX);
+
+    printf("\n");
+    printf("Opcode Dispatch:\n");
+    printf("  %-4s %-4s %-18s %8s %10s %8s %8s %10s %10s\n",
+           "func", "op", "handler", "calls", "total_us", "avg_us", "max_us", "bytes_in", "bytes_out");
+    for (size_t i = 0; i < count; i++) {
+        if (stats[i].calls == 0) {
+            continue;
+        }
+        char func[4], op[4];
+        format_opcode(func, sizeof(func), stats[i].function);
+        format_opcode(op, sizeof(op), stats[i].operation);
+        printf("  %-4s %-4s %-18s %8lu %10llu %8lu %8lu %10lu %10lu\n",
+               func, op, stats[i].name, (unsigned long)stats[i].calls,
+               (unsigned long long)stats[i].total_us,
+               (unsigned long)(stats[i].total_us / stats[i].calls),
+               (unsigned long)stats[i].max_us,
+               (unsigned long)stats[i].bytes_in, (unsigned long)stats[i].bytes_out);
+    }
+
+    ble_response_cache_stats_t cache;
+    ble_peripheral_get_response_cache_stats(&cache);
+    printf("  INFO response cache: %lu hits, %lu misses\n",
+           (unsigned long)cache.hits, (unsigned long)cache.misses);
+    printf("\n");
+
+    return 0;
+}
+
+// Command: link
+static int cmd_link(int argc, char **argv) {
+    link_policy_stats_t link;
+    link_policy_get_stats(&link);
+
+    printf("\n");
+    printf("BLE Link:\n");
+    if (link.conn_handle == 0xFFFF) {  // BLE_HS_CONN_HANDLE_NONE
+        printf("  Not connected\n");
+    } else {
+        printf("  Connections: %u (newest: %u)\n", link.connections, link.conn_handle);
+        printf("  Policy:   %s (%s profile)\n", link_policy_state_to_string(link.state),
+               printer_emulator_model_to_string(link.model));
+        printf("  Interval: %u.%02u ms, latency %u, timeout %u ms\n",
+               link.conn_itvl * 125 / 100, link.conn_itvl * 125 % 100,
+               link.conn_latency, link.supervision_timeout * 10);
+        printf("  PHY:      tx %u, rx %u (1=1M, 2=2M, 3=coded)\n", link.tx_phy, link.rx_phy);
+        printf("  Data len: tx %u octets / %u us, rx %u octets\n",
+               link.max_tx_octets, link.max_tx_time, link.max_rx_octets);
+        printf("  MTU:      %u\n", link.mtu);
+    }
+    printf("  Param requests: %lu, updates: %lu, failures: %lu, central requests: %lu\n",
+           (unsigned long)link.param_requests, (unsigned long)link.param_updates,
+           (unsigned long)link.param_failures, (unsigned long)link.peer_requests);
+
+    link_policy_event_t history[LINK_POLICY_HISTORY_SIZE];
+    size_t count = link_policy_get_history(history, LINK_POLICY_HISTORY_SIZE);
+    if (count > 0) {
+        printf("  History (oldest first):\n");
+        printf("    %10s %4s %-17s %-7s %6s %6s %4s %8s %6s %4s\n",
+               "time_ms", "conn", "event", "state", "status", "itvl", "lat", "timeout", "tx_oct", "mtu");
+        for (size_t i = 0; i < count; i++) {
+            printf("    %10lu %4u %-17s %-7s %6d %6u %4u %8u %6u %4u\n",
+                   (unsigned long)history[i].timestamp_ms, history[i].conn_handle,
+                   link_policy_event_to_string(history[i].kind),
+                   link_policy_state_to_string(history[i].state),
+                   history[i].status, history[i].conn_itvl, history[i].conn_latency,
+                   history[i].supervision_timeout, history[i].max_tx_octets, history[i].mtu);
+        }
+    }
+    printf("\n");
+
+    return 0;
+}
+
+// Command: pool
+static int cmd_pool(int argc, char **argv) {
+    print_pool_stats_t stats;
+    print_pool_get_stats(&stats);
+
+    printf("\n");
+    printf("Print Buffer Pool:\n");
+    printf("  Slots: %lu / %lu in use (%u KB each, high water %lu)\n",
+           (unsigned long)stats.in_use, (unsigned long)stats.slots,
+           (unsigned)(stats.slot_size / 1024), (unsigned long)stats.high_water);
+    printf("  Acquires: %lu (%lu refused)\n",
+           (unsigned long)stats.acquires, (unsigned long)stats.acquire_failures);
+    printf("  Heap: %lu bytes free (min %lu)\n",
+           (unsigned long)stats.free_bytes, (unsigned long)stats.free_bytes_min);
+    printf("  Largest free block: %lu bytes (min %lu)\n",
+           (unsigned long)stats.largest_free_block, (unsigned long)stats.largest_free_block_min);
+
+    print_pool_heap_sample_t samples[PRINT_POOL_HEAP_HISTORY];
+    size_t count = print_pool_get_heap_history(samples, PRINT_POOL_HEAP_HISTORY);
+    if (count > 0) {
+        printf("  History (oldest first):\n");
+        for (size_t i = 0; i < count; i++) {
+            printf("    %8lu ms: %7lu free, largest block %7lu\n",
+                   (unsigned long)samples[i].timestamp_ms, (unsigned long)samples[i].free_bytes,
+                   (unsigned long)samples[i].largest_free_block);
+        }
+    }
+
+    print_cache_stats_t cache;
+    print_cache_get_stats(&cache);
+    printf("Print Cache:\n");
+    printf("  Whole-print RAM mode: %s (%s)\n", cache.whole_print ? "enabled" : "disabled",
+           cache.psram ? "PSRAM" : "internal RAM only");
+    printf("  Jobs: %lu in RAM, %lu streamed, %lu aborted, %lu save failures\n",
+           (unsigned long)cache.jobs_in_ram, (unsigned long)cache.jobs_streamed,
+           (unsigned long)cache.jobs_aborted, (unsigned long)cache.save_failures);
+    printf("  Cached: %lu / %d prints (%u bytes), %lu hits, %lu misses, %lu evictions\n",
+           (unsigned long)cache.entries, PRINT_CACHE_ENTRIES, (unsigned)cache.bytes,
+           (unsigned long)cache.hits, (unsigned long)cache.misses, (unsigned long)cache.evictions);
+    printf("\n");
+
+    return 0;
+}
+
+// Command: telemetry
+static int cmd_telemetry(int argc, char **argv) {
+    print_telemetry_session_t sessions[PRINT_TELEMETRY_HISTORY];
+    size_t count = print_telemetry_get_sessions(sessions, PRINT_TELEMETRY_HISTORY);
+
+    printf("\n");
+    printf("Print Sessions (oldest first):\n");
+    if (count == 0) {
+        printf("  None recorded since boot\n\n");
+        return 0;
+    }
+
+    printf("  %4s %-12s %8s %6s %9s %4s %9s %9s %9s %6s\n",
+           "id", "end", "bytes", "chunks", "B/s", "mtu", "gap_avg", "gap_max", "ack_avg", "retry");
+    for (size_t i = 0; i < count; i++) {
+        const print_telemetry_session_t *ps = &sessions[i];
+        printf("  %4lu %-12s %8lu %6lu %9lu %4u %7lu us %7lu us %7lu us %6lu\n",
+               (unsigned long)ps->id, print_telemetry_end_reason_to_string(ps->end_reason),
+               (unsigned long)ps->bytes_received, (unsigned long)ps->chunks,
+               (unsigned long)ps->bytes_per_sec, ps->mtu,
+               (unsigned long)ps->gap_avg_us, (unsigned long)ps->gap_max_us,
+               (unsigned long)ps->ack_latency_avg_us, (unsigned long)ps->ack_retries);
+        if (ps->image_checked) {
+            printf("       %s: JPEG %s, %ux%u, %u components, CRC32 %08lx\n",
+                   ps->file, jpeg_scan_status_to_string(ps->image.status),
+                   ps->image.width, ps->image.height, ps->image.components,
+                   (unsigned long)ps->image.crc32);
+        }
+    }
+
+    print_resume_stats_t resume;
+    print_resume_get_stats(&resume);
+    printf("  Resume (window %d s): %lu kept, %lu resumed, %lu missed, %lu replaced, %lu expired, "
+           "%lu chunks / %lu bytes not resent to flash\n",
+           PRINT_RESUME_WINDOW_S, (unsigned long)resume.parked, (unsigned long)resume.hits,
+           (unsigned long)resume.misses, (unsigned long)resume.replaced, (unsigned long)resume.expired,
+           (unsigned long)resume.chunks_skipped, (unsigned long)resume.bytes_skipped);
+    if (resume.holding) {
+        printf("  Holding a dropped job: %lu bytes, %lu s old\n",
+               (unsigned long)resume.held_bytes, (unsigned long)resume.held_age_s);
+    }
+
+    // Histograms of the newest session
+    const print_telemetry_session_t *last = &sessions[count - 1];
+    printf("  Session #%lu histograms (bucket upper bound -> chunk gaps / ACK latencies):\n",
+           (unsigned long)last->id);
+    for (int b = 0; b < PRINT_TELEMETRY_BUCKETS; b++) {
+        if (b < PRINT_TELEMETRY_BUCKETS - 1) {
+            printf("    < %6lu us: %6lu / %6lu\n", (unsigned long)print_telemetry_bucket_limits_us[b],
+                   (unsigned long)last->gap_hist[b], (unsigned long)last->ack_hist[b]);
+        } else {
+            printf("    >= %5lu us: %6lu / %6lu\n", (unsigned long)print_telemetry_bucket_limits_us[b - 1],
+                   (unsigned long)last->gap_hist[b], (unsigned long)last->ack_hist[b]);
+        }
+    }
+    printf("\n");
+
+    return 0;
+}
+
+// Command: journal [status]
+static struct {
+    struct arg_str *status;
+    struct arg_end *end;
+} journal_args;
+
+static int cmd_journal(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&journal_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, journal_args.end, argv[0]);
+        return 1;
+    }
+
+    print_journal_filter_t filter = {0};
+    if (journal_args.status->count > 0) {
+        if (!print_telemetry_end_reason_from_string(journal_args.status->sval[0], &filter.status)) {
+            printf("Unknown status '%s' (completed, rejected, disconnected, restarted)\n",
+                   journal_args.status->sval[0]);
+            return 1;
+        }
+        filter.by_status = true;
+    }
+
+    // Newest 20 matches
+    print_journal_record_t records[20];
+    size_t count = print_journal_query(&filter, records, sizeof(records) / sizeof(records[0]));
+
+    print_journal_stats_t stats;
+    print_journal_get_stats(&stats);
+
+    printf("\n");
+    printf("Print Journal (%lu records indexed, %u in file, %lu pending, %lu repaired, %lu compactions):\n",
+           (unsigned long)stats.records, (unsigned)stats.file_records, (unsigned long)stats.pending,
+           (unsigned long)stats.repaired, (unsigned long)stats.compactions);
+    if (count == 0) {
+        printf("  No matching jobs\n\n");
+        return 0;
+    }
+    printf("  %5s %-10s %-6s %-12s %7s %6s %7s %8s %8s  %s\n",
+           "seq", "time", "model", "status", "bytes", "chunks", "ms", "B/s", "crc32", "file");
+    for (size_t i = 0; i < count; i++) {
+        const print_journal_record_t *rec = &records[i];
+        char file[32] = "-";
+        if (rec->file_id != 0) {
+            snprintf(file, sizeof(file), "print_%lu.jpg (%s)", (unsigned long)rec->file_id,
+                     jpeg_scan_status_to_string((jpeg_scan_status_t)rec->jpeg_status));
+        }
+        printf("  %5lu %10lu %-6s %-12s %7lu %6lu %7lu %8lu %08lx  %s\n",
+               (unsigned long)rec->seq, (unsigned long)rec->timestamp,
+               printer_emulator_model_to_string((instax_model_t)rec->model),
+               print_telemetry_end_reason_to_string((print_end_reason_t)rec->status),
+               (unsigned long)rec->bytes, (unsigned long)rec->chunks,
+               (unsigned long)rec->duration_ms, (unsigned long)rec->bytes_per_sec,
+               (unsigned long)rec->crc32, file);
+    }
+    printf("\n");
+
+    return 0;
+}
+
+// Command: retention [count|age|bytes <value>]
+static struct {
+    struct arg_str *rule;
+    struct arg_int *value;
+    struct arg_end *end;
+} retention_args;
+
+static int cmd_retention(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&retention_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, retention_args.end, argv[0]);
+        return 1;
+    }
+
+    retention_stats_t stats;
+    retention_get_stats(&stats);
+
+    if (retention_args.rule->count > 0) {
+        if (retention_args.value->count == 0 || retention_args.value->ival[0] < 0) {
+            printf("Usage: retention <count|age|bytes> <value> (0 = no limit, age in hours)\n");
+            return 1;
+        }
+        const char *rule = retention_args.rule->sval[0];
+        uint32_t value = (uint32_t)retention_args.value->ival[0];
+        retention_policy_t policy = stats.policy;
+
+        if (strcasecmp(rule, "count") == 0) {
+            policy.max_count = value;
+        } else if (strcasecmp(rule, "age") == 0) {
+            policy.max_age_s = value * 3600;
+        } else if (strcasecmp(rule, "bytes") == 0) {
+            policy.max_bytes = value;
+        } else {
+            printf("Invalid rule. Use 'count', 'age' or 'bytes'\n");
+            return 1;
+        }
+
+        esp_err_t ret = retention_set_policy(&policy);
+        if (ret != ESP_OK) {
+            printf("Failed to set retention: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        retention_get_stats(&stats);
+    }
+
+    printf("\n");
+    printf("Retention:\n");
+    printf("  Keep free: %u bytes (largest job + slack)\n", (unsigned)stats.reserve_bytes);
+    printf("  Limits: max %lu prints, max age %lu h, max %lu bytes (0 = no limit)\n",
+           (unsigned long)stats.policy.max_count, (unsigned long)(stats.policy.max_age_s / 3600),
+           (unsigned long)stats.policy.max_bytes);
+    printf("  Last pass: %lu prints, %lu bytes, %u bytes free\n",
+           (unsigned long)stats.print_files, (unsigned long)stats.print_bytes, (unsigned)stats.free_bytes);
+    printf("  Passes: %lu (%lu cut short by a job)\n",
+           (unsigned long)stats.passes, (unsigned long)stats.interrupted);
+    printf("  Evicted: %lu prints, %lu bytes (", (unsigned long)stats.evicted, (unsigned long)stats.evicted_bytes);
+    for (int i = 0; i < RETENTION_RULE_MAX; i++) {
+        printf("%s%s %lu", i > 0 ? ", " : "", retention_rule_to_string((retention_rule_t)i),
+               (unsigned long)stats.evicted_by_rule[i]);
+    }
+    printf("), %lu failures\n", (unsigned long)stats.failures);
+    if (stats.last_evicted[0] != '\0') {
+        printf("  Last evicted: %s\n", stats.last_evicted);
+    }
+    printf("\n");
+
+    return 0;
+}
+
+// Command: storage_bench [<fill %> ...]
+static struct {
+    struct arg_int *levels;
+    struct arg_end *end;
+} storage_bench_args;
+
+static int cmd_storage_bench(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&storage_bench_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, storage_bench_args.end, argv[0]);
+        return 1;
+    }
+
+    uint8_t levels[STORAGE_BENCH_MAX_LEVELS] = {0, 25, 50, 75};
+    size_t count = 4;
+    if (storage_bench_args.levels->count > 0) {
+        count = storage_bench_args.levels->count;
+        for (size_t i = 0; i < count; i++) {
+            int level = storage_bench_args.levels->ival[i];
+            if (level < 0 || level > 95 || (i > 0 && level <= levels[i - 1])) {
+                printf("Fill levels must be ascending, 0-95%%\n");
+                return 1;
+            }
+            levels[i] = (uint8_t)level;
+        }
+    }
+
+    printf("Benchmarking %s, this takes a while...\n", spiffs_manager_get_backend()->name);
+    storage_bench_result_t results[STORAGE_BENCH_MAX_LEVELS];
+    size_t measured = 0;
+    esp_err_t ret = storage_bench_run(levels, count, results, &measured);
+    if (ret == ESP_ERR_INVALID_STATE) {
+        printf("A print job is in progress, try again when it is done\n");
+        return 1;
+    }
+
+    printf("\n");
+    printf("Storage benchmark (%s, %u KB file in %u byte writes):\n", spiffs_manager_get_backend()->name,
+           (unsigned)(STORAGE_BENCH_FILE_SIZE / 1024), (unsigned)STORAGE_BENCH_IO_SIZE);
+    printf("  %6s %10s %10s %9s %9s %6s %9s\n", "fill", "write B/s", "read B/s", "write ms", "read ms", "files", "list ms");
+    for (size_t i = 0; i < measured; i++) {
+        const storage_bench_result_t *r = &results[i];
+        printf("  %5u%% %10lu %10lu %9lu %9lu %6lu %9lu.%03lu\n", r->fill_pct,
+               (unsigned long)r->write_bytes_per_sec, (unsigned long)r->read_bytes_per_sec,
+               (unsigned long)(r->write_us / 1000), (unsigned long)(r->read_us / 1000),
+               (unsigned long)r->files, (unsigned long)(r->list_us / 1000), (unsigned long)(r->list_us % 1000));
+    }
+    if (measured < count) {
+        printf("  %u level(s) skipped: %s\n", (unsigned)(count - measured),
+               ret == ESP_OK ? "not enough free space above the retention reserve" : esp_err_to_name(ret));
+    }
+    printf("\n");
+
+    return ret == ESP_OK ? 0 : 1;
+}
+
+// Command: trace [clear | level [<subsystem> <off|frames|verbose>]]
+static struct {
+    struct arg_str *action;
+    struct arg_str *subsys;
+    struct arg_str *level;
+    struct arg_end *end;
+} trace_args;
+
+static void print_trace_levels(void) {
+    printf("Trace levels:");
+    for (int i = 0; i < EVENT_TRACE_SUBSYS_COUNT; i++) {
+        printf(" %s=%s", event_trace_subsys_to_string(i),
+               event_trace_level_to_string(event_trace_levels[i]));
+    }
+    printf("\n");
+}
+
+static int cmd_trace(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&trace_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, trace_args.end, argv[0]);
+        return 1;
+    }
+
+    if (trace_args.action->count > 0) {
+        const char *action = trace_args.action->sval[0];
+        if (strcasecmp(action, "clear") == 0) {
+            event_trace_clear();
+            printf("Trace cleared\n");
+            return 0;
+        }
+        if (strcasecmp(action, "level") != 0) {
+            printf("Unknown action. Use 'trace', 'trace clear' or 'trace level <rx|tx|proto> <off|frames|verbose>'\n");
+            return 1;
+        }
+        if (trace_args.subsys->count == 0) {
+            print_trace_levels();
+            return 0;
+        }
+
+        event_trace_subsys_t subsys;
+        event_trace_level_t level;
+        if (!event_trace_subsys_from_string(trace_args.subsys->sval[0], &subsys)) {
+            printf("Unknown subsystem '%s' (rx, tx, proto)\n", trace_args.subsys->sval[0]);
+            return 1;
+        }
+        if (trace_args.level->count == 0 ||
+            !event_trace_level_from_string(trace_args.level->sval[0], &level)) {
+            printf("Level must be off, frames or verbose\n");
+            return 1;
+        }
+        event_trace_set_level(subsys, level);
+        print_trace_levels();
+        return 0;
+    }
+
+    // Decode the ring (records written meanwhile are picked up by the next read)
+    event_trace_record_t records[16];
+    char line[128];
+    uint32_t cursor = 0;
+    size_t total = 0;
+    size_t count;
+
+    printf("\n");
+    while ((count = event_trace_read(&cursor, records, sizeof(records) / sizeof(records[0]))) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            event_trace_format(&records[i], line, sizeof(line));
+            printf("  %s\n", line);
+        }
+        total += count;
+    }
+    printf("%u event(s). ", (unsigned)total);
+    print_trace_levels();
+    printf("\n");
+
+    return 0;
+}
+
 // Command: reboot
 static int cmd_reboot(int argc, char **argv) {
     printf("Rebooting...\n");
@@ -573,9 +1305,20 @@ void console_print_help(void) {
     printf("BLE Commands:\n");
     printf("  ble_start                   - Start advertising as Instax printer\n");
     printf("  ble_stop                    - Stop BLE advertising\n");
+    printf("  ack_pacing [adaptive|fixed] [ms] - Show or set PRINT_DATA ACK pacing\n");
+    printf("  transport [model field value] - Show or tune per-model MTU, chunk size and delays\n");
+    printf("  proto_task [priority]       - Show protocol task stats or set its priority\n");
+    printf("  opstats [reset]             - Show or reset per-opcode handler statistics\n");
+    printf("  link                        - Show negotiated BLE link parameters and history\n");
+    printf("  telemetry                   - Show throughput telemetry of recent print sessions\n");
+    printf("  journal [status]            - Show recent print jobs from the journal\n");
+    printf("  pool                        - Show print buffer pool, heap fragmentation and print cache\n");
+    printf("  trace [clear]               - Decode the binary frame trace, or clear it\n");
+    printf("  trace level [<sub> <level>] - Show or set trace verbosity (rx|tx|proto, off|frames|verbose)\n");
     printf("\n");
     printf("Storage Commands:\n");
     printf("  files                       - List received print files\n");
+    printf("  retention [rule value]      - Show or set print retention (count|age|bytes, 0 = off)\n");
     printf("\n");
     printf("System Commands:\n");
     printf("  help                        - Show this help\n");
@@ -738,6 +1481,114 @@ static void register_commands(void) {
     };
     ESP_ERROR_CHECK(esp_console_cmd_register(&accel_orientation_cmd));
 
+    // ack_pacing command
+    ack_pacing_args.mode = arg_str0(NULL, NULL, "<adaptive|fixed>", "Pacing mode");
+    ack_pacing_args.delay_ms = arg_int0(NULL, NULL, "<ms>", "Delay for fixed mode");
+    ack_pacing_args.end = arg_end(2);
+
+    const esp_console_cmd_t ack_pacing_cmd = {
+        .command = "ack_pacing",
+        .help = "Show or set PRINT_DATA ACK pacing",
+        .hint = NULL,
+        .func = &cmd_ack_pacing,
+        .argtable = &ack_pacing_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&ack_pacing_cmd));
+
+    // transport command
+    transport_args.model = arg_str0(NULL, NULL, "<mini|square|wide>", "Model to change");
+    transport_args.field = arg_str0(NULL, NULL, "<field|reset>", "mtu, chunk, ack, gap, start, end, execute, or reset");
+    transport_args.value = arg_int0(NULL, NULL, "<value>", "New value (bytes or ms)");
+    transport_args.end = arg_end(3);
+
+    const esp_console_cmd_t transport_cmd = {
+        .command = "transport",
+        .help = "Show or tune per-model transport profiles",
+        .hint = NULL,
+        .func = &cmd_transport,
+        .argtable = &transport_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&transport_cmd));
+
+    // proto_task command
+    proto_task_args.priority = arg_int0(NULL, NULL, "<priority>", "Protocol task priority");
+    proto_task_args.end = arg_end(1);
+
+    const esp_console_cmd_t proto_task_cmd = {
+        .command = "proto_task",
+        .help = "Show protocol task stats or set its priority",
+        .hint = NULL,
+        .func = &cmd_proto_task,
+        .argtable = &proto_task_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&proto_task_cmd));
+
+    // opstats command
+    opstats_args.action = arg_str0(NULL, NULL, "<reset>", "Reset all counters");
+    opstats_args.end = arg_end(1);
+
+    const esp_console_cmd_t opstats_cmd = {
+        .command = "opstats",
+        .help = "Show or reset per-opcode handler statistics",
+        .hint = NULL,
+        .func = &cmd_opstats,
+        .argtable = &opstats_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&opstats_cmd));
+
+    // trace command
+    trace_args.action = arg_str0(NULL, NULL, "<clear|level>", "Clear the trace or show/set verbosity");
+    trace_args.subsys = arg_str0(NULL, NULL, "<subsystem>", "rx, tx or proto");
+    trace_args.level = arg_str0(NULL, NULL, "<level>", "off, frames or verbose");
+    trace_args.end = arg_end(3);
+
+    journal_args.status = arg_str0(NULL, NULL, "<status>", "completed, rejected, disconnected or restarted");
+    journal_args.end = arg_end(1);
+
+    const esp_console_cmd_t journal_cmd = {
+        .command = "journal",
+        .help = "Show the newest print jobs from the journal, optionally by status",
+        .hint = NULL,
+        .func = &cmd_journal,
+        .argtable = &journal_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&journal_cmd));
+
+    retention_args.rule = arg_str0(NULL, NULL, "<count|age|bytes>", "Limit to change");
+    retention_args.value = arg_int0(NULL, NULL, "<value>", "Prints, hours or bytes (0 = no limit)");
+    retention_args.end = arg_end(2);
+
+    const esp_console_cmd_t retention_cmd = {
+        .command = "retention",
+        .help = "Show eviction statistics or set a retention limit",
+        .hint = NULL,
+        .func = &cmd_retention,
+        .argtable = &retention_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&retention_cmd));
+
+    storage_bench_args.levels = arg_intn(NULL, NULL, "<fill %>", 0, STORAGE_BENCH_MAX_LEVELS,
+                                         "Fill levels to measure at (default 0 25 50 75)");
+    storage_bench_args.end = arg_end(2);
+
+    const esp_console_cmd_t storage_bench_cmd = {
+        .command = "storage_bench",
+        .help = "Measure write, read and listing speed of the storage backend as the partition fills",
+        .hint = NULL,
+        .func = &cmd_storage_bench,
+        .argtable = &storage_bench_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&storage_bench_cmd));
+
+    const esp_console_cmd_t trace_cmd = {
+        .command = "trace",
+        .help = "Decode the binary frame trace, clear it, or set per-subsystem verbosity",
+        .hint = NULL,
+        .func = &cmd_trace,
+        .argtable = &trace_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&trace_cmd));
+
     // Simple commands without arguments
     const esp_console_cmd_t cmds[] = {
         { .command = "printer_status", .help = "Show printer status", .func = &cmd_printer_status },
@@ -748,6 +1599,9 @@ static void register_commands(void) {
         { .command = "wifi_clear", .help = "Clear WiFi credentials", .func = &cmd_wifi_clear },
         { .command = "ble_start", .help = "Start BLE advertising", .func = &cmd_ble_start },
         { .command = "ble_stop", .help = "Stop BLE advertising", .func = &cmd_ble_stop },
+        { .command = "link", .help = "Show BLE link parameters", .func = &cmd_link },
+        { .command = "telemetry", .help = "Show print session telemetry", .func = &cmd_telemetry },
+        { .command = "pool", .help = "Show print buffer pool and heap", .func = &cmd_pool },
         { .command = "files", .help = "List stored files", .func = &cmd_files },
         { .command = "reboot", .help = "Reboot device", .func = &cmd_reboot },
         { .command = "help", .help = "Show help", .func = &cmd_help },
@@ -0,0 +1,201 @@
+/**
+ * @file event_trace.c
+ * @brief Binary event tracer for the BLE / protocol hot paths
+ */
+
+#include "event_trace.h"
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "event_trace";
+
+_Static_assert((EVENT_TRACE_RING_SIZE & (EVENT_TRACE_RING_SIZE - 1)) == 0, "EVENT_TRACE_RING_SIZE must be a power of two");
+
+#define RECORD_INDEX(seq) ((seq) & (EVENT_TRACE_RING_SIZE - 1))
+
+uint8_t event_trace_levels[EVENT_TRACE_SUBSYS_COUNT];
+
+static event_trace_record_t s_ring[EVENT_TRACE_RING_SIZE];
+static uint32_t s_next_seq = 0;     // Next sequence number to hand out (atomic)
+static uint32_t s_clear_seq = 0;    // Records before this were cleared
+
+static const char *s_event_names[EVENT_TRACE_EVENT_COUNT] = {
+    [EVENT_TRACE_RX_FRAME] = "RX_FRAME",
+    [EVENT_TRACE_TX_NOTIFY] = "TX_NOTIFY",
+    [EVENT_TRACE_TX_INDICATE] = "TX_INDICATE",
+    [EVENT_TRACE_TX_STATUS] = "TX_STATUS",
+    [EVENT_TRACE_DISPATCH] = "DISPATCH",
+    [EVENT_TRACE_PARSE_FAIL] = "PARSE_FAIL",
+    [EVENT_TRACE_CHECKSUM_FAIL] = "CHECKSUM",
+};
+
+static const char *s_subsys_names[EVENT_TRACE_SUBSYS_COUNT] = {
+    [EVENT_TRACE_SUBSYS_RX] = "rx",
+    [EVENT_TRACE_SUBSYS_TX] = "tx",
+    [EVENT_TRACE_SUBSYS_PROTO] = "proto",
+};
+
+static const char *s_level_names[] = {
+    [EVENT_TRACE_LEVEL_OFF] = "off",
+    [EVENT_TRACE_LEVEL_FRAMES] = "frames",
+    [EVENT_TRACE_LEVEL_VERBOSE] = "verbose",
+};
+
+/**
+ * Claim the next ring entry; its seq stays 0 until publish()
+ */
+static event_trace_record_t *claim(event_trace_event_t event, uint16_t arg, uint32_t *seq) {
+    *seq = __atomic_fetch_add(&s_next_seq, 1, __ATOMIC_RELAXED);
+    event_trace_record_t *record = &s_ring[RECORD_INDEX(*seq)];
+    __atomic_store_n(&record->seq, 0, __ATOMIC_RELAXED);
+    record->timestamp_us = (uint32_t)esp_timer_get_time();
+    record->event = (uint8_t)event;
+    record->arg = arg;
+    return record;
+}
+
+static void publish(event_trace_record_t *record, uint32_t seq) {
+    __atomic_store_n(&record->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+esp_err_t event_trace_init(void) {
+    memset(s_ring, 0, sizeof(s_ring));
+    s_next_seq = 0;
+    s_clear_seq = 0;
+    for (int i = 0; i < EVENT_TRACE_SUBSYS_COUNT; i++) {
+        event_trace_levels[i] = EVENT_TRACE_LEVEL_FRAMES;
+    }
+
+    ESP_LOGI(TAG, "Event trace ready (%d records, %u bytes)",
+             EVENT_TRACE_RING_SIZE, (unsigned)sizeof(s_ring));
+    return ESP_OK;
+}
+
+void event_trace_data(event_trace_event_t event, uint16_t arg, const uint8_t *data, size_t len) {
+    uint32_t seq;
+    event_trace_record_t *record = claim(event, arg, &seq);
+    size_t copy = len < EVENT_TRACE_DATA_LEN ? len : EVENT_TRACE_DATA_LEN;
+    memcpy(record->data, data, copy);
+    record->len = len > UINT8_MAX ? UINT8_MAX : (uint8_t)len;
+    publish(record, seq);
+}
+
+void event_trace_values(event_trace_event_t event, uint16_t arg, uint32_t v0, uint32_t v1, uint32_t v2) {
+    uint32_t seq;
+    event_trace_record_t *record = claim(event, arg, &seq);
+    record->values[0] = v0;
+    record->values[1] = v1;
+    record->values[2] = v2;
+    record->len = 0;
+    publish(record, seq);
+}
+
+esp_err_t event_trace_set_level(event_trace_subsys_t subsys, event_trace_level_t level) {
+    if (subsys >= EVENT_TRACE_SUBSYS_COUNT || level > EVENT_TRACE_LEVEL_VERBOSE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    event_trace_levels[subsys] = (uint8_t)level;
+    ESP_LOGI(TAG, "Trace level for %s: %s", s_subsys_names[subsys], s_level_names[level]);
+    return ESP_OK;
+}
+
+void event_trace_clear(void) {
+    __atomic_store_n(&s_clear_seq, __atomic_load_n(&s_next_seq, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
+
+size_t event_trace_read(uint32_t *cursor, event_trace_record_t *records, size_t max_records) {
+    uint32_t next = __atomic_load_n(&s_next_seq, __ATOMIC_ACQUIRE);
+    uint32_t oldest = next > EVENT_TRACE_RING_SIZE ? next - EVENT_TRACE_RING_SIZE : 0;
+    uint32_t cleared = __atomic_load_n(&s_clear_seq, __ATOMIC_ACQUIRE);
+    if (oldest < cleared) {
+        oldest = cleared;
+    }
+
+    uint32_t seq = *cursor;
+    if (seq < oldest || seq > next) {
+        seq = oldest;
+    }
+
+    size_t count = 0;
+    for (; seq != next && count < max_records; seq++) {
+        event_trace_record_t *record = &s_ring[RECORD_INDEX(seq)];
+        if (__atomic_load_n(&record->seq, __ATOMIC_ACQUIRE) != seq + 1) {
+            continue;  // Still being written, or already overwritten
+        }
+        memcpy(&records[count], record, sizeof(*record));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&record->seq, __ATOMIC_RELAXED) != seq + 1) {
+            continue;  // Overwritten while copying
+        }
+        count++;
+    }
+
+    *cursor = seq;
+    return count;
+}
+
+int event_trace_format(const event_trace_record_t *record, char *buf, size_t buf_size) {
+    const char *name = record->event < EVENT_TRACE_EVENT_COUNT ? s_event_names[record->event] : "UNKNOWN";
+    int n = snprintf(buf, buf_size, "%5lu.%06lu #%-6lu %-11s ",
+                     (unsigned long)(record->timestamp_us / 1000000),
+                     (unsigned long)(record->timestamp_us % 1000000),
+                     (unsigned long)(record->seq - 1), name);
+
+    switch (record->event) {
+        case EVENT_TRACE_DISPATCH:
+            n += snprintf(buf + n, n < buf_size ? buf_size - n : 0,
+                          "session=%u func=0x%02lX op=0x%02lX payload=%lu",
+                          record->arg, (unsigned long)record->values[0],
+                          (unsigned long)record->values[1], (unsigned long)record->values[2]);
+            break;
+
+        default: {
+            const char *arg_name = (record->event == EVENT_TRACE_RX_FRAME) ? "conn" :
+                                   (record->event == EVENT_TRACE_PARSE_FAIL ||
+                                    record->event == EVENT_TRACE_CHECKSUM_FAIL) ? "session" : "handle";
+            n += snprintf(buf + n, n < buf_size ? buf_size - n : 0, "%s=%u len=%u:",
+                          arg_name, record->arg, record->len);
+            size_t shown = record->len < EVENT_TRACE_DATA_LEN ? record->len : EVENT_TRACE_DATA_LEN;
+            for (size_t i = 0; i < shown && n < (int)buf_size; i++) {
+                n += snprintf(buf + n, buf_size - n, " %02X", record->data[i]);
+            }
+            if (record->len > EVENT_TRACE_DATA_LEN && n < (int)buf_size) {
+                n += snprintf(buf + n, buf_size - n, " ...");
+            }
+            break;
+        }
+    }
+
+    return n < (int)buf_size ? n : (int)buf_size - 1;
+}
+
+const char *event_trace_subsys_to_string(event_trace_subsys_t subsys) {
+    return subsys < EVENT_TRACE_SUBSYS_COUNT ? s_subsys_names[subsys] : "unknown";
+}
+
+const char *event_trace_level_to_string(event_trace_level_t level) {
+    return level <= EVENT_TRACE_LEVEL_VERBOSE ? s_level_names[level] : "unknown";
+}
+
+bool event_trace_subsys_from_string(const char *name, event_trace_subsys_t *subsys) {
+    for (int i = 0; i < EVENT_TRACE_SUBSYS_COUNT; i++) {
+        if (strcasecmp(name, s_subsys_names[i]) == 0) {
+            *subsys = (event_trace_subsys_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool event_trace_level_from_string(const char *name, event_trace_level_t *level) {
+    for (int i = 0; i <= EVENT_TRACE_LEVEL_VERBOSE; i++) {
+        if (strcasecmp(name, s_level_names[i]) == 0) {
+            *level = (event_trace_level_t)i;
+            return true;
+        }
+    }
+    return false;
+}
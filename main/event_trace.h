@@ -0,0 +1,130 @@
+/**
+ * @file event_trace.h
+ * @brief Binary event tracer for the BLE / protocol hot paths
+ *
+ * Formatting hex dumps with ESP_LOGI on every frame costs CPU time and UART
+ * bandwidth exactly when the link is busiest. Instead, the hot paths store a
+ * fixed-size record (timestamp, event id, a small argument and up to 16 frame
+ * bytes or three integers) into a RAM ring; nothing is formatted until the
+ * ring is read by the `trace` console command or streamed by /api/trace.
+ *
+ * Recording is lock-free and safe from any task. Each subsystem has its own
+ * runtime verbosity:
+ *   - OFF:     nothing recorded
+ *   - FRAMES:  command frames, responses and status notifications
+ *   - VERBOSE: also every PRINT_DATA chunk and ACK (fills the ring quickly)
+ */
+
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Records kept in RAM (power of two)
+#define EVENT_TRACE_RING_SIZE       256
+
+// Frame bytes captured per record
+#define EVENT_TRACE_DATA_LEN        16
+
+typedef enum {
+    EVENT_TRACE_SUBSYS_RX = 0,      // GATT writes / frame reassembly (host task)
+    EVENT_TRACE_SUBSYS_TX,          // Notifications / indications queued
+    EVENT_TRACE_SUBSYS_PROTO,       // Protocol task dispatch
+    EVENT_TRACE_SUBSYS_COUNT
+} event_trace_subsys_t;
+
+typedef enum {
+    EVENT_TRACE_LEVEL_OFF = 0,
+    EVENT_TRACE_LEVEL_FRAMES = 1,
+    EVENT_TRACE_LEVEL_VERBOSE = 2,
+} event_trace_level_t;
+
+typedef enum {
+    EVENT_TRACE_RX_FRAME = 0,       // arg = conn handle, data = first bytes, len = frame length
+                                    // (header bytes seen for a zero-copy PRINT_DATA frame)
+    EVENT_TRACE_TX_NOTIFY,          // arg = attribute handle, data = first bytes, len = length
+    EVENT_TRACE_TX_INDICATE,        // arg = attribute handle, data = first bytes, len = length
+    EVENT_TRACE_TX_STATUS,          // arg = attribute handle, data = first bytes, len = length
+    EVENT_TRACE_DISPATCH,           // arg = session, values = function, operation, payload length
+    EVENT_TRACE_PARSE_FAIL,         // arg = session, data = first bytes, len = frame length
+    EVENT_TRACE_CHECKSUM_FAIL,      // arg = session, data = first bytes, len = bytes in the frame slot
+    EVENT_TRACE_EVENT_COUNT
+} event_trace_event_t;
+
+// One ring entry (28 bytes)
+typedef struct {
+    uint32_t seq;                   // Sequence number + 1 (0 while being written)
+    uint32_t timestamp_us;          // Low 32 bits of esp_timer_get_time()
+    uint8_t event;                  // event_trace_event_t
+    uint8_t len;                    // Length of the traced bytes (capped at 255), 0 for value events
+    uint16_t arg;
+    union {
+        uint8_t data[EVENT_TRACE_DATA_LEN];
+        uint32_t values[EVENT_TRACE_DATA_LEN / 4];
+    };
+} event_trace_record_t;
+
+// Per-subsystem verbosity, read inline by the hot paths
+extern uint8_t event_trace_levels[EVENT_TRACE_SUBSYS_COUNT];
+
+/**
+ * Whether events of this level are recorded for a subsystem
+ */
+static inline bool event_trace_enabled(event_trace_subsys_t subsys, event_trace_level_t level) {
+    return event_trace_levels[subsys] >= level;
+}
+
+/**
+ * Initialize the tracer (all subsystems at EVENT_TRACE_LEVEL_FRAMES)
+ */
+esp_err_t event_trace_init(void);
+
+/**
+ * Record an event carrying the first EVENT_TRACE_DATA_LEN bytes of a frame
+ */
+void event_trace_data(event_trace_event_t event, uint16_t arg, const uint8_t *data, size_t len);
+
+/**
+ * Record an event carrying up to three integer values
+ */
+void event_trace_values(event_trace_event_t event, uint16_t arg, uint32_t v0, uint32_t v1, uint32_t v2);
+
+/**
+ * Set the verbosity of a subsystem
+ */
+esp_err_t event_trace_set_level(event_trace_subsys_t subsys, event_trace_level_t level);
+
+/**
+ * Drop all recorded events
+ */
+void event_trace_clear(void);
+
+/**
+ * Copy recorded events, oldest first
+ * Records overwritten while being copied are skipped.
+ * @param cursor In: first sequence number wanted (0 = oldest available),
+ *               out: sequence number to pass on the next call
+ * @param records Output array
+ * @param max_records Capacity of records
+ * @return Number of records written
+ */
+size_t event_trace_read(uint32_t *cursor, event_trace_record_t *records, size_t max_records);
+
+/**
+ * Decode a record into one line of text (no trailing newline)
+ * @return Characters written (excluding the terminator)
+ */
+int event_trace_format(const event_trace_record_t *record, char *buf, size_t buf_size);
+
+/**
+ * Get display name for a subsystem / level, or parse one
+ */
+const char *event_trace_subsys_to_string(event_trace_subsys_t subsys);
+const char *event_trace_level_to_string(event_trace_level_t level);
+bool event_trace_subsys_from_string(const char *name, event_trace_subsys_t *subsys);
+bool event_trace_level_from_string(const char *name, event_trace_level_t *level);
+
+#endif // EVENT_TRACE_H
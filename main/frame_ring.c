@@ -0,0 +1,84 @@
+/**
+ * @file frame_ring.c
+ * @brief Single-producer/single-consumer ring of reassembled Instax frames
+ */
+
+#include "frame_ring.h"
+
+_Static_assert((FRAME_RING_SLOTS & (FRAME_RING_SLOTS - 1)) == 0, "FRAME_RING_SLOTS must be a power of two");
+_Static_assert(FRAME_RING_SLOTS <= 256, "Slot indices are stored as uint8_t");
+
+#define SLOT_INDEX(n) ((n) & (FRAME_RING_SLOTS - 1))
+
+void frame_ring_init(frame_ring_t *ring) {
+    for (uint32_t i = 0; i < FRAME_RING_SLOTS; i++) {
+        ring->free[i] = (uint8_t)i;
+    }
+    ring->head = 0;
+    ring->tail = 0;
+    ring->free_head = FRAME_RING_SLOTS;
+    ring->free_tail = 0;
+    ring->pushed = 0;
+    ring->dropped = 0;
+    ring->high_water = 0;
+}
+
+frame_ring_slot_t *frame_ring_acquire(frame_ring_t *ring) {
+    uint32_t free_tail = ring->free_tail;
+    uint32_t free_head = __atomic_load_n(&ring->free_head, __ATOMIC_ACQUIRE);
+
+    if (free_tail == free_head) {
+        ring->dropped++;
+        return NULL;
+    }
+    frame_ring_slot_t *slot = &ring->slots[ring->free[SLOT_INDEX(free_tail)]];
+    ring->free_tail = free_tail + 1;
+    return slot;
+}
+
+void frame_ring_commit(frame_ring_t *ring, frame_ring_slot_t *slot) {
+    // Never more slots in use than queue entries, so the entry is always free
+    uint32_t head = ring->head;
+    ring->queue[SLOT_INDEX(head)] = (uint8_t)(slot - ring->slots);
+    ring->pushed++;
+
+    // Release ordering makes the slot contents visible before the new head
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+    uint32_t depth = head + 1 - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if (depth > ring->high_water) {
+        ring->high_water = depth;
+    }
+}
+
+frame_ring_slot_t *frame_ring_peek(frame_ring_t *ring) {
+    uint32_t tail = ring->tail;
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    if (head == tail) {
+        return NULL;
+    }
+    return &ring->slots[ring->queue[SLOT_INDEX(tail)]];
+}
+
+void frame_ring_release(frame_ring_t *ring) {
+    uint32_t tail = ring->tail;
+    uint32_t free_head = ring->free_head;
+    ring->free[SLOT_INDEX(free_head)] = ring->queue[SLOT_INDEX(tail)];
+    __atomic_store_n(&ring->free_head, free_head + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+void frame_ring_get_stats(const frame_ring_t *ring, frame_ring_stats_t *stats) {
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    uint32_t free_slots = __atomic_load_n(&ring->free_head, __ATOMIC_ACQUIRE) -
+                          __atomic_load_n(&ring->free_tail, __ATOMIC_ACQUIRE);
+    uint32_t in_use = FRAME_RING_SLOTS - free_slots;
+
+    stats->depth = head - tail;
+    stats->reserved = in_use > stats->depth ? in_use - stats->depth : 0;  // Snapshot races
+    stats->high_water = ring->high_water;
+    stats->pushed = ring->pushed;
+    stats->dropped = ring->dropped;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file frame_ring.h
+ * @brief Single-producer/single-consumer ring of reassembled Instax frames
+ *
+ * The NimBLE host task reassembles BLE writes directly into a ring slot and
+ * publishes it; the protocol worker task consumes slots in order. Slots are
+ * statically allocated - no heap allocation per frame.
+ *
+ * Several connections can be reassembling at once, so the producer may hold
+ * more than one reserved slot. Slots come from a free list and are published
+ * in commit order, so a connection that stops halfway through a frame only
+ * ties up its own slot - complete frames of other connections go straight
+ * through. Each connection holds one slot at a time, so its own frames stay
+ * in order. The queue of committed slots and the free list are index rings
+ * with free-running counters, each written by only one side, so no lock is
+ * needed.
+ */
+
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Number of slots (must be a power of two) - room for one partial frame per
+// connection plus completed frames waiting for the protocol task
+#define FRAME_RING_SLOTS        8
+
+// Largest frame a slot can hold (Square: 1808-byte chunk + index + framing = 1819)
+#define FRAME_RING_SLOT_SIZE    2048
+
+typedef enum {
+    FRAME_RING_KIND_PACKET = 0,      // Complete Instax frame in data[]
+    FRAME_RING_KIND_DISCONNECT = 1,  // Connection dropped - abort any active job
+    FRAME_RING_KIND_PRINT_DATA_IN_PLACE = 2,  // PRINT_DATA header + checksum in data[],
+                                              // image data already in the print buffer
+    FRAME_RING_KIND_DROPPED = 3,     // Reassembly abandoned - consumer skips the slot
+} frame_ring_kind_t;
+
+typedef struct {
+    uint16_t len;
+    uint16_t conn_handle;
+    uint16_t payload_len;         // Image data length (PRINT_DATA_IN_PLACE only)
+    uint8_t kind;
+    uint8_t session;              // Session pool index of the sending connection
+    bool checksum_ok;             // Frame checksum matched (summed during reassembly)
+    uint32_t target_gen;          // Print target the image data went to (PRINT_DATA_IN_PLACE only)
+    uint32_t rx_us;               // Reassembly completed (low 32 bits of esp_timer_get_time())
+    uint8_t data[FRAME_RING_SLOT_SIZE];
+} frame_ring_slot_t;
+
+typedef struct {
+    frame_ring_slot_t slots[FRAME_RING_SLOTS];
+    uint8_t queue[FRAME_RING_SLOTS];  // Committed slot indices, in commit order
+    uint8_t free[FRAME_RING_SLOTS];   // Slot indices released by the consumer
+    uint32_t head;        // Next queue entry to publish (producer only)
+    uint32_t tail;        // Next queue entry to consume (consumer only)
+    uint32_t free_head;   // Next free list entry to fill (consumer only)
+    uint32_t free_tail;   // Next free list entry to hand out (producer only)
+    uint32_t pushed;      // Frames published
+    uint32_t dropped;     // Frames dropped because the ring was full
+    uint32_t high_water;  // Deepest queue observed
+} frame_ring_t;
+
+// Ring statistics snapshot
+typedef struct {
+    uint32_t depth;
+    uint32_t reserved;    // Slots handed to the producer but not yet committed
+    uint32_t high_water;
+    uint32_t pushed;
+    uint32_t dropped;
+} frame_ring_stats_t;
+
+/**
+ * Reset ring to empty (call before either task uses it)
+ */
+void frame_ring_init(frame_ring_t *ring);
+
+/**
+ * Producer: reserve a free slot without publishing it
+ * A reserved slot is only returned to the free list once it has been committed
+ * and consumed.
+ * @return Slot to fill, or NULL if every slot is in use (counted as a drop)
+ */
+frame_ring_slot_t *frame_ring_acquire(frame_ring_t *ring);
+
+/**
+ * Producer: publish a slot returned by frame_ring_acquire()
+ * Slots are consumed in the order they are committed.
+ */
+void frame_ring_commit(frame_ring_t *ring, frame_ring_slot_t *slot);
+
+/**
+ * Consumer: get the oldest published slot
+ * @return Slot to process, or NULL if the ring is empty
+ */
+frame_ring_slot_t *frame_ring_peek(frame_ring_t *ring);
+
+/**
+ * Consumer: return the slot from frame_ring_peek() to the producer
+ */
+void frame_ring_release(frame_ring_t *ring);
+
+/**
+ * Get ring statistics
+ */
+void frame_ring_get_stats(const frame_ring_t *ring, frame_ring_stats_t *stats);
+
+#endif // FRAME_RING_H
@@ -8,11 +8,25 @@
 
 // Model information table
 // Note: All models currently use 105KB max file size
-static const instax_model_info_t model_info[] = {
-    [INSTAX_MODEL_MINI]   = { .width = 600,  .height = 800, .chunk_size = 900,  .max_file_size = 105 * 1024 },  // 105 KB for Link 1/2, 55 KB for Link 3
-    [INSTAX_MODEL_SQUARE] = { .width = 800,  .height = 800, .chunk_size = 1808, .max_file_size = 105 * 1024 },  // 105 KB
-    [INSTAX_MODEL_WIDE]   = { .width = 1260, .height = 840, .chunk_size = 900,  .max_file_size = 105 * 1024 },  // 105 KB
-};
+// Transport defaults are the timings the official apps use (75 ms between
+// chunks, Link 3 needs 1 s before PRINT_EXECUTE); the MTU is capped by the
+// 256-byte msys blocks in sdkconfig.
+#define MODEL_INFO_DEFAULTS { \
+    [INSTAX_MODEL_MINI]   = { .width = 600,  .height = 800, .chunk_size = 900,  .max_file_size = 105 * 1024,   /* 105 KB for Link 1/2, 55 KB for Link 3 */ \
+                              .preferred_mtu = 256, .ack_delay_ms = 50, .chunk_delay_ms = 75, \
+                              .start_delay_ms = 100, .end_delay_ms = 100, .execute_delay_ms = 1000 }, \
+    [INSTAX_MODEL_SQUARE] = { .width = 800,  .height = 800, .chunk_size = 1808, .max_file_size = 105 * 1024,   /* 105 KB */ \
+                              .preferred_mtu = 256, .ack_delay_ms = 50, .chunk_delay_ms = 75, \
+                              .start_delay_ms = 100, .end_delay_ms = 100, .execute_delay_ms = 1000 }, \
+    [INSTAX_MODEL_WIDE]   = { .width = 1260, .height = 840, .chunk_size = 900,  .max_file_size = 105 * 1024,   /* 105 KB */ \
+                              .preferred_mtu = 256, .ack_delay_ms = 50, .chunk_delay_ms = 75, \
+                              .start_delay_ms = 100, .end_delay_ms = 100, .execute_delay_ms = 1000 }, \
+}
+
+static const instax_model_info_t default_model_info[] = MODEL_INFO_DEFAULTS;
+
+// Live table: defaults plus runtime transport overrides
+static instax_model_info_t model_info[] = MODEL_INFO_DEFAULTS;
 
 const instax_model_info_t* instax_get_model_info(instax_model_t model) {
     if (model >= INSTAX_MODEL_UNKNOWN) {
@@ -21,6 +35,39 @@ const instax_model_info_t* instax_get_model_info(instax_model_t model) {
     return &model_info[model];
 }
 
+const instax_model_info_t* instax_get_default_model_info(instax_model_t model) {
+    if (model >= INSTAX_MODEL_UNKNOWN) {
+        return NULL;
+    }
+    return &default_model_info[model];
+}
+
+bool instax_set_model_info(instax_model_t model, const instax_model_info_t *info) {
+    if (model >= INSTAX_MODEL_UNKNOWN || info == NULL) {
+        return false;
+    }
+    if (info->chunk_size < INSTAX_PROFILE_CHUNK_MIN || info->chunk_size > INSTAX_PROFILE_CHUNK_MAX ||
+        info->preferred_mtu < INSTAX_PROFILE_MTU_MIN || info->preferred_mtu > INSTAX_PROFILE_MTU_MAX ||
+        info->ack_delay_ms > INSTAX_PROFILE_ACK_DELAY_MAX_MS ||
+        info->chunk_delay_ms > INSTAX_PROFILE_DELAY_MAX_MS ||
+        info->start_delay_ms > INSTAX_PROFILE_DELAY_MAX_MS ||
+        info->end_delay_ms > INSTAX_PROFILE_DELAY_MAX_MS ||
+        info->execute_delay_ms > INSTAX_PROFILE_DELAY_MAX_MS) {
+        return false;
+    }
+
+    // Field by field, so a concurrent reader sees each value old or new, never torn
+    instax_model_info_t *live = &model_info[model];
+    live->chunk_size = info->chunk_size;
+    live->preferred_mtu = info->preferred_mtu;
+    live->ack_delay_ms = info->ack_delay_ms;
+    live->chunk_delay_ms = info->chunk_delay_ms;
+    live->start_delay_ms = info->start_delay_ms;
+    live->end_delay_ms = info->end_delay_ms;
+    live->execute_delay_ms = info->execute_delay_ms;
+    return true;
+}
+
 instax_model_t instax_detect_model(uint16_t width, uint16_t height) {
     if (width == 600 && height == 800) return INSTAX_MODEL_MINI;
     if (width == 800 && height == 800) return INSTAX_MODEL_SQUARE;
@@ -28,50 +75,157 @@ instax_model_t instax_detect_model(uint16_t width, uint16_t height) {
     return INSTAX_MODEL_UNKNOWN;
 }
 
-uint8_t instax_calculate_checksum(const uint8_t *data, size_t len) {
-    uint8_t sum = 0;
-    for (size_t i = 0; i < len; i++) {
-        sum += data[i];
+/**
+ * Byte sum, one 32-bit word per step
+ * Even and odd bytes of each word are added into two 16-bit lanes; a lane
+ * takes at most 128 words (128 x 2 x 255) before it could carry into the
+ * other, so the lanes are folded into the sum every 128 words.
+ */
+static uint32_t sum_bytes(const uint8_t *data, size_t len) {
+    uint32_t sum = 0;
+
+    // Up to a word boundary (unaligned word loads fault on Xtensa)
+    while (len > 0 && ((uintptr_t)data & 3) != 0) {
+        sum += *data++;
+        len--;
+    }
+
+    while (len >= 4) {
+        const uint8_t *words = __builtin_assume_aligned(data, 4);
+        size_t count = len / 4 < 128 ? len / 4 : 128;
+        uint32_t lanes = 0;
+        for (size_t i = 0; i < count; i++) {
+            uint32_t w;
+            memcpy(&w, &words[i * 4], sizeof(w));
+            lanes += (w & 0x00FF00FF) + ((w >> 8) & 0x00FF00FF);
+        }
+        sum += (lanes & 0xFFFF) + (lanes >> 16);
+        data += count * 4;
+        len -= count * 4;
+    }
+
+    while (len > 0) {
+        sum += *data++;
+        len--;
     }
-    return (255 - sum) & 0xFF;
+    return sum;
+}
+
+void instax_checksum_init(instax_checksum_t *ctx) {
+    ctx->sum = 0;
+}
+
+void instax_checksum_update(instax_checksum_t *ctx, const uint8_t *data, size_t len) {
+    ctx->sum += sum_bytes(data, len);
+}
+
+uint8_t instax_checksum_final(const instax_checksum_t *ctx) {
+    return (255 - ctx->sum) & 0xFF;
+}
+
+bool instax_checksum_frame_valid(const instax_checksum_t *ctx) {
+    return (ctx->sum & 0xFF) == 0xFF;
+}
+
+uint8_t instax_calculate_checksum(const uint8_t *data, size_t len) {
+    return (255 - sum_bytes(data, len)) & 0xFF;
 }
 
 /**
- * Create a packet with header, length, event type, payload, and checksum
+ * Fill in header and checksum around the payload segments
+ * @param prefix Leading payload bytes kept in the header (PRINT_DATA chunk index)
  */
-static size_t create_packet(uint8_t function, uint8_t operation,
-                            const uint8_t *payload, size_t payload_len,
-                            uint8_t *buffer, size_t buffer_size) {
+static size_t build_parts(uint8_t function, uint8_t operation, const uint8_t *prefix, size_t prefix_len,
+                          const instax_iovec_t *payload, size_t count, instax_frame_parts_t *parts) {
     // Total packet length = header(2) + length(2) + opcode(2) + payload + checksum(1) = 7 + payload_len
-    size_t packet_len = 7 + payload_len;
-
-    if (buffer_size < packet_len) {
+    size_t packet_len = 7 + prefix_len;
+    for (size_t i = 0; i < count; i++) {
+        packet_len += payload[i].len;
+    }
+    if (packet_len > 0xFFFF || 6 + prefix_len > sizeof(parts->header)) {
         return 0;
     }
 
     // Header
-    buffer[0] = INSTAX_HEADER_TO_DEVICE_0;
-    buffer[1] = INSTAX_HEADER_TO_DEVICE_1;
+    parts->header[0] = INSTAX_HEADER_TO_DEVICE_0;
+    parts->header[1] = INSTAX_HEADER_TO_DEVICE_1;
 
     // Length (big-endian) - includes entire packet length
-    buffer[2] = (packet_len >> 8) & 0xFF;
-    buffer[3] = packet_len & 0xFF;
+    parts->header[2] = (packet_len >> 8) & 0xFF;
+    parts->header[3] = packet_len & 0xFF;
 
     // Function and operation
-    buffer[4] = function;
-    buffer[5] = operation;
-
-    // Payload
-    if (payload_len > 0 && payload != NULL) {
-        memcpy(&buffer[6], payload, payload_len);
+    parts->header[4] = function;
+    parts->header[5] = operation;
+    if (prefix_len > 0) {
+        memcpy(&parts->header[6], prefix, prefix_len);
     }
+    parts->header_len = 6 + prefix_len;
+
+    // Checksum (over everything except checksum itself), read from the caller's buffers
+    instax_checksum_t checksum;
+    instax_checksum_init(&checksum);
+    instax_checksum_update(&checksum, parts->header, parts->header_len);
+    for (size_t i = 0; i < count; i++) {
+        if (payload[i].len > 0) {
+            instax_checksum_update(&checksum, payload[i].data, payload[i].len);
+        }
+    }
+    parts->trailer[0] = instax_checksum_final(&checksum);
 
-    // Checksum (over everything except checksum itself)
-    buffer[packet_len - 1] = instax_calculate_checksum(buffer, packet_len - 1);
-
+    parts->frame_len = packet_len;
     return packet_len;
 }
 
+size_t instax_build_frame(uint8_t function, uint8_t operation,
+                          const instax_iovec_t *payload, size_t count, instax_frame_parts_t *parts) {
+    return build_parts(function, operation, NULL, 0, payload, count, parts);
+}
+
+size_t instax_build_print_data(uint32_t chunk_index, const uint8_t *data, size_t data_len,
+                               instax_frame_parts_t *parts) {
+    // Payload = 4 bytes chunk index (big-endian, kept in the header) + data
+    uint8_t index[4] = {
+        (chunk_index >> 24) & 0xFF,
+        (chunk_index >> 16) & 0xFF,
+        (chunk_index >> 8) & 0xFF,
+        chunk_index & 0xFF
+    };
+    instax_iovec_t segment = { .data = data, .len = data != NULL ? data_len : 0 };
+    return build_parts(INSTAX_FUNC_PRINT, INSTAX_OP_PRINT_DATA, index, sizeof(index), &segment, 1, parts);
+}
+
+size_t instax_frame_copy(const instax_frame_parts_t *parts, const instax_iovec_t *payload, size_t count,
+                         uint8_t *buffer, size_t buffer_size) {
+    if (parts->frame_len == 0 || buffer_size < parts->frame_len) {
+        return 0;
+    }
+    size_t off = parts->header_len;
+    memcpy(buffer, parts->header, off);
+    for (size_t i = 0; i < count; i++) {
+        if (payload[i].len > 0) {
+            memcpy(&buffer[off], payload[i].data, payload[i].len);
+            off += payload[i].len;
+        }
+    }
+    buffer[off++] = parts->trailer[0];
+    return off;
+}
+
+/**
+ * Create a packet with header, length, event type, payload, and checksum
+ */
+static size_t create_packet(uint8_t function, uint8_t operation,
+                            const uint8_t *payload, size_t payload_len,
+                            uint8_t *buffer, size_t buffer_size) {
+    instax_iovec_t segment = { .data = payload, .len = payload != NULL ? payload_len : 0 };
+    instax_frame_parts_t parts;
+    if (instax_build_frame(function, operation, &segment, 1, &parts) == 0) {
+        return 0;
+    }
+    return instax_frame_copy(&parts, &segment, 1, buffer, buffer_size);
+}
+
 size_t instax_create_info_query(instax_info_type_t info_type, uint8_t *buffer, size_t buffer_size) {
     uint8_t payload[1] = { (uint8_t)info_type };
     return create_packet(INSTAX_FUNC_INFO, INSTAX_OP_SUPPORT_FUNCTION_INFO,
@@ -92,37 +246,12 @@ size_t instax_create_print_start(uint32_t image_size, uint8_t *buffer, size_t bu
 
 size_t instax_create_print_data(uint32_t chunk_index, const uint8_t *data, size_t data_len,
                                  uint8_t *buffer, size_t buffer_size) {
-    // Payload = 4 bytes chunk index + data
-    size_t payload_len = 4 + data_len;
-
-    if (buffer_size < 7 + payload_len) {
+    instax_iovec_t segment = { .data = data, .len = data != NULL ? data_len : 0 };
+    instax_frame_parts_t parts;
+    if (instax_build_print_data(chunk_index, data, data_len, &parts) == 0) {
         return 0;
     }
-
-    // Build payload: chunk index (big-endian) + data
-    uint8_t *payload_start = &buffer[6];
-    payload_start[0] = (chunk_index >> 24) & 0xFF;
-    payload_start[1] = (chunk_index >> 16) & 0xFF;
-    payload_start[2] = (chunk_index >> 8) & 0xFF;
-    payload_start[3] = chunk_index & 0xFF;
-
-    if (data_len > 0 && data != NULL) {
-        memcpy(&payload_start[4], data, data_len);
-    }
-
-    // Now build the header
-    size_t packet_len = 7 + payload_len;
-
-    buffer[0] = INSTAX_HEADER_TO_DEVICE_0;
-    buffer[1] = INSTAX_HEADER_TO_DEVICE_1;
-    buffer[2] = (packet_len >> 8) & 0xFF;
-    buffer[3] = packet_len & 0xFF;
-    buffer[4] = INSTAX_FUNC_PRINT;
-    buffer[5] = INSTAX_OP_PRINT_DATA;
-    // Payload already in place
-    buffer[packet_len - 1] = instax_calculate_checksum(buffer, packet_len - 1);
-
-    return packet_len;
+    return instax_frame_copy(&parts, &segment, 1, buffer, buffer_size);
 }
 
 size_t instax_create_print_end(uint8_t *buffer, size_t buffer_size) {
@@ -152,7 +281,12 @@ bool instax_parse_response(const uint8_t *data, size_t len,
 
     // Parse length
     uint16_t packet_len = ((uint16_t)data[2] << 8) | data[3];
-    if (len < packet_len) {
+    if (packet_len < 7 || len < packet_len) {
+        return false;
+    }
+
+    // Checksum over everything except the checksum itself
+    if (instax_calculate_checksum(data, packet_len - 1) != data[packet_len - 1]) {
         return false;
     }
 
@@ -183,7 +317,12 @@ bool instax_parse_command(const uint8_t *data, size_t len,
 
     // Parse length
     uint16_t packet_len = ((uint16_t)data[2] << 8) | data[3];
-    if (len < packet_len) {
+    if (packet_len < 7 || len < packet_len) {
+        return false;
+    }
+
+    // Checksum over everything except the checksum itself
+    if (instax_calculate_checksum(data, packet_len - 1) != data[packet_len - 1]) {
         return false;
     }
 
@@ -254,3 +393,161 @@ bool instax_parse_print_history_info(const uint8_t *payload, size_t payload_len,
 
     return true;
 }
+
+void instax_parser_init(instax_parser_t *parser, bool to_device,
+                        instax_parser_buffer_fn get_buffer, instax_parser_frame_fn on_frame, void *ctx) {
+    memset(parser, 0, sizeof(*parser));
+    parser->header[0] = to_device ? INSTAX_HEADER_TO_DEVICE_0 : INSTAX_HEADER_FROM_DEVICE_0;
+    parser->header[1] = to_device ? INSTAX_HEADER_TO_DEVICE_1 : INSTAX_HEADER_FROM_DEVICE_1;
+    parser->get_buffer = get_buffer;
+    parser->on_frame = on_frame;
+    parser->ctx = ctx;
+}
+
+void instax_parser_set_bad_frame_handler(instax_parser_t *parser, instax_parser_bad_frame_fn on_bad_checksum) {
+    parser->on_bad_checksum = on_bad_checksum;
+}
+
+void instax_parser_reset(instax_parser_t *parser) {
+    parser->buf = NULL;
+    parser->capacity = 0;
+    parser->len = 0;
+}
+
+size_t instax_parser_buffered(const instax_parser_t *parser) {
+    return parser->len;
+}
+
+size_t instax_parser_missing(const instax_parser_t *parser) {
+    if (parser->len < 4) {
+        return 0;
+    }
+    size_t frame_len = ((size_t)parser->buf[2] << 8) | parser->buf[3];
+    return frame_len > parser->len ? frame_len - parser->len : 0;
+}
+
+uint8_t *instax_parser_write_ptr(instax_parser_t *parser, size_t *space) {
+    if (parser->buf == NULL) {
+        parser->len = 0;
+        parser->buf = parser->get_buffer(parser->ctx, &parser->capacity);
+        if (parser->buf == NULL) {
+            *space = 0;
+            return NULL;
+        }
+    }
+    *space = parser->capacity - parser->len;
+    return parser->buf + parser->len;
+}
+
+static void drop_front(instax_parser_t *parser, size_t n) {
+    memmove(parser->buf, parser->buf + n, parser->len - n);
+    parser->len -= n;
+}
+
+/**
+ * Skip buffered bytes up to the next possible frame header
+ * A lone first header byte at the end is kept - the next slice may complete it.
+ */
+static void hunt_header(instax_parser_t *parser) {
+    size_t i = 0;
+    while (i < parser->len) {
+        const uint8_t *p = memchr(parser->buf + i, parser->header[0], parser->len - i);
+        if (p == NULL) {
+            i = parser->len;
+            break;
+        }
+        i = p - parser->buf;
+        if (i + 1 == parser->len || parser->buf[i + 1] == parser->header[1]) {
+            break;
+        }
+        i++;
+    }
+    if (i > 0) {
+        parser->stats.resyncs++;
+        parser->stats.bytes_skipped += i;
+        drop_front(parser, i);
+    }
+}
+
+/**
+ * Emit every complete frame in the buffer
+ * Leaves fewer bytes than the frame being assembled, so there is always space left.
+ */
+static void parse_buffered(instax_parser_t *parser) {
+    while (parser->len > 0) {
+        hunt_header(parser);
+        if (parser->len < 4) {
+            return;
+        }
+
+        // Minimum frame: header(2) + length(2) + opcode(2) + checksum(1) = 7
+        size_t frame_len = ((size_t)parser->buf[2] << 8) | parser->buf[3];
+        if (frame_len < 7 || frame_len > parser->capacity) {
+            // Not a real header (or a frame we could never hold) - look for the next one
+            parser->stats.bad_length++;
+            drop_front(parser, 1);
+            continue;
+        }
+        if (parser->len < frame_len) {
+            return;
+        }
+
+        if (instax_calculate_checksum(parser->buf, frame_len - 1) != parser->buf[frame_len - 1]) {
+            // A real frame hides behind the bad one if its header was a false match
+            parser->stats.bad_checksum++;
+            if (parser->on_bad_checksum != NULL) {
+                parser->on_bad_checksum(parser->ctx, parser->buf, frame_len);
+            }
+            drop_front(parser, 1);
+            continue;
+        }
+
+        parser->stats.frames++;
+        uint8_t *frame = parser->buf;
+        size_t tail = parser->len - frame_len;
+        if (!parser->on_frame(parser->ctx, frame, frame_len)) {
+            drop_front(parser, frame_len);
+            continue;
+        }
+
+        // The callee kept the buffer - carry the bytes after the frame into a new one
+        parser->buf = NULL;
+        parser->len = 0;
+        if (tail > 0) {
+            size_t space;
+            uint8_t *dst = instax_parser_write_ptr(parser, &space);
+            if (dst == NULL) {
+                parser->stats.bytes_dropped += tail;
+                return;
+            }
+            if (tail > space) {
+                parser->stats.bytes_dropped += tail - space;
+                tail = space;
+            }
+            memcpy(dst, frame + frame_len, tail);
+            parser->len = tail;
+        }
+    }
+}
+
+void instax_parser_written(instax_parser_t *parser, size_t len) {
+    parser->len += len;
+    parse_buffered(parser);
+}
+
+size_t instax_parser_push(instax_parser_t *parser, const uint8_t *data, size_t len) {
+    size_t done = 0;
+    while (done < len) {
+        size_t space;
+        uint8_t *dst = instax_parser_write_ptr(parser, &space);
+        if (dst == NULL) {
+            parser->stats.bytes_dropped += len - done;
+            break;
+        }
+        size_t n = len - done < space ? len - done : space;
+        memcpy(dst, data + done, n);
+        done += n;
+        instax_parser_written(parser, n);
+    }
+    return done;
+}
@@ -81,12 +81,26 @@ typedef enum {
     INSTAX_MODEL_UNKNOWN = 255
 } instax_model_t;
 
-// Model Dimensions
+// Bounds for the runtime-adjustable transport fields of instax_model_info_t
+#define INSTAX_PROFILE_MTU_MIN          23
+#define INSTAX_PROFILE_MTU_MAX          517
+#define INSTAX_PROFILE_CHUNK_MIN        64
+#define INSTAX_PROFILE_CHUNK_MAX        2037  // PRINT_DATA frame (chunk + 11) fits a 2048-byte frame ring slot
+#define INSTAX_PROFILE_ACK_DELAY_MAX_MS 500
+#define INSTAX_PROFILE_DELAY_MAX_MS     5000
+
+// Model dimensions and transport profile
 typedef struct {
     uint16_t width;
     uint16_t height;
-    uint16_t chunk_size;
+    uint16_t chunk_size;         // Image bytes per PRINT_DATA frame (scanner; emulator PRINT_START ACK)
     uint32_t max_file_size;
+    uint16_t preferred_mtu;      // ATT MTU requested on connect
+    uint16_t ack_delay_ms;       // Emulator: delay after each PRINT_DATA ACK in fixed pacing mode
+    uint16_t chunk_delay_ms;     // Scanner: delay between PRINT_DATA frames
+    uint16_t start_delay_ms;     // Scanner: delay after PRINT_START
+    uint16_t end_delay_ms;       // Scanner: delay after PRINT_END
+    uint16_t execute_delay_ms;   // Scanner: delay between LED pattern and PRINT_EXECUTE
 } instax_model_info_t;
 
 // Accelerometer Data Structure
@@ -157,14 +171,76 @@ typedef void (*instax_print_progress_callback_t)(const instax_print_progress_t *
 
 /**
  * Get model info for a specific model
+ * Transport fields reflect runtime overrides (instax_set_model_info)
  */
 const instax_model_info_t* instax_get_model_info(instax_model_t model);
 
+/**
+ * Get the built-in model info, ignoring runtime overrides
+ */
+const instax_model_info_t* instax_get_default_model_info(instax_model_t model);
+
+/**
+ * Override the transport profile of a model
+ * Only chunk_size, preferred_mtu and the delay fields are taken from info;
+ * dimensions and max_file_size stay fixed. Readers pick the new values up
+ * from their next connection or print job.
+ * @param model Model to change
+ * @param info Profile with the new transport fields
+ * @return false if the model is unknown or a field is out of bounds
+ */
+bool instax_set_model_info(instax_model_t model, const instax_model_info_t *info);
+
 /**
  * Detect model from dimensions
  */
 instax_model_t instax_detect_model(uint16_t width, uint16_t height);
 
+// Caller-owned piece of a frame payload
+typedef struct {
+    const void *data;
+    size_t len;
+} instax_iovec_t;
+
+// Header and checksum of a frame whose payload stays in the caller's buffers
+// On the wire: header, the payload segments in order, trailer.
+typedef struct {
+    uint8_t header[10];         // Header(2) + Length(2) + Func(1) + Op(1) [+ PRINT_DATA chunk index(4)]
+    size_t header_len;
+    uint8_t trailer[1];         // Checksum
+    size_t frame_len;           // Whole frame
+} instax_frame_parts_t;
+
+/**
+ * Build header and checksum for a frame around payload segments (no payload copy)
+ * @param function Function code
+ * @param operation Operation code
+ * @param payload Payload segments, read only to compute the checksum
+ * @param count Number of segments
+ * @param parts Output: header and trailer to send around the segments
+ * @return Frame length, or 0 if the payload is too long for the length field
+ */
+size_t instax_build_frame(uint8_t function, uint8_t operation,
+                          const instax_iovec_t *payload, size_t count, instax_frame_parts_t *parts);
+
+/**
+ * Build header (with chunk index) and checksum for a PRINT_DATA frame
+ * @param chunk_index Index of this chunk (0-based)
+ * @param data Image data chunk, sent from the caller's buffer
+ * @param data_len Length of image data chunk
+ * @param parts Output: header and trailer to send around data
+ * @return Frame length, or 0 on error
+ */
+size_t instax_build_print_data(uint32_t chunk_index, const uint8_t *data, size_t data_len,
+                               instax_frame_parts_t *parts);
+
+/**
+ * Copy a built frame into one flat buffer (for transports that need one)
+ * @return Frame length, or 0 if buffer is too small
+ */
+size_t instax_frame_copy(const instax_frame_parts_t *parts, const instax_iovec_t *payload, size_t count,
+                         uint8_t *buffer, size_t buffer_size);
+
 /**
  * Create an info query packet
  * @param info_type The type of info to query
@@ -220,7 +296,7 @@ size_t instax_create_led_pattern(uint8_t *buffer, size_t buffer_size);
 size_t instax_create_print_execute(uint8_t *buffer, size_t buffer_size);
 
 /**
- * Parse a response packet
+ * Parse a response packet (checks length and checksum)
  * @param data Raw packet data
  * @param len Length of packet data
  * @param function Output: function code from packet
@@ -234,7 +310,7 @@ bool instax_parse_response(const uint8_t *data, size_t len,
                            const uint8_t **payload, size_t *payload_len);
 
 /**
- * Parse command packet from app to device
+ * Parse command packet from app to device (checks length and checksum)
  * @param data Packet data buffer
  * @param len Length of packet data
  * @param function Output: function code from packet
@@ -298,4 +374,140 @@ bool instax_parse_print_history_info(const uint8_t *payload, size_t payload_len,
  */
 uint8_t instax_calculate_checksum(const uint8_t *data, size_t len);
 
+/**
+ * Running checksum, for frames that arrive or are built in pieces
+ * The checksum is 255 minus the byte sum, so pieces can be added in any
+ * order and a whole frame including its checksum byte sums to 0xFF.
+ */
+typedef struct {
+    uint32_t sum;       // Byte sum so far (only the low 8 bits matter)
+} instax_checksum_t;
+
+/**
+ * Start a running checksum
+ */
+void instax_checksum_init(instax_checksum_t *ctx);
+
+/**
+ * Add bytes to a running checksum
+ */
+void instax_checksum_update(instax_checksum_t *ctx, const uint8_t *data, size_t len);
+
+/**
+ * Checksum byte for the bytes added so far
+ */
+uint8_t instax_checksum_final(const instax_checksum_t *ctx);
+
+/**
+ * Whether the bytes added were a whole frame with a correct checksum byte
+ */
+bool instax_checksum_frame_valid(const instax_checksum_t *ctx);
+
+/**
+ * Streaming frame parser
+ *
+ * Takes the byte stream in slices of any size (BLE writes or notifications
+ * that split frames, or carry the end of one frame and the start of the
+ * next) and calls on_frame once per complete frame with a valid checksum.
+ * Bytes before a header are skipped; a frame with an impossible length or a
+ * bad checksum is dropped and the search for a header restarts one byte
+ * after its start, so a real frame behind a false header match is found.
+ *
+ * A caller that answers corrupt frames (e.g. with an error status) can set
+ * on_bad_checksum; it sees each bad frame before it is dropped.
+ *
+ * Frames are assembled in buffers the caller hands out through get_buffer.
+ * A caller that processes each frame at once returns false from on_frame and
+ * the buffer is reused; one that queues frames keeps the buffer (returns
+ * true) and is asked for a new one for the next frame.
+ */
+
+// Parser statistics (each dropped frame or skipped run counts once)
+typedef struct {
+    uint32_t frames;            // Valid frames passed to on_frame
+    uint32_t bad_checksum;      // Complete frames dropped for a checksum mismatch
+    uint32_t bad_length;        // Headers with a length below 7 or above the buffer size
+    uint32_t resyncs;           // Runs of bytes skipped to reach a header
+    uint32_t bytes_skipped;     // Bytes in those runs
+    uint32_t bytes_dropped;     // Bytes lost because get_buffer had no buffer
+} instax_parser_stats_t;
+
+/**
+ * Storage for the next frame
+ * @param capacity Set to the buffer size (at least the largest frame expected)
+ * @return Buffer, or NULL if none is available (the bytes are dropped)
+ */
+typedef uint8_t *(*instax_parser_buffer_fn)(void *ctx, size_t *capacity);
+
+/**
+ * A complete frame with a valid checksum (frame is the start of the buffer)
+ * @return true if the callee keeps the buffer, false to let the parser reuse it
+ */
+typedef bool (*instax_parser_frame_fn)(void *ctx, uint8_t *frame, size_t len);
+
+/**
+ * A complete frame whose checksum does not match, just before it is dropped
+ * Also called for false header matches inside dropped data.
+ */
+typedef void (*instax_parser_bad_frame_fn)(void *ctx, const uint8_t *frame, size_t len);
+
+typedef struct {
+    uint8_t header[2];          // Header of the direction being parsed
+    instax_parser_buffer_fn get_buffer;
+    instax_parser_frame_fn on_frame;
+    instax_parser_bad_frame_fn on_bad_checksum;  // Optional (NULL after init)
+    void *ctx;
+    uint8_t *buf;               // Current buffer (NULL until bytes arrive)
+    size_t capacity;
+    size_t len;                 // Bytes buffered
+    instax_parser_stats_t stats;
+} instax_parser_t;
+
+/**
+ * Set up a parser
+ * @param to_device true to parse app-to-printer frames (0x41 0x62), false for
+ *                  printer-to-app frames (0x61 0x42)
+ */
+void instax_parser_init(instax_parser_t *parser, bool to_device,
+                        instax_parser_buffer_fn get_buffer, instax_parser_frame_fn on_frame, void *ctx);
+
+/**
+ * Report frames dropped for a checksum mismatch to on_bad_checksum
+ */
+void instax_parser_set_bad_frame_handler(instax_parser_t *parser, instax_parser_bad_frame_fn on_bad_checksum);
+
+/**
+ * Forget the partial frame and the current buffer (statistics are kept)
+ */
+void instax_parser_reset(instax_parser_t *parser);
+
+/**
+ * Copy a slice of the stream in and emit the frames it completes
+ * @return Bytes taken; fewer than len only if get_buffer had no buffer
+ */
+size_t instax_parser_push(instax_parser_t *parser, const uint8_t *data, size_t len);
+
+/**
+ * Where the next bytes go, for callers that copy straight into the buffer
+ * Follow with instax_parser_written().
+ * @param space Set to the bytes that fit
+ * @return NULL if get_buffer had no buffer
+ */
+uint8_t *instax_parser_write_ptr(instax_parser_t *parser, size_t *space);
+
+/**
+ * Account for len bytes copied to instax_parser_write_ptr() and emit frames
+ */
+void instax_parser_written(instax_parser_t *parser, size_t len);
+
+/**
+ * Bytes buffered (0 = at a frame boundary)
+ */
+size_t instax_parser_buffered(const instax_parser_t *parser);
+
+/**
+ * Bytes still missing from the frame being assembled (0 if its length is not known yet)
+ */
+size_t instax_parser_missing(const instax_parser_t *parser);
+
 #endif // INSTAX_PROTOCOL_H
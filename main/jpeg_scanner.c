@@ -0,0 +1,222 @@
+/**
+ * @file jpeg_scanner.c
+ * @brief Incremental JPEG marker scanner fed chunk by chunk during upload
+ */
+
+#include "jpeg_scanner.h"
+#include <string.h>
+#include "esp_rom_crc.h"
+
+enum {
+    ST_SOI0 = 0,        // Expect FF
+    ST_SOI1,            // Expect D8
+    ST_MARKER_FF,       // Expect FF starting the next marker
+    ST_MARKER,          // Marker code (FF fill bytes skipped)
+    ST_LEN0,            // Segment length, high byte
+    ST_LEN1,            // Segment length, low byte
+    ST_SEGMENT,         // Segment payload
+    ST_ENTROPY,         // Entropy-coded scan data
+    ST_ENTROPY_FF,      // FF inside scan data: stuffing, restart or marker
+    ST_DONE,            // EOI seen
+    ST_ERROR,           // Structural error - only the CRC is kept up to date
+};
+
+#define MARKER_SOI  0xD8
+#define MARKER_EOI  0xD9
+#define MARKER_SOS  0xDA
+#define MARKER_TEM  0x01
+
+static bool is_sof(uint8_t marker) {
+    // C0-CF except DHT (C4), JPG (C8) and DAC (CC)
+    return (marker & 0xF0) == 0xC0 && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+}
+
+static bool is_rst(uint8_t marker) {
+    return marker >= 0xD0 && marker <= 0xD7;
+}
+
+static void fail(jpeg_scan_t *scan, jpeg_scan_status_t status, uint32_t offset) {
+    scan->result.status = status;
+    scan->result.error_offset = offset;
+    scan->state = ST_ERROR;
+}
+
+static void on_marker(jpeg_scan_t *scan, uint8_t marker, uint32_t offset) {
+    if (marker == MARKER_EOI) {
+        scan->result.eoi_offset = offset + 1;
+        scan->state = ST_DONE;
+    } else if (is_rst(marker) || marker == MARKER_TEM) {
+        // No length field
+        scan->state = scan->in_scan ? ST_ENTROPY : ST_MARKER_FF;
+    } else if (marker == MARKER_SOI) {
+        fail(scan, JPEG_SCAN_BAD_SEGMENT, offset);
+    } else {
+        scan->in_scan = false;
+        scan->marker = marker;
+        scan->state = ST_LEN0;
+    }
+}
+
+static void end_segment(jpeg_scan_t *scan, uint32_t offset) {
+    if (is_sof(scan->marker) && scan->result.sof == 0) {
+        // Precision(1) Height(2) Width(2) Components(1)
+        const uint8_t *h = scan->header;
+        scan->result.sof = scan->marker;
+        scan->result.height = (uint16_t)((h[1] << 8) | h[2]);
+        scan->result.width = (uint16_t)((h[3] << 8) | h[4]);
+        scan->result.components = h[5];
+    }
+
+    if (scan->marker == MARKER_SOS) {
+        if (scan->result.sof == 0) {
+            fail(scan, JPEG_SCAN_NO_FRAME, offset);
+            return;
+        }
+        scan->in_scan = true;
+        scan->state = ST_ENTROPY;
+    } else {
+        scan->state = ST_MARKER_FF;
+    }
+}
+
+void jpeg_scan_init(jpeg_scan_t *scan) {
+    memset(scan, 0, sizeof(*scan));
+    scan->state = ST_SOI0;
+}
+
+void jpeg_scan_feed(jpeg_scan_t *scan, const uint8_t *data, size_t len) {
+    if (data == NULL || len == 0) {
+        return;
+    }
+
+    uint32_t base = scan->result.bytes;
+    scan->result.crc32 = esp_rom_crc32_le(scan->result.crc32, data, len);
+    scan->result.bytes += len;
+
+    size_t i = 0;
+    while (i < len) {
+        uint32_t offset = base + i;
+        switch (scan->state) {
+            case ST_SOI0:
+            case ST_SOI1: {
+                uint8_t expected = scan->state == ST_SOI0 ? 0xFF : MARKER_SOI;
+                if (data[i] != expected) {
+                    fail(scan, JPEG_SCAN_NO_SOI, offset);
+                } else {
+                    scan->state = scan->state == ST_SOI0 ? ST_SOI1 : ST_MARKER_FF;
+                }
+                i++;
+                break;
+            }
+
+            case ST_MARKER_FF:
+                if (data[i] != 0xFF) {
+                    fail(scan, JPEG_SCAN_BAD_SEGMENT, offset);
+                } else {
+                    scan->state = ST_MARKER;
+                }
+                i++;
+                break;
+
+            case ST_MARKER:
+                if (data[i] != 0xFF) {
+                    on_marker(scan, data[i], offset);
+                }
+                i++;
+                break;
+
+            case ST_LEN0:
+                scan->seg_remaining = (uint16_t)(data[i] << 8);
+                scan->state = ST_LEN1;
+                i++;
+                break;
+
+            case ST_LEN1: {
+                uint16_t seg_len = scan->seg_remaining | data[i];
+                i++;
+                if (seg_len < 2 || (is_sof(scan->marker) && seg_len < 2 + sizeof(scan->header))) {
+                    fail(scan, JPEG_SCAN_BAD_SEGMENT, offset);
+                    break;
+                }
+                scan->seg_remaining = seg_len - 2;
+                scan->header_len = 0;
+                scan->state = ST_SEGMENT;
+                if (scan->seg_remaining == 0) {
+                    end_segment(scan, offset);
+                }
+                break;
+            }
+
+            case ST_SEGMENT: {
+                size_t n = len - i < scan->seg_remaining ? len - i : scan->seg_remaining;
+                if (is_sof(scan->marker) && scan->header_len < sizeof(scan->header)) {
+                    size_t want = sizeof(scan->header) - scan->header_len;
+                    size_t copy = n < want ? n : want;
+                    memcpy(scan->header + scan->header_len, data + i, copy);
+                    scan->header_len += copy;
+                }
+                i += n;
+                scan->seg_remaining -= n;
+                if (scan->seg_remaining == 0) {
+                    end_segment(scan, base + i - 1);
+                }
+                break;
+            }
+
+            case ST_ENTROPY: {
+                const uint8_t *ff = memchr(data + i, 0xFF, len - i);
+                if (ff == NULL) {
+                    i = len;
+                } else {
+                    i = (size_t)(ff - data) + 1;
+                    scan->state = ST_ENTROPY_FF;
+                }
+                break;
+            }
+
+            case ST_ENTROPY_FF:
+                if (data[i] == 0x00) {
+                    scan->state = ST_ENTROPY;       // Stuffed FF 00
+                } else if (data[i] != 0xFF) {
+                    on_marker(scan, data[i], offset);
+                }
+                i++;
+                break;
+
+            default:
+                // Done or failed - trailing bytes only go into the CRC
+                i = len;
+                break;
+        }
+    }
+}
+
+void jpeg_scan_finish(const jpeg_scan_t *scan, jpeg_scan_result_t *result) {
+    *result = scan->result;
+    if (scan->state == ST_ERROR) {
+        return;
+    }
+    if (result->bytes == 0) {
+        result->status = JPEG_SCAN_EMPTY;
+    } else if (scan->state != ST_DONE) {
+        result->status = JPEG_SCAN_TRUNCATED;
+        result->error_offset = result->bytes;
+    } else if (result->sof == 0) {
+        result->status = JPEG_SCAN_NO_FRAME;
+        result->error_offset = result->eoi_offset;
+    } else {
+        result->status = JPEG_SCAN_OK;
+    }
+}
+
+const char *jpeg_scan_status_to_string(jpeg_scan_status_t status) {
+    switch (status) {
+        case JPEG_SCAN_OK:          return "ok";
+        case JPEG_SCAN_EMPTY:       return "empty";
+        case JPEG_SCAN_NO_SOI:      return "no_soi";
+        case JPEG_SCAN_BAD_SEGMENT: return "bad_segment";
+        case JPEG_SCAN_NO_FRAME:    return "no_frame";
+        case JPEG_SCAN_TRUNCATED:   return "truncated";
+        default:                    return "unknown";
+    }
+}
@@ -0,0 +1,74 @@
+/**
+ * @file jpeg_scanner.h
+ * @brief Incremental JPEG marker scanner fed chunk by chunk during upload
+ *
+ * Checks the structure of a print while it arrives instead of re-reading the
+ * file afterwards: SOI at the start, a frame header (SOF0/1/2) with the image
+ * size and component count, well-formed segments, and an EOI. A CRC32 of every
+ * byte received is kept alongside. Entropy-coded data is skipped with memchr()
+ * looking for the next 0xFF, so the cost per chunk stays small.
+ *
+ * The scanner keeps no pointers into the data, so chunks can come from any
+ * buffer and be discarded right after jpeg_scan_feed().
+ */
+
+#ifndef JPEG_SCANNER_H
+#define JPEG_SCANNER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef enum {
+    JPEG_SCAN_OK = 0,           // SOI, frame header and EOI present
+    JPEG_SCAN_EMPTY,            // No data
+    JPEG_SCAN_NO_SOI,           // Does not start with FF D8
+    JPEG_SCAN_BAD_SEGMENT,      // Garbage between segments or invalid segment length
+    JPEG_SCAN_NO_FRAME,         // Scan data before any SOF header
+    JPEG_SCAN_TRUNCATED,        // Ended before EOI
+} jpeg_scan_status_t;
+
+typedef struct {
+    jpeg_scan_status_t status;
+    uint8_t sof;                // Frame marker (0xC0 baseline, 0xC2 progressive), 0 if none
+    uint8_t components;         // 1 = greyscale, 3 = YCbCr
+    uint16_t width;
+    uint16_t height;
+    uint32_t bytes;             // Bytes fed
+    uint32_t crc32;             // CRC32 (IEEE) of every byte fed
+    uint32_t eoi_offset;        // Bytes up to and including EOI, 0 if not seen
+    uint32_t error_offset;      // Where a structural error was found
+} jpeg_scan_result_t;
+
+// Scanner state (internal; treat as opaque)
+typedef struct {
+    uint8_t state;
+    uint8_t marker;             // Segment being skipped
+    uint8_t header[6];          // Start of the SOF segment
+    uint8_t header_len;
+    uint16_t seg_remaining;
+    bool in_scan;               // Between SOS and the next marker
+    jpeg_scan_result_t result;
+} jpeg_scan_t;
+
+/**
+ * Reset a scanner for a new image
+ */
+void jpeg_scan_init(jpeg_scan_t *scan);
+
+/**
+ * Feed the next chunk of the image
+ */
+void jpeg_scan_feed(jpeg_scan_t *scan, const uint8_t *data, size_t len);
+
+/**
+ * Get the result for everything fed so far
+ */
+void jpeg_scan_finish(const jpeg_scan_t *scan, jpeg_scan_result_t *result);
+
+/**
+ * Get display name for a scan status
+ */
+const char *jpeg_scan_status_to_string(jpeg_scan_status_t status);
+
+#endif // JPEG_SCANNER_H
@@ -0,0 +1,600 @@
+/**
+ * @file link_policy.c
+ * @brief Connection parameter / PHY / data length / MTU negotiation policy
+ */
+
+#include "link_policy.h"
+#include <string.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "host/ble_hs.h"
+#include "host/ble_gatt.h"
+#include "nimble/nimble_port.h"
+
+static const char *TAG = "link_policy";
+
+// Wait before re-requesting parameters the central rejected or was too busy for
+#define RETRY_INTERVAL_MS       2000
+#define MAX_RETRIES             3
+
+typedef struct {
+    uint16_t itvl_min_ms;
+    uint16_t itvl_max_ms;
+    uint16_t latency;
+    uint16_t timeout_ms;
+} link_params_t;
+
+typedef struct {
+    link_params_t active;
+    link_params_t idle;
+    uint8_t phy_mask;           // Preferred PHYs (BLE 5 controllers only)
+    uint16_t tx_octets;         // LE Data Length Extension request
+    uint16_t tx_time_us;
+} link_profile_t;
+
+/*
+ * Per-model profiles. Intervals respect the iOS accessory rules (min >= 15 ms
+ * and a multiple of 15, max >= min + 15 ms, itvl_max * (latency + 1) <= 2 s,
+ * timeout > 3x that). The preferred MTU comes from the model's transport
+ * profile (instax_protocol.c).
+ *
+ * The active interval is the longest that still moves one chunk within the
+ * apps' 75 ms chunk gap, at the ~4 full 251-byte packets a phone sends per
+ * connection event: a 900-byte Mini/Wide chunk is 4 packets, one event, so
+ * 30-45 ms is enough; a 1808-byte Square chunk is 8 packets, two events, so
+ * it needs 15-30 ms. Wide idles longer since its sessions are mostly idle
+ * between (larger, slower) prints. Data length and PHY are the link-layer
+ * maximum for every model - a smaller packet never helps throughput.
+ */
+static const link_profile_t s_profiles[] = {
+    [INSTAX_MODEL_MINI] = {
+        .active = { .itvl_min_ms = 30, .itvl_max_ms = 45, .latency = 0, .timeout_ms = 4000 },
+        .idle   = { .itvl_min_ms = 120, .itvl_max_ms = 180, .latency = 4, .timeout_ms = 5000 },
+        .phy_mask = BLE_GAP_LE_PHY_2M_MASK | BLE_GAP_LE_PHY_1M_MASK,
+        .tx_octets = 251, .tx_time_us = 2120,
+    },
+    [INSTAX_MODEL_SQUARE] = {
+        .active = { .itvl_min_ms = 15, .itvl_max_ms = 30, .latency = 0, .timeout_ms = 4000 },
+        .idle   = { .itvl_min_ms = 120, .itvl_max_ms = 180, .latency = 4, .timeout_ms = 5000 },
+        .phy_mask = BLE_GAP_LE_PHY_2M_MASK | BLE_GAP_LE_PHY_1M_MASK,
+        .tx_octets = 251, .tx_time_us = 2120,
+    },
+    [INSTAX_MODEL_WIDE] = {
+        .active = { .itvl_min_ms = 30, .itvl_max_ms = 45, .latency = 0, .timeout_ms = 4000 },
+        .idle   = { .itvl_min_ms = 150, .itvl_max_ms = 240, .latency = 4, .timeout_ms = 6000 },
+        .phy_mask = BLE_GAP_LE_PHY_2M_MASK | BLE_GAP_LE_PHY_1M_MASK,
+        .tx_octets = 251, .tx_time_us = 2120,
+    },
+};
+
+#define PROFILE_COUNT (sizeof(s_profiles) / sizeof(s_profiles[0]))
+
+// One entry per connection NimBLE can hold
+#define MAX_CONNS   CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+
+typedef struct {
+    uint16_t conn_handle;               // BLE_HS_CONN_HANDLE_NONE = entry unused
+    instax_model_t model;
+    const link_profile_t *profile;
+    uint32_t connected_seq;             // Connect order, newest reported by get_stats
+
+    // Shared with console/HTTP readers and print start/finish (s_lock)
+    link_policy_state_t state;          // Parameters in force
+    link_policy_state_t target_state;
+    bool print_active;
+    uint16_t conn_itvl;
+    uint16_t conn_latency;
+    uint16_t supervision_timeout;
+    uint8_t tx_phy;
+    uint8_t rx_phy;
+    uint16_t max_tx_octets;
+    uint16_t max_tx_time;
+    uint16_t max_rx_octets;
+    uint16_t mtu;
+
+    // Host task only
+    link_policy_state_t requested_state;
+    bool update_pending;
+    int retries;
+    struct ble_npl_event apply_event;
+    struct ble_npl_callout idle_callout;
+    struct ble_npl_callout retry_callout;
+} link_conn_t;
+
+// Shared with console/HTTP readers
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static link_policy_stats_t s_stats = { .conn_handle = BLE_HS_CONN_HANDLE_NONE };  // Counters only
+static link_policy_event_t s_history[LINK_POLICY_HISTORY_SIZE];
+static link_conn_t s_conns[MAX_CONNS];
+static uint32_t s_connect_seq = 0;
+
+static bool s_initialized = false;
+
+/**
+ * Tracked connection for a handle (caller holds s_lock or runs on the host task)
+ */
+static link_conn_t *find_conn(uint16_t conn_handle) {
+    if (conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+        return NULL;
+    }
+    for (int i = 0; i < MAX_CONNS; i++) {
+        if (s_conns[i].conn_handle == conn_handle) {
+            return &s_conns[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Append an event built from the connection's current values (caller holds s_lock)
+ */
+static void record_event_locked(const link_conn_t *c, link_event_kind_t kind, link_policy_state_t state,
+                                int status) {
+    link_policy_event_t *ev = &s_history[s_stats.events_total % LINK_POLICY_HISTORY_SIZE];
+    ev->timestamp_ms = esp_log_timestamp();
+    ev->conn_handle = c->conn_handle;
+    ev->kind = kind;
+    ev->state = state;
+    ev->status = (int16_t)status;
+    ev->conn_itvl = c->conn_itvl;
+    ev->conn_latency = c->conn_latency;
+    ev->supervision_timeout = c->supervision_timeout;
+    ev->max_tx_octets = c->max_tx_octets;
+    ev->mtu = c->mtu;
+    ev->tx_phy = c->tx_phy;
+    ev->rx_phy = c->rx_phy;
+    s_stats.events_total++;
+}
+
+/**
+ * Refresh interval/latency/timeout from the controller's view of the connection
+ */
+static bool read_conn_params(link_conn_t *c) {
+    struct ble_gap_conn_desc desc;
+    if (ble_gap_conn_find(c->conn_handle, &desc) != 0) {
+        return false;
+    }
+    portENTER_CRITICAL(&s_lock);
+    c->conn_itvl = desc.conn_itvl;
+    c->conn_latency = desc.conn_latency;
+    c->supervision_timeout = desc.supervision_timeout;
+    portEXIT_CRITICAL(&s_lock);
+    return true;
+}
+
+static void schedule_retry(link_conn_t *c) {
+    if (c->retries < MAX_RETRIES) {
+        c->retries++;
+        ble_npl_callout_reset(&c->retry_callout, ble_npl_time_ms_to_ticks32(RETRY_INTERVAL_MS));
+    } else {
+        ESP_LOGW(TAG, "Giving up on %s parameters for connection %u after %d retries",
+                 link_policy_state_to_string(c->requested_state), c->conn_handle, MAX_RETRIES);
+    }
+}
+
+/**
+ * Request the parameters for the connection's target state if they are not
+ * already in force. Runs on the NimBLE host task only.
+ */
+static void apply_state(link_conn_t *c) {
+    uint16_t conn_handle;
+    link_policy_state_t target;
+    link_policy_state_t current;
+
+    portENTER_CRITICAL(&s_lock);
+    conn_handle = c->conn_handle;
+    target = c->target_state;
+    current = c->state;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (conn_handle == BLE_HS_CONN_HANDLE_NONE || target == LINK_POLICY_STATE_NONE) {
+        return;
+    }
+    if (c->update_pending) {
+        // CONN_UPDATE will call back in here once the current procedure ends
+        return;
+    }
+    if (target == current && c->requested_state == target) {
+        return;
+    }
+    if (target != c->requested_state) {
+        c->retries = 0;
+    }
+
+    const link_params_t *p = (target == LINK_POLICY_STATE_ACTIVE) ? &c->profile->active : &c->profile->idle;
+    struct ble_gap_upd_params params = {
+        .itvl_min = BLE_GAP_CONN_ITVL_MS(p->itvl_min_ms),
+        .itvl_max = BLE_GAP_CONN_ITVL_MS(p->itvl_max_ms),
+        .latency = p->latency,
+        .supervision_timeout = BLE_GAP_SUPERVISION_TIMEOUT_MS(p->timeout_ms),
+        .min_ce_len = 0,
+        .max_ce_len = 0,
+    };
+
+    c->requested_state = target;
+    int rc = ble_gap_update_params(conn_handle, &params);
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.param_requests++;
+    if (rc != 0) {
+        s_stats.param_failures++;
+    }
+    record_event_locked(c, LINK_EVENT_PARAMS_REQUESTED, target, rc);
+    portEXIT_CRITICAL(&s_lock);
+
+    if (rc == 0) {
+        c->update_pending = true;
+        ESP_LOGI(TAG, "🔗 Requested %s link for connection %u: %u-%u ms, latency %u, timeout %u ms",
+                 link_policy_state_to_string(target), conn_handle, p->itvl_min_ms, p->itvl_max_ms,
+                 p->latency, p->timeout_ms);
+    } else {
+        ESP_LOGW(TAG, "Connection parameter request failed: %d", rc);
+        schedule_retry(c);
+    }
+}
+
+static void apply_event_cb(struct ble_npl_event *ev) {
+    apply_state((link_conn_t *)ble_npl_event_get_arg(ev));
+}
+
+static void idle_timeout_cb(struct ble_npl_event *ev) {
+    link_conn_t *c = (link_conn_t *)ble_npl_event_get_arg(ev);
+
+    portENTER_CRITICAL(&s_lock);
+    bool go_idle = !c->print_active && c->conn_handle != BLE_HS_CONN_HANDLE_NONE;
+    if (go_idle) {
+        c->target_state = LINK_POLICY_STATE_IDLE;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (go_idle) {
+        apply_state(c);
+    }
+}
+
+static int mtu_exchange_cb(uint16_t conn_handle, const struct ble_gatt_error *error,
+                           uint16_t mtu, void *arg) {
+    // The negotiated value is recorded from BLE_GAP_EVENT_MTU
+    if (error->status != 0 && error->status != BLE_HS_EALREADY) {
+        ESP_LOGW(TAG, "MTU exchange failed: %d", error->status);
+    }
+    return 0;
+}
+
+esp_err_t link_policy_init(void) {
+    for (int i = 0; i < MAX_CONNS; i++) {
+        link_conn_t *c = &s_conns[i];
+        c->conn_handle = BLE_HS_CONN_HANDLE_NONE;
+        ble_npl_event_init(&c->apply_event, apply_event_cb, c);
+        ble_npl_callout_init(&c->idle_callout, nimble_port_get_dflt_eventq(), idle_timeout_cb, c);
+        ble_npl_callout_init(&c->retry_callout, nimble_port_get_dflt_eventq(), apply_event_cb, c);
+    }
+    s_initialized = true;
+    return ESP_OK;
+}
+
+void link_policy_on_connect(uint16_t conn_handle, instax_model_t model) {
+    if (!s_initialized) {
+        return;
+    }
+
+    link_conn_t *c = NULL;
+    for (int i = 0; c == NULL && i < MAX_CONNS; i++) {
+        if (s_conns[i].conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+            c = &s_conns[i];
+        }
+    }
+    if (c == NULL) {
+        ESP_LOGW(TAG, "No policy entry for connection %u", conn_handle);
+        return;
+    }
+
+    if ((size_t)model >= PROFILE_COUNT) {
+        model = INSTAX_MODEL_MINI;
+    }
+    c->model = model;
+    c->profile = &s_profiles[model];
+    c->requested_state = LINK_POLICY_STATE_NONE;
+    c->update_pending = false;
+    c->retries = 0;
+
+    portENTER_CRITICAL(&s_lock);
+    c->conn_handle = conn_handle;
+    c->connected_seq = s_connect_seq++;
+    c->state = LINK_POLICY_STATE_NONE;
+    c->tx_phy = BLE_GAP_LE_PHY_1M;
+    c->rx_phy = BLE_GAP_LE_PHY_1M;
+    c->max_tx_octets = 27;      // LL defaults until DLE completes
+    c->max_tx_time = 328;
+    c->max_rx_octets = 27;
+    c->mtu = 23;
+    c->target_state = LINK_POLICY_STATE_ACTIVE;
+    c->print_active = false;
+    portEXIT_CRITICAL(&s_lock);
+
+    read_conn_params(c);
+    portENTER_CRITICAL(&s_lock);
+    record_event_locked(c, LINK_EVENT_CONNECTED, LINK_POLICY_STATE_NONE, 0);
+    portEXIT_CRITICAL(&s_lock);
+
+    ESP_LOGI(TAG, "🔗 Connection %u: interval %u x 1.25 ms, latency %u, timeout %u x 10 ms",
+             conn_handle, c->conn_itvl, c->conn_latency, c->supervision_timeout);
+
+    // Larger link-layer packets: one ATT write per radio packet instead of ~10
+    int rc = ble_gap_set_data_len(conn_handle, c->profile->tx_octets, c->profile->tx_time_us);
+    if (rc != 0) {
+        ESP_LOGW(TAG, "Data length request failed: %d", rc);
+    }
+
+#if CONFIG_BT_NIMBLE_50_FEATURE_SUPPORT
+    rc = ble_gap_set_prefered_le_phy(conn_handle, c->profile->phy_mask, c->profile->phy_mask,
+                                     BLE_GAP_LE_PHY_CODED_ANY);
+    if (rc != 0) {
+        ESP_LOGW(TAG, "PHY request failed: %d", rc);
+    }
+#endif
+
+    ble_att_set_preferred_mtu(instax_get_model_info(model)->preferred_mtu);
+    rc = ble_gattc_exchange_mtu(conn_handle, mtu_exchange_cb, NULL);
+    if (rc != 0 && rc != BLE_HS_EALREADY) {
+        ESP_LOGW(TAG, "MTU exchange request failed: %d", rc);
+    }
+
+    // Fast link for discovery and the INFO burst; relax if no print follows
+    apply_state(c);
+    ble_npl_callout_reset(&c->idle_callout, ble_npl_time_ms_to_ticks32(LINK_POLICY_IDLE_DELAY_MS));
+}
+
+void link_policy_on_disconnect(uint16_t conn_handle) {
+    if (!s_initialized) {
+        return;
+    }
+
+    link_conn_t *c = find_conn(conn_handle);
+    if (c == NULL) {
+        return;
+    }
+
+    ble_npl_callout_stop(&c->idle_callout);
+    ble_npl_callout_stop(&c->retry_callout);
+    c->requested_state = LINK_POLICY_STATE_NONE;
+    c->update_pending = false;
+
+    portENTER_CRITICAL(&s_lock);
+    c->conn_handle = BLE_HS_CONN_HANDLE_NONE;
+    c->state = LINK_POLICY_STATE_NONE;
+    c->target_state = LINK_POLICY_STATE_NONE;
+    c->print_active = false;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void link_policy_on_gap_event(const struct ble_gap_event *event) {
+    if (!s_initialized) {
+        return;
+    }
+
+    link_conn_t *c;
+    switch (event->type) {
+        case BLE_GAP_EVENT_CONN_UPDATE: {
+            c = find_conn(event->conn_update.conn_handle);
+            if (c == NULL) {
+                break;
+            }
+            bool ours = c->update_pending;
+            c->update_pending = false;
+            read_conn_params(c);
+
+            portENTER_CRITICAL(&s_lock);
+            if (event->conn_update.status == 0) {
+                s_stats.param_updates++;
+                if (ours) {
+                    c->state = c->requested_state;
+                }
+            } else {
+                s_stats.param_failures++;
+            }
+            record_event_locked(c, LINK_EVENT_PARAMS_UPDATED, c->state, event->conn_update.status);
+            portEXIT_CRITICAL(&s_lock);
+
+            ESP_LOGI(TAG, "🔗 Link parameters %s for connection %u: interval %u x 1.25 ms, latency %u, "
+                     "timeout %u x 10 ms (status %d)",
+                     event->conn_update.status == 0 ? "updated" : "unchanged", c->conn_handle,
+                     c->conn_itvl, c->conn_latency, c->supervision_timeout,
+                     event->conn_update.status);
+
+            if (ours && event->conn_update.status != 0) {
+                schedule_retry(c);
+            } else {
+                // The state may have moved on while the procedure was running
+                apply_state(c);
+            }
+            break;
+        }
+
+        case BLE_GAP_EVENT_CONN_UPDATE_REQ: {
+            c = find_conn(event->conn_update_req.conn_handle);
+            if (c == NULL) {
+                break;
+            }
+            // Accept the central's proposal as-is; the result arrives as CONN_UPDATE
+            const struct ble_gap_upd_params *peer = event->conn_update_req.peer_params;
+            portENTER_CRITICAL(&s_lock);
+            s_stats.peer_requests++;
+            record_event_locked(c, LINK_EVENT_PEER_REQUEST, c->state, 0);
+            portEXIT_CRITICAL(&s_lock);
+            if (peer != NULL) {
+                ESP_LOGI(TAG, "🔗 Central proposed interval %u-%u x 1.25 ms, latency %u",
+                         peer->itvl_min, peer->itvl_max, peer->latency);
+            }
+            break;
+        }
+
+        case BLE_GAP_EVENT_PHY_UPDATE_COMPLETE:
+            c = find_conn(event->phy_updated.conn_handle);
+            if (c == NULL) {
+                break;
+            }
+            portENTER_CRITICAL(&s_lock);
+            if (event->phy_updated.status == 0) {
+                c->tx_phy = event->phy_updated.tx_phy;
+                c->rx_phy = event->phy_updated.rx_phy;
+                s_stats.phy_updates++;
+            }
+            record_event_locked(c, LINK_EVENT_PHY_UPDATED, c->state, event->phy_updated.status);
+            portEXIT_CRITICAL(&s_lock);
+            ESP_LOGI(TAG, "🔗 PHY: tx %u, rx %u (status %d)",
+                     event->phy_updated.tx_phy, event->phy_updated.rx_phy, event->phy_updated.status);
+            break;
+
+#ifdef BLE_GAP_EVENT_DATA_LEN_CHG
+        case BLE_GAP_EVENT_DATA_LEN_CHG:
+            c = find_conn(event->data_len_chg.conn_handle);
+            if (c == NULL) {
+                break;
+            }
+            portENTER_CRITICAL(&s_lock);
+            c->max_tx_octets = event->data_len_chg.max_tx_octets;
+            c->max_tx_time = event->data_len_chg.max_tx_time;
+            c->max_rx_octets = event->data_len_chg.max_rx_octets;
+            s_stats.data_len_updates++;
+            record_event_locked(c, LINK_EVENT_DATA_LEN_UPDATED, c->state, 0);
+            portEXIT_CRITICAL(&s_lock);
+            ESP_LOGI(TAG, "🔗 Data length: tx %u octets / %u us, rx %u octets",
+                     event->data_len_chg.max_tx_octets, event->data_len_chg.max_tx_time,
+                     event->data_len_chg.max_rx_octets);
+            break;
+#endif
+
+        case BLE_GAP_EVENT_MTU:
+            c = find_conn(event->mtu.conn_handle);
+            if (c == NULL) {
+                break;
+            }
+            portENTER_CRITICAL(&s_lock);
+            c->mtu = event->mtu.value;
+            s_stats.mtu_updates++;
+            record_event_locked(c, LINK_EVENT_MTU_UPDATED, c->state, 0);
+            portEXIT_CRITICAL(&s_lock);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void link_policy_print_started(uint16_t conn_handle) {
+    if (!s_initialized) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    link_conn_t *c = find_conn(conn_handle);
+    if (c != NULL) {
+        c->print_active = true;
+        c->target_state = LINK_POLICY_STATE_ACTIVE;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (c == NULL) {
+        return;
+    }
+
+    ble_npl_callout_stop(&c->idle_callout);
+    ble_npl_eventq_put(nimble_port_get_dflt_eventq(), &c->apply_event);
+}
+
+void link_policy_print_finished(uint16_t conn_handle) {
+    if (!s_initialized) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    link_conn_t *c = find_conn(conn_handle);
+    if (c != NULL) {
+        c->print_active = false;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (c == NULL) {
+        return;
+    }
+
+    ble_npl_callout_reset(&c->idle_callout, ble_npl_time_ms_to_ticks32(LINK_POLICY_IDLE_DELAY_MS));
+}
+
+void link_policy_get_stats(link_policy_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    memcpy(stats, &s_stats, sizeof(*stats));
+
+    // Link values of the newest connection
+    const link_conn_t *newest = NULL;
+    for (int i = 0; i < MAX_CONNS; i++) {
+        const link_conn_t *c = &s_conns[i];
+        if (c->conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+            continue;
+        }
+        stats->connections++;
+        if (newest == NULL || (int32_t)(c->connected_seq - newest->connected_seq) > 0) {
+            newest = c;
+        }
+    }
+    if (newest != NULL) {
+        stats->conn_handle = newest->conn_handle;
+        stats->state = newest->state;
+        stats->model = newest->model;
+        stats->conn_itvl = newest->conn_itvl;
+        stats->conn_latency = newest->conn_latency;
+        stats->supervision_timeout = newest->supervision_timeout;
+        stats->tx_phy = newest->tx_phy;
+        stats->rx_phy = newest->rx_phy;
+        stats->max_tx_octets = newest->max_tx_octets;
+        stats->max_tx_time = newest->max_tx_time;
+        stats->max_rx_octets = newest->max_rx_octets;
+        stats->mtu = newest->mtu;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+size_t link_policy_get_history(link_policy_event_t *events, size_t max_events) {
+    if (events == NULL || max_events == 0) {
+        return 0;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    uint32_t total = s_stats.events_total;
+    uint32_t count = total < LINK_POLICY_HISTORY_SIZE ? total : LINK_POLICY_HISTORY_SIZE;
+    if (count > max_events) {
+        count = max_events;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        events[i] = s_history[(total - count + i) % LINK_POLICY_HISTORY_SIZE];
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    return count;
+}
+
+const char *link_policy_state_to_string(link_policy_state_t state) {
+    switch (state) {
+        case LINK_POLICY_STATE_ACTIVE: return "active";
+        case LINK_POLICY_STATE_IDLE:   return "idle";
+        default:                       return "none";
+    }
+}
+
+const char *link_policy_event_to_string(link_event_kind_t kind) {
+    switch (kind) {
+        case LINK_EVENT_CONNECTED:          return "connected";
+        case LINK_EVENT_PARAMS_REQUESTED:   return "params_requested";
+        case LINK_EVENT_PARAMS_UPDATED:     return "params_updated";
+        case LINK_EVENT_PEER_REQUEST:       return "peer_request";
+        case LINK_EVENT_PHY_UPDATED:        return "phy_updated";
+        case LINK_EVENT_DATA_LEN_UPDATED:   return "data_len_updated";
+        case LINK_EVENT_MTU_UPDATED:        return "mtu_updated";
+        default:                            return "unknown";
+    }
+}
@@ -0,0 +1,149 @@
+/**
+ * @file link_policy.h
+ * @brief Connection parameter / PHY / data length / MTU negotiation policy
+ *
+ * Image upload time is dominated by the link layer: how often the central
+ * polls us (connection interval), how many bytes fit in one radio packet
+ * (LE Data Length Extension), the symbol rate (PHY) and the ATT MTU. After
+ * BLE_GAP_EVENT_CONNECT the policy asks the central for the values in the
+ * per-model profile:
+ *   - ACTIVE: short interval, no slave latency - used while the app sets up
+ *             the connection and for the whole print session
+ *   - IDLE:   long interval with slave latency - applied a few seconds after
+ *             the last print session ends, to save power while connected
+ *
+ * The central has the final say; whatever it grants is recorded, along with
+ * every request and (re)negotiation, in a small history ring.
+ *
+ * Each connection has its own profile, state and timers, keyed by its
+ * connection handle; calls for handles the policy does not track are
+ * ignored. All NimBLE calls are made on the host task.
+ */
+
+#ifndef LINK_POLICY_H
+#define LINK_POLICY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "host/ble_gap.h"
+#include "instax_protocol.h"
+
+// Negotiation events kept for the status API
+#define LINK_POLICY_HISTORY_SIZE        16
+
+// Time after a print session ends before the link is relaxed
+#define LINK_POLICY_IDLE_DELAY_MS       5000
+
+typedef enum {
+    LINK_POLICY_STATE_NONE = 0,     // Not connected
+    LINK_POLICY_STATE_ACTIVE = 1,   // Fast interval (setup / print session)
+    LINK_POLICY_STATE_IDLE = 2,     // Relaxed interval (connected, no print)
+} link_policy_state_t;
+
+typedef enum {
+    LINK_EVENT_CONNECTED = 0,       // Initial parameters chosen by the central
+    LINK_EVENT_PARAMS_REQUESTED,    // We asked for a connection parameter update
+    LINK_EVENT_PARAMS_UPDATED,      // Connection parameters changed (or update failed)
+    LINK_EVENT_PEER_REQUEST,        // Central proposed new parameters
+    LINK_EVENT_PHY_UPDATED,
+    LINK_EVENT_DATA_LEN_UPDATED,
+    LINK_EVENT_MTU_UPDATED,
+} link_event_kind_t;
+
+// Snapshot of the link after a negotiation event
+typedef struct {
+    uint32_t timestamp_ms;
+    uint16_t conn_handle;
+    uint8_t kind;                   // link_event_kind_t
+    uint8_t state;                  // link_policy_state_t in force when recorded
+    int16_t status;                 // 0 = success, NimBLE error otherwise
+    uint16_t conn_itvl;             // 1.25 ms units
+    uint16_t conn_latency;
+    uint16_t supervision_timeout;   // 10 ms units
+    uint16_t max_tx_octets;
+    uint16_t mtu;
+    uint8_t tx_phy;
+    uint8_t rx_phy;
+} link_policy_event_t;
+
+// Link values of the newest connection and negotiation counters (all
+// connections, since boot)
+typedef struct {
+    uint8_t connections;            // Connections tracked
+    uint16_t conn_handle;           // Newest connection, BLE_HS_CONN_HANDLE_NONE if none
+    link_policy_state_t state;
+    instax_model_t model;           // Profile in use
+    uint16_t conn_itvl;             // 1.25 ms units
+    uint16_t conn_latency;
+    uint16_t supervision_timeout;   // 10 ms units
+    uint8_t tx_phy;                 // BLE_GAP_LE_PHY_1M / BLE_GAP_LE_PHY_2M / coded
+    uint8_t rx_phy;
+    uint16_t max_tx_octets;
+    uint16_t max_tx_time;           // us
+    uint16_t max_rx_octets;
+    uint16_t mtu;
+    uint32_t param_requests;        // Updates we requested
+    uint32_t param_updates;         // Parameter changes applied by the controller
+    uint32_t param_failures;        // Rejected / failed update procedures
+    uint32_t peer_requests;         // Updates proposed by the central
+    uint32_t phy_updates;
+    uint32_t data_len_updates;
+    uint32_t mtu_updates;
+    uint32_t events_total;          // Events recorded (history keeps the newest)
+} link_policy_stats_t;
+
+/**
+ * Initialize the policy engine (call after nimble_port_init())
+ */
+esp_err_t link_policy_init(void);
+
+/**
+ * A connection was established (host task, BLE_GAP_EVENT_CONNECT)
+ * Records the initial parameters and starts negotiation for the model's profile.
+ */
+void link_policy_on_connect(uint16_t conn_handle, instax_model_t model);
+
+/**
+ * The connection was dropped (host task, BLE_GAP_EVENT_DISCONNECT)
+ */
+void link_policy_on_disconnect(uint16_t conn_handle);
+
+/**
+ * Feed link-related GAP events (CONN_UPDATE, CONN_UPDATE_REQ,
+ * PHY_UPDATE_COMPLETE, DATA_LEN_CHG, MTU) to the policy (host task)
+ */
+void link_policy_on_gap_event(const struct ble_gap_event *event);
+
+/**
+ * A print session started on a connection - switch to the ACTIVE profile (any task)
+ */
+void link_policy_print_started(uint16_t conn_handle);
+
+/**
+ * A print session ended on a connection - relax to IDLE after
+ * LINK_POLICY_IDLE_DELAY_MS (any task)
+ */
+void link_policy_print_finished(uint16_t conn_handle);
+
+/**
+ * Get current link values and counters
+ */
+void link_policy_get_stats(link_policy_stats_t *stats);
+
+/**
+ * Copy the negotiation history, oldest first
+ * @param events Output array
+ * @param max_events Capacity of events
+ * @return Number of entries written
+ */
+size_t link_policy_get_history(link_policy_event_t *events, size_t max_events);
+
+/**
+ * Get display name for a state / event kind
+ */
+const char *link_policy_state_to_string(link_policy_state_t state);
+const char *link_policy_event_to_string(link_event_kind_t kind);
+
+#endif // LINK_POLICY_H
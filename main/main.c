@@ -24,6 +24,7 @@
 #include "web_server.h"
 #include "console.h"
 #include "printer_emulator.h"
+#include "print_pool.h"
 
 static const char *TAG = "main";
 
@@ -86,6 +87,12 @@ void app_main(void) {
     ESP_ERROR_CHECK(ret);
     ESP_LOGI(TAG, "NVS initialized");
 
+    // Reserve the print buffers before WiFi/BLE start carving up the heap
+    ret = print_pool_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to reserve print buffer pool - prints will be rejected");
+    }
+
     // Create event group
     s_wifi_event_group = xEventGroupCreate();
 
@@ -150,7 +157,12 @@ void app_main(void) {
         static int counter = 0;
         if (++counter >= 60) {  // Every 60 seconds
             counter = 0;
-            ESP_LOGI(TAG, "Free heap: %d bytes", esp_get_free_heap_size());
+            print_pool_sample_heap();
+            print_pool_stats_t pool;
+            print_pool_get_stats(&pool);
+            ESP_LOGI(TAG, "Free heap: %lu bytes (largest block %lu, print slots %lu/%lu)",
+                     (unsigned long)pool.free_bytes, (unsigned long)pool.largest_free_block,
+                     (unsigned long)pool.in_use, (unsigned long)pool.slots);
         }
 
         vTaskDelay(pdMS_TO_TICKS(1000));
@@ -0,0 +1,318 @@
+/**
+ * @file notify_queue.c
+ * @brief Non-blocking outbound notification/indication scheduler
+ */
+
+#include "notify_queue.h"
+#include "print_telemetry.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "host/ble_hs.h"
+#include "host/ble_gatt.h"
+#include "nimble/nimble_port.h"
+
+static const char *TAG = "notify_queue";
+
+// Status traffic is held back while fewer mbufs than this are free,
+// leaving them for incoming PRINT_DATA writes and ACKs
+#define STATUS_MIN_FREE_MBUFS   4
+
+// Fallback retry when no NOTIFY_TX completion is pending to wake us
+#define RETRY_INTERVAL_MS       10
+
+typedef struct {
+    uint16_t conn_handle;
+    uint16_t attr_handle;
+    uint16_t len;
+    uint8_t indicate;
+    uint8_t attempts;
+    uint8_t dead;           // Connection went away - skipped by drain()
+    uint32_t queued_us;     // Low 32 bits of esp_timer_get_time() at enqueue
+    uint8_t data[NOTIFY_QUEUE_MAX_LEN];
+} notify_entry_t;
+
+typedef struct {
+    notify_entry_t entries[NOTIFY_QUEUE_DEPTH];
+    uint32_t head;  // Next entry to fill (producers, under s_lock)
+    uint32_t tail;  // Next entry to send (host task)
+} notify_ring_t;
+
+_Static_assert((NOTIFY_QUEUE_DEPTH & (NOTIFY_QUEUE_DEPTH - 1)) == 0, "NOTIFY_QUEUE_DEPTH must be a power of two");
+
+#define ENTRY_INDEX(n) ((n) & (NOTIFY_QUEUE_DEPTH - 1))
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static notify_ring_t s_rings[NOTIFY_CLASS_COUNT];
+static notify_queue_stats_t s_stats = {0};
+
+// Host task only
+static struct os_mbuf *s_reserve[NOTIFY_QUEUE_RESERVE_MBUFS];
+static int s_reserve_count = 0;
+static struct ble_npl_event s_drain_event;
+static struct ble_npl_callout s_retry_callout;
+static bool s_initialized = false;
+
+/**
+ * Keep the ACK reserve topped up, but never at the expense of a starved pool
+ */
+static void refill_reserve(void) {
+    while (s_reserve_count < NOTIFY_QUEUE_RESERVE_MBUFS &&
+           os_msys_num_free() > STATUS_MIN_FREE_MBUFS) {
+        struct os_mbuf *om = ble_hs_mbuf_att_pkt();
+        if (om == NULL) {
+            break;
+        }
+        s_reserve[s_reserve_count++] = om;
+    }
+}
+
+/**
+ * Build the mbuf for an entry
+ * @return mbuf, or NULL if none is available for this class
+ */
+static struct os_mbuf *entry_to_mbuf(const notify_entry_t *entry, notify_class_t cls, bool *from_reserve) {
+    *from_reserve = false;
+
+    struct os_mbuf *om = ble_hs_mbuf_from_flat(entry->data, entry->len);
+    if (om != NULL || cls != NOTIFY_CLASS_ACK || s_reserve_count == 0) {
+        return om;
+    }
+
+    om = s_reserve[--s_reserve_count];
+    if (os_mbuf_append(om, entry->data, entry->len) != 0) {
+        os_mbuf_free_chain(om);
+        return NULL;
+    }
+    *from_reserve = true;
+    return om;
+}
+
+static bool is_retryable(int rc) {
+    return rc == BLE_HS_ENOMEM || rc == BLE_HS_EBUSY || rc == BLE_HS_EALREADY;
+}
+
+/**
+ * Pop the head entry of a ring (host task)
+ */
+static void ring_pop(notify_ring_t *ring) {
+    portENTER_CRITICAL(&s_lock);
+    ring->tail++;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * Get the head entry of a ring without removing it (host task)
+ * Entries flushed for a closed connection are popped on the way.
+ */
+static notify_entry_t *ring_peek(notify_ring_t *ring) {
+    portENTER_CRITICAL(&s_lock);
+    while (ring->head != ring->tail && ring->entries[ENTRY_INDEX(ring->tail)].dead) {
+        ring->tail++;
+    }
+    notify_entry_t *entry = (ring->head != ring->tail) ? &ring->entries[ENTRY_INDEX(ring->tail)] : NULL;
+    portEXIT_CRITICAL(&s_lock);
+    return entry;
+}
+
+static void record_sent(const notify_entry_t *entry, notify_class_t cls, bool from_reserve) {
+    portENTER_CRITICAL(&s_lock);
+    if (cls == NOTIFY_CLASS_ACK) {
+        s_stats.acks_sent++;
+        if (from_reserve) {
+            s_stats.acks_from_reserve++;
+        }
+    } else {
+        s_stats.status_sent++;
+    }
+    uint32_t acks_sent = s_stats.acks_sent;
+    portEXIT_CRITICAL(&s_lock);
+
+    // PRINT_DATA ACKs: periodic logging to track progress without flooding
+    bool is_data_ack = (entry->len >= 6 && entry->data[4] == 0x10 && entry->data[5] == 0x01);
+    if (cls == NOTIFY_CLASS_ACK && is_data_ack) {
+        print_telemetry_record_ack((uint32_t)esp_timer_get_time() - entry->queued_us, entry->attempts);
+    }
+    if (cls == NOTIFY_CLASS_ACK && is_data_ack && (acks_sent % 10 == 0 || entry->attempts > 0)) {
+        ESP_LOGI(TAG, "✅ DATA ACK #%lu sent%s", (unsigned long)acks_sent,
+                 entry->attempts > 0 ? " (after retry)" : "");
+    }
+}
+
+/**
+ * Transmit queued entries until the queues are empty or the host runs out of buffers
+ * Runs on the NimBLE host task only.
+ */
+static void drain(void) {
+    refill_reserve();
+
+    while (true) {
+        notify_class_t cls = NOTIFY_CLASS_ACK;
+        notify_entry_t *entry = ring_peek(&s_rings[NOTIFY_CLASS_ACK]);
+
+        if (entry == NULL) {
+            cls = NOTIFY_CLASS_STATUS;
+            entry = ring_peek(&s_rings[NOTIFY_CLASS_STATUS]);
+            if (entry == NULL) {
+                return;
+            }
+            if (os_msys_num_free() <= STATUS_MIN_FREE_MBUFS) {
+                // Leave the remaining buffers to ACKs and incoming data
+                portENTER_CRITICAL(&s_lock);
+                s_stats.status_deferred++;
+                portEXIT_CRITICAL(&s_lock);
+                ble_npl_callout_reset(&s_retry_callout, ble_npl_time_ms_to_ticks32(RETRY_INTERVAL_MS));
+                return;
+            }
+        }
+
+        bool from_reserve;
+        int rc;
+        struct os_mbuf *om = entry_to_mbuf(entry, cls, &from_reserve);
+        if (om == NULL) {
+            rc = BLE_HS_ENOMEM;
+        } else if (entry->indicate) {
+            rc = ble_gatts_indicate_custom(entry->conn_handle, entry->attr_handle, om);
+        } else {
+            rc = ble_gatts_notify_custom(entry->conn_handle, entry->attr_handle, om);
+        }
+        // Note: om is consumed by NimBLE on success and failure
+
+        if (rc == 0) {
+            record_sent(entry, cls, from_reserve);
+            ring_pop(&s_rings[cls]);
+            continue;
+        }
+
+        if (is_retryable(rc)) {
+            // Keep the entry at the head; NOTIFY_TX or the callout will drain again
+            entry->attempts++;
+            if (cls == NOTIFY_CLASS_ACK) {
+                portENTER_CRITICAL(&s_lock);
+                s_stats.acks_retried++;
+                portEXIT_CRITICAL(&s_lock);
+                ESP_LOGW(TAG, "⚠️ ACK deferred: no buffers (attempt %d, rc=%d)", entry->attempts, rc);
+            }
+            ble_npl_callout_reset(&s_retry_callout, ble_npl_time_ms_to_ticks32(RETRY_INTERVAL_MS));
+            return;
+        }
+
+        // Hard failure (e.g. connection gone) - drop it
+        portENTER_CRITICAL(&s_lock);
+        if (cls == NOTIFY_CLASS_ACK) {
+            s_stats.acks_failed++;
+        } else {
+            s_stats.status_failed++;
+        }
+        portEXIT_CRITICAL(&s_lock);
+        ESP_LOGE(TAG, "❌ %s %s failed: %d (handle %d) - dropped",
+                 cls == NOTIFY_CLASS_ACK ? "ACK" : "Status",
+                 entry->indicate ? "indication" : "notification", rc, entry->attr_handle);
+        ring_pop(&s_rings[cls]);
+    }
+}
+
+static void drain_event_cb(struct ble_npl_event *ev) {
+    drain();
+}
+
+esp_err_t notify_queue_init(void) {
+    memset(s_rings, 0, sizeof(s_rings));
+    ble_npl_event_init(&s_drain_event, drain_event_cb, NULL);
+    ble_npl_callout_init(&s_retry_callout, nimble_port_get_dflt_eventq(), drain_event_cb, NULL);
+    s_initialized = true;
+
+    ESP_LOGI(TAG, "Notification queue ready (%d entries/class, %d reserved mbufs)",
+             NOTIFY_QUEUE_DEPTH, NOTIFY_QUEUE_RESERVE_MBUFS);
+    return ESP_OK;
+}
+
+esp_err_t notify_queue_send(uint16_t conn_handle, uint16_t attr_handle,
+                            const uint8_t *data, size_t len,
+                            notify_class_t cls, bool indicate) {
+    if (!s_initialized || data == NULL || len == 0 || cls >= NOTIFY_CLASS_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len > NOTIFY_QUEUE_MAX_LEN) {
+        ESP_LOGE(TAG, "Frame too large to queue (%u > %d)", (unsigned)len, NOTIFY_QUEUE_MAX_LEN);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    notify_ring_t *ring = &s_rings[cls];
+
+    portENTER_CRITICAL(&s_lock);
+    uint32_t depth = ring->head - ring->tail;
+    if (depth >= NOTIFY_QUEUE_DEPTH) {
+        s_stats.queue_full++;
+        portEXIT_CRITICAL(&s_lock);
+        ESP_LOGE(TAG, "❌ %s queue full - frame dropped", cls == NOTIFY_CLASS_ACK ? "ACK" : "Status");
+        return ESP_ERR_NO_MEM;
+    }
+    notify_entry_t *entry = &ring->entries[ENTRY_INDEX(ring->head)];
+    entry->conn_handle = conn_handle;
+    entry->attr_handle = attr_handle;
+    entry->len = (uint16_t)len;
+    entry->indicate = indicate ? 1 : 0;
+    entry->attempts = 0;
+    entry->dead = 0;
+    entry->queued_us = (uint32_t)esp_timer_get_time();
+    memcpy(entry->data, data, len);
+    ring->head++;
+    if (cls == NOTIFY_CLASS_ACK && depth + 1 > s_stats.depth_high_water) {
+        s_stats.depth_high_water = depth + 1;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    // Hand off to the host task (no-op if a drain is already queued)
+    ble_npl_eventq_put(nimble_port_get_dflt_eventq(), &s_drain_event);
+    return ESP_OK;
+}
+
+void notify_queue_on_tx_complete(void) {
+    if (s_initialized) {
+        drain();
+    }
+}
+
+void notify_queue_flush(uint16_t conn_handle) {
+    uint32_t dropped[NOTIFY_CLASS_COUNT] = {0};
+
+    portENTER_CRITICAL(&s_lock);
+    for (int cls = 0; cls < NOTIFY_CLASS_COUNT; cls++) {
+        notify_ring_t *ring = &s_rings[cls];
+        // Entries of other connections may sit in between - mark every one of
+        // this connection dead so a reused handle never receives them
+        for (uint32_t n = ring->tail; n != ring->head; n++) {
+            notify_entry_t *entry = &ring->entries[ENTRY_INDEX(n)];
+            if (!entry->dead && entry->conn_handle == conn_handle) {
+                entry->dead = 1;
+                dropped[cls]++;
+            }
+        }
+    }
+    s_stats.acks_failed += dropped[NOTIFY_CLASS_ACK];
+    s_stats.status_failed += dropped[NOTIFY_CLASS_STATUS];
+    portEXIT_CRITICAL(&s_lock);
+
+    if (dropped[NOTIFY_CLASS_ACK] > 0 || dropped[NOTIFY_CLASS_STATUS] > 0) {
+        ESP_LOGW(TAG, "Disconnected with %lu ACK(s) and %lu status frame(s) queued - dropped",
+                 (unsigned long)dropped[NOTIFY_CLASS_ACK], (unsigned long)dropped[NOTIFY_CLASS_STATUS]);
+    }
+}
+
+void notify_queue_reset_stats(void) {
+    portENTER_CRITICAL(&s_lock);
+    memset(&s_stats, 0, sizeof(s_stats));
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void notify_queue_get_stats(notify_queue_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    memcpy(stats, &s_stats, sizeof(*stats));
+    portEXIT_CRITICAL(&s_lock);
+    stats->reserve_held = s_reserve_count;
+}
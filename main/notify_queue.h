@@ -0,0 +1,95 @@
+/**
+ * @file notify_queue.h
+ * @brief Non-blocking outbound notification/indication scheduler
+ *
+ * Callers enqueue a copy of the frame and return immediately; the NimBLE
+ * host task transmits it. When the host is out of mbufs the head entry
+ * stays queued and is retried when an earlier notification completes
+ * (BLE_GAP_EVENT_NOTIFY_TX) or after a short callout, never by sleeping.
+ *
+ * Two classes share the link:
+ *   - ACK:    protocol responses - always sent first, may use a small
+ *             pool of mbufs held in reserve for them
+ *   - STATUS: unsolicited status notifications - only sent when no ACK is
+ *             waiting and the mbuf pool has headroom
+ */
+
+#ifndef NOTIFY_QUEUE_H
+#define NOTIFY_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Queued entries per class
+#define NOTIFY_QUEUE_DEPTH              8
+
+// Largest frame that can be queued (protocol responses are well below this)
+#define NOTIFY_QUEUE_MAX_LEN            64
+
+// Mbufs held back for ACK class traffic
+#define NOTIFY_QUEUE_RESERVE_MBUFS      2
+
+typedef enum {
+    NOTIFY_CLASS_ACK = 0,       // Protocol responses (Instax notify/indicate characteristic)
+    NOTIFY_CLASS_STATUS = 1,    // Unsolicited status notifications
+    NOTIFY_CLASS_COUNT
+} notify_class_t;
+
+// Scheduler statistics (per print job unless noted)
+typedef struct {
+    uint32_t acks_sent;
+    uint32_t acks_retried;      // Transmit attempts deferred for lack of buffers
+    uint32_t acks_failed;       // Dropped (disconnect or stack error)
+    uint32_t acks_from_reserve; // Sent using a reserved mbuf
+    uint32_t status_sent;
+    uint32_t status_deferred;   // Drain passes where status traffic yielded
+    uint32_t status_failed;
+    uint32_t queue_full;        // Enqueue attempts rejected (both classes)
+    uint32_t depth_high_water;  // Deepest ACK queue observed
+    uint32_t reserve_held;      // Reserved mbufs currently held (live)
+} notify_queue_stats_t;
+
+/**
+ * Initialize the scheduler (call after nimble_port_init())
+ */
+esp_err_t notify_queue_init(void);
+
+/**
+ * Queue a notification or indication
+ * @param conn_handle Connection to send on
+ * @param attr_handle Characteristic value handle
+ * @param data Frame to send (copied)
+ * @param len Frame length (max NOTIFY_QUEUE_MAX_LEN)
+ * @param cls Traffic class
+ * @param indicate true to send as an indication
+ * @return ESP_OK if queued, ESP_ERR_NO_MEM if the class queue is full
+ */
+esp_err_t notify_queue_send(uint16_t conn_handle, uint16_t attr_handle,
+                            const uint8_t *data, size_t len,
+                            notify_class_t cls, bool indicate);
+
+/**
+ * A notification/indication completed (call from BLE_GAP_EVENT_NOTIFY_TX)
+ */
+void notify_queue_on_tx_complete(void);
+
+/**
+ * Drop everything queued for a connection (call on disconnect)
+ * Entries are dropped wherever they sit in the queue, so a reused handle
+ * never receives frames meant for the previous central.
+ */
+void notify_queue_flush(uint16_t conn_handle);
+
+/**
+ * Reset per-job statistics (call at PRINT_START)
+ */
+void notify_queue_reset_stats(void);
+
+/**
+ * Get a snapshot of scheduler statistics
+ */
+void notify_queue_get_stats(notify_queue_stats_t *stats);
+
+#endif // NOTIFY_QUEUE_H
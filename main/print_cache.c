@@ -0,0 +1,356 @@
+/**
+ * @file print_cache.c
+ * @brief Whole-print RAM buffers and a cache of recently received prints
+ */
+
+#include "print_cache.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "print_writer.h"
+
+static const char *TAG = "print_cache";
+
+#define INTERNAL_CAPS   (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+
+// Cached prints, the job being received, and one dropped print still being read
+#define CACHE_SLOTS     (PRINT_CACHE_ENTRIES + 2)
+
+typedef enum {
+    SLOT_FREE = 0,
+    SLOT_RECEIVING,     // Job in progress (not visible to lookups)
+    SLOT_CACHED,        // Complete print, visible to lookups
+    SLOT_DROPPED,       // Evicted or deleted, freed once the last reader is done
+} slot_state_t;
+
+typedef struct {
+    slot_state_t state;
+    char path[64];
+    const char *name;   // File name part of path
+    uint8_t *data;
+    size_t len;
+    size_t capacity;
+    uint32_t refs;      // Readers, plus one while the save is pending
+    uint32_t last_used; // LRU tick
+    bool in_psram;
+    bool deleted;       // File deleted while the save was pending
+} cache_slot_t;
+
+static SemaphoreHandle_t s_mutex = NULL;
+static cache_slot_t s_slots[CACHE_SLOTS];
+static cache_slot_t *s_job = NULL;
+static uint32_t s_tick = 0;
+static print_cache_stats_t s_stats = {0};
+
+static uint8_t *alloc_buffer(size_t capacity, bool *in_psram) {
+#ifdef CONFIG_SPIRAM
+    uint8_t *buf = heap_caps_malloc(capacity, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (buf != NULL) {
+        *in_psram = true;
+        return buf;
+    }
+#endif
+    // Internal RAM only if WiFi and BLE keep their headroom
+    size_t free_bytes = heap_caps_get_free_size(INTERNAL_CAPS);
+    if (heap_caps_get_largest_free_block(INTERNAL_CAPS) < capacity ||
+        free_bytes < capacity + PRINT_CACHE_INTERNAL_HEADROOM) {
+        return NULL;
+    }
+    *in_psram = false;
+    return heap_caps_malloc(capacity, INTERNAL_CAPS);
+}
+
+/**
+ * Free a dropped slot once nobody references it (lock held)
+ */
+static void put_slot_locked(cache_slot_t *slot) {
+    if (slot->state == SLOT_DROPPED && slot->refs == 0) {
+        heap_caps_free(slot->data);
+        memset(slot, 0, sizeof(*slot));
+    }
+}
+
+static void drop_slot_locked(cache_slot_t *slot) {
+    if (slot->state != SLOT_CACHED) {
+        return;
+    }
+    slot->state = SLOT_DROPPED;
+    s_stats.entries--;
+    s_stats.bytes -= slot->capacity;
+    put_slot_locked(slot);
+}
+
+/**
+ * Drop the least recently used print (lock held)
+ * @param idle_only Only consider prints nobody is using, so memory is freed now
+ */
+static bool evict_lru_locked(bool idle_only) {
+    cache_slot_t *oldest = NULL;
+    for (int i = 0; i < CACHE_SLOTS; i++) {
+        cache_slot_t *slot = &s_slots[i];
+        if (slot->state != SLOT_CACHED || (idle_only && slot->refs > 0)) {
+            continue;
+        }
+        if (oldest == NULL || (int32_t)(slot->last_used - oldest->last_used) < 0) {
+            oldest = slot;
+        }
+    }
+    if (oldest == NULL) {
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Dropping %s from RAM (least recently used)", oldest->name);
+    s_stats.evictions++;
+    drop_slot_locked(oldest);
+    return true;
+}
+
+static cache_slot_t *find_cached_locked(const char *name) {
+    for (int i = 0; i < CACHE_SLOTS; i++) {
+        if (s_slots[i].state == SLOT_CACHED && strcmp(s_slots[i].name, name) == 0) {
+            return &s_slots[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t print_cache_init(void) {
+    if (s_mutex != NULL) {
+        return ESP_OK;
+    }
+    s_mutex = xSemaphoreCreateMutex();
+    if (s_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+#ifdef CONFIG_PRINT_CACHE_WHOLE_PRINT
+    s_stats.whole_print = true;
+#endif
+#ifdef CONFIG_SPIRAM
+    s_stats.psram = heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0;
+#endif
+    ESP_LOGI(TAG, "Whole-print RAM mode %s (%s, %d recent prints cached)",
+             s_stats.whole_print ? "enabled" : "disabled",
+             s_stats.psram ? "PSRAM" : "internal RAM only", PRINT_CACHE_ENTRIES);
+    return ESP_OK;
+}
+
+uint8_t *print_cache_begin(const char *path, size_t size, size_t *capacity) {
+    if (s_mutex == NULL || !s_stats.whole_print || path == NULL) {
+        return NULL;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (s_job != NULL) {
+        // Previous job was never finished or aborted
+        heap_caps_free(s_job->data);
+        memset(s_job, 0, sizeof(*s_job));
+        s_job = NULL;
+    }
+
+    cache_slot_t *slot = NULL;
+    for (int i = 0; i < CACHE_SLOTS && slot == NULL; i++) {
+        if (s_slots[i].state == SLOT_FREE) {
+            slot = &s_slots[i];
+        }
+    }
+
+    uint8_t *buf = NULL;
+    bool in_psram = false;
+    size_t cap = size + PRINT_CACHE_SLACK;
+    if (slot != NULL) {
+        buf = alloc_buffer(cap, &in_psram);
+        while (buf == NULL && evict_lru_locked(true)) {
+            buf = alloc_buffer(cap, &in_psram);
+        }
+    }
+
+    if (buf == NULL) {
+        s_stats.jobs_streamed++;
+        xSemaphoreGive(s_mutex);
+        ESP_LOGW(TAG, "No memory for a %u byte print in RAM - streaming to SPIFFS", (unsigned)size);
+        return NULL;
+    }
+
+    slot->state = SLOT_RECEIVING;
+    snprintf(slot->path, sizeof(slot->path), "%s", path);
+    const char *sep = strrchr(slot->path, '/');
+    slot->name = sep != NULL ? sep + 1 : slot->path;
+    slot->data = buf;
+    slot->len = 0;
+    slot->capacity = cap;
+    slot->refs = 0;
+    slot->in_psram = in_psram;
+    slot->deleted = false;
+    s_job = slot;
+    s_stats.jobs_in_ram++;
+    xSemaphoreGive(s_mutex);
+
+    ESP_LOGI(TAG, "Receiving print into %u byte %s buffer", (unsigned)cap, in_psram ? "PSRAM" : "RAM");
+    *capacity = cap;
+    return buf;
+}
+
+bool print_cache_job_active(void) {
+    return s_job != NULL;
+}
+
+/**
+ * Save finished (writer task)
+ */
+static void on_saved(bool ok, void *arg) {
+    cache_slot_t *slot = arg;
+    bool deleted;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (!ok) {
+        // Keep it cached - for now the RAM copy is the only one
+        s_stats.save_failures++;
+    }
+    deleted = slot->deleted;
+    if (slot->state == SLOT_CACHED && !slot->in_psram &&
+        heap_caps_get_free_size(INTERNAL_CAPS) < PRINT_CACHE_INTERNAL_HEADROOM) {
+        ESP_LOGI(TAG, "Dropping %s from RAM (internal heap low)", slot->name);
+        s_stats.evictions++;
+        drop_slot_locked(slot);
+    }
+    char path[sizeof(slot->path)];
+    memcpy(path, slot->path, sizeof(path));
+    slot->refs--;
+    put_slot_locked(slot);
+    xSemaphoreGive(s_mutex);
+
+    if (deleted && ok) {
+        // Deleted through the web UI before it reached the flash
+        remove(path);
+    }
+}
+
+esp_err_t print_cache_finish(size_t len) {
+    if (s_job == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    cache_slot_t *slot = s_job;
+    s_job = NULL;
+    slot->len = len < slot->capacity ? len : slot->capacity;
+    slot->state = SLOT_CACHED;
+    slot->last_used = ++s_tick;
+    slot->refs++;   // Held by the pending save
+    s_stats.entries++;
+    s_stats.bytes += slot->capacity;
+    while (s_stats.entries > PRINT_CACHE_ENTRIES && evict_lru_locked(false)) {
+        // The new print is freed once saved if the cache holds none
+    }
+    xSemaphoreGive(s_mutex);
+
+    esp_err_t ret = print_writer_save(slot->path, slot->data, slot->len, on_saved, slot);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to queue save of %s: %s", slot->path, esp_err_to_name(ret));
+        on_saved(false, slot);
+    }
+    return ret;
+}
+
+void print_cache_abort(void) {
+    if (s_job == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (s_job != NULL) {
+        ESP_LOGI(TAG, "Discarding unfinished print (%s never written to flash)", s_job->name);
+        heap_caps_free(s_job->data);
+        memset(s_job, 0, sizeof(*s_job));
+        s_job = NULL;
+        s_stats.jobs_aborted++;
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+const uint8_t *print_cache_acquire(const char *name, size_t *len) {
+    if (s_mutex == NULL || name == NULL) {
+        return NULL;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    cache_slot_t *slot = find_cached_locked(name);
+    const uint8_t *data = NULL;
+    if (slot != NULL) {
+        slot->refs++;
+        slot->last_used = ++s_tick;
+        data = slot->data;
+        if (len != NULL) {
+            *len = slot->len;
+        }
+        s_stats.hits++;
+    } else {
+        s_stats.misses++;
+    }
+    xSemaphoreGive(s_mutex);
+    return data;
+}
+
+void print_cache_release(const uint8_t *data) {
+    if (s_mutex == NULL || data == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (int i = 0; i < CACHE_SLOTS; i++) {
+        cache_slot_t *slot = &s_slots[i];
+        if ((slot->state == SLOT_CACHED || slot->state == SLOT_DROPPED) &&
+            slot->data == data && slot->refs > 0) {
+            slot->refs--;
+            put_slot_locked(slot);
+            break;
+        }
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+void print_cache_remove(const char *name) {
+    if (s_mutex == NULL || name == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    cache_slot_t *slot = find_cached_locked(name);
+    if (slot != NULL) {
+        slot->deleted = true;
+        drop_slot_locked(slot);
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+void print_cache_clear(void) {
+    if (s_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (int i = 0; i < CACHE_SLOTS; i++) {
+        if (s_slots[i].state == SLOT_CACHED) {
+            s_slots[i].deleted = true;
+            drop_slot_locked(&s_slots[i]);
+        }
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+void print_cache_get_stats(print_cache_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    if (s_mutex == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    memcpy(stats, &s_stats, sizeof(*stats));
+    xSemaphoreGive(s_mutex);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file print_cache.h
+ * @brief Whole-print RAM buffers and a cache of recently received prints
+ *
+ * A print is at most ~105 KB, so instead of streaming it through flash while
+ * it arrives the job can be received into one contiguous buffer (PSRAM when
+ * the board has it) and written to SPIFFS only after PRINT_EXECUTE. Aborted
+ * jobs then never touch the flash at all.
+ *
+ * Once saved, the buffer stays in a small LRU cache so the web UI can fetch a
+ * print it just received without a flash read. Cached prints are dropped when
+ * a new job needs the memory. If no buffer can be had (cache disabled in
+ * menuconfig, no PSRAM and too little internal heap) print_cache_begin()
+ * returns NULL and the job is streamed through print_writer as before.
+ *
+ * The job calls (begin/finish/abort) come from the protocol task; lookups
+ * come from the web server and may run concurrently.
+ */
+
+#ifndef PRINT_CACHE_H
+#define PRINT_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifndef CONFIG_PRINT_CACHE_ENTRIES
+#define CONFIG_PRINT_CACHE_ENTRIES              3
+#endif
+#ifndef CONFIG_PRINT_CACHE_INTERNAL_HEADROOM_KB
+#define CONFIG_PRINT_CACHE_INTERNAL_HEADROOM_KB 64
+#endif
+
+#define PRINT_CACHE_ENTRIES             CONFIG_PRINT_CACHE_ENTRIES
+#define PRINT_CACHE_INTERNAL_HEADROOM   (CONFIG_PRINT_CACHE_INTERNAL_HEADROOM_KB * 1024)
+
+// Extra room beyond the announced image size (apps pad the last chunk)
+#define PRINT_CACHE_SLACK               2048
+
+typedef struct {
+    bool whole_print;           // Whole-print mode compiled in
+    bool psram;                 // Buffers can come from PSRAM
+    uint32_t jobs_in_ram;       // Jobs received into a RAM buffer
+    uint32_t jobs_streamed;     // Jobs that fell back to streaming (no memory)
+    uint32_t jobs_aborted;      // RAM jobs discarded before PRINT_EXECUTE
+    uint32_t save_failures;     // RAM jobs that could not be written to SPIFFS
+    uint32_t hits;              // Downloads served from RAM
+    uint32_t misses;            // Downloads that had to read flash
+    uint32_t evictions;         // Cached prints dropped to make room
+    uint32_t entries;           // Prints cached right now
+    size_t bytes;               // RAM held by cached prints
+} print_cache_stats_t;
+
+/**
+ * Create the cache lock (call once at startup)
+ */
+esp_err_t print_cache_init(void);
+
+/**
+ * Start a job in RAM
+ * @param path Final SPIFFS path of the print
+ * @param size Image size announced in PRINT_START
+ * @param capacity Set to the usable buffer size
+ * @return Buffer for the whole image, or NULL to stream the job instead
+ */
+uint8_t *print_cache_begin(const char *path, size_t size, size_t *capacity);
+
+/**
+ * Whether a RAM job is being received
+ */
+bool print_cache_job_active(void);
+
+/**
+ * Finish the RAM job after PRINT_EXECUTE: queue the save to SPIFFS and keep
+ * the buffer as the most recent cache entry
+ * @param len Bytes received
+ */
+esp_err_t print_cache_finish(size_t len);
+
+/**
+ * Discard the RAM job (disconnect, error, timeout) without saving it
+ */
+void print_cache_abort(void);
+
+/**
+ * Look up a cached print by file name (e.g. "print_1234.jpg")
+ * The data stays valid until print_cache_release() is called.
+ * @param len Set to the image size
+ * @return Image data, or NULL if the print is not cached
+ */
+const uint8_t *print_cache_acquire(const char *name, size_t *len);
+
+/**
+ * Release data returned by print_cache_acquire()
+ */
+void print_cache_release(const uint8_t *data);
+
+/**
+ * Forget a print whose file is being deleted
+ */
+void print_cache_remove(const char *name);
+
+/**
+ * Forget every cached print (all files deleted)
+ */
+void print_cache_clear(void);
+
+/**
+ * Get cache statistics
+ */
+void print_cache_get_stats(print_cache_stats_t *stats);
+
+#endif // PRINT_CACHE_H
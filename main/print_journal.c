@@ -0,0 +1,377 @@
+/**
+ * @file print_journal.c
+ * @brief Append-only journal of print jobs with an in-RAM index
+ */
+
+#include "print_journal.h"
+#include "spiffs_manager.h"
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+
+static const char *TAG = "print_journal";
+
+#define JOURNAL_PATH        SPIFFS_BASE_PATH "/journal.bin"
+#define JOURNAL_TMP_PATH    SPIFFS_BASE_PATH "/journal.tmp"
+
+// Records are written behind by a low-priority task, so a slow flash write
+// (SPIFFS garbage collection) never holds up the protocol task
+#define JOURNAL_PENDING_SIZE        8
+#define JOURNAL_TASK_STACK_SIZE     3072
+#define JOURNAL_TASK_PRIORITY       1
+
+_Static_assert((JOURNAL_PENDING_SIZE & (JOURNAL_PENDING_SIZE - 1)) == 0, "JOURNAL_PENDING_SIZE must be a power of two");
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static print_journal_record_t s_index[PRINT_JOURNAL_INDEX_SIZE];
+static uint32_t s_indexed = 0;      // Records added to the index since boot
+static print_journal_record_t s_pending[JOURNAL_PENDING_SIZE];  // Indexed, not yet in the file
+static uint32_t s_pending_head = 0;
+static uint32_t s_pending_tail = 0;
+static bool s_overflowed = false;   // A record did not fit in s_pending (s_lock)
+static bool s_dirty = false;        // File has a torn tail and must be rewritten (s_file_mutex)
+static SemaphoreHandle_t s_file_mutex = NULL;
+static TaskHandle_t s_journal_task = NULL;
+static print_journal_stats_t s_stats = { .next_seq = 1 };
+
+static uint32_t record_crc(const print_journal_record_t *rec) {
+    return esp_rom_crc32_le(0, (const uint8_t *)rec, offsetof(print_journal_record_t, record_crc));
+}
+
+static bool record_valid(const print_journal_record_t *rec) {
+    return rec->magic == PRINT_JOURNAL_MAGIC && rec->record_crc == record_crc(rec);
+}
+
+static void index_add_locked(const print_journal_record_t *rec) {
+    s_index[s_indexed % PRINT_JOURNAL_INDEX_SIZE] = *rec;
+    s_indexed++;
+    s_stats.records = s_indexed < PRINT_JOURNAL_INDEX_SIZE ? s_indexed : PRINT_JOURNAL_INDEX_SIZE;
+    s_stats.next_seq = rec->seq + 1;
+}
+
+static void index_add(const print_journal_record_t *rec) {
+    portENTER_CRITICAL(&s_lock);
+    index_add_locked(rec);
+    portEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * Replace the file with the records in the index (oldest first)
+ * Written to a temporary file and renamed, so a power loss leaves either the
+ * old or the new journal. Pending records are part of the index and are
+ * written with it. Call with s_file_mutex held (or before the task starts).
+ */
+static esp_err_t rewrite_file(void) {
+    FILE *f = fopen(JOURNAL_TMP_PATH, "wb");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Failed to create %s", JOURNAL_TMP_PATH);
+        return ESP_FAIL;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    uint32_t count = s_stats.records;
+    uint32_t first = s_indexed - count;
+    s_pending_tail = s_pending_head;
+    s_stats.pending = 0;
+    portEXIT_CRITICAL(&s_lock);
+
+    bool ok = true;
+    for (uint32_t i = 0; i < count && ok; i++) {
+        print_journal_record_t rec;
+        portENTER_CRITICAL(&s_lock);
+        rec = s_index[(first + i) % PRINT_JOURNAL_INDEX_SIZE];
+        portEXIT_CRITICAL(&s_lock);
+        ok = fwrite(&rec, 1, sizeof(rec), f) == sizeof(rec);
+    }
+    ok = ok && fflush(f) == 0 && fsync(fileno(f)) == 0;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        ESP_LOGE(TAG, "Failed to write %s", JOURNAL_TMP_PATH);
+        remove(JOURNAL_TMP_PATH);
+        return ESP_FAIL;
+    }
+
+    remove(JOURNAL_PATH);
+    if (rename(JOURNAL_TMP_PATH, JOURNAL_PATH) != 0) {
+        ESP_LOGE(TAG, "Failed to rename %s", JOURNAL_TMP_PATH);
+        return ESP_FAIL;
+    }
+
+    s_dirty = false;
+    portENTER_CRITICAL(&s_lock);
+    s_stats.file_records = count;
+    s_stats.compactions++;
+    portEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
+
+/**
+ * Read the file into the index, dropping a torn tail (before the task starts)
+ */
+static void load_journal(void) {
+    FILE *f = fopen(JOURNAL_PATH, "rb");
+    if (f == NULL) {
+        // Power lost between removing the old journal and renaming the new one
+        if (rename(JOURNAL_TMP_PATH, JOURNAL_PATH) == 0) {
+            ESP_LOGW(TAG, "Recovered journal from %s", JOURNAL_TMP_PATH);
+            f = fopen(JOURNAL_PATH, "rb");
+        }
+    } else {
+        remove(JOURNAL_TMP_PATH);  // Stale, the rename never started
+    }
+    if (f == NULL) {
+        ESP_LOGI(TAG, "No print journal yet");
+        return;
+    }
+
+    print_journal_record_t rec;
+    size_t loaded = 0;
+    size_t n;
+    bool torn = false;
+    while ((n = fread(&rec, 1, sizeof(rec), f)) > 0) {
+        if (n != sizeof(rec) || !record_valid(&rec)) {
+            torn = true;
+            break;
+        }
+        index_add(&rec);
+        loaded++;
+    }
+    fclose(f);
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.file_records = loaded;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (torn) {
+        ESP_LOGW(TAG, "Journal damaged after record %u (power loss mid-append?), dropping the tail",
+                 (unsigned)loaded);
+        portENTER_CRITICAL(&s_lock);
+        s_stats.repaired++;
+        portEXIT_CRITICAL(&s_lock);
+        s_dirty = true;
+    }
+    if (s_dirty || loaded > PRINT_JOURNAL_INDEX_SIZE) {
+        rewrite_file();
+    }
+
+    ESP_LOGI(TAG, "Loaded %u print journal records (next #%lu)",
+             (unsigned)loaded, (unsigned long)s_stats.next_seq);
+}
+
+/**
+ * Write one pending record to the end of the file (journal task, s_file_mutex held)
+ */
+static esp_err_t write_record(const print_journal_record_t *rec) {
+    esp_err_t ret;
+    if (s_dirty || s_stats.file_records >= 2 * PRINT_JOURNAL_INDEX_SIZE) {
+        // Drop a torn tail / old records - the index already holds the new one
+        ret = rewrite_file();
+    } else {
+        ret = ESP_FAIL;
+        FILE *f = fopen(JOURNAL_PATH, "ab");
+        if (f != NULL) {
+            bool ok = fwrite(rec, 1, sizeof(*rec), f) == sizeof(*rec) &&
+                      fflush(f) == 0 && fsync(fileno(f)) == 0;
+            ok = (fclose(f) == 0) && ok;
+            ret = ok ? ESP_OK : ESP_FAIL;
+        }
+        if (ret == ESP_OK) {
+            portENTER_CRITICAL(&s_lock);
+            s_stats.file_records++;
+            portEXIT_CRITICAL(&s_lock);
+        } else {
+            s_dirty = true;  // Possibly half a record on flash - rewrite next time
+        }
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    if (ret == ESP_OK) {
+        s_stats.appended++;
+    } else {
+        s_stats.append_failures++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to append journal record #%lu", (unsigned long)rec->seq);
+    }
+    return ret;
+}
+
+/**
+ * Writes queued records to flash, oldest first
+ */
+static void journal_task(void *arg) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        xSemaphoreTake(s_file_mutex, portMAX_DELAY);
+        while (true) {
+            print_journal_record_t rec;
+            portENTER_CRITICAL(&s_lock);
+            if (s_overflowed) {
+                s_overflowed = false;
+                s_dirty = true;  // The rewrite below takes every pending record with it
+            }
+            bool have = s_pending_tail != s_pending_head;
+            if (have) {
+                rec = s_pending[s_pending_tail % JOURNAL_PENDING_SIZE];
+                s_pending_tail++;
+                s_stats.pending = s_pending_head - s_pending_tail;
+            }
+            portEXIT_CRITICAL(&s_lock);
+            if (!have) {
+                break;
+            }
+            write_record(&rec);
+        }
+        xSemaphoreGive(s_file_mutex);
+    }
+}
+
+esp_err_t print_journal_init(void) {
+    load_journal();
+
+    s_file_mutex = xSemaphoreCreateMutex();
+    if (s_file_mutex == NULL ||
+        xTaskCreate(journal_task, "print_journal", JOURNAL_TASK_STACK_SIZE, NULL,
+                    JOURNAL_TASK_PRIORITY, &s_journal_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start print journal task");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t print_journal_append(const print_telemetry_session_t *session) {
+    if (session == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    print_journal_record_t rec = {0};
+    rec.magic = PRINT_JOURNAL_MAGIC;
+    portENTER_CRITICAL(&s_lock);
+    rec.seq = s_stats.next_seq;
+    portEXIT_CRITICAL(&s_lock);
+    rec.timestamp = (uint32_t)time(NULL);
+    rec.model = (uint8_t)session->model;
+    rec.status = (uint8_t)session->end_reason;
+    rec.bytes = session->bytes_received;
+    rec.chunks = session->chunks;
+    rec.duration_ms = session->end_ms - session->start_ms;
+    rec.bytes_per_sec = session->bytes_per_sec;
+    if (session->image_checked) {
+        unsigned long file_id = 0;
+        if (sscanf(session->file, "print_%lu", &file_id) == 1) {
+            rec.file_id = (uint32_t)file_id;
+        }
+        rec.jpeg_status = (uint8_t)session->image.status;
+        rec.crc32 = session->image.crc32;
+        rec.width = session->image.width;
+        rec.height = session->image.height;
+    }
+    rec.record_crc = record_crc(&rec);
+
+    // Index and queue together, so a rewrite either includes the record or
+    // leaves it pending - never both
+    bool queued;
+    portENTER_CRITICAL(&s_lock);
+    index_add_locked(&rec);
+    queued = s_pending_head - s_pending_tail < JOURNAL_PENDING_SIZE;
+    if (queued) {
+        s_pending[s_pending_head % JOURNAL_PENDING_SIZE] = rec;
+        s_pending_head++;
+    } else {
+        // The writer is behind - have it rewrite the file from the index instead
+        s_overflowed = true;
+        s_stats.overflows++;
+    }
+    s_stats.pending = s_pending_head - s_pending_tail;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (!queued) {
+        ESP_LOGW(TAG, "Journal writer behind, record #%lu will be written by a rewrite",
+                 (unsigned long)rec.seq);
+    }
+    if (s_journal_task != NULL) {
+        xTaskNotifyGive(s_journal_task);
+    }
+    return ESP_OK;
+}
+
+size_t print_journal_query(const print_journal_filter_t *filter,
+                           print_journal_record_t *records, size_t max_records) {
+    if (records == NULL || max_records == 0) {
+        return 0;
+    }
+
+    size_t found = 0;
+    portENTER_CRITICAL(&s_lock);
+    uint32_t count = s_stats.records;
+    for (uint32_t i = 0; i < count && found < max_records; i++) {
+        const print_journal_record_t *rec = &s_index[(s_indexed - 1 - i) % PRINT_JOURNAL_INDEX_SIZE];
+        if (filter != NULL) {
+            if ((filter->by_status && rec->status != filter->status) ||
+                (filter->by_model && rec->model != filter->model) ||
+                rec->timestamp < filter->since) {
+                continue;
+            }
+        }
+        records[found++] = *rec;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    return found;
+}
+
+uint32_t print_journal_file_seq(uint32_t file_id) {
+    uint32_t seq = 0;
+
+    portENTER_CRITICAL(&s_lock);
+    uint32_t count = s_stats.records;
+    for (uint32_t i = 0; i < count; i++) {
+        const print_journal_record_t *rec = &s_index[(s_indexed - 1 - i) % PRINT_JOURNAL_INDEX_SIZE];
+        if (rec->file_id == file_id) {
+            seq = rec->seq;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    return seq;
+}
+
+void print_journal_reset(void) {
+    if (s_file_mutex != NULL) {
+        xSemaphoreTake(s_file_mutex, portMAX_DELAY);
+    }
+    portENTER_CRITICAL(&s_lock);
+    s_indexed = 0;
+    s_stats.records = 0;
+    s_stats.file_records = 0;
+    s_pending_tail = s_pending_head;
+    s_stats.pending = 0;
+    s_overflowed = false;
+    portEXIT_CRITICAL(&s_lock);
+    s_dirty = false;
+    remove(JOURNAL_PATH);
+    if (s_file_mutex != NULL) {
+        xSemaphoreGive(s_file_mutex);
+    }
+    ESP_LOGI(TAG, "Print journal cleared (sequence continues at #%lu)", (unsigned long)s_stats.next_seq);
+}
+
+void print_journal_get_stats(print_journal_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    memcpy(stats, &s_stats, sizeof(*stats));
+    portEXIT_CRITICAL(&s_lock);
+}
@@ -0,0 +1,108 @@
+/**
+ * @file print_journal.h
+ * @brief Append-only journal of print jobs with an in-RAM index
+ *
+ * One fixed-size binary record is appended to /spiffs/journal.bin for every
+ * print job, whatever its outcome. At boot the file is read once into a RAM
+ * index of the newest PRINT_JOURNAL_INDEX_SIZE records, so listing and
+ * filtering history never touches the filesystem. New records go into the
+ * index at once and are written to the file by a low-priority task.
+ *
+ * Each record carries a magic and its own CRC32. A record torn by a power
+ * loss mid-append fails the check; loading stops there and the file is
+ * rewritten from the valid records (via a temporary file and rename). The
+ * same rewrite compacts the file once it holds twice the index size.
+ */
+
+#ifndef PRINT_JOURNAL_H
+#define PRINT_JOURNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "print_telemetry.h"
+
+// Records kept in RAM (and in the file after compaction)
+#define PRINT_JOURNAL_INDEX_SIZE    128
+
+#define PRINT_JOURNAL_MAGIC         0x524A5849  // "IXJR"
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t seq;               // Increases by one per job, across reboots
+    uint32_t timestamp;         // Wall clock when the job ended (time())
+    uint32_t file_id;           // print_<file_id>.jpg, 0 if nothing was saved
+    uint8_t model;              // instax_model_t
+    uint8_t status;             // print_end_reason_t
+    uint8_t jpeg_status;        // jpeg_scan_status_t (meaningless if file_id is 0)
+    uint8_t reserved;
+    uint32_t bytes;             // Image bytes received
+    uint32_t chunks;
+    uint32_t duration_ms;       // PRINT_START to the end of the job
+    uint32_t bytes_per_sec;
+    uint32_t crc32;             // CRC32 of the image data
+    uint16_t width;
+    uint16_t height;
+    uint32_t record_crc;        // CRC32 of all fields above
+} print_journal_record_t;
+
+_Static_assert(sizeof(print_journal_record_t) == 48, "Journal record layout changed");
+
+// Query filter; zero-initialised matches everything
+typedef struct {
+    bool by_status;
+    print_end_reason_t status;
+    bool by_model;
+    instax_model_t model;
+    uint32_t since;             // Only jobs with timestamp >= since
+} print_journal_filter_t;
+
+typedef struct {
+    uint32_t records;           // In the RAM index
+    uint32_t next_seq;
+    uint32_t appended;          // Since boot
+    uint32_t append_failures;
+    uint32_t pending;           // Records waiting for the writer task
+    uint32_t overflows;         // Records the queue had no room for (written by a rewrite)
+    uint32_t repaired;          // Torn or corrupt tails dropped
+    uint32_t compactions;
+    size_t file_records;        // Records in the file
+} print_journal_stats_t;
+
+/**
+ * Load the journal into RAM, repairing a torn tail (call once SPIFFS is mounted)
+ */
+esp_err_t print_journal_init(void);
+
+/**
+ * Add the record of a finished job to the index and queue it for the file
+ * Does not touch the filesystem: a low-priority task appends it (protocol task).
+ */
+esp_err_t print_journal_append(const print_telemetry_session_t *session);
+
+/**
+ * Copy matching records from the RAM index, newest first
+ * @return Number of records written
+ */
+size_t print_journal_query(const print_journal_filter_t *filter,
+                           print_journal_record_t *records, size_t max_records);
+
+/**
+ * Sequence number of the newest job that saved print_<file_id>.jpg
+ * File ids are not ordered across reboots; sequence numbers are.
+ * @return Sequence number, or 0 if no indexed record names the file
+ */
+uint32_t print_journal_file_seq(uint32_t file_id);
+
+/**
+ * Forget all records (the file system was formatted)
+ */
+void print_journal_reset(void);
+
+/**
+ * Get journal statistics
+ */
+void print_journal_get_stats(print_journal_stats_t *stats);
+
+#endif // PRINT_JOURNAL_H
@@ -0,0 +1,159 @@
+/**
+ * @file print_pool.c
+ * @brief Print buffer arena reserved at boot, plus heap fragmentation tracking
+ */
+
+#include "print_pool.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+static const char *TAG = "print_pool";
+
+_Static_assert(PRINT_POOL_SLOTS <= 32, "Slot bitmap holds at most 32 slots");
+
+#define HEAP_CAPS   (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t *s_arena = NULL;
+static uint32_t s_used_mask = 0;    // Bit n set = slot n borrowed
+static print_pool_stats_t s_stats = {0};
+
+static print_pool_heap_sample_t s_history[PRINT_POOL_HEAP_HISTORY];
+static uint32_t s_history_count = 0;    // Samples taken since boot
+
+esp_err_t print_pool_init(void) {
+    if (s_arena != NULL) {
+        return ESP_OK;
+    }
+
+    // Early in boot the heap is still in one piece - take the whole arena now
+    s_arena = heap_caps_malloc((size_t)PRINT_POOL_SLOTS * PRINT_POOL_SLOT_SIZE, HEAP_CAPS);
+    if (s_arena == NULL) {
+        ESP_LOGE(TAG, "Failed to reserve %d x %d KB print buffer arena",
+                 PRINT_POOL_SLOTS, PRINT_POOL_SLOT_SIZE / 1024);
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_stats.slot_size = PRINT_POOL_SLOT_SIZE;
+    s_stats.slots = PRINT_POOL_SLOTS;
+    s_stats.free_bytes_min = UINT32_MAX;
+    s_stats.largest_free_block_min = UINT32_MAX;
+    print_pool_sample_heap();
+
+    ESP_LOGI(TAG, "Reserved %d x %d KB print buffer arena (largest free block now %lu bytes)",
+             PRINT_POOL_SLOTS, PRINT_POOL_SLOT_SIZE / 1024, (unsigned long)s_stats.largest_free_block);
+    return ESP_OK;
+}
+
+uint8_t *print_pool_acquire(void) {
+    uint8_t *slot = NULL;
+
+    portENTER_CRITICAL(&s_lock);
+    if (s_arena != NULL) {
+        for (int i = 0; i < PRINT_POOL_SLOTS; i++) {
+            if ((s_used_mask & (1u << i)) == 0) {
+                s_used_mask |= (1u << i);
+                slot = s_arena + (size_t)i * PRINT_POOL_SLOT_SIZE;
+                break;
+            }
+        }
+    }
+    if (slot != NULL) {
+        s_stats.in_use++;
+        s_stats.acquires++;
+        if (s_stats.in_use > s_stats.high_water) {
+            s_stats.high_water = s_stats.in_use;
+        }
+    } else {
+        s_stats.acquire_failures++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (slot == NULL) {
+        ESP_LOGE(TAG, "No free print buffer slot (%d in use)", PRINT_POOL_SLOTS);
+    }
+    return slot;
+}
+
+void print_pool_release(uint8_t *slot) {
+    if (slot == NULL || s_arena == NULL) {
+        return;
+    }
+
+    size_t offset = (size_t)(slot - s_arena);
+    int index = offset / PRINT_POOL_SLOT_SIZE;
+    if (slot < s_arena || index >= PRINT_POOL_SLOTS || offset % PRINT_POOL_SLOT_SIZE != 0) {
+        ESP_LOGE(TAG, "Release of a pointer that is not a pool slot: %p", slot);
+        return;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    if (s_used_mask & (1u << index)) {
+        s_used_mask &= ~(1u << index);
+        s_stats.in_use--;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void print_pool_sample_heap(void) {
+    uint32_t free_bytes = heap_caps_get_free_size(HEAP_CAPS);
+    uint32_t largest = heap_caps_get_largest_free_block(HEAP_CAPS);
+    uint32_t now_ms = esp_log_timestamp();
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.free_bytes = free_bytes;
+    s_stats.largest_free_block = largest;
+    if (free_bytes < s_stats.free_bytes_min) {
+        s_stats.free_bytes_min = free_bytes;
+    }
+    if (largest < s_stats.largest_free_block_min) {
+        s_stats.largest_free_block_min = largest;
+    }
+    print_pool_heap_sample_t *sample = &s_history[s_history_count % PRINT_POOL_HEAP_HISTORY];
+    sample->timestamp_ms = now_ms;
+    sample->free_bytes = free_bytes;
+    sample->largest_free_block = largest;
+    s_history_count++;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void print_pool_get_stats(print_pool_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    // Current figures are live; the lowest values come from the samples
+    uint32_t free_bytes = heap_caps_get_free_size(HEAP_CAPS);
+    uint32_t largest = heap_caps_get_largest_free_block(HEAP_CAPS);
+
+    portENTER_CRITICAL(&s_lock);
+    memcpy(stats, &s_stats, sizeof(*stats));
+    portEXIT_CRITICAL(&s_lock);
+
+    stats->free_bytes = free_bytes;
+    stats->largest_free_block = largest;
+    if (stats->free_bytes_min == UINT32_MAX) {
+        stats->free_bytes_min = free_bytes;
+    }
+    if (stats->largest_free_block_min == UINT32_MAX) {
+        stats->largest_free_block_min = largest;
+    }
+}
+
+size_t print_pool_get_heap_history(print_pool_heap_sample_t *samples, size_t max_samples) {
+    if (samples == NULL || max_samples == 0) {
+        return 0;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    uint32_t available = s_history_count < PRINT_POOL_HEAP_HISTORY ? s_history_count : PRINT_POOL_HEAP_HISTORY;
+    size_t count = available < max_samples ? available : max_samples;
+    uint32_t first = s_history_count - count;
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = s_history[(first + i) % PRINT_POOL_HEAP_HISTORY];
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    return count;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file print_pool.h
+ * @brief Print buffer arena reserved at boot, plus heap fragmentation tracking
+ *
+ * Allocating the print buffers per job fails once hours of web and BLE
+ * traffic have fragmented the heap, even with plenty of free memory in
+ * total. The pool reserves one arena at boot (PRINT_POOL_SLOTS slots of
+ * PRINT_POOL_SLOT_SIZE bytes, set in menuconfig) and jobs borrow slots from
+ * it, so starting a print never depends on the state of the heap.
+ *
+ * The pool also samples the free heap and the largest free block, keeping
+ * the lowest values seen and a short history for the console and status API.
+ */
+
+#ifndef PRINT_POOL_H
+#define PRINT_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifndef CONFIG_PRINT_POOL_SLOT_SIZE_KB
+#define CONFIG_PRINT_POOL_SLOT_SIZE_KB  16
+#endif
+#ifndef CONFIG_PRINT_POOL_SLOTS
+#define CONFIG_PRINT_POOL_SLOTS         2
+#endif
+
+#define PRINT_POOL_SLOT_SIZE    (CONFIG_PRINT_POOL_SLOT_SIZE_KB * 1024)
+#define PRINT_POOL_SLOTS        CONFIG_PRINT_POOL_SLOTS
+
+// Heap samples kept (one per print_pool_sample_heap() call, e.g. every minute)
+#define PRINT_POOL_HEAP_HISTORY 30
+
+typedef struct {
+    uint32_t timestamp_ms;
+    uint32_t free_bytes;
+    uint32_t largest_free_block;
+} print_pool_heap_sample_t;
+
+typedef struct {
+    size_t slot_size;
+    uint32_t slots;
+    uint32_t in_use;
+    uint32_t high_water;            // Most slots borrowed at once
+    uint32_t acquires;              // Slots handed out since boot
+    uint32_t acquire_failures;      // Requests refused because every slot was busy
+    uint32_t free_bytes;            // Heap right now (8-bit capable)
+    uint32_t free_bytes_min;        // Lowest free heap since boot
+    uint32_t largest_free_block;    // Largest allocatable block right now
+    uint32_t largest_free_block_min;  // Lowest largest-free-block sampled since boot
+} print_pool_stats_t;
+
+/**
+ * Reserve the arena (call once at startup)
+ */
+esp_err_t print_pool_init(void);
+
+/**
+ * Borrow a slot (PRINT_POOL_SLOT_SIZE bytes)
+ * @return Slot, or NULL if every slot is in use
+ */
+uint8_t *print_pool_acquire(void);
+
+/**
+ * Return a slot borrowed with print_pool_acquire() (NULL is ignored)
+ */
+void print_pool_release(uint8_t *slot);
+
+/**
+ * Record a heap sample (free bytes / largest free block) in the history
+ */
+void print_pool_sample_heap(void);
+
+/**
+ * Get pool occupancy and current/lowest heap figures
+ */
+void print_pool_get_stats(print_pool_stats_t *stats);
+
+/**
+ * Copy the heap sample history, oldest first
+ * @return Number of samples written
+ */
+size_t print_pool_get_heap_history(print_pool_heap_sample_t *samples, size_t max_samples);
+
+#endif // PRINT_POOL_H
@@ -0,0 +1,180 @@
+/**
+ * @file print_resume.c
+ * @brief Keeps a dropped print job so a restarted transfer can resume it
+ */
+
+#include "print_resume.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_crc.h"
+#include "print_cache.h"
+
+static const char *TAG = "print_resume";
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static print_resume_job_t s_parked;
+static bool s_holding = false;
+static int64_t s_parked_us = 0;
+static print_resume_stats_t s_stats = {0};
+
+void print_chunk_map_reset(print_chunk_map_t *map, uint32_t image_size) {
+    memset(map, 0, sizeof(*map));
+    map->image_size = image_size;
+}
+
+void print_chunk_map_add(print_chunk_map_t *map, uint32_t chunk_index, const uint8_t *data, size_t len) {
+    if (chunk_index >= PRINT_RESUME_MAX_CHUNKS || print_chunk_map_has(map, chunk_index)) {
+        return;
+    }
+    if (chunk_index == 0) {
+        map->first_crc = print_chunk_map_crc(data, len);
+    }
+    map->bits[chunk_index / 32] |= 1UL << (chunk_index % 32);
+    map->chunks++;
+    map->bytes += len;
+}
+
+bool print_chunk_map_has(const print_chunk_map_t *map, uint32_t chunk_index) {
+    return chunk_index < PRINT_RESUME_MAX_CHUNKS &&
+           (map->bits[chunk_index / 32] & (1UL << (chunk_index % 32))) != 0;
+}
+
+uint32_t print_chunk_map_crc(const uint8_t *data, size_t len) {
+    return data != NULL ? esp_rom_crc32_le(0, data, len) : 0;
+}
+
+/**
+ * Number of chunks received in order from chunk 0
+ * Chunks arrive in order, so this is every chunk - but only a gap-free prefix
+ * can be resumed, since the data after it is appended.
+ */
+static uint32_t prefix_chunks(const print_chunk_map_t *map) {
+    uint32_t n = 0;
+    while (n < PRINT_RESUME_MAX_CHUNKS && print_chunk_map_has(map, n)) {
+        n++;
+    }
+    return n;
+}
+
+void print_resume_release(print_resume_job_t *job) {
+    if (job->ram != NULL) {
+        print_cache_abort();
+        job->ram = NULL;
+    }
+    // A streamed partial file stays on SPIFFS, as for any aborted streamed job
+}
+
+/**
+ * Forget the parked job and release what it holds
+ */
+static void drop_parked(void) {
+    if (!s_holding) {
+        return;
+    }
+    print_resume_release(&s_parked);
+    portENTER_CRITICAL(&s_lock);
+    s_holding = false;
+    s_stats.holding = false;
+    s_stats.held_bytes = 0;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+bool print_resume_park(const print_resume_job_t *job) {
+    if (PRINT_RESUME_WINDOW_S == 0 || job == NULL || job->map.chunks == 0 ||
+        job->map.bytes >= job->map.image_size || prefix_chunks(&job->map) != job->map.chunks) {
+        return false;
+    }
+
+    drop_parked();  // At most one job is kept
+    s_parked = *job;
+    s_parked_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_lock);
+    s_holding = true;
+    s_stats.holding = true;
+    s_stats.held_bytes = job->map.bytes;
+    s_stats.parked++;
+    portEXIT_CRITICAL(&s_lock);
+
+    ESP_LOGI(TAG, "⏸️ Kept dropped job for %d s: %lu of %lu bytes in %lu chunks (%s)",
+             PRINT_RESUME_WINDOW_S, (unsigned long)job->map.bytes, (unsigned long)job->map.image_size,
+             (unsigned long)job->map.chunks, job->ram != NULL ? "RAM" : job->path);
+    return true;
+}
+
+bool print_resume_claim(uint32_t image_size, print_resume_job_t *job) {
+    print_resume_expire();
+    if (!s_holding) {
+        return false;
+    }
+
+    if (s_parked.map.image_size != image_size) {
+        ESP_LOGI(TAG, "New job of %lu bytes, releasing the dropped %lu byte job",
+                 (unsigned long)image_size, (unsigned long)s_parked.map.image_size);
+        drop_parked();
+        portENTER_CRITICAL(&s_lock);
+        s_stats.replaced++;
+        portEXIT_CRITICAL(&s_lock);
+        return false;
+    }
+
+    *job = s_parked;
+    portENTER_CRITICAL(&s_lock);
+    s_holding = false;
+    s_stats.holding = false;
+    s_stats.held_bytes = 0;
+    portEXIT_CRITICAL(&s_lock);
+    return true;
+}
+
+void print_resume_record_result(bool hit, const print_chunk_map_t *map) {
+    portENTER_CRITICAL(&s_lock);
+    if (hit) {
+        s_stats.hits++;
+    } else {
+        s_stats.misses++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (hit) {
+        ESP_LOGI(TAG, "▶️ Resuming job: first chunk matches, %lu chunks (%lu of %lu bytes) already received",
+                 (unsigned long)map->chunks, (unsigned long)map->bytes, (unsigned long)map->image_size);
+    } else {
+        ESP_LOGI(TAG, "Same-size job with a different first chunk - starting over");
+    }
+}
+
+void print_resume_record_skip(size_t len) {
+    portENTER_CRITICAL(&s_lock);
+    s_stats.chunks_skipped++;
+    s_stats.bytes_skipped += len;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void print_resume_expire(void) {
+    if (!s_holding || esp_timer_get_time() - s_parked_us < PRINT_RESUME_WINDOW_S * 1000000LL) {
+        return;
+    }
+    ESP_LOGI(TAG, "Dropped job was not restarted within %d s - releasing %lu bytes",
+             PRINT_RESUME_WINDOW_S, (unsigned long)s_parked.map.bytes);
+    drop_parked();
+    portENTER_CRITICAL(&s_lock);
+    s_stats.expired++;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+bool print_resume_pending(void) {
+    return s_holding;
+}
+
+void print_resume_get_stats(print_resume_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    memcpy(stats, &s_stats, sizeof(*stats));
+    stats->held_age_s = s_holding ? (uint32_t)((esp_timer_get_time() - s_parked_us) / 1000000) : 0;
+    portEXIT_CRITICAL(&s_lock);
+}
@@ -0,0 +1,134 @@
+/**
+ * @file print_resume.h
+ * @brief Keeps a dropped print job so a restarted transfer can resume it
+ *
+ * Phone links drop in the middle of ~100 KB transfers, and the app then
+ * starts the same print again from PRINT_START and chunk 0. Instead of
+ * discarding the partial job on disconnect, the printer parks it - the RAM
+ * buffer or the partial file, the JPEG scanner state and a bitmap of the
+ * chunks received - for PRINT_RESUME_WINDOW_S.
+ *
+ * A new job with the same image size claims the parked one; its first chunk
+ * then decides: if its CRC32 matches the parked job's first chunk it is the
+ * same image, and every chunk already received is ACKed without being
+ * written again (hit). Otherwise the parked data is dropped and the job
+ * starts over (miss). A job of another size, or the window running out,
+ * releases the parked job.
+ *
+ * All calls come from the protocol task except print_resume_get_stats().
+ */
+
+#ifndef PRINT_RESUME_H
+#define PRINT_RESUME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include "jpeg_scanner.h"
+
+#ifndef CONFIG_PRINT_RESUME_WINDOW_S
+#define CONFIG_PRINT_RESUME_WINDOW_S    60
+#endif
+
+// How long a dropped job is kept, 0 = never resume
+#define PRINT_RESUME_WINDOW_S           CONFIG_PRINT_RESUME_WINDOW_S
+
+// Chunks tracked per job (the largest print is ~117 chunks of 900 bytes)
+#define PRINT_RESUME_MAX_CHUNKS         512
+
+// Chunks received by a job
+typedef struct {
+    uint32_t image_size;        // From PRINT_START
+    uint32_t first_crc;         // CRC32 of chunk 0's image data
+    uint32_t chunks;            // Bits set
+    uint32_t bytes;             // Image bytes received
+    uint32_t bits[PRINT_RESUME_MAX_CHUNKS / 32];
+} print_chunk_map_t;
+
+// A dropped job and everything needed to continue it
+typedef struct {
+    char path[64];              // Final SPIFFS path
+    uint8_t *ram;               // Whole-print buffer (print_cache job), NULL if streamed to path
+    size_t ram_capacity;
+    jpeg_scan_t scan;           // Scanner state after the last chunk received
+    print_chunk_map_t map;
+} print_resume_job_t;
+
+typedef struct {
+    uint32_t parked;            // Dropped jobs kept for resuming
+    uint32_t hits;              // Restarted jobs that continued a parked one
+    uint32_t misses;            // Same-size restarts with a different first chunk
+    uint32_t replaced;          // Parked jobs released for a job of another size
+    uint32_t expired;           // Parked jobs released after the window
+    uint32_t chunks_skipped;    // Chunks ACKed without being written again
+    uint32_t bytes_skipped;
+    bool holding;               // A job is parked right now
+    uint32_t held_bytes;
+    uint32_t held_age_s;
+} print_resume_stats_t;
+
+/**
+ * Start an empty chunk map for a job
+ */
+void print_chunk_map_reset(print_chunk_map_t *map, uint32_t image_size);
+
+/**
+ * Record a received chunk (hashes chunk 0)
+ */
+void print_chunk_map_add(print_chunk_map_t *map, uint32_t chunk_index, const uint8_t *data, size_t len);
+
+/**
+ * Whether a chunk was received
+ */
+bool print_chunk_map_has(const print_chunk_map_t *map, uint32_t chunk_index);
+
+/**
+ * CRC32 used to match first chunks
+ */
+uint32_t print_chunk_map_crc(const uint8_t *data, size_t len);
+
+/**
+ * Keep a dropped job for resuming
+ * @return false if the job cannot be resumed - the caller releases it as before
+ */
+bool print_resume_park(const print_resume_job_t *job);
+
+/**
+ * Take the parked job if it has the same image size (releases it otherwise)
+ * @return true if job was filled in; the caller now owns its resources
+ */
+bool print_resume_claim(uint32_t image_size, print_resume_job_t *job);
+
+/**
+ * Record whether a claimed job turned out to be the same image
+ */
+void print_resume_record_result(bool hit, const print_chunk_map_t *map);
+
+/**
+ * Record a chunk ACKed without being written
+ */
+void print_resume_record_skip(size_t len);
+
+/**
+ * Release a claimed job's resources (miss or failed reopen)
+ */
+void print_resume_release(print_resume_job_t *job);
+
+/**
+ * Release the parked job once the window has run out
+ */
+void print_resume_expire(void);
+
+/**
+ * Whether a job is parked (the protocol task polls while one is)
+ */
+bool print_resume_pending(void);
+
+/**
+ * Get resume statistics
+ */
+void print_resume_get_stats(print_resume_stats_t *stats);
+
+#endif // PRINT_RESUME_H
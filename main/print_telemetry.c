@@ -0,0 +1,225 @@
+/**
+ * @file print_telemetry.c
+ * @brief Per print session transfer telemetry
+ */
+
+#include "print_telemetry.h"
+#include "print_journal.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "print_telemetry";
+
+const uint32_t print_telemetry_bucket_limits_us[PRINT_TELEMETRY_BUCKETS] = {
+    1000, 2500, 5000, 10000, 25000, 50000, 100000, UINT32_MAX,
+};
+
+typedef struct {
+    print_telemetry_session_t info;
+    uint32_t start_us;
+    uint32_t last_rx_us;
+    uint64_t gap_total_us;
+    uint32_t gaps;
+    uint64_t ack_latency_total_us;
+} session_record_t;
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static session_record_t s_records[PRINT_TELEMETRY_HISTORY];
+static uint32_t s_count = 0;        // Sessions started since boot
+static bool s_running = false;      // Newest record is still open
+
+static session_record_t *newest(void) {
+    return &s_records[(s_count - 1) % PRINT_TELEMETRY_HISTORY];
+}
+
+static void histogram_add(uint32_t *hist, uint32_t value_us) {
+    for (int i = 0; i < PRINT_TELEMETRY_BUCKETS; i++) {
+        if (value_us < print_telemetry_bucket_limits_us[i] || i == PRINT_TELEMETRY_BUCKETS - 1) {
+            hist[i]++;
+            return;
+        }
+    }
+}
+
+/**
+ * Fill in the derived fields of a record (caller holds s_lock)
+ */
+static void finalize(session_record_t *rec, print_telemetry_session_t *out) {
+    *out = rec->info;
+    out->gap_avg_us = rec->gaps > 0 ? (uint32_t)(rec->gap_total_us / rec->gaps) : 0;
+    out->ack_latency_avg_us = rec->info.acks > 0 ? (uint32_t)(rec->ack_latency_total_us / rec->info.acks) : 0;
+    out->bytes_per_sec = out->upload_us > 0 ?
+                         (uint32_t)((uint64_t)out->bytes_received * 1000000ULL / out->upload_us) : 0;
+}
+
+esp_err_t print_telemetry_init(void) {
+    portENTER_CRITICAL(&s_lock);
+    memset(s_records, 0, sizeof(s_records));
+    s_count = 0;
+    s_running = false;
+    portEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
+
+void print_telemetry_begin(uint16_t conn_handle, instax_model_t model,
+                           uint16_t mtu, uint32_t image_size) {
+    print_telemetry_end(PRINT_END_RESTARTED);
+
+    portENTER_CRITICAL(&s_lock);
+    s_count++;
+    session_record_t *rec = newest();
+    memset(rec, 0, sizeof(*rec));
+    rec->info.id = s_count;
+    rec->info.conn_handle = conn_handle;
+    rec->info.mtu = mtu;
+    rec->info.model = model;
+    rec->info.end_reason = PRINT_END_NONE;
+    rec->info.start_ms = esp_log_timestamp();
+    rec->info.image_size = image_size;
+    rec->info.gap_min_us = UINT32_MAX;
+    rec->start_us = (uint32_t)esp_timer_get_time();
+    s_running = true;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void print_telemetry_record_chunk(uint32_t rx_us, size_t len) {
+    portENTER_CRITICAL(&s_lock);
+    if (s_running) {
+        session_record_t *rec = newest();
+        if (rec->info.chunks > 0) {
+            uint32_t gap = rx_us - rec->last_rx_us;
+            if (gap < rec->info.gap_min_us) {
+                rec->info.gap_min_us = gap;
+            }
+            if (gap > rec->info.gap_max_us) {
+                rec->info.gap_max_us = gap;
+            }
+            rec->gap_total_us += gap;
+            rec->gaps++;
+            histogram_add(rec->info.gap_hist, gap);
+        }
+        rec->last_rx_us = rx_us;
+        rec->info.chunks++;
+        rec->info.bytes_received += len;
+        rec->info.upload_us = rx_us - rec->start_us;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void print_telemetry_record_ack(uint32_t latency_us, uint32_t retries) {
+    portENTER_CRITICAL(&s_lock);
+    if (s_running) {
+        session_record_t *rec = newest();
+        rec->info.acks++;
+        rec->info.ack_retries += retries;
+        if (latency_us > rec->info.ack_latency_max_us) {
+            rec->info.ack_latency_max_us = latency_us;
+        }
+        rec->ack_latency_total_us += latency_us;
+        histogram_add(rec->info.ack_hist, latency_us);
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void print_telemetry_record_image(const char *file, const jpeg_scan_result_t *image) {
+    if (file == NULL || image == NULL) {
+        return;
+    }
+    const char *sep = strrchr(file, '/');
+    const char *name = sep != NULL ? sep + 1 : file;
+
+    portENTER_CRITICAL(&s_lock);
+    if (s_running) {
+        session_record_t *rec = newest();
+        rec->info.image_checked = true;
+        snprintf(rec->info.file, sizeof(rec->info.file), "%s", name);
+        rec->info.image = *image;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void print_telemetry_end(print_end_reason_t reason) {
+    print_telemetry_session_t summary;
+
+    portENTER_CRITICAL(&s_lock);
+    if (!s_running) {
+        portEXIT_CRITICAL(&s_lock);
+        return;
+    }
+    session_record_t *rec = newest();
+    rec->info.end_reason = reason;
+    rec->info.end_ms = esp_log_timestamp();
+    if (rec->info.gap_min_us == UINT32_MAX) {
+        rec->info.gap_min_us = 0;
+    }
+    s_running = false;
+    finalize(rec, &summary);
+    rec->info = summary;
+    portEXIT_CRITICAL(&s_lock);
+
+    ESP_LOGI(TAG, "📈 Print session #%lu %s: %lu/%lu bytes in %lu chunks, %lu B/s, "
+             "gap avg %lu us (max %lu), ACK latency avg %lu us (max %lu), %lu retries, MTU %u",
+             (unsigned long)summary.id, print_telemetry_end_reason_to_string(reason),
+             (unsigned long)summary.bytes_received, (unsigned long)summary.image_size,
+             (unsigned long)summary.chunks, (unsigned long)summary.bytes_per_sec,
+             (unsigned long)summary.gap_avg_us, (unsigned long)summary.gap_max_us,
+             (unsigned long)summary.ack_latency_avg_us, (unsigned long)summary.ack_latency_max_us,
+             (unsigned long)summary.ack_retries, summary.mtu);
+    if (summary.image_checked) {
+        ESP_LOGI(TAG, "📈 Print session #%lu image %s: JPEG %s, %ux%u, %u components, CRC32 %08lx",
+                 (unsigned long)summary.id, summary.file,
+                 jpeg_scan_status_to_string(summary.image.status),
+                 summary.image.width, summary.image.height, summary.image.components,
+                 (unsigned long)summary.image.crc32);
+    }
+
+    print_journal_append(&summary);
+}
+
+size_t print_telemetry_get_sessions(print_telemetry_session_t *sessions, size_t max_sessions) {
+    if (sessions == NULL || max_sessions == 0) {
+        return 0;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    uint32_t available = s_count < PRINT_TELEMETRY_HISTORY ? s_count : PRINT_TELEMETRY_HISTORY;
+    size_t count = available < max_sessions ? available : max_sessions;
+    uint32_t first = s_count - count;
+    for (size_t i = 0; i < count; i++) {
+        session_record_t *rec = &s_records[(first + i) % PRINT_TELEMETRY_HISTORY];
+        finalize(rec, &sessions[i]);
+        if (sessions[i].gap_min_us == UINT32_MAX) {
+            sessions[i].gap_min_us = 0;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    return count;
+}
+
+const char *print_telemetry_end_reason_to_string(print_end_reason_t reason) {
+    switch (reason) {
+        case PRINT_END_NONE:            return "in_progress";
+        case PRINT_END_COMPLETED:       return "completed";
+        case PRINT_END_REJECTED:        return "rejected";
+        case PRINT_END_DISCONNECTED:    return "disconnected";
+        case PRINT_END_RESTARTED:       return "restarted";
+        default:                        return "unknown";
+    }
+}
+
+bool print_telemetry_end_reason_from_string(const char *name, print_end_reason_t *reason) {
+    if (name == NULL || reason == NULL) {
+        return false;
+    }
+    for (int r = PRINT_END_NONE; r <= PRINT_END_RESTARTED; r++) {
+        if (strcmp(name, print_telemetry_end_reason_to_string((print_end_reason_t)r)) == 0) {
+            *reason = (print_end_reason_t)r;
+            return true;
+        }
+    }
+    return false;
+}
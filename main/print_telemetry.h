@@ -0,0 +1,129 @@
+/**
+ * @file print_telemetry.h
+ * @brief Per print session transfer telemetry
+ *
+ * Records one entry per print session (PRINT_START up to the end of the job):
+ * timing, throughput, chunk inter-arrival and ACK send-latency histograms,
+ * ACK retries, the negotiated MTU, why the session ended and, once the job is
+ * finished, the file it was saved to and the streaming JPEG check. The last
+ * PRINT_TELEMETRY_HISTORY sessions are kept so throughput can be compared
+ * across firmware builds (`telemetry` console command, `print_sessions` in
+ * /api/status).
+ *
+ * Sessions are opened, fed chunks and closed by the protocol task; ACK
+ * latencies are reported by the NimBLE host task.
+ */
+
+#ifndef PRINT_TELEMETRY_H
+#define PRINT_TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "instax_protocol.h"
+#include "jpeg_scanner.h"
+
+// Print sessions kept (the running session included)
+#define PRINT_TELEMETRY_HISTORY     8
+
+// Histogram buckets (both histograms share the limits below)
+#define PRINT_TELEMETRY_BUCKETS     8
+
+// Bucket upper bounds in us; the last bucket is open-ended
+extern const uint32_t print_telemetry_bucket_limits_us[PRINT_TELEMETRY_BUCKETS];
+
+typedef enum {
+    PRINT_END_NONE = 0,         // Session still running
+    PRINT_END_COMPLETED,        // PRINT_EXECUTE accepted
+    PRINT_END_REJECTED,         // PRINT_EXECUTE refused (no film, cover open, ...)
+    PRINT_END_DISCONNECTED,     // Central dropped the connection mid-job
+    PRINT_END_RESTARTED,        // A new PRINT_START replaced the job
+} print_end_reason_t;
+
+typedef struct {
+    uint32_t id;                    // Session number since boot
+    uint16_t conn_handle;
+    uint16_t mtu;                   // ATT MTU at PRINT_START
+    instax_model_t model;
+    print_end_reason_t end_reason;
+    uint32_t start_ms;
+    uint32_t end_ms;                // 0 while running
+    uint32_t image_size;            // Announced by PRINT_START
+    uint32_t bytes_received;
+    uint32_t chunks;
+    uint32_t upload_us;             // PRINT_START to last chunk arrival
+    uint32_t bytes_per_sec;         // bytes_received over upload_us
+    uint32_t gap_min_us;            // Chunk inter-arrival time
+    uint32_t gap_max_us;
+    uint32_t gap_avg_us;
+    uint32_t gap_hist[PRINT_TELEMETRY_BUCKETS];
+    uint32_t acks;                  // PRINT_DATA ACKs handed to the controller
+    uint32_t ack_retries;           // Send attempts deferred for lack of buffers
+    uint32_t ack_latency_max_us;    // Queued -> accepted by the host
+    uint32_t ack_latency_avg_us;
+    uint32_t ack_hist[PRINT_TELEMETRY_BUCKETS];
+    bool image_checked;             // file/image below are valid
+    char file[32];                  // Saved as (name only)
+    jpeg_scan_result_t image;       // JPEG structure, size and CRC32 of the data received
+} print_telemetry_session_t;
+
+/**
+ * Initialize telemetry (clears the history)
+ */
+esp_err_t print_telemetry_init(void);
+
+/**
+ * A print session started (protocol task)
+ * A session still running is closed as PRINT_END_RESTARTED.
+ */
+void print_telemetry_begin(uint16_t conn_handle, instax_model_t model,
+                           uint16_t mtu, uint32_t image_size);
+
+/**
+ * A PRINT_DATA chunk reached the protocol task
+ * @param rx_us Time the frame was reassembled (low 32 bits of esp_timer_get_time())
+ * @param len Image bytes in the chunk
+ */
+void print_telemetry_record_chunk(uint32_t rx_us, size_t len);
+
+/**
+ * A PRINT_DATA ACK was accepted by the host (host task)
+ * @param latency_us Time between queueing and sending
+ * @param retries Send attempts that were deferred
+ */
+void print_telemetry_record_ack(uint32_t latency_us, uint32_t retries);
+
+/**
+ * Attach the JPEG check of the job to the running session (protocol task)
+ * @param file Path or name the print was saved as
+ */
+void print_telemetry_record_image(const char *file, const jpeg_scan_result_t *image);
+
+/**
+ * The running session ended (no-op if none is running)
+ * The session is also appended to the print journal.
+ */
+void print_telemetry_end(print_end_reason_t reason);
+
+/**
+ * Copy the recorded sessions, oldest first
+ * A running session is included with end_reason PRINT_END_NONE.
+ * @param sessions Output array
+ * @param max_sessions Capacity of sessions
+ * @return Number of entries written
+ */
+size_t print_telemetry_get_sessions(print_telemetry_session_t *sessions, size_t max_sessions);
+
+/**
+ * Get display name for an end reason
+ */
+const char *print_telemetry_end_reason_to_string(print_end_reason_t reason);
+
+/**
+ * Parse an end reason name ("completed", "rejected", ...)
+ * @return false if the name is unknown
+ */
+bool print_telemetry_end_reason_from_string(const char *name, print_end_reason_t *reason);
+
+#endif // PRINT_TELEMETRY_H
@@ -0,0 +1,382 @@
+/**
+ * @file print_writer.c
+ * @brief Double-buffered asynchronous writer for incoming print data
+ */
+
+#include "print_writer.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "ack_pacer.h"
+
+static const char *TAG = "print_writer";
+
+#define WRITER_TASK_STACK_SIZE      4096
+#define WRITER_TASK_PRIORITY        6   // Below the protocol task, above the console
+
+static TaskHandle_t s_task = NULL;
+static SemaphoreHandle_t s_idle = NULL;     // Given when no drain is in flight
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static print_writer_stats_t s_stats = {0};
+
+// Job state (protocol task, except s_drain_* which the writer task reads)
+static FILE *s_file = NULL;
+static uint8_t *s_buffers[2] = {NULL, NULL};
+static int s_active = 0;                    // Buffer being filled
+static size_t s_active_pos = 0;
+static const uint8_t *s_drain_buf = NULL;   // Buffer handed to the writer task
+static size_t s_drain_len = 0;
+
+// Whole-image save handed to the writer task (instead of a drain)
+static char s_save_path[64];
+static const uint8_t *s_save_buf = NULL;
+static size_t s_save_len = 0;
+static print_writer_saved_cb_t s_save_cb = NULL;
+static void *s_save_arg = NULL;
+
+static void report_buffer(void) {
+    portENTER_CRITICAL(&s_lock);
+    s_stats.active_used = s_active_pos;
+    portEXIT_CRITICAL(&s_lock);
+    ack_pacer_report_buffer(s_active_pos, s_file != NULL ? PRINT_WRITER_BUFFER_SIZE : 0);
+}
+
+static void set_draining(bool draining) {
+    portENTER_CRITICAL(&s_lock);
+    s_stats.draining = draining;
+    portEXIT_CRITICAL(&s_lock);
+    ack_pacer_report_drain(draining);
+}
+
+/**
+ * Wait until the writer task has no buffer in flight (protocol task)
+ */
+static void wait_idle(void) {
+    if (xSemaphoreTake(s_idle, 0) == pdTRUE) {
+        return;
+    }
+
+    // The previous drain is slower than the link - this is the stall pacing tries to avoid
+    int64_t start_us = esp_timer_get_time();
+    xSemaphoreTake(s_idle, portMAX_DELAY);
+    uint32_t waited_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.stalls++;
+    s_stats.stall_total_us += waited_us;
+    if (waited_us > s_stats.stall_max_us) {
+        s_stats.stall_max_us = waited_us;
+    }
+    portEXIT_CRITICAL(&s_lock);
+    ESP_LOGW(TAG, "⏳ Waited %lu us for the previous buffer to reach flash", (unsigned long)waited_us);
+}
+
+/**
+ * Hand the active buffer to the writer task and start filling the other one
+ */
+static void swap_buffers(void) {
+    if (s_active_pos == 0) {
+        return;
+    }
+
+    wait_idle();
+    s_drain_buf = s_buffers[s_active];
+    s_drain_len = s_active_pos;
+    s_active ^= 1;
+    s_active_pos = 0;
+    set_draining(true);
+    xTaskNotifyGive(s_task);
+    report_buffer();
+}
+
+static void record_flush(size_t requested, size_t written, uint32_t elapsed_us) {
+    portENTER_CRITICAL(&s_lock);
+    s_stats.flushes++;
+    s_stats.bytes_written += written;
+    s_stats.flush_last_us = elapsed_us;
+    if (elapsed_us > s_stats.flush_max_us) {
+        s_stats.flush_max_us = elapsed_us;
+    }
+    // Exponential moving average (1/8 weight for new samples)
+    s_stats.flush_avg_us = s_stats.flush_avg_us == 0 ? elapsed_us :
+                           (s_stats.flush_avg_us * 7 + elapsed_us) / 8;
+    if (written != requested) {
+        s_stats.write_errors++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (written != requested) {
+        ESP_LOGE(TAG, "Failed to write buffer: wrote %u/%u bytes", (unsigned)written, (unsigned)requested);
+    }
+    ack_pacer_report_flush(written, elapsed_us);
+}
+
+/**
+ * Write a whole image to its own file (writer task)
+ */
+static void save_image(void) {
+    int64_t start_us = esp_timer_get_time();
+    size_t written = 0;
+    FILE *f = fopen(s_save_path, "wb");
+    if (f != NULL) {
+        written = fwrite(s_save_buf, 1, s_save_len, f);
+        if (fclose(f) != 0) {
+            written = 0;
+        }
+    }
+    bool ok = (written == s_save_len);
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.saves++;
+    s_stats.save_last_us = elapsed_us;
+    if (!ok) {
+        s_stats.save_failures++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (ok) {
+        ESP_LOGI(TAG, "💾 Saved %u bytes to %s in %lu us",
+                 (unsigned)s_save_len, s_save_path, (unsigned long)elapsed_us);
+    } else {
+        ESP_LOGE(TAG, "Failed to save %s: wrote %u/%u bytes", s_save_path,
+                 (unsigned)written, (unsigned)s_save_len);
+    }
+
+    print_writer_saved_cb_t cb = s_save_cb;
+    void *cb_arg = s_save_arg;
+    s_save_buf = NULL;
+    s_save_cb = NULL;
+    s_save_arg = NULL;
+    if (cb != NULL) {
+        cb(ok, cb_arg);
+    }
+}
+
+static void writer_task(void *arg) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (s_save_buf != NULL) {
+            save_image();
+            xSemaphoreGive(s_idle);
+            continue;
+        }
+
+        int64_t start_us = esp_timer_get_time();
+        size_t written = fwrite(s_drain_buf, 1, s_drain_len, s_file);
+        record_flush(s_drain_len, written, (uint32_t)(esp_timer_get_time() - start_us));
+
+        set_draining(false);
+        xSemaphoreGive(s_idle);
+    }
+}
+
+esp_err_t print_writer_init(void) {
+    if (s_task != NULL) {
+        return ESP_OK;
+    }
+
+    s_idle = xSemaphoreCreateBinary();
+    if (s_idle == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    xSemaphoreGive(s_idle);
+
+    if (xTaskCreate(writer_task, "print_writer", WRITER_TASK_STACK_SIZE, NULL,
+                    WRITER_TASK_PRIORITY, &s_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create writer task");
+        vSemaphoreDelete(s_idle);
+        s_idle = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_stats.buffer_size = PRINT_WRITER_BUFFER_SIZE;
+    ESP_LOGI(TAG, "Print writer ready (2 x %d KB buffers)", PRINT_WRITER_BUFFER_SIZE / 1024);
+    return ESP_OK;
+}
+
+static esp_err_t open_job(const char *path, const char *mode) {
+    if (s_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_file != NULL) {
+        ESP_LOGE(TAG, "A print job is already open");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        s_buffers[i] = print_pool_acquire();
+        if (s_buffers[i] == NULL) {
+            ESP_LOGE(TAG, "No print buffer slot available for the RAM buffers!");
+            print_pool_release(s_buffers[0]);
+            s_buffers[0] = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    s_file = fopen(path, mode);
+    if (s_file == NULL) {
+        ESP_LOGE(TAG, "Failed to open file for writing: %s", path);
+        print_pool_release(s_buffers[0]);
+        print_pool_release(s_buffers[1]);
+        s_buffers[0] = s_buffers[1] = NULL;
+        return ESP_FAIL;
+    }
+
+    s_active = 0;
+    s_active_pos = 0;
+    portENTER_CRITICAL(&s_lock);
+    s_stats.open = true;
+    portEXIT_CRITICAL(&s_lock);
+    report_buffer();
+    return ESP_OK;
+}
+
+esp_err_t print_writer_open(const char *path) {
+    return open_job(path, "wb");
+}
+
+esp_err_t print_writer_open_append(const char *path) {
+    return open_job(path, "ab");
+}
+
+bool print_writer_is_open(void) {
+    return s_file != NULL;
+}
+
+esp_err_t print_writer_write(const uint8_t *data, size_t len) {
+    if (s_file == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (len > PRINT_WRITER_BUFFER_SIZE) {
+        // Chunk larger than a whole buffer - write it directly, in order
+        ESP_LOGW(TAG, "Chunk larger than buffer, writing directly");
+        swap_buffers();
+        wait_idle();
+        int64_t start_us = esp_timer_get_time();
+        size_t written = fwrite(data, 1, len, s_file);
+        record_flush(len, written, (uint32_t)(esp_timer_get_time() - start_us));
+        xSemaphoreGive(s_idle);
+        return written == len ? ESP_OK : ESP_FAIL;
+    }
+
+    if (s_active_pos + len > PRINT_WRITER_BUFFER_SIZE) {
+        swap_buffers();
+    }
+    memcpy(s_buffers[s_active] + s_active_pos, data, len);
+    return print_writer_commit(len);
+}
+
+uint8_t *print_writer_reserve(size_t *capacity) {
+    if (s_file == NULL) {
+        *capacity = 0;
+        return NULL;
+    }
+    *capacity = PRINT_WRITER_BUFFER_SIZE - s_active_pos;  // A chunk that doesn't fit takes the copying path
+    return s_buffers[s_active] + s_active_pos;
+}
+
+esp_err_t print_writer_commit(size_t len) {
+    if (s_file == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_active_pos + len > PRINT_WRITER_BUFFER_SIZE) {
+        ESP_LOGE(TAG, "Chunk overruns buffer: %u + %u > %d",
+                 (unsigned)s_active_pos, (unsigned)len, PRINT_WRITER_BUFFER_SIZE);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    s_active_pos += len;
+    if (s_active_pos >= PRINT_WRITER_BUFFER_SIZE - PRINT_WRITER_SWAP_MARGIN) {
+        swap_buffers();
+    } else {
+        report_buffer();
+    }
+    return ESP_OK;
+}
+
+const uint8_t *print_writer_active_tail(void) {
+    return s_file != NULL ? s_buffers[s_active] + s_active_pos : NULL;
+}
+
+esp_err_t print_writer_close(void) {
+    if (s_file == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (s_active_pos > 0) {
+        ESP_LOGI(TAG, "Flushing final %u bytes from RAM buffer to SPIFFS", (unsigned)s_active_pos);
+        swap_buffers();
+    }
+    wait_idle();
+    xSemaphoreGive(s_idle);
+
+    fclose(s_file);
+    s_file = NULL;
+    print_pool_release(s_buffers[0]);
+    print_pool_release(s_buffers[1]);
+    s_buffers[0] = s_buffers[1] = NULL;
+    s_active_pos = 0;
+    ESP_LOGI(TAG, "✅ Returned 2 x %dKB RAM buffers to the print pool", PRINT_WRITER_BUFFER_SIZE / 1024);
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.open = false;
+    bool ok = (s_stats.write_errors == 0);
+    portEXIT_CRITICAL(&s_lock);
+    report_buffer();
+
+    return ok ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t print_writer_save(const char *path, const uint8_t *data, size_t len,
+                            print_writer_saved_cb_t cb, void *arg) {
+    if (s_task == NULL || s_file != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (path == NULL || data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Previous save still running (back-to-back prints) - counted as a stall
+    wait_idle();
+    snprintf(s_save_path, sizeof(s_save_path), "%s", path);
+    s_save_len = len;
+    s_save_cb = cb;
+    s_save_arg = arg;
+    s_save_buf = data;
+    xTaskNotifyGive(s_task);
+    return ESP_OK;
+}
+
+void print_writer_reset_stats(void) {
+    portENTER_CRITICAL(&s_lock);
+    s_stats.flushes = 0;
+    s_stats.bytes_written = 0;
+    s_stats.flush_last_us = 0;
+    s_stats.flush_max_us = 0;
+    s_stats.stalls = 0;
+    s_stats.stall_total_us = 0;
+    s_stats.stall_max_us = 0;
+    s_stats.write_errors = 0;
+    s_stats.saves = 0;
+    s_stats.save_last_us = 0;
+    s_stats.save_failures = 0;
+    // flush_avg_us is a property of the storage, not the job - keep it
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void print_writer_get_stats(print_writer_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    memcpy(stats, &s_stats, sizeof(*stats));
+    portEXIT_CRITICAL(&s_lock);
+}
@@ -0,0 +1,143 @@
+/**
+ * @file print_writer.h
+ * @brief Double-buffered asynchronous writer for incoming print data
+ *
+ * SPIFFS writes take tens of milliseconds as the partition fills, far longer
+ * than the gap between PRINT_DATA chunks. The writer keeps two RAM buffers:
+ * the BLE side fills the active one while a background task drains the
+ * other to flash. When the active buffer fills up the two are swapped; the
+ * BLE side only waits if the previous buffer is still being written.
+ *
+ * Backpressure is reported to the ACK pacer: the active buffer's occupancy
+ * and whether a drain is in flight. A nearly full buffer costs nothing while
+ * the writer is idle (the swap is instant) and is paced only while a drain is
+ * still running.
+ *
+ * Jobs received whole into RAM (see print_cache.h) skip the buffers and are
+ * written in one go by print_writer_save(), on the same task so saves and
+ * drains never compete for the flash.
+ *
+ * All calls except the stats getter come from the protocol task. The NimBLE
+ * host task only writes at the spot print_writer_reserve() returned, once the
+ * protocol task has published it (see ble_peripheral_publish_print_target).
+ */
+
+#ifndef PRINT_WRITER_H
+#define PRINT_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "print_pool.h"
+
+// Size of each of the two RAM buffers (one print pool slot each)
+#define PRINT_WRITER_BUFFER_SIZE    PRINT_POOL_SLOT_SIZE
+
+// Swap when less than this is free (room for the largest PRINT_DATA chunk)
+#define PRINT_WRITER_SWAP_MARGIN    2048
+
+// Writer statistics (per print job unless noted)
+typedef struct {
+    bool open;                  // A job is being written
+    bool draining;              // A buffer is being written to flash right now
+    size_t buffer_size;         // Size of each buffer
+    size_t active_used;         // Bytes waiting in the active buffer
+    uint32_t flushes;           // Buffers written to flash
+    uint32_t bytes_written;
+    uint32_t flush_last_us;
+    uint32_t flush_avg_us;      // Moving average, kept across jobs
+    uint32_t flush_max_us;
+    uint32_t stalls;            // Swaps that had to wait for the previous drain
+    uint32_t stall_total_us;
+    uint32_t stall_max_us;
+    uint32_t write_errors;      // Short writes
+    uint32_t saves;             // Whole images written by print_writer_save()
+    uint32_t save_last_us;
+    uint32_t save_failures;
+} print_writer_stats_t;
+
+/**
+ * Called on the writer task when a print_writer_save() has finished
+ * @param ok  Every byte reached the file
+ * @param arg Argument given to print_writer_save()
+ */
+typedef void (*print_writer_saved_cb_t)(bool ok, void *arg);
+
+/**
+ * Create the writer task (call once at startup)
+ */
+esp_err_t print_writer_init(void);
+
+/**
+ * Start a job: open the output file and borrow both buffers from the print pool
+ * @param path File to create
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if a job is open, ESP_ERR_NO_MEM if
+ *         the pool has no free slot, ESP_FAIL if the file cannot be created
+ */
+esp_err_t print_writer_open(const char *path);
+
+/**
+ * Continue a job: like print_writer_open(), but keeps what the file holds and
+ * appends to it (resuming a dropped print)
+ */
+esp_err_t print_writer_open_append(const char *path);
+
+/**
+ * Whether a job is open
+ */
+bool print_writer_is_open(void);
+
+/**
+ * Append data (copying path); swaps buffers when the active one is full
+ */
+esp_err_t print_writer_write(const uint8_t *data, size_t len);
+
+/**
+ * Zero-copy path: where the next chunk should be written
+ * @param capacity Set to the bytes that fit there
+ * @return Pointer into the active buffer, or NULL if no job is open
+ */
+uint8_t *print_writer_reserve(size_t *capacity);
+
+/**
+ * Zero-copy path: len bytes were written at the pointer returned by
+ * print_writer_reserve(); swaps buffers when the active one is full
+ */
+esp_err_t print_writer_commit(size_t len);
+
+/**
+ * Pointer to the next byte to be written in the active buffer (for inspecting
+ * data just committed), or NULL if no job is open
+ */
+const uint8_t *print_writer_active_tail(void);
+
+/**
+ * Finish the job: write what is buffered, wait for the drain, close the file
+ * and return the buffers to the print pool
+ * @return ESP_OK if every byte reached the file
+ */
+esp_err_t print_writer_close(void);
+
+/**
+ * Write a complete image to a new file on the writer task
+ * Waits only while the writer is busy with earlier work. The data must stay
+ * valid until the callback runs.
+ * @param path File to create
+ * @param cb   Called on the writer task when done (may be NULL)
+ * @return ESP_OK if queued, ESP_ERR_INVALID_STATE if a buffered job is open
+ */
+esp_err_t print_writer_save(const char *path, const uint8_t *data, size_t len,
+                            print_writer_saved_cb_t cb, void *arg);
+
+/**
+ * Reset per-job statistics (call at PRINT_START)
+ */
+void print_writer_reset_stats(void);
+
+/**
+ * Get a snapshot of writer statistics (any task)
+ */
+void print_writer_get_stats(print_writer_stats_t *stats);
+
+#endif // PRINT_WRITER_H
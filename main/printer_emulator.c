@@ -7,26 +7,51 @@
 #include "instax_protocol.h"
 #include "spiffs_manager.h"
 #include "ble_peripheral.h"
+#include "ack_pacer.h"
+#include "transport_profile.h"
+#include "print_writer.h"
+#include "print_cache.h"
+#include "print_telemetry.h"
+#include "jpeg_scanner.h"
+#include "thumbnail.h"
+#include "print_journal.h"
+#include "retention.h"
+#include "print_resume.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
 #include "nvs.h"
+#include "esp_system.h"
+#include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include <string.h>
 #include <stdio.h>
 #include <time.h>
+#include <sys/stat.h>
 
 static const char *TAG = "printer_emulator";
 
-// Current print job state
-static FILE *s_current_print_file = NULL;
+// Current print job state. The job is either received whole into a RAM buffer
+// (print_cache, saved after PRINT_EXECUTE) or streamed to SPIFFS by print_writer.
 static char s_current_print_filename[64];
 static uint32_t s_current_print_size = 0;
-
-// RAM buffer for print data (reduces SPIFFS write overhead)
-#define PRINT_BUFFER_SIZE (32 * 1024)  // 32KB RAM buffer (reduced to fit ESP32 available RAM)
-static uint8_t *s_print_buffer = NULL;
-static size_t s_print_buffer_pos = 0;
+static uint8_t *s_ram_job = NULL;       // Whole-print buffer, NULL when streaming
+static size_t s_ram_job_capacity = 0;
+static size_t s_ram_job_len = 0;
+static jpeg_scan_t s_jpeg_scan;         // Fed every chunk, checked at the end of the job
+static print_chunk_map_t s_chunk_map;   // Chunks received, kept with the job if the link drops
+static uint32_t s_next_chunk = 0;       // Index of the next chunk expected
+
+// Resuming a dropped job (print_resume): a same-size job first waits for chunk 0
+// to show whether it is the same image, then skips the chunks already received
+typedef enum {
+    RESUME_NONE = 0,
+    RESUME_VERIFY,      // Claimed a dropped job, waiting for chunk 0
+    RESUME_ACTIVE       // Same image - chunks in s_chunk_map are ACKed without writing
+} resume_state_t;
+static resume_state_t s_resume_state = RESUME_NONE;
 
 // NVS storage keys
 #define NVS_NAMESPACE "printer"
@@ -43,10 +68,41 @@ static size_t s_print_buffer_pos = 0;
 #define NVS_KEY_HARDWARE_REV "hardware_rev"
 #define NVS_KEY_SOFTWARE_REV "software_rev"
 #define NVS_KEY_MANUFACTURER "manufacturer"
+#define NVS_KEY_STATE "state"
+
+// Printer state is saved write-behind: setters mark it dirty and state_task
+// writes one versioned snapshot once changes settle (or on restart)
+#define PRINTER_STATE_VERSION 1
+#define PRINTER_STATE_DEBOUNCE_MS CONFIG_PRINTER_STATE_DEBOUNCE_MS
+#define PRINTER_STATE_MAX_DELAY_MS CONFIG_PRINTER_STATE_MAX_DELAY_MS
+#define STATE_TASK_STACK_SIZE 3072
+#define STATE_TASK_PRIORITY 2
+
+typedef struct {
+    uint16_t version;           // PRINTER_STATE_VERSION
+    uint16_t info_size;         // sizeof(instax_printer_info_t) when written
+    uint8_t suspend_decrement;
+    uint8_t reserved[3];
+    instax_printer_info_t info;
+} printer_state_blob_t;
+
+static TaskHandle_t s_state_task = NULL;
+static SemaphoreHandle_t s_state_mutex = NULL;
+static portMUX_TYPE s_state_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool s_state_dirty = false;
+static int64_t s_state_dirty_since_us = 0;  // First unsaved change
+static int64_t s_state_changed_us = 0;      // Latest unsaved change
+static bool s_state_legacy_keys = false;    // Per-field keys still in NVS
+static printer_state_blob_t s_state_saved;  // Last snapshot committed
+static bool s_state_saved_valid = false;
+static printer_state_stats_t s_state_stats = {0};
 
 // Suspend decrement flag (for unlimited testing)
 static bool s_suspend_decrement = false;
 
+// Bumped whenever s_printer_info changes (lets BLE drop prebuilt responses)
+static uint32_t s_info_generation = 1;
+
 // Printer state
 static instax_printer_info_t s_printer_info = {
     .model = INSTAX_MODEL_MINI,
@@ -81,19 +137,50 @@ static instax_printer_info_t s_printer_info = {
 };
 
 /**
- * Load printer state from NVS
+ * Mark printer info as changed (invalidates cached protocol responses)
  */
-static esp_err_t load_state_from_nvs(void) {
-    nvs_handle_t nvs_handle;
-    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
-    if (ret != ESP_OK) {
-        ESP_LOGI(TAG, "No saved state found, using defaults");
-        return ESP_OK;  // Not an error, just no saved state
-    }
+static void info_changed(void) {
+    __atomic_add_fetch(&s_info_generation, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Apply the persisted fields of a state snapshot
+ */
+static void apply_state_snapshot(const printer_state_blob_t *blob) {
+    const instax_printer_info_t *saved = &blob->info;
+
+    s_printer_info.model = saved->model;
+    s_printer_info.battery_percentage = saved->battery_percentage;
+    s_printer_info.photos_remaining = saved->photos_remaining;
+    s_printer_info.lifetime_print_count = saved->lifetime_print_count;
+    s_printer_info.is_charging = saved->is_charging;
+    s_suspend_decrement = (blob->suspend_decrement != 0);
+
+    memcpy(s_printer_info.device_name, saved->device_name, sizeof(s_printer_info.device_name));
+    memcpy(s_printer_info.model_number, saved->model_number, sizeof(s_printer_info.model_number));
+    memcpy(s_printer_info.serial_number, saved->serial_number, sizeof(s_printer_info.serial_number));
+    memcpy(s_printer_info.firmware_revision, saved->firmware_revision, sizeof(s_printer_info.firmware_revision));
+    memcpy(s_printer_info.hardware_revision, saved->hardware_revision, sizeof(s_printer_info.hardware_revision));
+    memcpy(s_printer_info.software_revision, saved->software_revision, sizeof(s_printer_info.software_revision));
+    memcpy(s_printer_info.manufacturer_name, saved->manufacturer_name, sizeof(s_printer_info.manufacturer_name));
+    s_printer_info.device_name[sizeof(s_printer_info.device_name) - 1] = '\0';
+    s_printer_info.model_number[sizeof(s_printer_info.model_number) - 1] = '\0';
+    s_printer_info.serial_number[sizeof(s_printer_info.serial_number) - 1] = '\0';
+    s_printer_info.firmware_revision[sizeof(s_printer_info.firmware_revision) - 1] = '\0';
+    s_printer_info.hardware_revision[sizeof(s_printer_info.hardware_revision) - 1] = '\0';
+    s_printer_info.software_revision[sizeof(s_printer_info.software_revision) - 1] = '\0';
+    s_printer_info.manufacturer_name[sizeof(s_printer_info.manufacturer_name) - 1] = '\0';
+}
 
+/**
+ * Load state written as one key per field (firmware before the state blob)
+ * The keys are erased by the first blob commit.
+ */
+static void load_legacy_state(nvs_handle_t nvs_handle) {
     uint8_t model;
     if (nvs_get_u8(nvs_handle, NVS_KEY_MODEL, &model) == ESP_OK) {
         s_printer_info.model = (instax_model_t)model;
+        s_state_legacy_keys = true;
     }
 
     nvs_get_u8(nvs_handle, NVS_KEY_BATTERY, &s_printer_info.battery_percentage);
@@ -105,10 +192,6 @@ static esp_err_t load_state_from_nvs(void) {
         s_printer_info.is_charging = (charging != 0);
     }
 
-    // EXPERIMENT 2: Force charging to false to test official app behavior
-    s_printer_info.is_charging = false;
-    ESP_LOGI(TAG, "EXPERIMENT 2: Forcing is_charging = false");
-
     uint8_t suspend;
     if (nvs_get_u8(nvs_handle, NVS_KEY_SUSPEND, &suspend) == ESP_OK) {
         s_suspend_decrement = (suspend != 0);
@@ -132,48 +215,193 @@ static esp_err_t load_state_from_nvs(void) {
     nvs_get_str(nvs_handle, NVS_KEY_SOFTWARE_REV, s_printer_info.software_revision, &len);
     len = sizeof(s_printer_info.manufacturer_name);
     nvs_get_str(nvs_handle, NVS_KEY_MANUFACTURER, s_printer_info.manufacturer_name, &len);
+}
+
+/**
+ * Load printer state from NVS
+ */
+static esp_err_t load_state_from_nvs(void) {
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGI(TAG, "No saved state found, using defaults");
+        return ESP_OK;  // Not an error, just no saved state
+    }
 
+    printer_state_blob_t blob;
+    size_t blob_len = sizeof(blob);
+    ret = nvs_get_blob(nvs_handle, NVS_KEY_STATE, &blob, &blob_len);
+    if (ret == ESP_OK && blob_len == sizeof(blob) && blob.version == PRINTER_STATE_VERSION &&
+        blob.info_size == sizeof(instax_printer_info_t)) {
+        apply_state_snapshot(&blob);
+        s_state_saved = blob;
+        s_state_saved_valid = true;
+        ESP_LOGI(TAG, "Loaded state from NVS (v%u snapshot)", blob.version);
+    } else {
+        if (ret == ESP_OK) {
+            ESP_LOGW(TAG, "Ignoring state snapshot v%u (%u bytes), expected v%u (%u bytes)",
+                     blob.version, (unsigned)blob_len, PRINTER_STATE_VERSION, (unsigned)sizeof(blob));
+        }
+        load_legacy_state(nvs_handle);
+        ESP_LOGI(TAG, "Loaded state from NVS%s", s_state_legacy_keys ? " (per-field keys, will migrate)" : "");
+    }
     nvs_close(nvs_handle);
-    ESP_LOGI(TAG, "Loaded state from NVS");
+
+    // EXPERIMENT 2: Force charging to false to test official app behavior
+    s_printer_info.is_charging = false;
+    ESP_LOGI(TAG, "EXPERIMENT 2: Forcing is_charging = false");
+
     return ESP_OK;
 }
 
 /**
- * Save printer state to NVS
+ * Write the current state snapshot to NVS if it differs from the last commit
+ * Serialised by s_state_mutex (state task and shutdown handler).
  */
-static esp_err_t save_state_to_nvs(void) {
+static esp_err_t flush_state_to_nvs(void) {
+    if (s_state_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_state_mutex, portMAX_DELAY);
+
+    portENTER_CRITICAL(&s_state_lock);
+    bool dirty = s_state_dirty;
+    s_state_dirty = false;
+    portEXIT_CRITICAL(&s_state_lock);
+    if (!dirty) {
+        xSemaphoreGive(s_state_mutex);
+        return ESP_OK;
+    }
+
+    printer_state_blob_t blob;
+    memset(&blob, 0, sizeof(blob));
+    blob.version = PRINTER_STATE_VERSION;
+    blob.info_size = sizeof(instax_printer_info_t);
+    blob.suspend_decrement = s_suspend_decrement ? 1 : 0;
+    memcpy(&blob.info, &s_printer_info, sizeof(blob.info));
+    blob.info.connected = false;    // Runtime only
+
+    if (s_state_saved_valid && !s_state_legacy_keys && memcmp(&blob, &s_state_saved, sizeof(blob)) == 0) {
+        portENTER_CRITICAL(&s_state_lock);
+        s_state_stats.unchanged++;
+        portEXIT_CRITICAL(&s_state_lock);
+        xSemaphoreGive(s_state_mutex);
+        return ESP_OK;
+    }
+
+    int64_t start_us = esp_timer_get_time();
     nvs_handle_t nvs_handle;
     esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
-        return ret;
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(nvs_handle, NVS_KEY_STATE, &blob, sizeof(blob));
+        if (ret == ESP_OK && s_state_legacy_keys) {
+            const char *legacy_keys[] = {
+                NVS_KEY_MODEL, NVS_KEY_BATTERY, NVS_KEY_PRINTS, NVS_KEY_LIFETIME, NVS_KEY_CHARGING,
+                NVS_KEY_SUSPEND, NVS_KEY_DEVICE_NAME, NVS_KEY_MODEL_NUMBER, NVS_KEY_SERIAL_NUMBER,
+                NVS_KEY_FIRMWARE_REV, NVS_KEY_HARDWARE_REV, NVS_KEY_SOFTWARE_REV, NVS_KEY_MANUFACTURER
+            };
+            for (size_t i = 0; i < sizeof(legacy_keys) / sizeof(legacy_keys[0]); i++) {
+                nvs_erase_key(nvs_handle, legacy_keys[i]);
+            }
+        }
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
     }
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
 
-    nvs_set_u8(nvs_handle, NVS_KEY_MODEL, (uint8_t)s_printer_info.model);
-    nvs_set_u8(nvs_handle, NVS_KEY_BATTERY, s_printer_info.battery_percentage);
-    nvs_set_u8(nvs_handle, NVS_KEY_PRINTS, s_printer_info.photos_remaining);
-    nvs_set_u32(nvs_handle, NVS_KEY_LIFETIME, s_printer_info.lifetime_print_count);
-    nvs_set_u8(nvs_handle, NVS_KEY_CHARGING, s_printer_info.is_charging ? 1 : 0);
-    nvs_set_u8(nvs_handle, NVS_KEY_SUSPEND, s_suspend_decrement ? 1 : 0);
-    nvs_set_str(nvs_handle, NVS_KEY_DEVICE_NAME, s_printer_info.device_name);
-
-    // Save Device Information Service values
-    nvs_set_str(nvs_handle, NVS_KEY_MODEL_NUMBER, s_printer_info.model_number);
-    nvs_set_str(nvs_handle, NVS_KEY_SERIAL_NUMBER, s_printer_info.serial_number);
-    nvs_set_str(nvs_handle, NVS_KEY_FIRMWARE_REV, s_printer_info.firmware_revision);
-    nvs_set_str(nvs_handle, NVS_KEY_HARDWARE_REV, s_printer_info.hardware_revision);
-    nvs_set_str(nvs_handle, NVS_KEY_SOFTWARE_REV, s_printer_info.software_revision);
-    nvs_set_str(nvs_handle, NVS_KEY_MANUFACTURER, s_printer_info.manufacturer_name);
+    portENTER_CRITICAL(&s_state_lock);
+    if (ret == ESP_OK) {
+        s_state_stats.commits++;
+        s_state_stats.last_us = elapsed_us;
+        s_state_stats.total_us += elapsed_us;
+        if (elapsed_us > s_state_stats.max_us) {
+            s_state_stats.max_us = elapsed_us;
+        }
+    } else {
+        // Retried by state_task one debounce window from now (both timers
+        // restart, so a lasting failure is retried at that pace, not in a loop)
+        s_state_stats.failures++;
+        s_state_dirty = true;
+        s_state_dirty_since_us = esp_timer_get_time();
+        s_state_changed_us = s_state_dirty_since_us;
+    }
+    portEXIT_CRITICAL(&s_state_lock);
 
-    ret = nvs_commit(nvs_handle);
-    nvs_close(nvs_handle);
+    if (ret != ESP_OK && s_state_task != NULL) {
+        xTaskNotifyGive(s_state_task);
+    }
 
     if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "Saved state to NVS");
+        if (s_state_legacy_keys) {
+            ESP_LOGI(TAG, "Migrated printer state to a single NVS snapshot");
+        }
+        s_state_saved = blob;
+        s_state_saved_valid = true;
+        s_state_legacy_keys = false;
+        ESP_LOGI(TAG, "Saved state to NVS (%lu us)", (unsigned long)elapsed_us);
+    } else {
+        ESP_LOGE(TAG, "Failed to save state to NVS: %s", esp_err_to_name(ret));
     }
+
+    xSemaphoreGive(s_state_mutex);
     return ret;
 }
 
+/**
+ * Writes the state once changes have settled for the debounce window, or at
+ * the latest PRINTER_STATE_MAX_DELAY_MS after the first unsaved change
+ */
+static void state_task(void *arg) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (true) {
+            portENTER_CRITICAL(&s_state_lock);
+            bool dirty = s_state_dirty;
+            int64_t settle_at = s_state_changed_us + PRINTER_STATE_DEBOUNCE_MS * 1000LL;
+            int64_t deadline = s_state_dirty_since_us + PRINTER_STATE_MAX_DELAY_MS * 1000LL;
+            portEXIT_CRITICAL(&s_state_lock);
+
+            int64_t wait_us = (settle_at < deadline ? settle_at : deadline) - esp_timer_get_time();
+            if (!dirty || wait_us <= 0) {
+                break;
+            }
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_us / 1000) + 1);
+        }
+
+        flush_state_to_nvs();
+    }
+}
+
+/**
+ * Mark printer state for saving (write-behind: coalesced by state_task)
+ */
+static void schedule_state_save(void) {
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_state_lock);
+    s_state_stats.requests++;
+    if (!s_state_dirty) {
+        s_state_dirty = true;
+        s_state_dirty_since_us = now;
+    }
+    s_state_changed_us = now;
+    portEXIT_CRITICAL(&s_state_lock);
+
+    if (s_state_task != NULL) {
+        xTaskNotifyGive(s_state_task);
+    }
+}
+
+/**
+ * Flush pending state before a restart (esp_restart() shutdown handler)
+ */
+static void state_shutdown_handler(void) {
+    printer_emulator_flush_state();
+}
+
 /**
  * Update model-specific dimensions
  */
@@ -248,113 +476,237 @@ esp_err_t printer_emulator_reset_dis_to_defaults(void) {
              s_printer_info.software_revision,
              s_printer_info.manufacturer_name);
     ESP_LOGI(TAG, "Device name set to: %s", s_printer_info.device_name);
+    info_changed();
 
-    save_state_to_nvs();
+    schedule_state_save();
     return ESP_OK;
 }
 
 /**
- * Print start callback - called when print job starts
- * @return true if successful, false if error (out of memory, etc.)
+ * Publish where the next chunk may be received in place (protocol task)
+ * The NimBLE host task only sees this snapshot, never the job state itself,
+ * so call it after every change to the job's buffers, write position or
+ * resume state. Whether the next chunk of a resumed job is skipped is decided
+ * here, from s_chunk_map and s_next_chunk.
  */
-static bool on_print_start(uint32_t image_size) {
-    ESP_LOGI(TAG, "Print job started: %lu bytes", (unsigned long)image_size);
+static void publish_print_target(void) {
+    uint8_t *dest = NULL;
+    size_t capacity = 0;
+    if (s_resume_state == RESUME_VERIFY ||
+        (s_resume_state == RESUME_ACTIVE && print_chunk_map_has(&s_chunk_map, s_next_chunk))) {
+        // Chunk 0 of a claimed job is checked and chunks already received are
+        // skipped on the copying path
+    } else if (s_ram_job != NULL) {
+        // Straight into the whole-print buffer
+        dest = s_ram_job + s_ram_job_len;
+        capacity = s_ram_job_capacity - s_ram_job_len;
+    } else {
+        dest = print_writer_reserve(&capacity);
+    }
+    ble_peripheral_publish_print_target(dest, capacity);
+}
 
+/**
+ * Take the print target back before a buffer is swapped or freed (protocol task)
+ */
+static void withdraw_print_target(void) {
+    ble_peripheral_publish_print_target(NULL, 0);
+}
+
+/**
+ * Set up a fresh job: RAM buffer if possible, otherwise a file streamed by print_writer
+ */
+static bool start_new_job(uint32_t image_size) {
     // Generate filename with timestamp
     time_t now = time(NULL);
     snprintf(s_current_print_filename, sizeof(s_current_print_filename),
-             "/spiffs/print_%lu.jpg", (unsigned long)now);
+             SPIFFS_BASE_PATH "/print_%lu.jpg", (unsigned long)now);
 
-    // Open file for writing
-    s_current_print_file = fopen(s_current_print_filename, "wb");
-    if (s_current_print_file == NULL) {
-        ESP_LOGE(TAG, "Failed to open file for writing: %s", s_current_print_filename);
-        return false;
+    jpeg_scan_init(&s_jpeg_scan);
+
+    // Prefer holding the whole print in RAM until PRINT_EXECUTE
+    s_ram_job_len = 0;
+    s_ram_job = print_cache_begin(s_current_print_filename, image_size, &s_ram_job_capacity);
+    if (s_ram_job != NULL) {
+        ESP_LOGI(TAG, "Receiving print into RAM, saving to %s after PRINT_EXECUTE", s_current_print_filename);
+        return true;
     }
 
-    // Allocate RAM buffer for incoming data
-    s_print_buffer = malloc(PRINT_BUFFER_SIZE);
-    if (s_print_buffer == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate %d byte RAM buffer!", PRINT_BUFFER_SIZE);
-        fclose(s_current_print_file);
-        s_current_print_file = NULL;
+    // Otherwise stream it: open the file and borrow the RAM buffers for incoming data
+    if (print_writer_open(s_current_print_filename) != ESP_OK) {
+        s_current_print_filename[0] = '\0';
         return false;
     }
-    s_print_buffer_pos = 0;
 
-    s_current_print_size = image_size;
-    ESP_LOGI(TAG, "Saving print to: %s (using %dKB RAM buffer)", s_current_print_filename, PRINT_BUFFER_SIZE / 1024);
+    ESP_LOGI(TAG, "Saving print to: %s (using 2 x %dKB RAM buffers)", s_current_print_filename,
+             PRINT_WRITER_BUFFER_SIZE / 1024);
     return true;
 }
 
 /**
- * Print data callback - called for each chunk of print data
+ * Take over a dropped job of the same size until chunk 0 confirms it
  */
-static void on_print_data(uint32_t chunk_index, const uint8_t *data, size_t len) {
+static bool claim_dropped_job(print_resume_job_t *job) {
+    if (job->ram != NULL) {
+        s_ram_job = job->ram;
+        s_ram_job_capacity = job->ram_capacity;
+        s_ram_job_len = job->map.bytes;
+    } else {
+        // The partial file must still hold exactly the chunks received
+        struct stat st;
+        if (stat(job->path, &st) != 0 || (uint32_t)st.st_size != job->map.bytes ||
+            print_writer_open_append(job->path) != ESP_OK) {
+            ESP_LOGW(TAG, "Partial file %s changed or cannot be reopened - not resuming", job->path);
+            print_resume_release(job);
+            return false;
+        }
+    }
+
+    snprintf(s_current_print_filename, sizeof(s_current_print_filename), "%s", job->path);
+    s_jpeg_scan = job->scan;
+    s_chunk_map = job->map;
+    s_resume_state = RESUME_VERIFY;
+    ESP_LOGI(TAG, "Same size as the dropped job - checking chunk 0 before resuming %s", s_current_print_filename);
+    return true;
+}
+
+/**
+ * Chunk 0 of a claimed job: continue the dropped job if it is the same image,
+ * otherwise drop the old data and start over
+ */
+static void verify_claimed_job(const uint8_t *data, size_t len) {
+    if (print_chunk_map_crc(data, len) == s_chunk_map.first_crc) {
+        s_resume_state = RESUME_ACTIVE;
+        print_resume_record_result(true, &s_chunk_map);
+        return;
+    }
+
+    print_resume_record_result(false, &s_chunk_map);
+    withdraw_print_target();  // Already NULL while verifying - keep it so while the buffers go
+    s_resume_state = RESUME_NONE;
+    if (s_ram_job != NULL) {
+        print_cache_abort();
+        s_ram_job = NULL;
+        s_ram_job_capacity = 0;
+        s_ram_job_len = 0;
+    } else if (print_writer_is_open()) {
+        print_writer_close();
+    }
+    print_chunk_map_reset(&s_chunk_map, s_current_print_size);
+    if (!start_new_job(s_current_print_size)) {
+        ESP_LOGE(TAG, "No buffer for the restarted print - its data will be dropped");
+    }
+}
+
+/**
+ * Keep a dropped job in case the app restarts it
+ * @return true if print_resume now owns the job's RAM buffer / partial file
+ */
+static bool park_dropped_job(void) {
+    print_resume_job_t job;
+    memset(&job, 0, sizeof(job));
+    snprintf(job.path, sizeof(job.path), "%s", s_current_print_filename);
+    job.ram = s_ram_job;
+    job.ram_capacity = s_ram_job_capacity;
+    job.scan = s_jpeg_scan;
+    job.map = s_chunk_map;
+    return print_resume_park(&job);
+}
+
+/**
+ * Print start callback - called when print job starts
+ * @return true if successful, false if error (out of memory, etc.)
+ */
+static bool on_print_start(uint32_t image_size) {
+    ESP_LOGI(TAG, "Print job started: %lu bytes", (unsigned long)image_size);
+
+    withdraw_print_target();
+    print_writer_reset_stats();
+    s_current_print_size = image_size;
+    s_next_chunk = 0;
+    s_resume_state = RESUME_NONE;
+    print_chunk_map_reset(&s_chunk_map, image_size);
+
+    print_resume_job_t dropped;
+    bool ok = (print_resume_claim(image_size, &dropped) && claim_dropped_job(&dropped)) ||
+              start_new_job(image_size);
+    publish_print_target();
+    return ok;
+}
+
+/**
+ * Add a chunk received by the copying path to the job
+ */
+static void store_chunk(uint32_t chunk_index, const uint8_t *data, size_t len) {
     // Reduced logging to save stack space during rapid transfers
     if (chunk_index % 20 == 0) {
-        ESP_LOGD(TAG, "Print data chunk %lu: %d bytes (buffer: %d/%d)",
-                (unsigned long)chunk_index, len, s_print_buffer_pos, PRINT_BUFFER_SIZE);
+        ESP_LOGD(TAG, "Print data chunk %lu: %u bytes", (unsigned long)chunk_index, (unsigned)len);
     }
+    s_next_chunk = chunk_index + 1;
 
-    if (s_current_print_file == NULL || s_print_buffer == NULL) {
-        ESP_LOGW(TAG, "No open print file or buffer for data chunk");
+    if (s_resume_state == RESUME_VERIFY) {
+        verify_claimed_job(data, len);
+    }
+    if (s_resume_state == RESUME_ACTIVE && print_chunk_map_has(&s_chunk_map, chunk_index)) {
+        // Received before the link dropped - ACK it without writing it again
+        print_resume_record_skip(len);
         return;
     }
 
-    // Log first chunk bytes to verify JPEG header
-    if (chunk_index == 0 && len > 0) {
-        ESP_LOGD(TAG, "First chunk (%d bytes): %02x %02x %02x %02x %02x %02x %02x %02x",
-                len,
-                len > 0 ? data[0] : 0, len > 1 ? data[1] : 0, len > 2 ? data[2] : 0, len > 3 ? data[3] : 0,
-                len > 4 ? data[4] : 0, len > 5 ? data[5] : 0, len > 6 ? data[6] : 0, len > 7 ? data[7] : 0);
-
-        // Check for JPEG header (should be FF D8 FF)
-        if (len >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF) {
-            ESP_LOGD(TAG, "Valid JPEG header detected");
-        } else {
-            ESP_LOGW(TAG, "WARNING: Expected JPEG header (FF D8 FF), got %02x %02x %02x",
-                    len > 0 ? data[0] : 0, len > 1 ? data[1] : 0, len > 2 ? data[2] : 0);
+    if (s_ram_job != NULL) {
+        if (s_ram_job_len + len > s_ram_job_capacity) {
+            ESP_LOGE(TAG, "Print data overruns RAM buffer: %u + %u > %u",
+                     (unsigned)s_ram_job_len, (unsigned)len, (unsigned)s_ram_job_capacity);
+            return;
         }
+        memcpy(s_ram_job + s_ram_job_len, data, len);
+        s_ram_job_len += len;
+        jpeg_scan_feed(&s_jpeg_scan, data, len);
+        print_chunk_map_add(&s_chunk_map, chunk_index, data, len);
+        return;
     }
 
-    // Copy data to RAM buffer
-    if (s_print_buffer_pos + len <= PRINT_BUFFER_SIZE) {
-        memcpy(s_print_buffer + s_print_buffer_pos, data, len);
-        s_print_buffer_pos += len;
-    } else {
-        ESP_LOGW(TAG, "Buffer overflow prevented: %d + %d > %d", s_print_buffer_pos, len, PRINT_BUFFER_SIZE);
-        // Flush current buffer to make room
-        if (s_print_buffer_pos > 0) {
-            size_t written = fwrite(s_print_buffer, 1, s_print_buffer_pos, s_current_print_file);
-            if (written != s_print_buffer_pos) {
-                ESP_LOGE(TAG, "Failed to write buffer: wrote %d/%d bytes", written, s_print_buffer_pos);
-            }
-            s_print_buffer_pos = 0;
-        }
-        // Now copy the incoming data
-        if (len <= PRINT_BUFFER_SIZE) {
-            memcpy(s_print_buffer, data, len);
-            s_print_buffer_pos = len;
-        } else {
-            // Chunk is larger than entire buffer - write directly
-            ESP_LOGW(TAG, "Chunk larger than buffer, writing directly");
-            size_t written = fwrite(data, 1, len, s_current_print_file);
-            if (written != len) {
-                ESP_LOGE(TAG, "Failed to write large chunk: wrote %d/%d bytes", written, len);
-            }
-        }
+    if (!print_writer_is_open()) {
+        ESP_LOGW(TAG, "No open print file or buffer for data chunk");
+        return;
     }
 
-    // Flush buffer to SPIFFS when it's getting full (reserve 2KB for next chunk)
-    if (s_print_buffer_pos >= PRINT_BUFFER_SIZE - 2048) {
-        ESP_LOGD(TAG, "Buffer near full (%d bytes), flushing to SPIFFS", s_print_buffer_pos);
-        size_t written = fwrite(s_print_buffer, 1, s_print_buffer_pos, s_current_print_file);
-        if (written != s_print_buffer_pos) {
-            ESP_LOGE(TAG, "Failed to write buffer: wrote %d/%d bytes", written, s_print_buffer_pos);
-        }
-        s_print_buffer_pos = 0;
+    // Copy data to the active RAM buffer (swapped to the writer task when full)
+    jpeg_scan_feed(&s_jpeg_scan, data, len);
+    if (print_writer_write(data, len) == ESP_OK) {
+        print_chunk_map_add(&s_chunk_map, chunk_index, data, len);
+    }
+}
+
+/**
+ * Print data callback - called for each chunk of print data
+ */
+static void on_print_data(uint32_t chunk_index, const uint8_t *data, size_t len) {
+    store_chunk(chunk_index, data, len);
+    publish_print_target();
+}
+
+/**
+ * Commit callback for the zero-copy path - chunk data is at the published print target
+ */
+static void on_print_commit(uint32_t chunk_index, size_t len) {
+    s_next_chunk = chunk_index + 1;
+    if (s_resume_state == RESUME_ACTIVE && print_chunk_map_has(&s_chunk_map, chunk_index)) {
+        // Target was published for another chunk index - never append a chunk twice
+        print_resume_record_skip(len);
+    } else if (s_ram_job != NULL) {
+        jpeg_scan_feed(&s_jpeg_scan, s_ram_job + s_ram_job_len, len);
+        print_chunk_map_add(&s_chunk_map, chunk_index, s_ram_job + s_ram_job_len, len);
+        s_ram_job_len += len;
+    } else if (print_writer_is_open()) {
+        // Scan before committing - the commit may hand the buffer to the writer task
+        jpeg_scan_feed(&s_jpeg_scan, print_writer_active_tail(), len);
+        print_chunk_map_add(&s_chunk_map, chunk_index, print_writer_active_tail(), len);
+        print_writer_commit(len);
+    } else {
+        ESP_LOGW(TAG, "No open print file or buffer for data chunk");
     }
+    publish_print_target();
 }
 
 /**
@@ -362,28 +714,55 @@ static void on_print_data(uint32_t chunk_index, const uint8_t *data, size_t len)
  * Called on: successful completion, disconnect, error, timeout
  */
 static void cleanup_print_job(bool save_counts) {
-    // Flush any remaining buffered data to SPIFFS
-    if (s_print_buffer != NULL && s_print_buffer_pos > 0 && s_current_print_file != NULL) {
-        ESP_LOGI(TAG, "Flushing final %d bytes from RAM buffer to SPIFFS", s_print_buffer_pos);
-        size_t written = fwrite(s_print_buffer, 1, s_print_buffer_pos, s_current_print_file);
-        if (written != s_print_buffer_pos) {
-            ESP_LOGE(TAG, "Failed to write final buffer: wrote %d/%d bytes", written, s_print_buffer_pos);
+    withdraw_print_target();
+
+    // Report the JPEG check from the scan done while the data arrived
+    if (s_current_print_filename[0] != '\0') {
+        jpeg_scan_result_t image;
+        jpeg_scan_finish(&s_jpeg_scan, &image);
+        if (image.status == JPEG_SCAN_OK) {
+            ESP_LOGI(TAG, "🖼️ JPEG ok: %ux%u, %u components, %s, CRC32 %08lx, %lu bytes after EOI",
+                     image.width, image.height, image.components,
+                     image.sof == 0xC2 ? "progressive" : "baseline", (unsigned long)image.crc32,
+                     (unsigned long)(image.bytes - image.eoi_offset));
+        } else {
+            ESP_LOGW(TAG, "🖼️ JPEG %s at byte %lu of %lu (CRC32 %08lx)",
+                     jpeg_scan_status_to_string(image.status), (unsigned long)image.error_offset,
+                     (unsigned long)image.bytes, (unsigned long)image.crc32);
+        }
+        print_telemetry_record_image(s_current_print_filename, &image);
+
+        // Gallery preview, made once the central has gone (TJpgDec is baseline only)
+        if (save_counts && image.status == JPEG_SCAN_OK && image.sof != 0xC2) {
+            thumbnail_request(strrchr(s_current_print_filename, '/') + 1);
         }
-        s_print_buffer_pos = 0;
     }
 
-    // Free RAM buffer (CRITICAL for preventing memory leak)
-    if (s_print_buffer != NULL) {
-        free(s_print_buffer);
-        s_print_buffer = NULL;
-        ESP_LOGI(TAG, "✅ Freed 32KB RAM buffer");
+    // Whole-print job: save it now (PRINT_EXECUTE), keep it in case the app restarts
+    // it, or drop it without touching flash
+    if (s_ram_job != NULL) {
+        if (save_counts) {
+            ESP_LOGI(TAG, "Saving %u byte print from RAM to %s",
+                     (unsigned)s_ram_job_len, s_current_print_filename);
+            print_cache_finish(s_ram_job_len);
+        } else if (!park_dropped_job()) {
+            print_cache_abort();
+        }
+        s_ram_job = NULL;
+        s_ram_job_capacity = 0;
+        s_ram_job_len = 0;
     }
 
-    // Close file
-    if (s_current_print_file != NULL) {
-        fclose(s_current_print_file);
-        s_current_print_file = NULL;
+    // Write remaining buffered data, close the file and free the RAM buffers
+    // (CRITICAL for preventing memory leak)
+    if (print_writer_is_open()) {
+        if (print_writer_close() != ESP_OK) {
+            ESP_LOGE(TAG, "Print data was lost while writing %s", s_current_print_filename);
+        } else if (!save_counts && s_current_print_filename[0] != '\0') {
+            park_dropped_job();  // The partial file can be appended to if the app restarts the job
+        }
     }
+    s_resume_state = RESUME_NONE;
 
     // Update counters only if requested (successful completion)
     if (save_counts && s_current_print_filename[0] != '\0') {
@@ -400,8 +779,10 @@ static void cleanup_print_job(bool save_counts) {
             ESP_LOGI(TAG, "Print count decrement suspended - remaining unchanged at %d", s_printer_info.photos_remaining);
         }
 
+        info_changed();
+
         // Save updated state
-        save_state_to_nvs();
+        schedule_state_save();
 
         ESP_LOGI(TAG, "Lifetime prints: %lu, Remaining: %d",
                 (unsigned long)s_printer_info.lifetime_print_count,
@@ -410,6 +791,9 @@ static void cleanup_print_job(bool save_counts) {
 
     // Clear filename
     s_current_print_filename[0] = '\0';
+
+    // Make room for the next job while the link is idle
+    retention_kick();
 }
 
 /**
@@ -426,6 +810,15 @@ esp_err_t printer_emulator_init(void) {
     // Load saved state
     load_state_from_nvs();
 
+    s_state_mutex = xSemaphoreCreateMutex();
+    if (s_state_mutex == NULL ||
+        xTaskCreate(state_task, "printer_state", STATE_TASK_STACK_SIZE, NULL,
+                    STATE_TASK_PRIORITY, &s_state_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start printer state task");
+        return ESP_ERR_NO_MEM;
+    }
+    esp_register_shutdown_handler(state_shutdown_handler);
+
     // Update dimensions based on model
     update_model_dimensions();
 
@@ -440,8 +833,30 @@ esp_err_t printer_emulator_init(void) {
     ESP_LOGI(TAG, "  Prints remaining: %d", s_printer_info.photos_remaining);
     ESP_LOGI(TAG, "  Lifetime prints: %lu", (unsigned long)s_printer_info.lifetime_print_count);
 
+    // Load transport profile overrides and ACK pacing mode, and start the
+    // SPIFFS writer before BLE comes up
+    transport_profile_init();
+    ack_pacer_init();
+    esp_err_t ret = print_writer_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start print writer");
+        return ret;
+    }
+    ret = print_cache_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize print cache");
+        return ret;
+    }
+    print_journal_init();
+    if (thumbnail_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to start thumbnail task - gallery will show full images");
+    }
+    if (retention_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to start retention task - old prints will not be evicted");
+    }
+
     // Initialize BLE peripheral
-    esp_err_t ret = ble_peripheral_init();
+    ret = ble_peripheral_init();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize BLE peripheral");
         return ret;
@@ -451,6 +866,7 @@ esp_err_t printer_emulator_init(void) {
     ble_peripheral_register_print_start_callback(on_print_start);
     ble_peripheral_register_print_data_callback(on_print_data);
     ble_peripheral_register_print_complete_callback(on_print_complete);
+    ble_peripheral_register_print_commit_callback(on_print_commit);
 
     ESP_LOGI(TAG, "BLE peripheral initialized and callbacks registered");
     return ESP_OK;
@@ -470,6 +886,10 @@ const instax_printer_info_t* printer_emulator_get_info(void) {
     return &s_printer_info;
 }
 
+uint32_t printer_emulator_get_info_generation(void) {
+    return __atomic_load_n(&s_info_generation, __ATOMIC_ACQUIRE);
+}
+
 esp_err_t printer_emulator_set_model(instax_model_t model) {
     if (model != INSTAX_MODEL_MINI &&
         model != INSTAX_MODEL_SQUARE &&
@@ -479,13 +899,14 @@ esp_err_t printer_emulator_set_model(instax_model_t model) {
 
     s_printer_info.model = model;
     update_model_dimensions();
+    info_changed();
 
     // Reset Device Information Service values to model-specific defaults
     printer_emulator_reset_dis_to_defaults();
 
     // CRITICAL: Save updated device name and DIS values to NVS
     // Without this, old device name persists across reboots (e.g., WIDE-205555 when model is Square)
-    save_state_to_nvs();
+    schedule_state_save();
 
     ESP_LOGI(TAG, "Model set to %s (%dx%d)",
              printer_emulator_model_to_string(model),
@@ -520,8 +941,9 @@ esp_err_t printer_emulator_set_battery(uint8_t percentage) {
     } else {
         s_printer_info.battery_state = 0;  // Critical
     }
+    info_changed();
 
-    save_state_to_nvs();
+    schedule_state_save();
 
     ESP_LOGI(TAG, "Battery set to %d%%", percentage);
     return ESP_OK;
@@ -529,7 +951,8 @@ esp_err_t printer_emulator_set_battery(uint8_t percentage) {
 
 esp_err_t printer_emulator_set_prints_remaining(uint8_t count) {
     s_printer_info.photos_remaining = count;
-    save_state_to_nvs();
+    info_changed();
+    schedule_state_save();
 
     ESP_LOGI(TAG, "Prints remaining set to %d", count);
     return ESP_OK;
@@ -537,7 +960,8 @@ esp_err_t printer_emulator_set_prints_remaining(uint8_t count) {
 
 esp_err_t printer_emulator_set_charging(bool is_charging) {
     s_printer_info.is_charging = is_charging;
-    save_state_to_nvs();
+    info_changed();
+    schedule_state_save();
 
     ESP_LOGI(TAG, "Charging status set to %s", is_charging ? "ON" : "OFF");
     return ESP_OK;
@@ -554,7 +978,8 @@ esp_err_t printer_emulator_set_device_name(const char *name) {
 
     strncpy(s_printer_info.device_name, name, sizeof(s_printer_info.device_name) - 1);
     s_printer_info.device_name[sizeof(s_printer_info.device_name) - 1] = '\0';
-    save_state_to_nvs();
+    info_changed();
+    schedule_state_save();
 
     ESP_LOGI(TAG, "Device name set to: %s", s_printer_info.device_name);
 
@@ -572,43 +997,49 @@ esp_err_t printer_emulator_set_device_name(const char *name) {
 
 esp_err_t printer_emulator_set_cover_open(bool is_open) {
     s_printer_info.cover_open = is_open;
+    info_changed();
     ESP_LOGI(TAG, "Cover %s (error 179: %s)", is_open ? "OPEN" : "closed", is_open ? "ACTIVE" : "disabled");
     return ESP_OK;
 }
 
 esp_err_t printer_emulator_set_busy(bool is_busy) {
     s_printer_info.printer_busy = is_busy;
+    info_changed();
     ESP_LOGI(TAG, "Printer %s (error 181: %s)", is_busy ? "BUSY" : "ready", is_busy ? "ACTIVE" : "disabled");
     return ESP_OK;
 }
 
 esp_err_t printer_emulator_set_accel_x(int16_t x) {
     s_printer_info.accelerometer.x = x;
+    info_changed();
     ESP_LOGI(TAG, "Accelerometer X set to %d", x);
     return ESP_OK;
 }
 
 esp_err_t printer_emulator_set_accel_y(int16_t y) {
     s_printer_info.accelerometer.y = y;
+    info_changed();
     ESP_LOGI(TAG, "Accelerometer Y set to %d", y);
     return ESP_OK;
 }
 
 esp_err_t printer_emulator_set_accel_z(int16_t z) {
     s_printer_info.accelerometer.z = z;
+    info_changed();
     ESP_LOGI(TAG, "Accelerometer Z set to %d", z);
     return ESP_OK;
 }
 
 esp_err_t printer_emulator_set_accel_orientation(uint8_t orientation) {
     s_printer_info.accelerometer.orientation = orientation;
+    info_changed();
     ESP_LOGI(TAG, "Accelerometer orientation set to %d", orientation);
     return ESP_OK;
 }
 
 esp_err_t printer_emulator_set_suspend_decrement(bool suspend) {
     s_suspend_decrement = suspend;
-    save_state_to_nvs();
+    schedule_state_save();
 
     ESP_LOGI(TAG, "Suspend decrement %s", suspend ? "ENABLED" : "DISABLED");
     return ESP_OK;
@@ -620,6 +1051,7 @@ bool printer_emulator_get_suspend_decrement(void) {
 
 esp_err_t printer_emulator_set_auto_sleep(uint8_t timeout_minutes) {
     s_printer_info.auto_sleep_timeout = timeout_minutes;
+    info_changed();
     ESP_LOGI(TAG, "Auto-sleep timeout set to %d minutes (%s)",
              timeout_minutes, timeout_minutes == 0 ? "never" : "enabled");
     return ESP_OK;
@@ -631,6 +1063,7 @@ esp_err_t printer_emulator_set_print_mode(uint8_t mode) {
         // Accept it anyway to support future modes
     }
     s_printer_info.print_mode = mode;
+    info_changed();
     const char *mode_str;
     switch (mode) {
         case 0x00: mode_str = "Rich"; break;
@@ -652,7 +1085,8 @@ esp_err_t printer_emulator_set_model_number(const char *model_number) {
     }
     strncpy(s_printer_info.model_number, model_number, sizeof(s_printer_info.model_number) - 1);
     s_printer_info.model_number[sizeof(s_printer_info.model_number) - 1] = '\0';
-    save_state_to_nvs();
+    info_changed();
+    schedule_state_save();
     ESP_LOGI(TAG, "Model number set to: %s (BLE DIS will update on next advertising restart)", s_printer_info.model_number);
     return ESP_OK;
 }
@@ -666,7 +1100,8 @@ esp_err_t printer_emulator_set_serial_number(const char *serial_number) {
     }
     strncpy(s_printer_info.serial_number, serial_number, sizeof(s_printer_info.serial_number) - 1);
     s_printer_info.serial_number[sizeof(s_printer_info.serial_number) - 1] = '\0';
-    save_state_to_nvs();
+    info_changed();
+    schedule_state_save();
     ESP_LOGI(TAG, "Serial number set to: %s (BLE DIS will update on next advertising restart)", s_printer_info.serial_number);
     return ESP_OK;
 }
@@ -680,7 +1115,8 @@ esp_err_t printer_emulator_set_firmware_revision(const char *firmware_revision)
     }
     strncpy(s_printer_info.firmware_revision, firmware_revision, sizeof(s_printer_info.firmware_revision) - 1);
     s_printer_info.firmware_revision[sizeof(s_printer_info.firmware_revision) - 1] = '\0';
-    save_state_to_nvs();
+    info_changed();
+    schedule_state_save();
     ESP_LOGI(TAG, "Firmware revision set to: %s (BLE DIS will update on next advertising restart)", s_printer_info.firmware_revision);
     return ESP_OK;
 }
@@ -694,7 +1130,8 @@ esp_err_t printer_emulator_set_hardware_revision(const char *hardware_revision)
     }
     strncpy(s_printer_info.hardware_revision, hardware_revision, sizeof(s_printer_info.hardware_revision) - 1);
     s_printer_info.hardware_revision[sizeof(s_printer_info.hardware_revision) - 1] = '\0';
-    save_state_to_nvs();
+    info_changed();
+    schedule_state_save();
     ESP_LOGI(TAG, "Hardware revision set to: %s (BLE DIS will update on next advertising restart)", s_printer_info.hardware_revision);
     return ESP_OK;
 }
@@ -708,7 +1145,8 @@ esp_err_t printer_emulator_set_software_revision(const char *software_revision)
     }
     strncpy(s_printer_info.software_revision, software_revision, sizeof(s_printer_info.software_revision) - 1);
     s_printer_info.software_revision[sizeof(s_printer_info.software_revision) - 1] = '\0';
-    save_state_to_nvs();
+    info_changed();
+    schedule_state_save();
     ESP_LOGI(TAG, "Software revision set to: %s (BLE DIS will update on next advertising restart)", s_printer_info.software_revision);
     return ESP_OK;
 }
@@ -722,11 +1160,26 @@ esp_err_t printer_emulator_set_manufacturer_name(const char *manufacturer_name)
     }
     strncpy(s_printer_info.manufacturer_name, manufacturer_name, sizeof(s_printer_info.manufacturer_name) - 1);
     s_printer_info.manufacturer_name[sizeof(s_printer_info.manufacturer_name) - 1] = '\0';
-    save_state_to_nvs();
+    info_changed();
+    schedule_state_save();
     ESP_LOGI(TAG, "Manufacturer name set to: %s (BLE DIS will update on next advertising restart)", s_printer_info.manufacturer_name);
     return ESP_OK;
 }
 
+esp_err_t printer_emulator_flush_state(void) {
+    return flush_state_to_nvs();
+}
+
+void printer_emulator_get_state_stats(printer_state_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_state_lock);
+    memcpy(stats, &s_state_stats, sizeof(*stats));
+    stats->pending = s_state_dirty;
+    portEXIT_CRITICAL(&s_state_lock);
+}
+
 const char* printer_emulator_model_to_string(instax_model_t model) {
     switch (model) {
         case INSTAX_MODEL_MINI:
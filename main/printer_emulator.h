@@ -33,6 +33,13 @@ esp_err_t printer_emulator_stop_advertising(void);
  */
 const instax_printer_info_t* printer_emulator_get_info(void);
 
+/**
+ * Get printer info generation
+ * Changes whenever a setter modifies printer info; use it to invalidate
+ * anything derived from printer_emulator_get_info().
+ */
+uint32_t printer_emulator_get_info_generation(void);
+
 /**
  * Set printer model (mini/wide/square)
  */
@@ -149,6 +156,30 @@ bool printer_emulator_is_advertising(void);
  */
 void printer_emulator_dump_config(void);
 
+// Printer state persistence statistics (since boot)
+typedef struct {
+    uint32_t requests;      // State changes marked for saving
+    uint32_t commits;       // Snapshots written to NVS
+    uint32_t unchanged;     // Flushes skipped, snapshot already in NVS
+    uint32_t failures;
+    uint32_t last_us;       // Duration of the last commit
+    uint32_t max_us;
+    uint64_t total_us;
+    bool pending;           // Changes not yet written
+} printer_state_stats_t;
+
+/**
+ * Write pending printer state to NVS now
+ * State changes are otherwise coalesced and written in the background; this
+ * also runs automatically from esp_restart().
+ */
+esp_err_t printer_emulator_flush_state(void);
+
+/**
+ * Get printer state persistence statistics
+ */
+void printer_emulator_get_state_stats(printer_state_stats_t *stats);
+
 /**
  * Abort current print job and cleanup resources
  * Called on: disconnect, error, timeout
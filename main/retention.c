@@ -0,0 +1,319 @@
+/**
+ * @file retention.c
+ * @brief Storage retention: evicts old prints so the next job always fits
+ */
+
+#include "retention.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include "instax_protocol.h"
+#include "spiffs_manager.h"
+#include "ble_session.h"
+#include "print_writer.h"
+#include "print_cache.h"
+#include "thumbnail.h"
+#include "print_journal.h"
+
+static const char *TAG = "retention";
+
+// NVS storage keys
+#define NVS_NAMESPACE           "retention"
+#define NVS_KEY_MAX_COUNT       "max_count"
+#define NVS_KEY_MAX_AGE         "max_age"
+#define NVS_KEY_MAX_BYTES       "max_bytes"
+
+#define RETENTION_TASK_STACK_SIZE   4096
+#define RETENTION_TASK_PRIORITY     2
+#define RETENTION_PERIOD_MS         60000
+#define RETENTION_SETTLE_MS         2000        // Let the last job's save reach flash
+#define RETENTION_RESERVE_SLACK     (32 * 1024) // Thumbnail and journal growth
+#define RETENTION_MAX_CANDIDATES    64          // Oldest prints considered per pass
+#define RETENTION_CLOCK_VALID       1577836800  // 2020-01-01: earlier time() values count from boot
+
+typedef struct {
+    uint32_t seq;       // Journal sequence of the job, 0 = not in the journal
+    uint32_t id;        // print_<id>.jpg
+    uint32_t size;
+} candidate_t;
+
+static TaskHandle_t s_task = NULL;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static retention_stats_t s_stats = {0};
+static candidate_t s_candidates[RETENTION_MAX_CANDIDATES];
+
+static bool job_in_progress(void) {
+    return ble_session_print_owner() != NULL || print_writer_is_open() || print_cache_job_active();
+}
+
+/**
+ * Whether candidate a was received before b
+ * File ids are time() at PRINT_START, which restarts from zero at every boot
+ * until the clock is set, so jobs are ordered by journal sequence. Prints the
+ * journal no longer indexes are older than any it does.
+ */
+static bool older(const candidate_t *a, const candidate_t *b) {
+    return a->seq != b->seq ? a->seq < b->seq : a->id < b->id;
+}
+
+/**
+ * Collect received prints, oldest first (at most RETENTION_MAX_CANDIDATES)
+ * @return Number of candidates; totals cover every print found
+ */
+static size_t list_prints(uint32_t *total_files, uint32_t *total_bytes) {
+    *total_files = 0;
+    *total_bytes = 0;
+
+    DIR *dir = opendir(SPIFFS_BASE_PATH);
+    if (dir == NULL) {
+        return 0;
+    }
+
+    size_t count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        unsigned long id;
+        char ext[5];
+        if (sscanf(entry->d_name, "print_%lu.%4s", &id, ext) != 2 || strcmp(ext, "jpg") != 0) {
+            continue;
+        }
+
+        char path[64];
+        struct stat st;
+        snprintf(path, sizeof(path), SPIFFS_BASE_PATH "/%s", entry->d_name);
+        if (stat(path, &st) != 0) {
+            continue;
+        }
+        (*total_files)++;
+        *total_bytes += st.st_size;
+
+        candidate_t print = {
+            .seq = print_journal_file_seq((uint32_t)id),
+            .id = (uint32_t)id,
+            .size = (uint32_t)st.st_size,
+        };
+
+        // Insertion sort, keeping the oldest prints when there are too many
+        if (count == RETENTION_MAX_CANDIDATES) {
+            if (!older(&print, &s_candidates[count - 1])) {
+                continue;
+            }
+            count--;
+        }
+        size_t pos = count;
+        while (pos > 0 && older(&print, &s_candidates[pos - 1])) {
+            s_candidates[pos] = s_candidates[pos - 1];
+            pos--;
+        }
+        s_candidates[pos] = print;
+        count++;
+    }
+    closedir(dir);
+    return count;
+}
+
+/**
+ * Which rule, if any, requires deleting the oldest print
+ */
+static bool rule_violated(const retention_policy_t *policy, size_t free_bytes, size_t reserve,
+                          uint32_t files, uint32_t bytes, uint32_t oldest_id, retention_rule_t *rule) {
+    uint32_t now = (uint32_t)time(NULL);
+
+    if (free_bytes < reserve) {
+        *rule = RETENTION_RULE_SPACE;
+    } else if (policy->max_count > 0 && files > policy->max_count) {
+        *rule = RETENTION_RULE_COUNT;
+    } else if (policy->max_age_s > 0 && oldest_id >= RETENTION_CLOCK_VALID &&
+               now > oldest_id && now - oldest_id > policy->max_age_s) {
+        // File ids are time() at PRINT_START - only an age once the clock has
+        // been set, both now and when the print arrived
+        *rule = RETENTION_RULE_AGE;
+    } else if (policy->max_bytes > 0 && bytes > policy->max_bytes) {
+        *rule = RETENTION_RULE_BYTES;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void run_pass(void) {
+    retention_policy_t policy;
+    size_t reserve;
+    portENTER_CRITICAL(&s_lock);
+    policy = s_stats.policy;
+    reserve = s_stats.reserve_bytes;
+    s_stats.passes++;
+    portEXIT_CRITICAL(&s_lock);
+
+    uint32_t files, bytes;
+    size_t count = list_prints(&files, &bytes);
+    size_t total = 0, used = 0;
+    if (spiffs_manager_get_stats(&total, &used) != ESP_OK) {
+        return;
+    }
+    size_t free_bytes = total > used ? total - used : 0;
+
+    for (size_t i = 0; i < count; i++) {
+        retention_rule_t rule;
+        if (!rule_violated(&policy, free_bytes, reserve, files, bytes, s_candidates[i].id, &rule)) {
+            break;
+        }
+        if (job_in_progress()) {
+            // Only ever between jobs - the next kick finishes the work
+            portENTER_CRITICAL(&s_lock);
+            s_stats.interrupted++;
+            portEXIT_CRITICAL(&s_lock);
+            break;
+        }
+
+        char name[32];
+        char path[64];
+        snprintf(name, sizeof(name), "print_%lu.jpg", (unsigned long)s_candidates[i].id);
+        snprintf(path, sizeof(path), SPIFFS_BASE_PATH "/%s", name);
+        print_cache_remove(name);
+        thumbnail_remove(name);
+        if (remove(path) != 0) {
+            ESP_LOGE(TAG, "Failed to evict %s", name);
+            portENTER_CRITICAL(&s_lock);
+            s_stats.failures++;
+            portEXIT_CRITICAL(&s_lock);
+            continue;
+        }
+
+        files--;
+        bytes -= s_candidates[i].size;
+        if (spiffs_manager_get_stats(&total, &used) == ESP_OK) {
+            free_bytes = total > used ? total - used : 0;
+        }
+
+        portENTER_CRITICAL(&s_lock);
+        s_stats.evicted++;
+        s_stats.evicted_bytes += s_candidates[i].size;
+        s_stats.evicted_by_rule[rule]++;
+        snprintf(s_stats.last_evicted, sizeof(s_stats.last_evicted), "%s", name);
+        uint32_t evicted = s_stats.evicted;
+        portEXIT_CRITICAL(&s_lock);
+
+        ESP_LOGI(TAG, "🗑️ Evicted %s (%lu bytes, rule %s) - %u bytes free, %lu prints left, %lu evicted since boot",
+                 name, (unsigned long)s_candidates[i].size, retention_rule_to_string(rule),
+                 (unsigned)free_bytes, (unsigned long)files, (unsigned long)evicted);
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.print_files = files;
+    s_stats.print_bytes = bytes;
+    s_stats.free_bytes = free_bytes;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (free_bytes < reserve && !job_in_progress()) {
+        ESP_LOGW(TAG, "Only %u bytes free (want %u) and no received prints left to evict",
+                 (unsigned)free_bytes, (unsigned)reserve);
+    }
+}
+
+static void retention_task(void *arg) {
+    while (true) {
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(RETENTION_PERIOD_MS)) > 0) {
+            vTaskDelay(pdMS_TO_TICKS(RETENTION_SETTLE_MS));
+        }
+        if (!job_in_progress()) {
+            run_pass();
+        }
+    }
+}
+
+esp_err_t retention_init(void) {
+    if (s_task != NULL) {
+        return ESP_OK;
+    }
+
+    // Room for the largest job any model can send
+    size_t max_job = 0;
+    for (int m = INSTAX_MODEL_MINI; m <= INSTAX_MODEL_WIDE; m++) {
+        const instax_model_info_t *info = instax_get_model_info((instax_model_t)m);
+        if (info != NULL && info->max_file_size > max_job) {
+            max_job = info->max_file_size;
+        }
+    }
+    s_stats.reserve_bytes = max_job + RETENTION_RESERVE_SLACK;
+
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle) == ESP_OK) {
+        nvs_get_u32(nvs_handle, NVS_KEY_MAX_COUNT, &s_stats.policy.max_count);
+        nvs_get_u32(nvs_handle, NVS_KEY_MAX_AGE, &s_stats.policy.max_age_s);
+        nvs_get_u32(nvs_handle, NVS_KEY_MAX_BYTES, &s_stats.policy.max_bytes);
+        nvs_close(nvs_handle);
+    }
+
+    if (xTaskCreate(retention_task, "retention", RETENTION_TASK_STACK_SIZE, NULL,
+                    RETENTION_TASK_PRIORITY, &s_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create retention task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Retention: keep %u bytes free, max %lu prints, max age %lu s, max %lu bytes (0 = no limit)",
+             (unsigned)s_stats.reserve_bytes, (unsigned long)s_stats.policy.max_count,
+             (unsigned long)s_stats.policy.max_age_s, (unsigned long)s_stats.policy.max_bytes);
+    retention_kick();   // First pass right after boot
+    return ESP_OK;
+}
+
+void retention_kick(void) {
+    if (s_task != NULL) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+esp_err_t retention_set_policy(const retention_policy_t *policy) {
+    if (policy == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.policy = *policy;
+    portEXIT_CRITICAL(&s_lock);
+
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    nvs_set_u32(nvs_handle, NVS_KEY_MAX_COUNT, policy->max_count);
+    nvs_set_u32(nvs_handle, NVS_KEY_MAX_AGE, policy->max_age_s);
+    nvs_set_u32(nvs_handle, NVS_KEY_MAX_BYTES, policy->max_bytes);
+    ret = nvs_commit(nvs_handle);
+    nvs_close(nvs_handle);
+
+    ESP_LOGI(TAG, "Retention limits set: max %lu prints, max age %lu s, max %lu bytes",
+             (unsigned long)policy->max_count, (unsigned long)policy->max_age_s,
+             (unsigned long)policy->max_bytes);
+    retention_kick();
+    return ret;
+}
+
+void retention_get_stats(retention_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    memcpy(stats, &s_stats, sizeof(*stats));
+    portEXIT_CRITICAL(&s_lock);
+}
+
+const char *retention_rule_to_string(retention_rule_t rule) {
+    switch (rule) {
+        case RETENTION_RULE_SPACE:  return "space";
+        case RETENTION_RULE_COUNT:  return "count";
+        case RETENTION_RULE_AGE:    return "age";
+        case RETENTION_RULE_BYTES:  return "bytes";
+        default:                    return "unknown";
+    }
+}
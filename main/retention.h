@@ -0,0 +1,83 @@
+/**
+ * @file retention.h
+ * @brief Storage retention: evicts old prints so the next job always fits
+ *
+ * The 1 MB SPIFFS partition holds about ten prints; after that opening the
+ * next print file fails and jobs are rejected. A background task deletes the
+ * oldest received prints (print_<time>.jpg, with their thumbnails) until
+ *  - free space is at least one maximum-size job (always enforced), and
+ *  - the optional count, age and total-size limits are met.
+ *
+ * Without a wall clock time() counts from boot, so "oldest" follows the print
+ * journal's sequence numbers rather than the file names, and the age limit
+ * only applies to prints received while the clock was set.
+ *
+ * Passes run after every job and once a minute, and only between jobs: a
+ * pass stops as soon as a print starts. Every eviction is logged and counted
+ * so long unattended soak runs can be checked afterwards. The limits are
+ * stored in NVS.
+ */
+
+#ifndef RETENTION_H
+#define RETENTION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+typedef struct {
+    uint32_t max_count;         // Prints kept, 0 = no limit
+    uint32_t max_age_s;         // Oldest print kept, 0 = no limit
+    uint32_t max_bytes;         // Total size of prints kept, 0 = no limit
+} retention_policy_t;
+
+typedef enum {
+    RETENTION_RULE_SPACE = 0,   // Free space below one maximum job
+    RETENTION_RULE_COUNT,
+    RETENTION_RULE_AGE,
+    RETENTION_RULE_BYTES,
+    RETENTION_RULE_MAX
+} retention_rule_t;
+
+typedef struct {
+    retention_policy_t policy;
+    size_t reserve_bytes;                       // Free space kept for the next job
+    uint32_t passes;
+    uint32_t evicted;                           // Prints deleted since boot
+    uint32_t evicted_bytes;
+    uint32_t evicted_by_rule[RETENTION_RULE_MAX];
+    uint32_t interrupted;                       // Passes cut short by a starting job
+    uint32_t failures;                          // Prints that could not be deleted
+    uint32_t print_files;                       // After the last pass
+    uint32_t print_bytes;
+    size_t free_bytes;
+    char last_evicted[32];
+} retention_stats_t;
+
+/**
+ * Load the policy and start the retention task (call once SPIFFS is mounted)
+ */
+esp_err_t retention_init(void);
+
+/**
+ * Ask for a pass soon (e.g. a job just finished)
+ */
+void retention_kick(void);
+
+/**
+ * Change and persist the optional limits, then run a pass
+ */
+esp_err_t retention_set_policy(const retention_policy_t *policy);
+
+/**
+ * Get the policy and eviction statistics
+ */
+void retention_get_stats(retention_stats_t *stats);
+
+/**
+ * Get display name for a rule
+ */
+const char *retention_rule_to_string(retention_rule_t rule);
+
+#endif // RETENTION_H
@@ -1,6 +1,6 @@
 /**
  * @file spiffs_manager.c
- * @brief SPIFFS file system management for storing JPEG images
+ * @brief Flash file system management for storing JPEG images
  */
 
 #include "spiffs_manager.h"
@@ -11,42 +11,88 @@
 #include <unistd.h>
 #include "esp_spiffs.h"
 #include "esp_log.h"
+#include "sdkconfig.h"
+#ifdef CONFIG_STORAGE_BACKEND_LITTLEFS
+#include "esp_littlefs.h"
+#endif
 
 static const char *TAG = "spiffs_manager";
 
-#define SPIFFS_BASE_PATH    "/spiffs"
 #define SPIFFS_PARTITION    "spiffs"
 
 static bool s_initialized = false;
 
-esp_err_t spiffs_manager_init(void) {
-    if (s_initialized) {
-        return ESP_OK;
-    }
-
+#ifndef CONFIG_STORAGE_BACKEND_LITTLEFS
+static esp_err_t spiffs_backend_mount(const char *base_path, const char *partition_label) {
     esp_vfs_spiffs_conf_t conf = {
-        .base_path = SPIFFS_BASE_PATH,
-        .partition_label = SPIFFS_PARTITION,
+        .base_path = base_path,
+        .partition_label = partition_label,
         .max_files = 10,
         .format_if_mount_failed = true
     };
+    return esp_vfs_spiffs_register(&conf);
+}
+
+static const spiffs_backend_t s_spiffs_backend = {
+    .name = "spiffs",
+    .directories = false,
+    .mount = spiffs_backend_mount,
+    .info = esp_spiffs_info,
+    .format = esp_spiffs_format,
+};
+#endif
+
+#ifdef CONFIG_STORAGE_BACKEND_LITTLEFS
+static esp_err_t littlefs_backend_mount(const char *base_path, const char *partition_label) {
+    esp_vfs_littlefs_conf_t conf = {
+        .base_path = base_path,
+        .partition_label = partition_label,
+        .format_if_mount_failed = true,
+        .dont_mount = false,
+    };
+    return esp_vfs_littlefs_register(&conf);
+}
+
+static const spiffs_backend_t s_littlefs_backend = {
+    .name = "littlefs",
+    .directories = true,
+    .mount = littlefs_backend_mount,
+    .info = esp_littlefs_info,
+    .format = esp_littlefs_format,
+};
+#endif
+
+const spiffs_backend_t *spiffs_manager_get_backend(void) {
+#ifdef CONFIG_STORAGE_BACKEND_LITTLEFS
+    return &s_littlefs_backend;
+#else
+    return &s_spiffs_backend;
+#endif
+}
+
+esp_err_t spiffs_manager_init(void) {
+    if (s_initialized) {
+        return ESP_OK;
+    }
 
-    esp_err_t ret = esp_vfs_spiffs_register(&conf);
+    const spiffs_backend_t *backend = spiffs_manager_get_backend();
+    esp_err_t ret = backend->mount(SPIFFS_BASE_PATH, SPIFFS_PARTITION);
     if (ret != ESP_OK) {
         if (ret == ESP_FAIL) {
-            ESP_LOGE(TAG, "Failed to mount or format filesystem");
+            ESP_LOGE(TAG, "Failed to mount or format %s filesystem", backend->name);
         } else if (ret == ESP_ERR_NOT_FOUND) {
-            ESP_LOGE(TAG, "Failed to find SPIFFS partition");
+            ESP_LOGE(TAG, "Failed to find storage partition '%s'", SPIFFS_PARTITION);
         } else {
-            ESP_LOGE(TAG, "Failed to initialize SPIFFS (%s)", esp_err_to_name(ret));
+            ESP_LOGE(TAG, "Failed to initialize %s (%s)", backend->name, esp_err_to_name(ret));
         }
         return ret;
     }
 
     size_t total = 0, used = 0;
-    ret = esp_spiffs_info(SPIFFS_PARTITION, &total, &used);
+    ret = backend->info(SPIFFS_PARTITION, &total, &used);
     if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "SPIFFS initialized: %d bytes total, %d bytes used", total, used);
+        ESP_LOGI(TAG, "%s initialized at %s: %d bytes total, %d bytes used",
+                 backend->name, SPIFFS_BASE_PATH, total, used);
     }
 
     s_initialized = true;
@@ -58,7 +104,7 @@ esp_err_t spiffs_manager_get_stats(size_t *total_bytes, size_t *used_bytes) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    return esp_spiffs_info(SPIFFS_PARTITION, total_bytes, used_bytes);
+    return spiffs_manager_get_backend()->info(SPIFFS_PARTITION, total_bytes, used_bytes);
 }
 
 int spiffs_manager_list_files(spiffs_file_info_t *files, int max_files) {
@@ -212,9 +258,10 @@ esp_err_t spiffs_manager_format(void) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    ESP_LOGW(TAG, "Formatting SPIFFS...");
+    const spiffs_backend_t *backend = spiffs_manager_get_backend();
+    ESP_LOGW(TAG, "Formatting %s...", backend->name);
 
-    esp_err_t ret = esp_spiffs_format(SPIFFS_PARTITION);
+    esp_err_t ret = backend->format(SPIFFS_PARTITION);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Format failed: %s", esp_err_to_name(ret));
     } else {
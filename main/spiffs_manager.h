@@ -1,6 +1,11 @@
 /**
  * @file spiffs_manager.h
- * @brief SPIFFS file system management for storing JPEG images
+ * @brief Flash file system management for storing JPEG images
+ *
+ * Prints, thumbnails, the journal and the web docs live on the "spiffs" data
+ * partition, mounted at SPIFFS_BASE_PATH. The file system on it is a storage
+ * backend chosen in menuconfig (SPIFFS or LittleFS); everything else uses
+ * plain VFS calls under SPIFFS_BASE_PATH and works with either.
  */
 
 #ifndef SPIFFS_MANAGER_H
@@ -10,6 +15,9 @@
 #include <stddef.h>
 #include "esp_err.h"
 
+// Mount point of the print storage, whatever the backend
+#define SPIFFS_BASE_PATH        "/spiffs"
+
 // Maximum filename length
 #define SPIFFS_MAX_FILENAME     32
 
@@ -22,8 +30,22 @@ typedef struct {
     size_t size;
 } spiffs_file_info_t;
 
+// Storage backend - mounts a file system on the partition; file I/O then goes through the VFS
+typedef struct {
+    const char *name;
+    bool directories;           // Supports subdirectories
+    esp_err_t (*mount)(const char *base_path, const char *partition_label);
+    esp_err_t (*info)(const char *partition_label, size_t *total_bytes, size_t *used_bytes);
+    esp_err_t (*format)(const char *partition_label);
+} spiffs_backend_t;
+
+/**
+ * Get the backend selected in menuconfig
+ */
+const spiffs_backend_t *spiffs_manager_get_backend(void);
+
 /**
- * Initialize SPIFFS filesystem
+ * Initialize the filesystem
  * @return ESP_OK on success
  */
 esp_err_t spiffs_manager_init(void);
@@ -0,0 +1,198 @@
+/**
+ * @file storage_bench.c
+ * @brief Storage backend benchmark at several fill levels
+ */
+
+#include "storage_bench.h"
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "spiffs_manager.h"
+#include "print_pool.h"
+#include "print_writer.h"
+#include "print_cache.h"
+#include "ble_session.h"
+#include "retention.h"
+
+static const char *TAG = "storage_bench";
+
+#define BENCH_PREFIX        "bench_"
+#define BENCH_TEST_PATH     SPIFFS_BASE_PATH "/" BENCH_PREFIX "test.bin"
+#define BENCH_FILL_SIZE     (32 * 1024)
+
+/**
+ * Remove every benchmark file (also ones left by an interrupted run)
+ */
+static void remove_bench_files(void) {
+    DIR *dir = opendir(SPIFFS_BASE_PATH);
+    if (dir == NULL) {
+        return;
+    }
+
+    char path[64];
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, BENCH_PREFIX, strlen(BENCH_PREFIX)) == 0) {
+            snprintf(path, sizeof(path), SPIFFS_BASE_PATH "/%s", entry->d_name);
+            unlink(path);
+        }
+    }
+    closedir(dir);
+}
+
+static uint8_t used_pct(void) {
+    size_t total = 0, used = 0;
+    if (spiffs_manager_get_stats(&total, &used) != ESP_OK || total == 0) {
+        return 100;
+    }
+    return (uint8_t)((uint64_t)used * 100 / total);
+}
+
+/**
+ * Write len bytes from buf in STORAGE_BENCH_IO_SIZE pieces, synced to flash
+ * @return Elapsed time in microseconds, 0 on failure
+ */
+static uint32_t write_file(const char *path, const uint8_t *buf, size_t len) {
+    int64_t start = esp_timer_get_time();
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        return 0;
+    }
+    bool ok = true;
+    for (size_t off = 0; off < len && ok; off += STORAGE_BENCH_IO_SIZE) {
+        size_t n = len - off < STORAGE_BENCH_IO_SIZE ? len - off : STORAGE_BENCH_IO_SIZE;
+        ok = fwrite(buf, 1, n, f) == n;
+    }
+    ok = ok && fflush(f) == 0 && fsync(fileno(f)) == 0;
+    ok = (fclose(f) == 0) && ok;
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+    return ok ? (elapsed > 0 ? elapsed : 1) : 0;
+}
+
+static uint32_t read_file(const char *path, uint8_t *buf, size_t len) {
+    int64_t start = esp_timer_get_time();
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return 0;
+    }
+    size_t total = 0;
+    size_t n;
+    while ((n = fread(buf, 1, STORAGE_BENCH_IO_SIZE, f)) > 0) {
+        total += n;
+    }
+    fclose(f);
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+    return total == len ? (elapsed > 0 ? elapsed : 1) : 0;
+}
+
+/**
+ * List the directory the way the gallery does (name and size of every file)
+ */
+static uint32_t list_files(uint32_t *files) {
+    int64_t start = esp_timer_get_time();
+    *files = 0;
+    DIR *dir = opendir(SPIFFS_BASE_PATH);
+    if (dir == NULL) {
+        return 0;
+    }
+    char path[64];
+    struct stat st;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        snprintf(path, sizeof(path), SPIFFS_BASE_PATH "/%s", entry->d_name);
+        if (stat(path, &st) == 0) {
+            (*files)++;
+        }
+    }
+    closedir(dir);
+    return (uint32_t)(esp_timer_get_time() - start);
+}
+
+static uint32_t bytes_per_sec(size_t bytes, uint32_t us) {
+    return us > 0 ? (uint32_t)((uint64_t)bytes * 1000000 / us) : 0;
+}
+
+esp_err_t storage_bench_run(const uint8_t *levels, size_t count,
+                            storage_bench_result_t *results, size_t *measured) {
+    *measured = 0;
+    if (levels == NULL || results == NULL || count == 0 || count > STORAGE_BENCH_MAX_LEVELS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ble_session_print_owner() != NULL || print_writer_is_open() || print_cache_job_active()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Borrow a print buffer slot for the data instead of allocating
+    uint8_t *buf = print_pool_acquire();
+    if (buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (size_t i = 0; i < STORAGE_BENCH_IO_SIZE; i++) {
+        buf[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    retention_stats_t retention;
+    retention_get_stats(&retention);
+    size_t total = 0, used = 0;
+    spiffs_manager_get_stats(&total, &used);
+
+    ESP_LOGI(TAG, "Benchmarking %s (%u bytes, %u%% used)", spiffs_manager_get_backend()->name,
+             (unsigned)total, used_pct());
+    remove_bench_files();
+
+    esp_err_t ret = ESP_OK;
+    unsigned fill_files = 0;
+    char path[64];
+    for (size_t i = 0; i < count; i++) {
+        // Fill up to the level, stopping short of what retention would free again
+        while (used_pct() < levels[i]) {
+            spiffs_manager_get_stats(&total, &used);
+            if (total - used < retention.reserve_bytes + STORAGE_BENCH_FILE_SIZE + BENCH_FILL_SIZE) {
+                break;
+            }
+            snprintf(path, sizeof(path), SPIFFS_BASE_PATH "/" BENCH_PREFIX "fill_%03u.bin", fill_files);
+            if (write_file(path, buf, BENCH_FILL_SIZE) == 0) {
+                ESP_LOGW(TAG, "Failed to write fill file %s", path);
+                break;
+            }
+            fill_files++;
+        }
+
+        uint8_t fill = used_pct();
+        if (fill < levels[i]) {
+            ESP_LOGW(TAG, "Skipping %u%% fill (reached %u%%, free space must stay above the retention reserve)",
+                     levels[i], fill);
+            break;
+        }
+
+        storage_bench_result_t *r = &results[*measured];
+        memset(r, 0, sizeof(*r));
+        r->level_pct = levels[i];
+        r->fill_pct = fill;
+        r->write_us = write_file(BENCH_TEST_PATH, buf, STORAGE_BENCH_FILE_SIZE);
+        r->read_us = r->write_us > 0 ? read_file(BENCH_TEST_PATH, buf, STORAGE_BENCH_FILE_SIZE) : 0;
+        r->list_us = list_files(&r->files);
+        unlink(BENCH_TEST_PATH);
+
+        if (r->write_us == 0 || r->read_us == 0) {
+            ESP_LOGE(TAG, "Test file I/O failed at %u%% fill", fill);
+            ret = ESP_FAIL;
+            break;
+        }
+        r->write_bytes_per_sec = bytes_per_sec(STORAGE_BENCH_FILE_SIZE, r->write_us);
+        r->read_bytes_per_sec = bytes_per_sec(STORAGE_BENCH_FILE_SIZE, r->read_us);
+        (*measured)++;
+
+        ESP_LOGI(TAG, "%u%% full: write %lu B/s, read %lu B/s, list %lu files in %lu us",
+                 fill, (unsigned long)r->write_bytes_per_sec, (unsigned long)r->read_bytes_per_sec,
+                 (unsigned long)r->files, (unsigned long)r->list_us);
+    }
+
+    remove_bench_files();
+    print_pool_release(buf);
+    return ret;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file storage_bench.h
+ * @brief Storage backend benchmark at several fill levels
+ *
+ * Flash file systems slow down as they fill (SPIFFS in particular has to
+ * garbage-collect more). To compare backends on the real partition, the
+ * benchmark fills it with temporary files up to each requested level and
+ * measures sequential write and read of one maximum-size print and the time
+ * to list the directory. Build once per backend (menuconfig) and compare.
+ *
+ * Existing files count towards the fill level and are never touched; the
+ * temporary files are removed afterwards (and at the start of the next run
+ * if the device was reset mid-benchmark). Levels that would leave less free
+ * space than the retention reserve are skipped, so the benchmark never makes
+ * the retention task evict prints.
+ */
+
+#ifndef STORAGE_BENCH_H
+#define STORAGE_BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Test file: one maximum-size print
+#define STORAGE_BENCH_FILE_SIZE     (105 * 1024)
+
+// Bytes per fwrite/fread call (a print buffer flush)
+#define STORAGE_BENCH_IO_SIZE       4096
+
+#define STORAGE_BENCH_MAX_LEVELS    6
+
+typedef struct {
+    uint8_t level_pct;          // Requested fill level
+    uint8_t fill_pct;           // Partition used when measured
+    uint32_t write_bytes_per_sec;   // Including fsync
+    uint32_t read_bytes_per_sec;
+    uint32_t write_us;
+    uint32_t read_us;
+    uint32_t list_us;           // opendir/readdir/stat of every file
+    uint32_t files;             // Files listed
+} storage_bench_result_t;
+
+/**
+ * Run the benchmark (blocks for several seconds; not while a print is received)
+ * @param levels Fill levels in percent, ascending
+ * @param count Number of levels (at most STORAGE_BENCH_MAX_LEVELS)
+ * @param results One entry per level measured
+ * @param measured Set to the number of results
+ * @return ESP_ERR_INVALID_STATE while a print job is running, ESP_ERR_NO_MEM
+ *         if no print buffer slot is free
+ */
+esp_err_t storage_bench_run(const uint8_t *levels, size_t count,
+                            storage_bench_result_t *results, size_t *measured);
+
+#endif // STORAGE_BENCH_H
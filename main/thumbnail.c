@@ -0,0 +1,357 @@
+/**
+ * @file thumbnail.c
+ * @brief Background thumbnail generation for received prints
+ */
+
+#include "thumbnail.h"
+#include "spiffs_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_rom_tjpgd.h"
+#include "ble_session.h"
+#include "print_cache.h"
+
+static const char *TAG = "thumbnail";
+
+#define THUMBNAIL_TASK_STACK_SIZE   4096
+#define THUMBNAIL_TASK_PRIORITY     2       // Below everything that serves BLE or HTTP
+#define THUMBNAIL_IDLE_POLL_MS      2000    // Re-check for connected centrals
+#define THUMBNAIL_SCALE             3       // 1/8 (TJpgDec scale is a power of two)
+#define TJPGD_WORK_SIZE             3100    // Work area required by the ROM decoder
+#define THUMBNAIL_NAME_LEN          32
+
+#define BMP_HEADER_SIZE             (14 + 40 + 12)  // File + info header + RGB565 masks
+
+typedef enum {
+    GEN_OK = 0,
+    GEN_FAILED,
+    GEN_UNSUPPORTED,
+    GEN_INTERRUPTED,
+} gen_result_t;
+
+// Decode context shared with the TJpgDec callbacks
+typedef struct {
+    FILE *in;                   // Source file, or NULL when decoding from RAM
+    const uint8_t *mem;         // Cached print
+    size_t mem_len;
+    size_t mem_pos;
+    FILE *out;
+    uint16_t width;             // Thumbnail size
+    uint16_t height;
+    size_t row_bytes;           // Padded to 4 bytes
+    uint8_t *strip;             // strip_rows rows of RGB565
+    uint16_t strip_rows;
+    uint16_t strip_top;         // First thumbnail row held in strip
+    bool write_error;
+} gen_ctx_t;
+
+static QueueHandle_t s_queue = NULL;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static thumbnail_stats_t s_stats = {0};
+
+static void put_le16(uint8_t *p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+    put_le16(p, v & 0xFFFF);
+    put_le16(p + 2, v >> 16);
+}
+
+static bool write_bmp_header(FILE *f, uint16_t width, uint16_t height, size_t row_bytes) {
+    uint8_t h[BMP_HEADER_SIZE] = {0};
+    uint32_t image_size = (uint32_t)(row_bytes * height);
+
+    h[0] = 'B';
+    h[1] = 'M';
+    put_le32(h + 2, BMP_HEADER_SIZE + image_size);
+    put_le32(h + 10, BMP_HEADER_SIZE);
+    put_le32(h + 14, 40);                           // BITMAPINFOHEADER
+    put_le32(h + 18, width);
+    put_le32(h + 22, (uint32_t)-(int32_t)height);   // Negative height: rows top-down
+    put_le16(h + 26, 1);                            // Planes
+    put_le16(h + 28, 16);                           // Bits per pixel
+    put_le32(h + 30, 3);                            // BI_BITFIELDS
+    put_le32(h + 34, image_size);
+    put_le32(h + 54, 0xF800);                       // Red mask
+    put_le32(h + 58, 0x07E0);                       // Green mask
+    put_le32(h + 62, 0x001F);                       // Blue mask
+    return fwrite(h, 1, sizeof(h), f) == sizeof(h);
+}
+
+static uint32_t input_cb(esp_rom_tjpgd_dec_t *dec, uint8_t *buf, uint32_t len) {
+    gen_ctx_t *ctx = dec->device;
+
+    if (ctx->in != NULL) {
+        if (buf == NULL) {
+            return fseek(ctx->in, len, SEEK_CUR) == 0 ? len : 0;
+        }
+        return fread(buf, 1, len, ctx->in);
+    }
+
+    size_t avail = ctx->mem_len - ctx->mem_pos;
+    if (len > avail) {
+        len = avail;
+    }
+    if (buf != NULL) {
+        memcpy(buf, ctx->mem + ctx->mem_pos, len);
+    }
+    ctx->mem_pos += len;
+    return len;
+}
+
+static void flush_strip(gen_ctx_t *ctx) {
+    uint16_t rows = ctx->strip_rows;
+    if (ctx->strip_top + rows > ctx->height) {
+        rows = ctx->height - ctx->strip_top;
+    }
+    size_t bytes = ctx->row_bytes * rows;
+    if (bytes > 0 && fwrite(ctx->strip, 1, bytes, ctx->out) != bytes) {
+        ctx->write_error = true;
+    }
+    memset(ctx->strip, 0, ctx->row_bytes * ctx->strip_rows);
+}
+
+static uint32_t output_cb(esp_rom_tjpgd_dec_t *dec, void *bitmap, esp_rom_tjpgd_rect_t *rect) {
+    gen_ctx_t *ctx = dec->device;
+
+    // Step aside as soon as a central connects
+    if (ble_session_count() > 0 || ctx->write_error) {
+        return 0;
+    }
+
+    // MCUs arrive left to right, top to bottom - write out the finished strip
+    if (rect->top >= ctx->strip_top + ctx->strip_rows) {
+        flush_strip(ctx);
+        ctx->strip_top = rect->top;
+    }
+
+    const uint8_t *rgb = bitmap;
+    uint16_t w = rect->right - rect->left + 1;
+    for (uint16_t y = rect->top; y <= rect->bottom; y++) {
+        for (uint16_t x = rect->left; x < rect->left + w; x++, rgb += 3) {
+            if (x >= ctx->width || y >= ctx->height || y - ctx->strip_top >= ctx->strip_rows) {
+                continue;
+            }
+            uint16_t px = ((rgb[0] & 0xF8) << 8) | ((rgb[1] & 0xFC) << 3) | (rgb[2] >> 3);
+            put_le16(ctx->strip + (y - ctx->strip_top) * ctx->row_bytes + x * 2, px);
+        }
+    }
+    return 1;
+}
+
+static gen_result_t generate(const char *name, const char *thumb_path) {
+    gen_ctx_t ctx = {0};
+    char src_path[64];
+    gen_result_t result = GEN_FAILED;
+
+    // Recent prints are still in RAM - no flash read needed
+    ctx.mem = print_cache_acquire(name, &ctx.mem_len);
+    if (ctx.mem == NULL) {
+        snprintf(src_path, sizeof(src_path), SPIFFS_BASE_PATH "/%s", name);
+        ctx.in = fopen(src_path, "rb");
+        if (ctx.in == NULL) {
+            ESP_LOGW(TAG, "Print %s not found", name);
+            return GEN_FAILED;
+        }
+    }
+
+    void *work = malloc(TJPGD_WORK_SIZE);
+    if (work == NULL) {
+        goto done;
+    }
+
+    esp_rom_tjpgd_dec_t dec;
+    esp_rom_tjpgd_result_t res = esp_rom_tjpgd_prepare(&dec, input_cb, work, TJPGD_WORK_SIZE, &ctx);
+    if (res != JDR_OK) {
+        // JDR_FMT3: progressive or otherwise unsupported
+        ESP_LOGW(TAG, "Cannot decode %s (TJpgDec error %d)", name, res);
+        result = res == JDR_FMT3 ? GEN_UNSUPPORTED : GEN_FAILED;
+        goto done;
+    }
+
+    ctx.width = (dec.width + 7) >> THUMBNAIL_SCALE;
+    ctx.height = (dec.height + 7) >> THUMBNAIL_SCALE;
+    ctx.row_bytes = ((size_t)ctx.width * 2 + 3) & ~(size_t)3;
+    ctx.strip_rows = (dec.msy * 8) >> THUMBNAIL_SCALE;     // One MCU row
+    if (ctx.strip_rows == 0) {
+        ctx.strip_rows = 1;
+    }
+    ctx.strip = calloc(ctx.strip_rows, ctx.row_bytes);
+    if (ctx.strip == NULL) {
+        goto done;
+    }
+
+    size_t working_set = TJPGD_WORK_SIZE + ctx.strip_rows * ctx.row_bytes;
+    portENTER_CRITICAL(&s_lock);
+    if (working_set > s_stats.peak_bytes) {
+        s_stats.peak_bytes = working_set;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    ctx.out = fopen(thumb_path, "wb");
+    if (ctx.out == NULL || !write_bmp_header(ctx.out, ctx.width, ctx.height, ctx.row_bytes)) {
+        ESP_LOGE(TAG, "Failed to create %s", thumb_path);
+        goto done;
+    }
+
+    res = esp_rom_tjpgd_decomp(&dec, output_cb, THUMBNAIL_SCALE);
+    if (res == JDR_OK) {
+        flush_strip(&ctx);
+        result = ctx.write_error ? GEN_FAILED : GEN_OK;
+    } else if (res == JDR_INTR && !ctx.write_error) {
+        result = GEN_INTERRUPTED;
+    } else {
+        ESP_LOGW(TAG, "Decoding %s failed (TJpgDec error %d)", name, res);
+    }
+
+    if (result == GEN_OK) {
+        portENTER_CRITICAL(&s_lock);
+        s_stats.last_width = ctx.width;
+        s_stats.last_height = ctx.height;
+        portEXIT_CRITICAL(&s_lock);
+    }
+
+done:
+    if (ctx.out != NULL) {
+        if (fclose(ctx.out) != 0 && result == GEN_OK) {
+            result = GEN_FAILED;
+        }
+        if (result != GEN_OK) {
+            remove(thumb_path);
+        }
+    }
+    free(ctx.strip);
+    free(work);
+    if (ctx.in != NULL) {
+        fclose(ctx.in);
+    }
+    print_cache_release(ctx.mem);
+    return result;
+}
+
+static void thumbnail_task(void *arg) {
+    char name[THUMBNAIL_NAME_LEN];
+
+    while (true) {
+        xQueueReceive(s_queue, name, portMAX_DELAY);
+
+        // Never decode while a central is connected
+        if (ble_session_count() > 0) {
+            portENTER_CRITICAL(&s_lock);
+            s_stats.deferred++;
+            portEXIT_CRITICAL(&s_lock);
+            while (ble_session_count() > 0) {
+                vTaskDelay(pdMS_TO_TICKS(THUMBNAIL_IDLE_POLL_MS));
+            }
+        }
+
+        char thumb_path[64];
+        if (!thumbnail_path(name, thumb_path, sizeof(thumb_path))) {
+            continue;
+        }
+
+        uint32_t start_ms = esp_log_timestamp();
+        gen_result_t result = generate(name, thumb_path);
+        uint32_t elapsed_ms = esp_log_timestamp() - start_ms;
+
+        portENTER_CRITICAL(&s_lock);
+        switch (result) {
+            case GEN_OK:
+                s_stats.generated++;
+                s_stats.last_ms = elapsed_ms;
+                break;
+            case GEN_UNSUPPORTED:
+                s_stats.unsupported++;
+                break;
+            case GEN_INTERRUPTED:
+                s_stats.interrupted++;
+                break;
+            default:
+                s_stats.failed++;
+                break;
+        }
+        portEXIT_CRITICAL(&s_lock);
+
+        if (result == GEN_OK) {
+            ESP_LOGI(TAG, "🖼️ Thumbnail for %s written in %lu ms", name, (unsigned long)elapsed_ms);
+        } else if (result == GEN_INTERRUPTED) {
+            // Try again once the central has gone
+            ESP_LOGI(TAG, "Thumbnail for %s interrupted by a BLE connection, retrying later", name);
+            thumbnail_request(name);
+        }
+    }
+}
+
+esp_err_t thumbnail_init(void) {
+    if (s_queue != NULL) {
+        return ESP_OK;
+    }
+
+    s_queue = xQueueCreate(THUMBNAIL_QUEUE_LEN, THUMBNAIL_NAME_LEN);
+    if (s_queue == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(thumbnail_task, "thumbnail", THUMBNAIL_TASK_STACK_SIZE, NULL,
+                    THUMBNAIL_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create thumbnail task");
+        vQueueDelete(s_queue);
+        s_queue = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t thumbnail_request(const char *name) {
+    if (s_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (name == NULL || strlen(name) >= THUMBNAIL_NAME_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char entry[THUMBNAIL_NAME_LEN] = {0};
+    strcpy(entry, name);
+    if (xQueueSend(s_queue, entry, 0) != pdTRUE) {
+        portENTER_CRITICAL(&s_lock);
+        s_stats.dropped++;
+        portEXIT_CRITICAL(&s_lock);
+        ESP_LOGW(TAG, "Thumbnail queue full, skipping %s", name);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+bool thumbnail_path(const char *name, char *path, size_t path_len) {
+    if (name == NULL || path == NULL) {
+        return false;
+    }
+    // print_123.jpg -> /spiffs/t_print_123.bmp
+    const char *ext = strrchr(name, '.');
+    int base_len = ext != NULL ? (int)(ext - name) : (int)strlen(name);
+    int written = snprintf(path, path_len, SPIFFS_BASE_PATH "/t_%.*s.bmp", base_len, name);
+    return written > 0 && (size_t)written < path_len;
+}
+
+void thumbnail_remove(const char *name) {
+    char path[64];
+    if (thumbnail_path(name, path, sizeof(path))) {
+        remove(path);
+    }
+}
+
+void thumbnail_get_stats(thumbnail_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    memcpy(stats, &s_stats, sizeof(*stats));
+    portEXIT_CRITICAL(&s_lock);
+    stats->queued = s_queue != NULL ? uxQueueMessagesWaiting(s_queue) : 0;
+}
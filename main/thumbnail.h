@@ -0,0 +1,70 @@
+/**
+ * @file thumbnail.h
+ * @brief Background thumbnail generation for received prints
+ *
+ * After a print is saved its name is queued here. A low-priority task decodes
+ * the JPEG at 1/8 scale with the ROM TJpgDec decoder and writes a small RGB565
+ * BMP next to it (print_123.jpg -> t_print_123.bmp), which the web gallery
+ * shows instead of downloading the full image.
+ *
+ * Work is deferred while any central is connected and abandoned (to be
+ * retried later) if one connects mid-decode, so it never competes with a BLE
+ * session. Peak memory is fixed: the decoder work area plus one strip of
+ * thumbnail rows; the JPEG is read from the print cache or straight from the
+ * file, never loaded whole.
+ */
+
+#ifndef THUMBNAIL_H
+#define THUMBNAIL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Prints waiting for a thumbnail
+#define THUMBNAIL_QUEUE_LEN     8
+
+typedef struct {
+    uint32_t queued;            // Prints waiting right now
+    uint32_t generated;
+    uint32_t failed;            // Decode or write errors
+    uint32_t unsupported;       // Not decodable by TJpgDec (e.g. progressive)
+    uint32_t deferred;          // Times work waited for BLE sessions to end
+    uint32_t interrupted;       // Decodes abandoned because a central connected
+    uint32_t dropped;           // Requests refused with the queue full
+    uint32_t last_ms;           // Time taken by the last thumbnail
+    uint16_t last_width;
+    uint16_t last_height;
+    size_t peak_bytes;          // Largest working set of a decode (work area + strip)
+} thumbnail_stats_t;
+
+/**
+ * Create the queue and the thumbnail task (call once at startup)
+ */
+esp_err_t thumbnail_init(void);
+
+/**
+ * Queue a thumbnail for a saved print (any task)
+ * @param name Print file name, e.g. "print_1234.jpg"
+ * @return ESP_OK, or ESP_ERR_NO_MEM if the queue is full
+ */
+esp_err_t thumbnail_request(const char *name);
+
+/**
+ * Build the SPIFFS path of a print's thumbnail
+ * @return false if the name does not fit
+ */
+bool thumbnail_path(const char *name, char *path, size_t path_len);
+
+/**
+ * Delete a print's thumbnail, if any
+ */
+void thumbnail_remove(const char *name);
+
+/**
+ * Get thumbnail statistics
+ */
+void thumbnail_get_stats(thumbnail_stats_t *stats);
+
+#endif // THUMBNAIL_H
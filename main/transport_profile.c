@@ -0,0 +1,187 @@
+/**
+ * @file transport_profile.c
+ * @brief Per-model transport profiles with runtime overrides kept in NVS
+ */
+
+#include "transport_profile.h"
+#include <string.h>
+#include "esp_log.h"
+#include "nvs.h"
+
+static const char *TAG = "transport_profile";
+
+// NVS storage: one blob per overridden model
+#define NVS_NAMESPACE           "transport"
+#define PROFILE_BLOB_VERSION    1
+
+// Fixed ACK delay saved by earlier firmware (one value for all models)
+#define LEGACY_NVS_NAMESPACE    "ack_pacer"
+#define LEGACY_NVS_KEY_DELAY    "fixed_ms"
+
+#define MODEL_COUNT             3
+
+typedef struct {
+    uint16_t version;           // PROFILE_BLOB_VERSION
+    uint16_t chunk_size;
+    uint16_t preferred_mtu;
+    uint16_t ack_delay_ms;
+    uint16_t chunk_delay_ms;
+    uint16_t start_delay_ms;
+    uint16_t end_delay_ms;
+    uint16_t execute_delay_ms;
+} profile_blob_t;
+
+static const char *const s_nvs_keys[MODEL_COUNT] = {
+    [INSTAX_MODEL_MINI] = "mini",
+    [INSTAX_MODEL_SQUARE] = "square",
+    [INSTAX_MODEL_WIDE] = "wide",
+};
+
+static bool s_custom[MODEL_COUNT];
+
+static void blob_to_profile(const profile_blob_t *blob, instax_model_info_t *profile) {
+    profile->chunk_size = blob->chunk_size;
+    profile->preferred_mtu = blob->preferred_mtu;
+    profile->ack_delay_ms = blob->ack_delay_ms;
+    profile->chunk_delay_ms = blob->chunk_delay_ms;
+    profile->start_delay_ms = blob->start_delay_ms;
+    profile->end_delay_ms = blob->end_delay_ms;
+    profile->execute_delay_ms = blob->execute_delay_ms;
+}
+
+static void profile_to_blob(const instax_model_info_t *profile, profile_blob_t *blob) {
+    memset(blob, 0, sizeof(*blob));
+    blob->version = PROFILE_BLOB_VERSION;
+    blob->chunk_size = profile->chunk_size;
+    blob->preferred_mtu = profile->preferred_mtu;
+    blob->ack_delay_ms = profile->ack_delay_ms;
+    blob->chunk_delay_ms = profile->chunk_delay_ms;
+    blob->start_delay_ms = profile->start_delay_ms;
+    blob->end_delay_ms = profile->end_delay_ms;
+    blob->execute_delay_ms = profile->execute_delay_ms;
+}
+
+/**
+ * Carry a fixed ACK delay saved by earlier firmware into the profiles
+ * (models without an override only), then drop the old key
+ */
+static void migrate_legacy_ack_delay(void) {
+    nvs_handle_t nvs_handle;
+    if (nvs_open(LEGACY_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle) != ESP_OK) {
+        return;
+    }
+    uint16_t delay_ms;
+    if (nvs_get_u16(nvs_handle, LEGACY_NVS_KEY_DELAY, &delay_ms) == ESP_OK) {
+        for (int m = 0; m < MODEL_COUNT; m++) {
+            const instax_model_info_t *defaults = instax_get_default_model_info((instax_model_t)m);
+            if (s_custom[m] || delay_ms == defaults->ack_delay_ms) {
+                continue;
+            }
+            instax_model_info_t profile = *defaults;
+            profile.ack_delay_ms = delay_ms;
+            if (transport_profile_set((instax_model_t)m, &profile) != ESP_OK) {
+                ESP_LOGW(TAG, "Could not migrate ACK delay %u ms for %s", delay_ms, s_nvs_keys[m]);
+            }
+        }
+        ESP_LOGI(TAG, "Migrated fixed ACK delay %u ms into transport profiles", delay_ms);
+        nvs_erase_key(nvs_handle, LEGACY_NVS_KEY_DELAY);
+        nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+}
+
+esp_err_t transport_profile_init(void) {
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle) == ESP_OK) {
+        for (int m = 0; m < MODEL_COUNT; m++) {
+            profile_blob_t blob;
+            size_t blob_len = sizeof(blob);
+            if (nvs_get_blob(nvs_handle, s_nvs_keys[m], &blob, &blob_len) != ESP_OK) {
+                continue;
+            }
+
+            if (blob_len != sizeof(blob) || blob.version != PROFILE_BLOB_VERSION) {
+                ESP_LOGW(TAG, "Ignoring %s profile v%u (%u bytes), expected v%u (%u bytes)",
+                         s_nvs_keys[m], blob.version, (unsigned)blob_len,
+                         PROFILE_BLOB_VERSION, (unsigned)sizeof(blob));
+                continue;
+            }
+            instax_model_info_t profile = *instax_get_default_model_info((instax_model_t)m);
+            blob_to_profile(&blob, &profile);
+            if (!instax_set_model_info((instax_model_t)m, &profile)) {
+                ESP_LOGW(TAG, "Ignoring out-of-range %s profile", s_nvs_keys[m]);
+                continue;
+            }
+            s_custom[m] = true;
+        }
+        nvs_close(nvs_handle);
+    }
+
+    migrate_legacy_ack_delay();
+
+    for (int m = 0; m < MODEL_COUNT; m++) {
+        const instax_model_info_t *p = instax_get_model_info((instax_model_t)m);
+        ESP_LOGI(TAG, "%s%s: MTU %u, chunk %u, ACK %u ms, chunk gap %u ms, start/end/execute %u/%u/%u ms",
+                 s_nvs_keys[m], s_custom[m] ? " (custom)" : "", p->preferred_mtu, p->chunk_size,
+                 p->ack_delay_ms, p->chunk_delay_ms, p->start_delay_ms, p->end_delay_ms,
+                 p->execute_delay_ms);
+    }
+    return ESP_OK;
+}
+
+esp_err_t transport_profile_set(instax_model_t model, const instax_model_info_t *profile) {
+    if (model >= MODEL_COUNT || !instax_set_model_info(model, profile)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_custom[model] = true;
+
+    profile_blob_t blob;
+    profile_to_blob(instax_get_model_info(model), &blob);
+
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ret = nvs_set_blob(nvs_handle, s_nvs_keys[model], &blob, sizeof(blob));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+
+    ESP_LOGI(TAG, "%s profile set: MTU %u, chunk %u, ACK %u ms, chunk gap %u ms, start/end/execute %u/%u/%u ms",
+             s_nvs_keys[model], blob.preferred_mtu, blob.chunk_size, blob.ack_delay_ms,
+             blob.chunk_delay_ms, blob.start_delay_ms, blob.end_delay_ms, blob.execute_delay_ms);
+    return ret;
+}
+
+esp_err_t transport_profile_reset(instax_model_t model) {
+    if (model >= MODEL_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    instax_set_model_info(model, instax_get_default_model_info(model));
+    s_custom[model] = false;
+
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ret = nvs_erase_key(nvs_handle, s_nvs_keys[model]);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        ret = ESP_OK;
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+
+    ESP_LOGI(TAG, "%s profile reset to defaults", s_nvs_keys[model]);
+    return ret;
+}
+
+bool transport_profile_is_custom(instax_model_t model) {
+    return model < MODEL_COUNT && s_custom[model];
+}
@@ -0,0 +1,44 @@
+/**
+ * @file transport_profile.h
+ * @brief Per-model transport profiles with runtime overrides kept in NVS
+ *
+ * The built-in profiles live in the model table of instax_protocol.c:
+ * preferred MTU, PRINT_DATA chunk size, the emulator's fixed-mode ACK delay
+ * and the scanner's inter-chunk and phase delays. This module loads saved
+ * overrides at boot and applies and saves changes made from the console or
+ * the HTTP API, so a model can be tuned without reflashing. New values are
+ * picked up from the next connection (MTU) or print job (everything else).
+ */
+
+#ifndef TRANSPORT_PROFILE_H
+#define TRANSPORT_PROFILE_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "instax_protocol.h"
+
+/**
+ * Load saved overrides from NVS into the model table
+ */
+esp_err_t transport_profile_init(void);
+
+/**
+ * Override a model's transport profile and save it to NVS
+ * Only the transport fields of profile are used (see instax_set_model_info).
+ * @param model Model to change
+ * @param profile Profile with the new transport fields
+ * @return ESP_ERR_INVALID_ARG if the model is unknown or a field is out of bounds
+ */
+esp_err_t transport_profile_set(instax_model_t model, const instax_model_info_t *profile);
+
+/**
+ * Restore a model's built-in profile and remove its override from NVS
+ */
+esp_err_t transport_profile_reset(instax_model_t model);
+
+/**
+ * Check whether a model runs with a saved override
+ */
+bool transport_profile_is_custom(instax_model_t model);
+
+#endif // TRANSPORT_PROFILE_H
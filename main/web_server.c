@@ -9,6 +9,19 @@
 #include "printer_emulator.h"
 #include "spiffs_manager.h"
 #include "instax_protocol.h"
+#include "ack_pacer.h"
+#include "transport_profile.h"
+#include "print_writer.h"
+#include "print_pool.h"
+#include "print_cache.h"
+#include "thumbnail.h"
+#include "print_journal.h"
+#include "print_resume.h"
+#include "retention.h"
+#include "notify_queue.h"
+#include "link_policy.h"
+#include "print_telemetry.h"
+#include "event_trace.h"
 #include <string.h>
 #include <errno.h>
 #include "esp_http_server.h"
@@ -50,6 +63,7 @@ static const char *HTML_TEMPLATE =
 "        .device-list li.instax { border-left: 4px solid #4CAF50; }\n"
 "        .file-list { list-style: none; padding: 0; }\n"
 "        .file-list li { padding: 10px; margin: 5px 0; background: #fff; border: 1px solid #ddd; border-radius: 4px; display: flex; justify-content: space-between; align-items: center; }\n"
+"        .file-list img { height: 48px; margin-right: 10px; vertical-align: middle; }\n"
 "        .progress { width: 100%%; height: 20px; background: #ddd; border-radius: 10px; overflow: hidden; }\n"
 "        .progress-bar { height: 100%%; background: #4CAF50; transition: width 0.3s; }\n"
 "        .printer-info { display: grid; grid-template-columns: repeat(2, 1fr); gap: 10px; }\n"
@@ -789,7 +803,8 @@ static const char *HTML_TEMPLATE =
 "                    list.innerHTML = '';\n"
 "                    d.files.forEach(f => {\n"
 "                        const li = document.createElement('li');\n"
-"                        li.innerHTML = '<span>' + f.name + ' (' + (f.size/1024).toFixed(1) + ' KB)</span>' +\n"
+"                        li.innerHTML = '<span><img src=\"/api/thumbs/' + f.name + '\" loading=\"lazy\" onerror=\"this.remove()\">' +\n"
+"                            f.name + ' (' + (f.size/1024).toFixed(1) + ' KB)</span>' +\n"
 "                            '<span><button onclick=\"viewFile(\\'' + f.name + '\\')\">View</button>' +\n"
 "                            '<button onclick=\"downloadFile(\\'' + f.name + '\\')\">Download</button>' +\n"
 "                            '<button class=\"danger\" onclick=\"deleteFile(\\'' + f.name + '\\')\">Delete</button></span>';\n"
@@ -983,7 +998,30 @@ static esp_err_t root_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
+// Print session histogram as a JSON array of bucket counts
+static cJSON *histogram_to_json(const uint32_t *hist) {
+    cJSON *array = cJSON_CreateArray();
+    for (int b = 0; b < PRINT_TELEMETRY_BUCKETS; b++) {
+        cJSON_AddItemToArray(array, cJSON_CreateNumber(hist[b]));
+    }
+    return array;
+}
+
 // Handler for status API
+static cJSON *transport_profile_to_json(instax_model_t model) {
+    const instax_model_info_t *p = instax_get_model_info(model);
+    cJSON *obj = cJSON_CreateObject();
+    cJSON_AddBoolToObject(obj, "custom", transport_profile_is_custom(model));
+    cJSON_AddNumberToObject(obj, "preferred_mtu", p->preferred_mtu);
+    cJSON_AddNumberToObject(obj, "chunk_size", p->chunk_size);
+    cJSON_AddNumberToObject(obj, "ack_delay_ms", p->ack_delay_ms);
+    cJSON_AddNumberToObject(obj, "chunk_delay_ms", p->chunk_delay_ms);
+    cJSON_AddNumberToObject(obj, "start_delay_ms", p->start_delay_ms);
+    cJSON_AddNumberToObject(obj, "end_delay_ms", p->end_delay_ms);
+    cJSON_AddNumberToObject(obj, "execute_delay_ms", p->execute_delay_ms);
+    return obj;
+}
+
 static esp_err_t api_status_handler(httpd_req_t *req) {
     cJSON *root = cJSON_CreateObject();
 
@@ -1036,12 +1074,332 @@ static esp_err_t api_status_handler(httpd_req_t *req) {
     }
     cJSON_AddStringToObject(root, "reset_reason", reset_reason_str);
 
-    // BLE failure information (placeholder - will be implemented in ble_peripheral.c)
+    // PRINT_DATA ACK pacing (last print job)
+    ack_pacer_stats_t pacing;
+    ack_pacer_get_stats(&pacing);
+    cJSON *pacing_info = cJSON_CreateObject();
+    cJSON_AddStringToObject(pacing_info, "mode", ack_pacer_mode_to_string(pacing.mode));
+    cJSON_AddNumberToObject(pacing_info, "fixed_delay_ms", pacing.fixed_delay_ms);
+    cJSON_AddNumberToObject(pacing_info, "acks_paced", pacing.acks_paced);
+    cJSON_AddNumberToObject(pacing_info, "acks_delayed", pacing.acks_delayed);
+    cJSON_AddNumberToObject(pacing_info, "total_delay_ms", pacing.total_delay_ms);
+    cJSON_AddNumberToObject(pacing_info, "max_delay_ms", pacing.max_delay_ms);
+    cJSON_AddNumberToObject(pacing_info, "flush_count", pacing.flush_count);
+    cJSON_AddNumberToObject(pacing_info, "flush_avg_us", pacing.flush_avg_us);
+    cJSON_AddNumberToObject(pacing_info, "flush_max_us", pacing.flush_max_us);
+    cJSON_AddNumberToObject(pacing_info, "mbuf_free_min", pacing.mbuf_free_min);
+    cJSON_AddItemToObject(root, "ack_pacing", pacing_info);
+
+    // Per-model transport profiles (built-in or tuned from the API/console)
+    cJSON *profiles = cJSON_CreateObject();
+    for (int m = INSTAX_MODEL_MINI; m <= INSTAX_MODEL_WIDE; m++) {
+        cJSON_AddItemToObject(profiles, printer_emulator_model_to_string((instax_model_t)m),
+                              transport_profile_to_json((instax_model_t)m));
+    }
+    cJSON_AddItemToObject(root, "transport_profiles", profiles);
+
+    // Double-buffered SPIFFS writer (last print job)
+    print_writer_stats_t writer;
+    print_writer_get_stats(&writer);
+    cJSON *writer_info = cJSON_CreateObject();
+    cJSON_AddBoolToObject(writer_info, "open", writer.open);
+    cJSON_AddBoolToObject(writer_info, "draining", writer.draining);
+    cJSON_AddNumberToObject(writer_info, "buffer_size", writer.buffer_size);
+    cJSON_AddNumberToObject(writer_info, "active_used", writer.active_used);
+    cJSON_AddNumberToObject(writer_info, "flushes", writer.flushes);
+    cJSON_AddNumberToObject(writer_info, "bytes_written", writer.bytes_written);
+    cJSON_AddNumberToObject(writer_info, "flush_last_us", writer.flush_last_us);
+    cJSON_AddNumberToObject(writer_info, "flush_avg_us", writer.flush_avg_us);
+    cJSON_AddNumberToObject(writer_info, "flush_max_us", writer.flush_max_us);
+    cJSON_AddNumberToObject(writer_info, "stalls", writer.stalls);
+    cJSON_AddNumberToObject(writer_info, "stall_total_us", writer.stall_total_us);
+    cJSON_AddNumberToObject(writer_info, "stall_max_us", writer.stall_max_us);
+    cJSON_AddNumberToObject(writer_info, "write_errors", writer.write_errors);
+    cJSON_AddItemToObject(root, "print_writer", writer_info);
+
+    // Print buffer pool and heap fragmentation
+    print_pool_stats_t pool;
+    print_pool_get_stats(&pool);
+    cJSON *pool_info = cJSON_CreateObject();
+    cJSON_AddNumberToObject(pool_info, "slot_size", pool.slot_size);
+    cJSON_AddNumberToObject(pool_info, "slots", pool.slots);
+    cJSON_AddNumberToObject(pool_info, "in_use", pool.in_use);
+    cJSON_AddNumberToObject(pool_info, "high_water", pool.high_water);
+    cJSON_AddNumberToObject(pool_info, "acquires", pool.acquires);
+    cJSON_AddNumberToObject(pool_info, "acquire_failures", pool.acquire_failures);
+    cJSON_AddItemToObject(root, "print_pool", pool_info);
+
+    // Whole-print RAM mode and recent-prints cache
+    print_cache_stats_t cache;
+    print_cache_get_stats(&cache);
+    cJSON *cache_info = cJSON_CreateObject();
+    cJSON_AddBoolToObject(cache_info, "whole_print", cache.whole_print);
+    cJSON_AddBoolToObject(cache_info, "psram", cache.psram);
+    cJSON_AddNumberToObject(cache_info, "jobs_in_ram", cache.jobs_in_ram);
+    cJSON_AddNumberToObject(cache_info, "jobs_streamed", cache.jobs_streamed);
+    cJSON_AddNumberToObject(cache_info, "jobs_aborted", cache.jobs_aborted);
+    cJSON_AddNumberToObject(cache_info, "save_failures", cache.save_failures);
+    cJSON_AddNumberToObject(cache_info, "hits", cache.hits);
+    cJSON_AddNumberToObject(cache_info, "misses", cache.misses);
+    cJSON_AddNumberToObject(cache_info, "evictions", cache.evictions);
+    cJSON_AddNumberToObject(cache_info, "entries", cache.entries);
+    cJSON_AddNumberToObject(cache_info, "bytes", cache.bytes);
+    cJSON_AddItemToObject(root, "print_cache", cache_info);
+
+    // Dropped jobs kept for resuming
+    print_resume_stats_t resume;
+    print_resume_get_stats(&resume);
+    cJSON *resume_info = cJSON_CreateObject();
+    cJSON_AddNumberToObject(resume_info, "window_s", PRINT_RESUME_WINDOW_S);
+    cJSON_AddNumberToObject(resume_info, "parked", resume.parked);
+    cJSON_AddNumberToObject(resume_info, "hits", resume.hits);
+    cJSON_AddNumberToObject(resume_info, "misses", resume.misses);
+    cJSON_AddNumberToObject(resume_info, "replaced", resume.replaced);
+    cJSON_AddNumberToObject(resume_info, "expired", resume.expired);
+    cJSON_AddNumberToObject(resume_info, "chunks_skipped", resume.chunks_skipped);
+    cJSON_AddNumberToObject(resume_info, "bytes_skipped", resume.bytes_skipped);
+    cJSON_AddBoolToObject(resume_info, "holding", resume.holding);
+    cJSON_AddNumberToObject(resume_info, "held_bytes", resume.held_bytes);
+    cJSON_AddNumberToObject(resume_info, "held_age_s", resume.held_age_s);
+    cJSON_AddItemToObject(root, "print_resume", resume_info);
+
+    // Gallery thumbnails
+    thumbnail_stats_t thumbs;
+    thumbnail_get_stats(&thumbs);
+    cJSON *thumb_info = cJSON_CreateObject();
+    cJSON_AddNumberToObject(thumb_info, "queued", thumbs.queued);
+    cJSON_AddNumberToObject(thumb_info, "generated", thumbs.generated);
+    cJSON_AddNumberToObject(thumb_info, "failed", thumbs.failed);
+    cJSON_AddNumberToObject(thumb_info, "unsupported", thumbs.unsupported);
+    cJSON_AddNumberToObject(thumb_info, "deferred", thumbs.deferred);
+    cJSON_AddNumberToObject(thumb_info, "interrupted", thumbs.interrupted);
+    cJSON_AddNumberToObject(thumb_info, "dropped", thumbs.dropped);
+    cJSON_AddNumberToObject(thumb_info, "last_ms", thumbs.last_ms);
+    cJSON_AddNumberToObject(thumb_info, "last_width", thumbs.last_width);
+    cJSON_AddNumberToObject(thumb_info, "last_height", thumbs.last_height);
+    cJSON_AddNumberToObject(thumb_info, "peak_bytes", thumbs.peak_bytes);
+    cJSON_AddItemToObject(root, "thumbnails", thumb_info);
+
+    // Storage retention / eviction
+    retention_stats_t retention;
+    retention_get_stats(&retention);
+    cJSON *retention_info = cJSON_CreateObject();
+    cJSON_AddNumberToObject(retention_info, "reserve_bytes", retention.reserve_bytes);
+    cJSON_AddNumberToObject(retention_info, "max_count", retention.policy.max_count);
+    cJSON_AddNumberToObject(retention_info, "max_age_s", retention.policy.max_age_s);
+    cJSON_AddNumberToObject(retention_info, "max_bytes", retention.policy.max_bytes);
+    cJSON_AddNumberToObject(retention_info, "passes", retention.passes);
+    cJSON_AddNumberToObject(retention_info, "interrupted", retention.interrupted);
+    cJSON_AddNumberToObject(retention_info, "evicted", retention.evicted);
+    cJSON_AddNumberToObject(retention_info, "evicted_bytes", retention.evicted_bytes);
+    cJSON *by_rule = cJSON_CreateObject();
+    for (int i = 0; i < RETENTION_RULE_MAX; i++) {
+        cJSON_AddNumberToObject(by_rule, retention_rule_to_string((retention_rule_t)i),
+                                retention.evicted_by_rule[i]);
+    }
+    cJSON_AddItemToObject(retention_info, "evicted_by_rule", by_rule);
+    cJSON_AddNumberToObject(retention_info, "failures", retention.failures);
+    cJSON_AddNumberToObject(retention_info, "print_files", retention.print_files);
+    cJSON_AddNumberToObject(retention_info, "print_bytes", retention.print_bytes);
+    cJSON_AddNumberToObject(retention_info, "free_bytes", retention.free_bytes);
+    cJSON_AddStringToObject(retention_info, "last_evicted", retention.last_evicted);
+    cJSON_AddItemToObject(root, "retention", retention_info);
+
+    // Printer state persistence (coalesced NVS writes)
+    printer_state_stats_t state;
+    printer_emulator_get_state_stats(&state);
+    cJSON *state_info = cJSON_CreateObject();
+    cJSON_AddNumberToObject(state_info, "requests", state.requests);
+    cJSON_AddNumberToObject(state_info, "commits", state.commits);
+    cJSON_AddNumberToObject(state_info, "unchanged", state.unchanged);
+    cJSON_AddNumberToObject(state_info, "failures", state.failures);
+    cJSON_AddNumberToObject(state_info, "last_us", state.last_us);
+    cJSON_AddNumberToObject(state_info, "max_us", state.max_us);
+    cJSON_AddNumberToObject(state_info, "avg_us", state.commits ? (double)(state.total_us / state.commits) : 0);
+    cJSON_AddBoolToObject(state_info, "pending", state.pending);
+    cJSON_AddItemToObject(root, "state_store", state_info);
+
+    cJSON *heap_info = cJSON_CreateObject();
+    cJSON_AddNumberToObject(heap_info, "free_bytes", pool.free_bytes);
+    cJSON_AddNumberToObject(heap_info, "free_bytes_min", pool.free_bytes_min);
+    cJSON_AddNumberToObject(heap_info, "largest_free_block", pool.largest_free_block);
+    cJSON_AddNumberToObject(heap_info, "largest_free_block_min", pool.largest_free_block_min);
+    print_pool_heap_sample_t samples[PRINT_POOL_HEAP_HISTORY];
+    size_t sample_count = print_pool_get_heap_history(samples, PRINT_POOL_HEAP_HISTORY);
+    cJSON *heap_history = cJSON_CreateArray();
+    for (size_t i = 0; i < sample_count; i++) {
+        cJSON *sample = cJSON_CreateObject();
+        cJSON_AddNumberToObject(sample, "timestamp_ms", samples[i].timestamp_ms);
+        cJSON_AddNumberToObject(sample, "free_bytes", samples[i].free_bytes);
+        cJSON_AddNumberToObject(sample, "largest_free_block", samples[i].largest_free_block);
+        cJSON_AddItemToArray(heap_history, sample);
+    }
+    cJSON_AddItemToObject(heap_info, "history", heap_history);
+    cJSON_AddItemToObject(root, "heap", heap_info);
+
+    // Outbound notification scheduler (last print job)
+    notify_queue_stats_t notify;
+    notify_queue_get_stats(&notify);
+    cJSON *notify_info = cJSON_CreateObject();
+    cJSON_AddNumberToObject(notify_info, "acks_sent", notify.acks_sent);
+    cJSON_AddNumberToObject(notify_info, "acks_retried", notify.acks_retried);
+    cJSON_AddNumberToObject(notify_info, "acks_failed", notify.acks_failed);
+    cJSON_AddNumberToObject(notify_info, "acks_from_reserve", notify.acks_from_reserve);
+    cJSON_AddNumberToObject(notify_info, "status_sent", notify.status_sent);
+    cJSON_AddNumberToObject(notify_info, "status_deferred", notify.status_deferred);
+    cJSON_AddNumberToObject(notify_info, "queue_full", notify.queue_full);
+    cJSON_AddNumberToObject(notify_info, "depth_high_water", notify.depth_high_water);
+    cJSON_AddNumberToObject(notify_info, "reserve_held", notify.reserve_held);
+    cJSON_AddItemToObject(root, "notify_queue", notify_info);
+
+    // Negotiated BLE link (connection parameters, PHY, data length, MTU)
+    link_policy_stats_t link;
+    link_policy_get_stats(&link);
+    cJSON *link_info = cJSON_CreateObject();
+    cJSON_AddBoolToObject(link_info, "connected", link.conn_handle != 0xFFFF);
+    cJSON_AddNumberToObject(link_info, "connections", link.connections);
+    cJSON_AddStringToObject(link_info, "state", link_policy_state_to_string(link.state));
+    cJSON_AddStringToObject(link_info, "profile", printer_emulator_model_to_string(link.model));
+    cJSON_AddNumberToObject(link_info, "conn_interval_ms", link.conn_itvl * 1.25);
+    cJSON_AddNumberToObject(link_info, "conn_latency", link.conn_latency);
+    cJSON_AddNumberToObject(link_info, "supervision_timeout_ms", link.supervision_timeout * 10);
+    cJSON_AddNumberToObject(link_info, "tx_phy", link.tx_phy);
+    cJSON_AddNumberToObject(link_info, "rx_phy", link.rx_phy);
+    cJSON_AddNumberToObject(link_info, "max_tx_octets", link.max_tx_octets);
+    cJSON_AddNumberToObject(link_info, "max_tx_time_us", link.max_tx_time);
+    cJSON_AddNumberToObject(link_info, "max_rx_octets", link.max_rx_octets);
+    cJSON_AddNumberToObject(link_info, "mtu", link.mtu);
+    cJSON_AddNumberToObject(link_info, "param_requests", link.param_requests);
+    cJSON_AddNumberToObject(link_info, "param_updates", link.param_updates);
+    cJSON_AddNumberToObject(link_info, "param_failures", link.param_failures);
+    cJSON_AddNumberToObject(link_info, "peer_requests", link.peer_requests);
+    cJSON_AddNumberToObject(link_info, "phy_updates", link.phy_updates);
+    cJSON_AddNumberToObject(link_info, "data_len_updates", link.data_len_updates);
+    cJSON_AddNumberToObject(link_info, "mtu_updates", link.mtu_updates);
+
+    link_policy_event_t history[LINK_POLICY_HISTORY_SIZE];
+    size_t history_count = link_policy_get_history(history, LINK_POLICY_HISTORY_SIZE);
+    cJSON *history_array = cJSON_CreateArray();
+    for (size_t i = 0; i < history_count; i++) {
+        cJSON *ev = cJSON_CreateObject();
+        cJSON_AddNumberToObject(ev, "timestamp_ms", history[i].timestamp_ms);
+        cJSON_AddNumberToObject(ev, "conn_handle", history[i].conn_handle);
+        cJSON_AddStringToObject(ev, "event", link_policy_event_to_string(history[i].kind));
+        cJSON_AddStringToObject(ev, "state", link_policy_state_to_string(history[i].state));
+        cJSON_AddNumberToObject(ev, "status", history[i].status);
+        cJSON_AddNumberToObject(ev, "conn_interval_ms", history[i].conn_itvl * 1.25);
+        cJSON_AddNumberToObject(ev, "conn_latency", history[i].conn_latency);
+        cJSON_AddNumberToObject(ev, "supervision_timeout_ms", history[i].supervision_timeout * 10);
+        cJSON_AddNumberToObject(ev, "tx_phy", history[i].tx_phy);
+        cJSON_AddNumberToObject(ev, "rx_phy", history[i].rx_phy);
+        cJSON_AddNumberToObject(ev, "max_tx_octets", history[i].max_tx_octets);
+        cJSON_AddNumberToObject(ev, "mtu", history[i].mtu);
+        cJSON_AddItemToArray(history_array, ev);
+    }
+    cJSON_AddItemToObject(link_info, "history", history_array);
+    cJSON_AddItemToObject(root, "link", link_info);
+
+    // Protocol task / frame ring
+    ble_protocol_task_stats_t proto;
+    ble_peripheral_get_protocol_task_stats(&proto);
+    cJSON *proto_info = cJSON_CreateObject();
+    cJSON_AddNumberToObject(proto_info, "priority", proto.priority);
+    cJSON_AddNumberToObject(proto_info, "stack_free", proto.stack_free);
+    cJSON_AddNumberToObject(proto_info, "ring_depth", proto.ring.depth);
+    cJSON_AddNumberToObject(proto_info, "ring_high_water", proto.ring.high_water);
+    cJSON_AddNumberToObject(proto_info, "frames", proto.ring.pushed);
+    cJSON_AddNumberToObject(proto_info, "frames_dropped", proto.ring.dropped);
+    cJSON_AddNumberToObject(proto_info, "checksum_errors", proto.rx.bad_checksum);
+    cJSON_AddNumberToObject(proto_info, "checksum_error_replies", proto.bad_frame_replies);
+    cJSON_AddNumberToObject(proto_info, "bad_length", proto.rx.bad_length);
+    cJSON_AddNumberToObject(proto_info, "resyncs", proto.rx.resyncs);
+    cJSON_AddNumberToObject(proto_info, "bytes_skipped", proto.rx.bytes_skipped);
+    cJSON_AddNumberToObject(proto_info, "bytes_dropped", proto.rx.bytes_dropped);
+    cJSON_AddItemToObject(root, "protocol_task", proto_info);
+
+    // PRINT_DATA copy accounting (current/last job)
+    ble_print_data_path_stats_t copy_stats;
+    ble_peripheral_get_print_data_path_stats(&copy_stats);
+    cJSON *copy_info = cJSON_CreateObject();
+    cJSON_AddNumberToObject(copy_info, "payload_bytes", copy_stats.payload_bytes);
+    cJSON_AddNumberToObject(copy_info, "bytes_copied", copy_stats.bytes_copied);
+    cJSON_AddNumberToObject(copy_info, "zero_copy_chunks", copy_stats.zero_copy_chunks);
+    cJSON_AddNumberToObject(copy_info, "copied_chunks", copy_stats.copied_chunks);
+    cJSON_AddItemToObject(root, "print_data_path", copy_info);
+
+    // Per print session transfer telemetry (oldest first)
+    print_telemetry_session_t sessions[PRINT_TELEMETRY_HISTORY];
+    size_t session_count = print_telemetry_get_sessions(sessions, PRINT_TELEMETRY_HISTORY);
+    cJSON *bucket_limits = cJSON_CreateArray();
+    for (int b = 0; b < PRINT_TELEMETRY_BUCKETS - 1; b++) {
+        cJSON_AddItemToArray(bucket_limits, cJSON_CreateNumber(print_telemetry_bucket_limits_us[b]));
+    }
+    cJSON_AddItemToObject(root, "print_session_buckets_us", bucket_limits);
+    cJSON *sessions_array = cJSON_CreateArray();
+    for (size_t i = 0; i < session_count; i++) {
+        const print_telemetry_session_t *ps = &sessions[i];
+        cJSON *ses = cJSON_CreateObject();
+        cJSON_AddNumberToObject(ses, "id", ps->id);
+        cJSON_AddNumberToObject(ses, "conn_handle", ps->conn_handle);
+        cJSON_AddStringToObject(ses, "model", printer_emulator_model_to_string(ps->model));
+        cJSON_AddNumberToObject(ses, "mtu", ps->mtu);
+        cJSON_AddStringToObject(ses, "end_reason", print_telemetry_end_reason_to_string(ps->end_reason));
+        cJSON_AddNumberToObject(ses, "start_ms", ps->start_ms);
+        cJSON_AddNumberToObject(ses, "end_ms", ps->end_ms);
+        cJSON_AddNumberToObject(ses, "image_size", ps->image_size);
+        cJSON_AddNumberToObject(ses, "bytes_received", ps->bytes_received);
+        cJSON_AddNumberToObject(ses, "chunks", ps->chunks);
+        cJSON_AddNumberToObject(ses, "upload_ms", ps->upload_us / 1000);
+        cJSON_AddNumberToObject(ses, "bytes_per_sec", ps->bytes_per_sec);
+        cJSON_AddNumberToObject(ses, "gap_min_us", ps->gap_min_us);
+        cJSON_AddNumberToObject(ses, "gap_avg_us", ps->gap_avg_us);
+        cJSON_AddNumberToObject(ses, "gap_max_us", ps->gap_max_us);
+        cJSON_AddItemToObject(ses, "gap_histogram", histogram_to_json(ps->gap_hist));
+        cJSON_AddNumberToObject(ses, "acks", ps->acks);
+        cJSON_AddNumberToObject(ses, "ack_retries", ps->ack_retries);
+        cJSON_AddNumberToObject(ses, "ack_latency_avg_us", ps->ack_latency_avg_us);
+        cJSON_AddNumberToObject(ses, "ack_latency_max_us", ps->ack_latency_max_us);
+        cJSON_AddItemToObject(ses, "ack_latency_histogram", histogram_to_json(ps->ack_hist));
+        if (ps->image_checked) {
+            char crc[9];
+            snprintf(crc, sizeof(crc), "%08lx", (unsigned long)ps->image.crc32);
+            cJSON *image = cJSON_CreateObject();
+            cJSON_AddStringToObject(image, "file", ps->file);
+            cJSON_AddStringToObject(image, "status", jpeg_scan_status_to_string(ps->image.status));
+            cJSON_AddNumberToObject(image, "width", ps->image.width);
+            cJSON_AddNumberToObject(image, "height", ps->image.height);
+            cJSON_AddNumberToObject(image, "components", ps->image.components);
+            cJSON_AddBoolToObject(image, "progressive", ps->image.sof == 0xC2);
+            cJSON_AddNumberToObject(image, "bytes", ps->image.bytes);
+            cJSON_AddNumberToObject(image, "eoi_offset", ps->image.eoi_offset);
+            cJSON_AddNumberToObject(image, "error_offset", ps->image.error_offset);
+            cJSON_AddStringToObject(image, "crc32", crc);
+            cJSON_AddItemToObject(ses, "image", image);
+        }
+        cJSON_AddItemToArray(sessions_array, ses);
+    }
+    cJSON_AddItemToObject(root, "print_sessions", sessions_array);
+
+    // BLE host resets and disconnects
+    ble_failure_stats_t failures;
+    ble_peripheral_get_failure_stats(&failures);
+    uint32_t now_ms = esp_log_timestamp();
     cJSON *ble_info = cJSON_CreateObject();
-    cJSON_AddNumberToObject(ble_info, "reset_count", 0);
-    cJSON_AddNumberToObject(ble_info, "disconnect_count", 0);
-    cJSON_AddStringToObject(ble_info, "last_reset_reason", "None");
-    cJSON_AddStringToObject(ble_info, "last_disconnect_reason", "None");
+    cJSON_AddNumberToObject(ble_info, "reset_count", failures.reset_count);
+    cJSON_AddNumberToObject(ble_info, "disconnect_count", failures.disconnect_count);
+    cJSON_AddStringToObject(ble_info, "last_reset_reason", failures.reset_count > 0 ?
+                            ble_peripheral_reason_to_string(failures.last_reset_reason) : "None");
+    cJSON_AddStringToObject(ble_info, "last_disconnect_reason", failures.disconnect_count > 0 ?
+                            ble_peripheral_reason_to_string(failures.last_disconnect_reason) : "None");
+    if (failures.reset_count > 0) {
+        cJSON_AddNumberToObject(ble_info, "last_reset_code", failures.last_reset_reason);
+        cJSON_AddNumberToObject(ble_info, "last_reset_seconds_ago", (now_ms - failures.last_reset_ms) / 1000);
+    }
+    if (failures.disconnect_count > 0) {
+        cJSON_AddNumberToObject(ble_info, "last_disconnect_code", failures.last_disconnect_reason);
+        cJSON_AddNumberToObject(ble_info, "last_disconnect_seconds_ago",
+                                (now_ms - failures.last_disconnect_ms) / 1000);
+    }
     cJSON_AddItemToObject(root, "ble_failures", ble_info);
 
     char *json = cJSON_Print(root);
@@ -1139,9 +1497,20 @@ static esp_err_t api_file_download_handler(httpd_req_t *req) {
 
     ESP_LOGI(TAG, "Downloading file: %s", filename);
 
+    // Recently received prints are still in RAM
+    size_t cached_len = 0;
+    const uint8_t *cached = print_cache_acquire(filename, &cached_len);
+    if (cached != NULL) {
+        httpd_resp_set_type(req, "image/jpeg");
+        esp_err_t ret = httpd_resp_send(req, (const char *)cached, cached_len);
+        print_cache_release(cached);
+        ESP_LOGI(TAG, "File download complete from RAM cache: %u bytes", (unsigned)cached_len);
+        return ret;
+    }
+
     // Read file from SPIFFS
     char filepath[64];
-    snprintf(filepath, sizeof(filepath), "/spiffs/%s", filename);
+    snprintf(filepath, sizeof(filepath), SPIFFS_BASE_PATH "/%s", filename);
 
     FILE *f = fopen(filepath, "rb");
     if (f == NULL) {
@@ -1191,6 +1560,44 @@ static esp_err_t api_file_download_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
+// Handler for print thumbnails (e.g., /api/thumbs/print_12345.jpg)
+static esp_err_t api_thumb_handler(httpd_req_t *req) {
+    const char *filename = req->uri + strlen("/api/thumbs/");
+    char thumb_path[64];
+    if (strlen(filename) == 0 || !thumbnail_path(filename, thumb_path, sizeof(thumb_path))) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Bad filename");
+        return ESP_FAIL;
+    }
+
+    FILE *f = fopen(thumb_path, "rb");
+    if (f == NULL) {
+        // Older print, or still waiting for the BLE session to end - the gallery falls back
+        if (spiffs_manager_file_exists(filename)) {
+            thumbnail_request(filename);
+        }
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No thumbnail yet");
+        return ESP_FAIL;
+    }
+
+    httpd_resp_set_type(req, "image/bmp");
+    httpd_resp_set_hdr(req, "Cache-Control", "max-age=3600");
+
+    char chunk[512];
+    size_t read_bytes;
+    esp_err_t ret = ESP_OK;
+    while ((read_bytes = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        if (httpd_resp_send_chunk(req, chunk, read_bytes) != ESP_OK) {
+            ret = ESP_FAIL;
+            break;
+        }
+    }
+    fclose(f);
+    if (ret == ESP_OK) {
+        httpd_resp_send_chunk(req, NULL, 0);
+    }
+    return ret;
+}
+
 // Handler for file deletion
 static esp_err_t api_file_delete_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "File delete request, URI: %s", req->uri);
@@ -1201,9 +1608,11 @@ static esp_err_t api_file_delete_handler(httpd_req_t *req) {
         char filename[64] = {0};
         if (httpd_query_key_value(filename_param, "file", filename, sizeof(filename)) == ESP_OK) {
             ESP_LOGI(TAG, "Deleting file from query param: %s", filename);
+            print_cache_remove(filename);
+            thumbnail_remove(filename);
 
             char filepath[80];
-            snprintf(filepath, sizeof(filepath), "/spiffs/%s", filename);
+            snprintf(filepath, sizeof(filepath), SPIFFS_BASE_PATH "/%s", filename);
 
             if (remove(filepath) != 0) {
                 ESP_LOGE(TAG, "Failed to delete file: %s", filepath);
@@ -1222,9 +1631,11 @@ static esp_err_t api_file_delete_handler(httpd_req_t *req) {
     const char *filename = req->uri + strlen("/api/files/");
     if (strlen(filename) > 0 && strcmp(filename, "*") != 0) {
         ESP_LOGI(TAG, "Deleting file from path: %s", filename);
+        print_cache_remove(filename);
+        thumbnail_remove(filename);
 
         char filepath[80];
-        snprintf(filepath, sizeof(filepath), "/spiffs/%s", filename);
+        snprintf(filepath, sizeof(filepath), SPIFFS_BASE_PATH "/%s", filename);
 
         if (remove(filepath) != 0) {
             ESP_LOGE(TAG, "Failed to delete file: %s", filepath);
@@ -1246,6 +1657,7 @@ static esp_err_t api_file_delete_handler(httpd_req_t *req) {
 // Handler for delete all files
 static esp_err_t api_delete_all_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "Delete all files request");
+    print_cache_clear();
 
     // Format SPIFFS (deletes all files)
     esp_err_t ret = spiffs_manager_format();
@@ -1255,6 +1667,8 @@ static esp_err_t api_delete_all_handler(httpd_req_t *req) {
         return ESP_FAIL;
     }
 
+    print_journal_reset();  // The journal file went with the format
+
     ESP_LOGI(TAG, "All files deleted successfully");
     httpd_resp_set_status(req, "200 OK");
     httpd_resp_set_type(req, "application/json");
@@ -1535,7 +1949,7 @@ static esp_err_t docs_readme_handler(httpd_req_t *req) {
 
 // Raw markdown handlers for fetching actual content
 static esp_err_t docs_protocol_raw_handler(httpd_req_t *req) {
-    FILE *f = fopen("/spiffs/INSTAX_PROTOCOL.md", "r");
+    FILE *f = fopen(SPIFFS_BASE_PATH "/INSTAX_PROTOCOL.md", "r");
     if (f == NULL) {
         ESP_LOGE(TAG, "Failed to open /spiffs/INSTAX_PROTOCOL.md: %s", strerror(errno));
         httpd_resp_send_404(req);
@@ -1559,7 +1973,7 @@ static esp_err_t docs_protocol_raw_handler(httpd_req_t *req) {
 }
 
 static esp_err_t docs_install_raw_handler(httpd_req_t *req) {
-    FILE *f = fopen("/spiffs/INSTALL_ESP_IDF.md", "r");
+    FILE *f = fopen(SPIFFS_BASE_PATH "/INSTALL_ESP_IDF.md", "r");
     if (f == NULL) {
         ESP_LOGE(TAG, "Failed to open /spiffs/INSTALL_ESP_IDF.md: %s", strerror(errno));
         httpd_resp_send_404(req);
@@ -1583,7 +1997,7 @@ static esp_err_t docs_install_raw_handler(httpd_req_t *req) {
 }
 
 static esp_err_t docs_readme_raw_handler(httpd_req_t *req) {
-    FILE *f = fopen("/spiffs/README.md", "r");
+    FILE *f = fopen(SPIFFS_BASE_PATH "/README.md", "r");
     if (f == NULL) {
         ESP_LOGE(TAG, "Failed to open /spiffs/README.md: %s", strerror(errno));
         httpd_resp_send_404(req);
@@ -1836,6 +2250,289 @@ static esp_err_t api_set_suspend_decrement_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
+// Handler for setting PRINT_DATA ACK pacing mode
+static esp_err_t api_set_ack_pacing_handler(httpd_req_t *req) {
+    char buf[100];
+    int ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
+    if (ret <= 0) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid request");
+        return ESP_FAIL;
+    }
+    buf[ret] = '\0';
+
+    cJSON *json = cJSON_Parse(buf);
+    if (!json) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_FAIL;
+    }
+
+    cJSON *mode_item = cJSON_GetObjectItem(json, "mode");
+    if (!mode_item || !cJSON_IsString(mode_item)) {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing or invalid mode");
+        return ESP_FAIL;
+    }
+
+    ack_pacer_mode_t mode;
+    if (strcmp(mode_item->valuestring, "adaptive") == 0) {
+        mode = ACK_PACER_MODE_ADAPTIVE;
+    } else if (strcmp(mode_item->valuestring, "fixed") == 0) {
+        mode = ACK_PACER_MODE_FIXED;
+    } else {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Mode must be 'adaptive' or 'fixed'");
+        return ESP_FAIL;
+    }
+
+    // The fixed delay belongs to the emulated model's transport profile
+    instax_model_t model = printer_emulator_get_info()->model;
+    instax_model_info_t profile = *instax_get_model_info(model);
+    esp_err_t result = ESP_OK;
+
+    cJSON *delay_item = cJSON_GetObjectItem(json, "delay_ms");
+    if (delay_item) {
+        if (!cJSON_IsNumber(delay_item) || delay_item->valueint < 0 ||
+            delay_item->valueint > ACK_PACER_MAX_DELAY_MS) {
+            cJSON_Delete(json);
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid delay_ms");
+            return ESP_FAIL;
+        }
+        profile.ack_delay_ms = (uint16_t)delay_item->valueint;
+        result = transport_profile_set(model, &profile);
+    }
+
+    if (result == ESP_OK) {
+        result = ack_pacer_set_mode(mode);
+    }
+    uint32_t delay_ms = instax_get_model_info(model)->ack_delay_ms;
+
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddBoolToObject(response, "success", result == ESP_OK);
+    cJSON_AddStringToObject(response, "mode", ack_pacer_mode_to_string(mode));
+    cJSON_AddNumberToObject(response, "delay_ms", delay_ms);
+    char *response_str = cJSON_Print(response);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response_str, strlen(response_str));
+
+    free(response_str);
+    cJSON_Delete(response);
+    cJSON_Delete(json);
+    return ESP_OK;
+}
+
+// Handler for setting the print retention limits (missing fields keep their value)
+static esp_err_t api_set_retention_handler(httpd_req_t *req) {
+    char buf[128];
+    int ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
+    if (ret <= 0) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid request");
+        return ESP_FAIL;
+    }
+    buf[ret] = '\0';
+
+    cJSON *json = cJSON_Parse(buf);
+    if (!json) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_FAIL;
+    }
+
+    retention_stats_t stats;
+    retention_get_stats(&stats);
+    retention_policy_t policy = stats.policy;
+
+    const char *keys[] = { "max_count", "max_age_s", "max_bytes" };
+    uint32_t *values[] = { &policy.max_count, &policy.max_age_s, &policy.max_bytes };
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        cJSON *item = cJSON_GetObjectItem(json, keys[i]);
+        if (!item) {
+            continue;
+        }
+        if (!cJSON_IsNumber(item) || item->valuedouble < 0 || item->valuedouble > UINT32_MAX) {
+            cJSON_Delete(json);
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Limits must be numbers >= 0");
+            return ESP_FAIL;
+        }
+        *values[i] = (uint32_t)item->valuedouble;
+    }
+
+    esp_err_t result = retention_set_policy(&policy);
+
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddBoolToObject(response, "success", result == ESP_OK);
+    cJSON_AddNumberToObject(response, "max_count", policy.max_count);
+    cJSON_AddNumberToObject(response, "max_age_s", policy.max_age_s);
+    cJSON_AddNumberToObject(response, "max_bytes", policy.max_bytes);
+    char *response_str = cJSON_Print(response);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response_str, strlen(response_str));
+
+    free(response_str);
+    cJSON_Delete(response);
+    cJSON_Delete(json);
+    return ESP_OK;
+}
+
+// Handler for tuning a model's transport profile
+// Body: {"model": "mini", "chunk_size": 900, ...} with any subset of the
+// profile fields, or {"model": "mini", "reset": true} for the built-in values
+static esp_err_t api_set_transport_profile_handler(httpd_req_t *req) {
+    char buf[256];
+    int ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
+    if (ret <= 0) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid request");
+        return ESP_FAIL;
+    }
+    buf[ret] = '\0';
+
+    cJSON *json = cJSON_Parse(buf);
+    if (!json) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_FAIL;
+    }
+
+    cJSON *model_item = cJSON_GetObjectItem(json, "model");
+    if (!model_item || !cJSON_IsString(model_item)) {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing or invalid model");
+        return ESP_FAIL;
+    }
+
+    instax_model_t model;
+    if (strcmp(model_item->valuestring, "mini") == 0) {
+        model = INSTAX_MODEL_MINI;
+    } else if (strcmp(model_item->valuestring, "square") == 0) {
+        model = INSTAX_MODEL_SQUARE;
+    } else if (strcmp(model_item->valuestring, "wide") == 0) {
+        model = INSTAX_MODEL_WIDE;
+    } else {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid model name");
+        return ESP_FAIL;
+    }
+
+    esp_err_t result;
+    if (cJSON_IsTrue(cJSON_GetObjectItem(json, "reset"))) {
+        result = transport_profile_reset(model);
+    } else {
+        instax_model_info_t profile = *instax_get_model_info(model);
+        const char *keys[] = {
+            "preferred_mtu", "chunk_size", "ack_delay_ms", "chunk_delay_ms",
+            "start_delay_ms", "end_delay_ms", "execute_delay_ms"
+        };
+        uint16_t *values[] = {
+            &profile.preferred_mtu, &profile.chunk_size, &profile.ack_delay_ms, &profile.chunk_delay_ms,
+            &profile.start_delay_ms, &profile.end_delay_ms, &profile.execute_delay_ms
+        };
+        for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+            cJSON *item = cJSON_GetObjectItem(json, keys[i]);
+            if (!item) {
+                continue;
+            }
+            if (!cJSON_IsNumber(item) || item->valuedouble < 0 || item->valuedouble > UINT16_MAX) {
+                cJSON_Delete(json);
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Profile values must be numbers 0-65535");
+                return ESP_FAIL;
+            }
+            *values[i] = (uint16_t)item->valuedouble;
+        }
+        result = transport_profile_set(model, &profile);
+        if (result == ESP_ERR_INVALID_ARG) {
+            cJSON_Delete(json);
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Profile value out of range");
+            return ESP_FAIL;
+        }
+    }
+
+    cJSON *response = transport_profile_to_json(model);
+    cJSON_AddBoolToObject(response, "success", result == ESP_OK);
+    cJSON_AddStringToObject(response, "model", printer_emulator_model_to_string(model));
+    char *response_str = cJSON_Print(response);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response_str, strlen(response_str));
+
+    free(response_str);
+    cJSON_Delete(response);
+    cJSON_Delete(json);
+    return ESP_OK;
+}
+
+// Handler for the binary event trace - decoded here, off the BLE hot path, and streamed
+static esp_err_t api_trace_handler(httpd_req_t *req) {
+    httpd_resp_set_type(req, "text/plain; charset=UTF-8");
+
+    event_trace_record_t records[16];
+    char buffer[16 * 128];
+    uint32_t cursor = 0;
+    size_t count;
+
+    while ((count = event_trace_read(&cursor, records, sizeof(records) / sizeof(records[0]))) > 0) {
+        size_t used = 0;
+        for (size_t i = 0; i < count; i++) {
+            used += event_trace_format(&records[i], buffer + used, sizeof(buffer) - used - 1);
+            buffer[used++] = '\n';
+        }
+        if (httpd_resp_send_chunk(req, buffer, used) != ESP_OK) {
+            return ESP_FAIL;
+        }
+    }
+
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
+}
+
+// Handler for setting the trace verbosity of a subsystem
+static esp_err_t api_trace_level_handler(httpd_req_t *req) {
+    char buf[100];
+    int ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
+    if (ret <= 0) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid request");
+        return ESP_FAIL;
+    }
+    buf[ret] = '\0';
+
+    cJSON *json = cJSON_Parse(buf);
+    if (!json) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_FAIL;
+    }
+
+    cJSON *subsys_item = cJSON_GetObjectItem(json, "subsystem");
+    cJSON *level_item = cJSON_GetObjectItem(json, "level");
+    event_trace_subsys_t subsys;
+    event_trace_level_t level;
+    if (!subsys_item || !cJSON_IsString(subsys_item) ||
+        !event_trace_subsys_from_string(subsys_item->valuestring, &subsys)) {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "subsystem must be 'rx', 'tx' or 'proto'");
+        return ESP_FAIL;
+    }
+    if (!level_item || !cJSON_IsString(level_item) ||
+        !event_trace_level_from_string(level_item->valuestring, &level)) {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "level must be 'off', 'frames' or 'verbose'");
+        return ESP_FAIL;
+    }
+
+    esp_err_t result = event_trace_set_level(subsys, level);
+
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddBoolToObject(response, "success", result == ESP_OK);
+    cJSON *levels = cJSON_CreateObject();
+    for (int i = 0; i < EVENT_TRACE_SUBSYS_COUNT; i++) {
+        cJSON_AddStringToObject(levels, event_trace_subsys_to_string(i),
+                                event_trace_level_to_string(event_trace_levels[i]));
+    }
+    cJSON_AddItemToObject(response, "levels", levels);
+    char *response_str = cJSON_Print(response);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response_str, strlen(response_str));
+
+    free(response_str);
+    cJSON_Delete(response);
+    cJSON_Delete(json);
+    return ESP_OK;
+}
+
 // Handler for setting BLE bonding enabled/disabled
 static esp_err_t api_set_bonding_handler(httpd_req_t *req) {
     char buf[100];
@@ -2148,6 +2845,159 @@ error:
     return ESP_FAIL;
 }
 
+// Handler for per-opcode dispatch statistics
+// Handler for print job history from the journal index
+// Optional query: status=<completed|rejected|disconnected|restarted>, model=<mini|square|wide>,
+// since=<unix time>, limit=<n>
+static esp_err_t api_journal_handler(httpd_req_t *req) {
+    print_journal_filter_t filter = {0};
+    size_t limit = 50;
+
+    char query[128];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        char value[16];
+        if (httpd_query_key_value(query, "status", value, sizeof(value)) == ESP_OK) {
+            if (!print_telemetry_end_reason_from_string(value, &filter.status)) {
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown status");
+                return ESP_FAIL;
+            }
+            filter.by_status = true;
+        }
+        if (httpd_query_key_value(query, "model", value, sizeof(value)) == ESP_OK) {
+            filter.by_model = true;
+            if (strcmp(value, "mini") == 0) {
+                filter.model = INSTAX_MODEL_MINI;
+            } else if (strcmp(value, "square") == 0) {
+                filter.model = INSTAX_MODEL_SQUARE;
+            } else if (strcmp(value, "wide") == 0) {
+                filter.model = INSTAX_MODEL_WIDE;
+            } else {
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown model");
+                return ESP_FAIL;
+            }
+        }
+        if (httpd_query_key_value(query, "since", value, sizeof(value)) == ESP_OK) {
+            filter.since = (uint32_t)strtoul(value, NULL, 10);
+        }
+        if (httpd_query_key_value(query, "limit", value, sizeof(value)) == ESP_OK) {
+            limit = strtoul(value, NULL, 10);
+        }
+    }
+    if (limit == 0 || limit > PRINT_JOURNAL_INDEX_SIZE) {
+        limit = PRINT_JOURNAL_INDEX_SIZE;
+    }
+
+    print_journal_record_t *records = malloc(limit * sizeof(print_journal_record_t));
+    if (records == NULL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        return ESP_FAIL;
+    }
+    size_t count = print_journal_query(&filter, records, limit);
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON *jobs = cJSON_CreateArray();
+    for (size_t i = 0; i < count; i++) {
+        const print_journal_record_t *rec = &records[i];
+        cJSON *job = cJSON_CreateObject();
+        cJSON_AddNumberToObject(job, "seq", rec->seq);
+        cJSON_AddNumberToObject(job, "timestamp", rec->timestamp);
+        if (rec->file_id != 0) {
+            char file[32];
+            snprintf(file, sizeof(file), "print_%lu.jpg", (unsigned long)rec->file_id);
+            cJSON_AddStringToObject(job, "file", file);
+            cJSON_AddStringToObject(job, "jpeg", jpeg_scan_status_to_string((jpeg_scan_status_t)rec->jpeg_status));
+        }
+        cJSON_AddStringToObject(job, "model", printer_emulator_model_to_string((instax_model_t)rec->model));
+        cJSON_AddStringToObject(job, "status", print_telemetry_end_reason_to_string((print_end_reason_t)rec->status));
+        cJSON_AddNumberToObject(job, "bytes", rec->bytes);
+        cJSON_AddNumberToObject(job, "chunks", rec->chunks);
+        cJSON_AddNumberToObject(job, "duration_ms", rec->duration_ms);
+        cJSON_AddNumberToObject(job, "bytes_per_sec", rec->bytes_per_sec);
+        char crc[9];
+        snprintf(crc, sizeof(crc), "%08lx", (unsigned long)rec->crc32);
+        cJSON_AddStringToObject(job, "crc32", crc);
+        cJSON_AddNumberToObject(job, "width", rec->width);
+        cJSON_AddNumberToObject(job, "height", rec->height);
+        cJSON_AddItemToArray(jobs, job);
+    }
+    free(records);
+    cJSON_AddItemToObject(root, "jobs", jobs);
+
+    print_journal_stats_t stats;
+    print_journal_get_stats(&stats);
+    cJSON *info = cJSON_CreateObject();
+    cJSON_AddNumberToObject(info, "records", stats.records);
+    cJSON_AddNumberToObject(info, "file_records", stats.file_records);
+    cJSON_AddNumberToObject(info, "next_seq", stats.next_seq);
+    cJSON_AddNumberToObject(info, "appended", stats.appended);
+    cJSON_AddNumberToObject(info, "append_failures", stats.append_failures);
+    cJSON_AddNumberToObject(info, "pending", stats.pending);
+    cJSON_AddNumberToObject(info, "overflows", stats.overflows);
+    cJSON_AddNumberToObject(info, "repaired", stats.repaired);
+    cJSON_AddNumberToObject(info, "compactions", stats.compactions);
+    cJSON_AddItemToObject(root, "journal", info);
+
+    char *json_str = cJSON_Print(root);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, json_str, strlen(json_str));
+    free(json_str);
+    cJSON_Delete(root);
+    return ESP_OK;
+}
+
+static esp_err_t api_opcode_stats_handler(httpd_req_t *req) {
+    ble_opcode_stats_t stats[BLE_OPCODE_STATS_MAX];
+    size_t count = ble_peripheral_get_opcode_stats(stats, BLE_OPCODE_STATS_MAX);
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON *handlers = cJSON_CreateArray();
+    for (size_t i = 0; i < count; i++) {
+        cJSON *entry = cJSON_CreateObject();
+        // Wildcard entries report -1 (any function / any operation)
+        cJSON_AddNumberToObject(entry, "function", stats[i].function == BLE_OPCODE_ANY ? -1 : stats[i].function);
+        cJSON_AddNumberToObject(entry, "operation", stats[i].operation == BLE_OPCODE_ANY ? -1 : stats[i].operation);
+        cJSON_AddStringToObject(entry, "name", stats[i].name);
+        cJSON_AddNumberToObject(entry, "calls", stats[i].calls);
+        cJSON_AddNumberToObject(entry, "total_us", (double)stats[i].total_us);
+        cJSON_AddNumberToObject(entry, "avg_us", stats[i].calls > 0 ? (double)(stats[i].total_us / stats[i].calls) : 0);
+        cJSON_AddNumberToObject(entry, "max_us", stats[i].max_us);
+        cJSON_AddNumberToObject(entry, "bytes_in", stats[i].bytes_in);
+        cJSON_AddNumberToObject(entry, "bytes_out", stats[i].bytes_out);
+        cJSON_AddItemToArray(handlers, entry);
+    }
+    cJSON_AddItemToObject(root, "handlers", handlers);
+
+    ble_response_cache_stats_t cache;
+    ble_peripheral_get_response_cache_stats(&cache);
+    cJSON *cache_info = cJSON_CreateObject();
+    cJSON_AddNumberToObject(cache_info, "hits", cache.hits);
+    cJSON_AddNumberToObject(cache_info, "misses", cache.misses);
+    cJSON_AddItemToObject(root, "response_cache", cache_info);
+
+    char *json_str = cJSON_Print(root);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, json_str, strlen(json_str));
+
+    free(json_str);
+    cJSON_Delete(root);
+    return ESP_OK;
+}
+
+// Handler for resetting per-opcode dispatch statistics
+static esp_err_t api_opcode_stats_reset_handler(httpd_req_t *req) {
+    ble_peripheral_reset_opcode_stats();
+
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddBoolToObject(response, "success", true);
+    char *response_str = cJSON_Print(response);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response_str, strlen(response_str));
+
+    free(response_str);
+    cJSON_Delete(response);
+    return ESP_OK;
+}
+
 // Handler for resetting DIS to model defaults
 static esp_err_t api_reset_dis_defaults_handler(httpd_req_t *req) {
     esp_err_t result = printer_emulator_reset_dis_to_defaults();
@@ -2169,7 +3019,7 @@ esp_err_t web_server_start(void) {
     }
 
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-    config.max_uri_handlers = 34;  // Increased for printer settings, DIS endpoints, bonding control, and documentation
+    config.max_uri_handlers = 41;  // Increased for printer settings, DIS endpoints, bonding control, diagnostics, retention, transport profiles, and documentation
     config.stack_size = 8192;
     config.uri_match_fn = httpd_uri_match_wildcard;  // Enable wildcard matching for /api/files/*
 
@@ -2185,6 +3035,7 @@ esp_err_t web_server_start(void) {
     httpd_uri_t printer_info_uri = { .uri = "/api/printer-info", .method = HTTP_GET, .handler = api_printer_info_handler };
     httpd_uri_t files_uri = { .uri = "/api/files", .method = HTTP_GET, .handler = api_files_handler };
     httpd_uri_t file_download_uri = { .uri = "/api/files/*", .method = HTTP_GET, .handler = api_file_download_handler };
+    httpd_uri_t thumb_uri = { .uri = "/api/thumbs/*", .method = HTTP_GET, .handler = api_thumb_handler };
     httpd_uri_t file_delete_uri = { .uri = "/api/files", .method = HTTP_DELETE, .handler = api_file_delete_handler };  // Use query param
     httpd_uri_t delete_all_uri = { .uri = "/api/files-delete-all", .method = HTTP_POST, .handler = api_delete_all_handler };
     httpd_uri_t upload_uri = { .uri = "/api/upload", .method = HTTP_POST, .handler = api_upload_handler };
@@ -2197,6 +3048,14 @@ esp_err_t web_server_start(void) {
     httpd_uri_t set_prints_uri = { .uri = "/api/set-prints", .method = HTTP_POST, .handler = api_set_prints_handler };
     httpd_uri_t set_charging_uri = { .uri = "/api/set-charging", .method = HTTP_POST, .handler = api_set_charging_handler };
     httpd_uri_t set_suspend_decrement_uri = { .uri = "/api/set-suspend-decrement", .method = HTTP_POST, .handler = api_set_suspend_decrement_handler };
+    httpd_uri_t set_ack_pacing_uri = { .uri = "/api/set-ack-pacing", .method = HTTP_POST, .handler = api_set_ack_pacing_handler };
+    httpd_uri_t set_retention_uri = { .uri = "/api/set-retention", .method = HTTP_POST, .handler = api_set_retention_handler };
+    httpd_uri_t set_transport_profile_uri = { .uri = "/api/set-transport-profile", .method = HTTP_POST, .handler = api_set_transport_profile_handler };
+    httpd_uri_t journal_uri = { .uri = "/api/journal", .method = HTTP_GET, .handler = api_journal_handler };
+    httpd_uri_t opcode_stats_uri = { .uri = "/api/opcode-stats", .method = HTTP_GET, .handler = api_opcode_stats_handler };
+    httpd_uri_t opcode_stats_reset_uri = { .uri = "/api/opcode-stats-reset", .method = HTTP_POST, .handler = api_opcode_stats_reset_handler };
+    httpd_uri_t trace_uri = { .uri = "/api/trace", .method = HTTP_GET, .handler = api_trace_handler };
+    httpd_uri_t trace_level_uri = { .uri = "/api/trace-level", .method = HTTP_POST, .handler = api_trace_level_handler };
     httpd_uri_t set_bonding_uri = { .uri = "/api/set-bonding", .method = HTTP_POST, .handler = api_set_bonding_handler };
     httpd_uri_t clear_bonds_uri = { .uri = "/api/clear-bonds", .method = HTTP_POST, .handler = api_clear_bonds_handler };
     httpd_uri_t set_cover_open_uri = { .uri = "/api/set-cover-open", .method = HTTP_POST, .handler = api_set_cover_open_handler };
@@ -2217,6 +3076,7 @@ esp_err_t web_server_start(void) {
     httpd_register_uri_handler(s_server, &printer_info_uri);
     httpd_register_uri_handler(s_server, &files_uri);  // Register exact match first
     httpd_register_uri_handler(s_server, &file_download_uri);  // Then wildcard GET
+    httpd_register_uri_handler(s_server, &thumb_uri);
     httpd_register_uri_handler(s_server, &file_delete_uri);  // DELETE handler
     httpd_register_uri_handler(s_server, &delete_all_uri);  // Delete all handler
     httpd_register_uri_handler(s_server, &upload_uri);
@@ -2229,6 +3089,14 @@ esp_err_t web_server_start(void) {
     httpd_register_uri_handler(s_server, &set_prints_uri);
     httpd_register_uri_handler(s_server, &set_charging_uri);
     httpd_register_uri_handler(s_server, &set_suspend_decrement_uri);
+    httpd_register_uri_handler(s_server, &set_ack_pacing_uri);
+    httpd_register_uri_handler(s_server, &set_retention_uri);
+    httpd_register_uri_handler(s_server, &set_transport_profile_uri);
+    httpd_register_uri_handler(s_server, &journal_uri);
+    httpd_register_uri_handler(s_server, &opcode_stats_uri);
+    httpd_register_uri_handler(s_server, &opcode_stats_reset_uri);
+    httpd_register_uri_handler(s_server, &trace_uri);
+    httpd_register_uri_handler(s_server, &trace_level_uri);
     httpd_register_uri_handler(s_server, &set_bonding_uri);
     httpd_register_uri_handler(s_server, &clear_bonds_uri);
     httpd_register_uri_handler(s_server, &set_cover_open_uri);